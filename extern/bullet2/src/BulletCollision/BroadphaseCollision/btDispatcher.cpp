@@ -14,9 +14,15 @@ subject to the following restrictions:
 */
 
 #include "btDispatcher.h"
+#include "BulletCollision/NarrowPhaseCollision/btPersistentManifold.h"
 
 btDispatcher::~btDispatcher()
 {
 
 }
 
+btScalar	btDispatcher::getContactBreakingThreshold() const
+{
+	return gContactBreakingThreshold;
+}
+
@@ -101,6 +101,9 @@ public:
 
 	virtual	void freeCollisionAlgorithm(void* ptr) = 0;
 
+	///maximum contact breaking and merging threshold of the contacts found by this dispatcher, gContactBreakingThreshold by default
+	virtual	btScalar	getContactBreakingThreshold() const;
+
 };
 
 
@@ -36,6 +36,7 @@ int gNumManifold = 0;
 
 btCollisionDispatcher::btCollisionDispatcher (btCollisionConfiguration* collisionConfiguration): 
 m_dispatcherFlags(btCollisionDispatcher::CD_USE_RELATIVE_CONTACT_BREAKING_THRESHOLD),
+	m_contactBreakingThreshold(gContactBreakingThreshold),
 	m_collisionConfiguration(collisionConfiguration)
 {
 	int i;
@@ -79,8 +80,8 @@ btPersistentManifold*	btCollisionDispatcher::getNewManifold(const btCollisionObj
 	//optional relative contact breaking threshold, turned on by default (use setDispatcherFlags to switch off feature for improved performance)
 	
 	btScalar contactBreakingThreshold =  (m_dispatcherFlags & btCollisionDispatcher::CD_USE_RELATIVE_CONTACT_BREAKING_THRESHOLD) ? 
-		btMin(body0->getCollisionShape()->getContactBreakingThreshold(gContactBreakingThreshold) , body1->getCollisionShape()->getContactBreakingThreshold(gContactBreakingThreshold))
-		: gContactBreakingThreshold ;
+		btMin(body0->getCollisionShape()->getContactBreakingThreshold(m_contactBreakingThreshold) , body1->getCollisionShape()->getContactBreakingThreshold(m_contactBreakingThreshold))
+		: m_contactBreakingThreshold ;
 
 	btScalar contactProcessingThreshold = btMin(body0->getContactProcessingThreshold(),body1->getContactProcessingThreshold());
 		
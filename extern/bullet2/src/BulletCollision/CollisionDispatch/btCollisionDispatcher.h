@@ -47,6 +47,8 @@ protected:
 
 	int		m_dispatcherFlags;
 
+	btScalar	m_contactBreakingThreshold;
+
 	btAlignedObjectArray<btPersistentManifold*>	m_manifoldsPtr;
 
 	btManifoldResult	m_defaultManifoldResult;
@@ -81,6 +83,17 @@ public:
 		m_dispatcherFlags = flags;
 	}
 
+	virtual	btScalar	getContactBreakingThreshold() const
+	{
+		return m_contactBreakingThreshold;
+	}
+
+	///set the contact breaking threshold of this dispatcher and its world, instead of the global gContactBreakingThreshold
+	void	setContactBreakingThreshold(btScalar threshold)
+	{
+		m_contactBreakingThreshold = threshold;
+	}
+
 	///registerCollisionCreateFunc allows registration of custom/alternative collision create functions
 	void	registerCollisionCreateFunc(int proxyType0,int proxyType1, btCollisionAlgorithmCreateFunc* createFunc);
 
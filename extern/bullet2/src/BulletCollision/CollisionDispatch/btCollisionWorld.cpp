@@ -149,7 +149,8 @@ void	btCollisionWorld::updateSingleAabb(btCollisionObject* colObj)
 	btVector3 minAabb,maxAabb;
 	colObj->getCollisionShape()->getAabb(colObj->getWorldTransform(), minAabb,maxAabb);
 	//need to increase the aabb for contact thresholds
-	btVector3 contactThreshold(gContactBreakingThreshold,gContactBreakingThreshold,gContactBreakingThreshold);
+	const btScalar contactBreakingThreshold = m_dispatcher1->getContactBreakingThreshold();
+	btVector3 contactThreshold(contactBreakingThreshold,contactBreakingThreshold,contactBreakingThreshold);
 	minAabb -= contactThreshold;
 	maxAabb += contactThreshold;
 
@@ -1493,7 +1494,8 @@ void	btCollisionWorld::debugDrawWorld()
 						btVector3 minAabb,maxAabb;
 						btVector3 colorvec = defaultColors.m_aabb;
 						colObj->getCollisionShape()->getAabb(colObj->getWorldTransform(), minAabb,maxAabb);
-						btVector3 contactThreshold(gContactBreakingThreshold,gContactBreakingThreshold,gContactBreakingThreshold);
+						const btScalar contactBreakingThreshold = m_dispatcher1->getContactBreakingThreshold();
+						btVector3 contactThreshold(contactBreakingThreshold,contactBreakingThreshold,contactBreakingThreshold);
 						minAabb -= contactThreshold;
 						maxAabb += contactThreshold;
 
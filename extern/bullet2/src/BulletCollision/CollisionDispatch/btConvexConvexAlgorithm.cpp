@@ -613,11 +613,11 @@ void btConvexConvexAlgorithm ::processCollision (const btCollisionObjectWrapper*
 			btScalar radiusB = min1->getAngularMotionDisc();
 			if (radiusA < radiusB)
 			{
-				perturbeAngle = gContactBreakingThreshold /radiusA;
+				perturbeAngle = m_dispatcher->getContactBreakingThreshold() /radiusA;
 				perturbeA = true;
 			} else
 			{
-				perturbeAngle = gContactBreakingThreshold / radiusB;
+				perturbeAngle = m_dispatcher->getContactBreakingThreshold() / radiusB;
 				perturbeA = false;
 			}
 			if ( perturbeAngle > angleLimit ) 
@@ -140,7 +140,7 @@ void btConvexPlaneCollisionAlgorithm::processCollision (const btCollisionObjectW
 		const btScalar angleLimit = 0.125f * SIMD_PI;
 		btScalar perturbeAngle;
 		btScalar radius = convexShape->getAngularMotionDisc();
-		perturbeAngle = gContactBreakingThreshold / radius;
+		perturbeAngle = m_dispatcher->getContactBreakingThreshold() / radius;
 		if ( perturbeAngle > angleLimit ) 
 				perturbeAngle = angleLimit;
 
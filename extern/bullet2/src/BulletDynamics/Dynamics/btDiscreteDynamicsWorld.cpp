@@ -211,7 +211,8 @@ m_fixedTimeStep(0),
 m_synchronizeAllMotionStates(false),
 m_applySpeculativeContactRestitution(false),
 m_profileTimings(0),
-m_latencyMotionStateInterpolation(true)
+m_latencyMotionStateInterpolation(true),
+m_deactivationTime(gDeactivationTime)
 
 {
 	if (!m_constraintSolver)
@@ -629,7 +630,7 @@ void	btDiscreteDynamicsWorld::updateActivationState(btScalar timeStep)
 		{
 			body->updateDeactivation(timeStep);
 
-			if (body->wantsSleeping())
+			if (body->wantsSleeping(m_deactivationTime))
 			{
 				if (body->isStaticOrKinematicObject())
 				{
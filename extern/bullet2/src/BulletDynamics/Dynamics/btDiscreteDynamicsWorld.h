@@ -67,6 +67,9 @@ protected:
 
 	bool	m_latencyMotionStateInterpolation;
 
+	///time before a body wants to sleep, gDeactivationTime by default
+	btScalar	m_deactivationTime;
+
 	btAlignedObjectArray<btPersistentManifold*>	m_predictiveManifolds;
 
 	virtual void	predictUnconstraintMotion(btScalar timeStep);
@@ -229,6 +232,16 @@ public:
 	{
 		return m_latencyMotionStateInterpolation;
 	}
+
+	///set the deactivation time of the bodies of this world, instead of the global gDeactivationTime
+	void	setDeactivationTime(btScalar deactivationTime)
+	{
+		m_deactivationTime = deactivationTime;
+	}
+	btScalar	getDeactivationTime() const
+	{
+		return m_deactivationTime;
+	}
 };
 
 #endif //BT_DISCRETE_DYNAMICS_WORLD_H
@@ -433,19 +433,25 @@ public:
 	}
 
 	SIMD_FORCE_INLINE bool	wantsSleeping()
+	{
+		return wantsSleeping(gDeactivationTime);
+	}
+
+	///deactivationTime replaces gDeactivationTime, for worlds using their own value
+	SIMD_FORCE_INLINE bool	wantsSleeping(btScalar deactivationTime)
 	{
 
 		if (getActivationState() == DISABLE_DEACTIVATION)
 			return false;
 
 		//disable deactivation
-		if (gDisableDeactivation || (gDeactivationTime == btScalar(0.)))
+		if (gDisableDeactivation || (deactivationTime == btScalar(0.)))
 			return false;
 
 		if ( (getActivationState() == ISLAND_SLEEPING) || (getActivationState() == WANTS_DEACTIVATION))
 			return true;
 
-		if (m_deactivationTime> gDeactivationTime)
+		if (m_deactivationTime> deactivationTime)
 		{
 			return true;
 		}
@@ -69,6 +69,9 @@ class DATA_PT_skeleton(ArmatureButtonsPanel, Panel):
             col = layout.column()
             col.label(text="Deform:")
             col.prop(arm, "deform_method", expand=True)
+            sub = col.column()
+            sub.active = (arm.deform_method == 'BGE_CPU')
+            sub.prop(arm, "use_shared_deformation")
 
 
 class DATA_PT_display(ArmatureButtonsPanel, Panel):
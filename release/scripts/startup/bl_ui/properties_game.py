@@ -410,6 +410,10 @@ class RENDER_PT_game_system(RenderButtonsPanel, Panel):
         col = split.column()
         col.prop(gs, "use_frame_rate")
         col.prop(gs, "use_deprecation_warnings")
+        col.prop(gs, "use_python_bytecode_cache")
+        sub = col.column()
+        sub.active = gs.use_python_bytecode_cache
+        sub.prop(gs, "use_python_bytecode_pack")
 
         col = split.column()
         col.prop(gs, "vsync")
@@ -539,6 +543,10 @@ class SCENE_PT_game_physics(SceneButtonsPanel, Panel):
             col.label(text="Object Activity:")
             col.prop(gs, "use_activity_culling")
 
+            row = layout.row()
+            row.prop(gs, "use_parallel_scenes")
+            row.prop(gs, "use_parallel_physics")
+
         else:
             split = layout.split()
 
@@ -654,6 +662,30 @@ class SCENE_PT_game_hysteresis(SceneButtonsPanel, Panel):
         row.prop(gs, "scene_hysteresis_percentage", text="")
 
 
+class SCENE_PT_game_batching(SceneButtonsPanel, Panel):
+    bl_label = "Automatic Batching"
+    bl_options = {'DEFAULT_CLOSED'}
+    COMPAT_ENGINES = {'BLENDER_GAME'}
+
+    @classmethod
+    def poll(cls, context):
+        scene = context.scene
+        return (scene and scene.render.engine in cls.COMPAT_ENGINES)
+
+    def draw_header(self, context):
+        gs = context.scene.game_settings
+
+        self.layout.prop(gs, "use_auto_batching", text="")
+
+    def draw(self, context):
+        layout = self.layout
+
+        gs = context.scene.game_settings
+        row = layout.row()
+        row.active = gs.use_auto_batching
+        row.prop(gs, "batch_size")
+
+
 class SCENE_PT_game_console(SceneButtonsPanel, Panel):
     bl_label = "Python Console"
     COMPAT_ENGINES = {'BLENDER_GAME'}
@@ -994,6 +1026,7 @@ classes = (
     SCENE_PT_game_physics_obstacles,
     SCENE_PT_game_navmesh,
     SCENE_PT_game_hysteresis,
+    SCENE_PT_game_batching,
     SCENE_PT_game_console,
     WORLD_PT_game_context_world,
     WORLD_PT_game_world,
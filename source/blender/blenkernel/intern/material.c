@@ -501,7 +501,7 @@ Material *BKE_material_pop_id(Main *bmain, ID *id, int index_i, bool update_data
 
 				(*totcol)--;
 				*matar = MEM_reallocN(*matar, sizeof(void *) * (*totcol));
-				test_all_objects_materials(G.main, id);
+				test_all_objects_materials(bmain, id);
 			}
 
 			if (update_data) {
@@ -1920,9 +1920,9 @@ static short mesh_getmaterialnumber(Mesh *me, Material *ma)
 }
 
 /* append material */
-static short mesh_addmaterial(Mesh *me, Material *ma)
+static short mesh_addmaterial(Main *main, Mesh *me, Material *ma)
 {
-	BKE_material_append_id(G.main, &me->id, NULL);
+	BKE_material_append_id(main, &me->id, NULL);
 	me->mat[me->totcol - 1] = ma;
 
 	id_us_plus(&ma->id);
@@ -1954,7 +1954,7 @@ static short convert_tfacenomaterial(Main *main, Mesh *me, MTFace *tf, int flag)
 	if ((ma = BLI_findstring(&main->mat, idname + 2, offsetof(ID, name) + 2))) {
 		mat_nr = mesh_getmaterialnumber(me, ma);
 		/* assign the material to the mesh */
-		if (mat_nr == -1) mat_nr = mesh_addmaterial(me, ma);
+		if (mat_nr == -1) mat_nr = mesh_addmaterial(main, me, ma);
 
 		/* if needed set "Face Textures [Alpha]" Material options */
 		set_facetexture_flags(ma, tf->tpage);
@@ -1965,7 +1965,7 @@ static short convert_tfacenomaterial(Main *main, Mesh *me, MTFace *tf, int flag)
 
 		if (ma) {
 			printf("TexFace Convert: Material \"%s\" created.\n", idname + 2);
-			mat_nr = mesh_addmaterial(me, ma);
+			mat_nr = mesh_addmaterial(main, me, ma);
 			
 			/* if needed set "Face Textures [Alpha]" Material options */
 			set_facetexture_flags(ma, tf->tpage);
@@ -2028,7 +2028,7 @@ static void convert_tfacematerial(Main *main, Material *ma)
 				/* material already existent, see if the mesh has it */
 				mat_nr = mesh_getmaterialnumber(me, mat_new);
 				/* material is not in the mesh, add it */
-				if (mat_nr == -1) mat_nr = mesh_addmaterial(me, mat_new);
+				if (mat_nr == -1) mat_nr = mesh_addmaterial(main, me, mat_new);
 			}
 			/* create a new material */
 			else {
@@ -2038,7 +2038,7 @@ static void convert_tfacematerial(Main *main, Material *ma)
 					BLI_strncpy(mat_new->id.name, idname, sizeof(mat_new->id.name));
 					id_us_min((ID *)mat_new);
 
-					mat_nr = mesh_addmaterial(me, mat_new);
+					mat_nr = mesh_addmaterial(main, me, mat_new);
 					decode_tfaceflag(mat_new, flag, 1);
 				}
 				else {
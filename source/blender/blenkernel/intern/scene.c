@@ -85,6 +85,7 @@
 #include "BKE_mask.h"
 #include "BKE_node.h"
 #include "BKE_object.h"
+#include "BKE_packedFile.h"
 #include "BKE_paint.h"
 #include "BKE_rigidbody.h"
 #include "BKE_scene.h"
@@ -190,6 +191,10 @@ void BKE_scene_copy_data(Main *bmain, Scene *sce_dst, const Scene *sce_src, cons
 		sce_dst->rigidbody_world = BKE_rigidbody_world_copy(sce_src->rigidbody_world, flag_subdata);
 	}
 
+	if (sce_src->gm.pybytecode) {
+		sce_dst->gm.pybytecode = dupPackedFile(sce_src->gm.pybytecode);
+	}
+
 	/* copy Freestyle settings */
 	for (SceneRenderLayer *srl_dst = sce_dst->r.layers.first, *srl_src = sce_src->r.layers.first;
 	     srl_src;
@@ -303,6 +308,9 @@ Scene *BKE_scene_copy(Main *bmain, Scene *sce, int type)
 		sce_copy->unit = sce->unit;
 		sce_copy->physics_settings = sce->physics_settings;
 		sce_copy->gm = sce->gm;
+		if (sce->gm.pybytecode) {
+			sce_copy->gm.pybytecode = dupPackedFile(sce->gm.pybytecode);
+		}
 		sce_copy->audio = sce->audio;
 
 		if (sce->id.properties)
@@ -543,6 +551,11 @@ void BKE_scene_free(Scene *sce)
 
 	BKE_color_managed_view_settings_free(&sce->view_settings);
 
+	if (sce->gm.pybytecode) {
+		freePackedFile(sce->gm.pybytecode);
+		sce->gm.pybytecode = NULL;
+	}
+
 	BKE_previewimg_free(&sce->preview);
 	curvemapping_free_data(&sce->r.mblur_shutter_curve);
 }
@@ -815,6 +828,8 @@ void BKE_scene_init(Scene *sce)
 	sce->gm.lodflag = SCE_LOD_USE_HYST;
 	sce->gm.scehysteresis = 10;
 
+	sce->gm.batchSize = 32;
+
 	sce->gm.exitkey = 218; // Blender key code for ESC
 
 	sce->gm.pythonkeys[0] = LEFTCTRLKEY;
@@ -0,0 +1,50 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_GZIP_WRITER_H__
+#define __BLI_GZIP_WRITER_H__
+
+/** \file BLI_gzip_writer.h
+ *  \ingroup bli
+ *  \brief Gzip files compressed on worker threads, with an index of their members.
+ */
+
+#include "BLI_compiler_attrs.h"
+
+typedef struct GzipWriter GzipWriter;
+
+/* A gzip member of a file, decompressed independently from the others. */
+typedef struct GzipMember {
+	/* position of the member in the file */
+	size_t offset;
+	/* position of its data in the decompressed stream */
+	size_t data_offset;
+	unsigned int size;
+	unsigned int data_size;
+} GzipMember;
+
+GzipWriter *BLI_gzip_writer_open(const char *filepath, int level) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+bool BLI_gzip_writer_write(GzipWriter *gw, const void *buf, size_t buf_len) ATTR_NONNULL();
+bool BLI_gzip_writer_close(GzipWriter *gw) ATTR_NONNULL();
+
+bool BLI_gzip_index_read(int file, GzipMember **r_members, unsigned int *r_members_len) ATTR_NONNULL();
+bool BLI_gzip_member_read(int file, const GzipMember *member, void *r_data) ATTR_NONNULL();
+
+#endif  /* __BLI_GZIP_WRITER_H__ */
@@ -0,0 +1,46 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+#ifndef __BLI_MMAP_H__
+#define __BLI_MMAP_H__
+
+/** \file BLI_mmap.h
+ *  \ingroup bli
+ *  \brief Map a whole file in memory.
+ *
+ * The mapping is private: pages written by the caller are copied on write
+ * and never reach the file. Reading a truncated file or an I/O error don't
+ * crash, the mapping is then read as zeros and flagged with an I/O error.
+ */
+
+#include "BLI_compiler_attrs.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct BLI_mmap_file BLI_mmap_file;
+
+BLI_mmap_file *BLI_mmap_open(int file) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void *BLI_mmap_get_pointer(BLI_mmap_file *mmap_file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+size_t BLI_mmap_get_length(const BLI_mmap_file *mmap_file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+bool BLI_mmap_any_io_error(const BLI_mmap_file *mmap_file) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+void BLI_mmap_free(BLI_mmap_file *mmap_file) ATTR_NONNULL(1);
+
+#endif  /* __BLI_MMAP_H__ */
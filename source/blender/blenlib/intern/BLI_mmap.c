@@ -0,0 +1,221 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/BLI_mmap.c
+ *  \ingroup bli
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_mmap.h"
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#ifdef WIN32
+#  include <windows.h>
+#  include <io.h>
+#else
+#  include <signal.h>
+#  include <sys/mman.h>
+#endif
+
+struct BLI_mmap_file {
+	struct BLI_mmap_file *next, *prev;
+	/* The address of the mapping. */
+	void *memory;
+	/* The size of the mapped file. */
+	size_t length;
+	/* Set when reading the file failed, the mapping is then replaced by zeroed pages. */
+	volatile bool io_error;
+#ifdef WIN32
+	HANDLE handle;
+#endif
+};
+
+/* The open mappings, looked up by the error handler. */
+static ListBase open_mmaps = {NULL, NULL};
+static ThreadMutex open_mmaps_mutex = BLI_MUTEX_INITIALIZER;
+static bool error_handler_installed = false;
+
+/**
+ * A read of a mapping fails with a signal or an exception when the file was truncated
+ * or on an I/O error. Flag the mapping and replace it with zeroed pages, the read
+ * then continues and the caller checks #BLI_mmap_any_io_error.
+ * eturn False if the address isn't part of a mapping.
+ */
+static bool mmap_handle_error(void *address)
+{
+	/* Not locked, the faulting mapping can't be freed while it's read. */
+	for (BLI_mmap_file *mmap_file = open_mmaps.first; mmap_file; mmap_file = mmap_file->next) {
+		char *memory = mmap_file->memory;
+		if ((char *)address >= memory && (char *)address < memory + mmap_file->length) {
+			mmap_file->io_error = true;
+#ifdef WIN32
+			UnmapViewOfFile(memory);
+			return (VirtualAlloc(memory, mmap_file->length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE) != NULL);
+#else
+			return (mmap(memory, mmap_file->length, PROT_READ | PROT_WRITE,
+			             MAP_PRIVATE | MAP_ANON | MAP_FIXED, -1, 0) != MAP_FAILED);
+#endif
+		}
+	}
+
+	return false;
+}
+
+#ifdef WIN32
+static LONG WINAPI mmap_exception_handler(EXCEPTION_POINTERS *info)
+{
+	const EXCEPTION_RECORD *record = info->ExceptionRecord;
+	if (record->ExceptionCode == EXCEPTION_IN_PAGE_ERROR && record->NumberParameters >= 2 &&
+	    mmap_handle_error((void *)record->ExceptionInformation[1]))
+	{
+		return EXCEPTION_CONTINUE_EXECUTION;
+	}
+
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+#else
+static struct sigaction previous_sigbus_action;
+
+static void mmap_sigbus_handler(int sig, siginfo_t *siginfo, void *context)
+{
+	if (mmap_handle_error(siginfo->si_addr)) {
+		return;
+	}
+
+	/* Not a mapped file, forward to the previous handler. */
+	if (previous_sigbus_action.sa_flags & SA_SIGINFO) {
+		previous_sigbus_action.sa_sigaction(sig, siginfo, context);
+	}
+	else if (previous_sigbus_action.sa_handler != SIG_DFL && previous_sigbus_action.sa_handler != SIG_IGN) {
+		previous_sigbus_action.sa_handler(sig);
+	}
+	else {
+		/* The faulting instruction runs again with the default action. */
+		sigaction(SIGBUS, &previous_sigbus_action, NULL);
+	}
+}
+#endif
+
+static void mmap_install_error_handler(void)
+{
+	if (error_handler_installed) {
+		return;
+	}
+
+#ifdef WIN32
+	AddVectoredExceptionHandler(0, mmap_exception_handler);
+#else
+	struct sigaction action = {{0}};
+	action.sa_sigaction = mmap_sigbus_handler;
+	action.sa_flags = SA_SIGINFO;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGBUS, &action, &previous_sigbus_action);
+#endif
+
+	error_handler_installed = true;
+}
+
+/**
+ * Map the whole file of a descriptor, the descriptor can be closed after.
+ * \return NULL for empty files or if the file can't be mapped.
+ */
+BLI_mmap_file *BLI_mmap_open(int file)
+{
+	const size_t length = BLI_file_descriptor_size(file);
+	if (length == 0 || length == (size_t)-1) {
+		return NULL;
+	}
+
+#ifdef WIN32
+	HANDLE handle = CreateFileMapping((HANDLE)_get_osfhandle(file), NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (handle == NULL) {
+		return NULL;
+	}
+
+	void *memory = MapViewOfFile(handle, FILE_MAP_COPY, 0, 0, 0);
+	if (memory == NULL) {
+		CloseHandle(handle);
+		return NULL;
+	}
+#else
+	void *memory = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	if (memory == MAP_FAILED) {
+		return NULL;
+	}
+#endif
+
+	BLI_mmap_file *mmap_file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+	mmap_file->memory = memory;
+	mmap_file->length = length;
+#ifdef WIN32
+	mmap_file->handle = handle;
+#endif
+
+	BLI_mutex_lock(&open_mmaps_mutex);
+	mmap_install_error_handler();
+	BLI_addtail(&open_mmaps, mmap_file);
+	BLI_mutex_unlock(&open_mmaps_mutex);
+
+	return mmap_file;
+}
+
+void *BLI_mmap_get_pointer(BLI_mmap_file *mmap_file)
+{
+	return mmap_file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *mmap_file)
+{
+	return mmap_file->length;
+}
+
+/**
+ * Return true if reading the file failed since it was mapped, the data
+ * read after the error are zeros.
+ */
+bool BLI_mmap_any_io_error(const BLI_mmap_file *mmap_file)
+{
+	return mmap_file->io_error;
+}
+
+void BLI_mmap_free(BLI_mmap_file *mmap_file)
+{
+	BLI_mutex_lock(&open_mmaps_mutex);
+	BLI_remlink(&open_mmaps, mmap_file);
+	BLI_mutex_unlock(&open_mmaps_mutex);
+
+#ifdef WIN32
+	/* The view was replaced by allocated pages on error. */
+	if (mmap_file->io_error) {
+		VirtualFree(mmap_file->memory, 0, MEM_RELEASE);
+	}
+	else {
+		UnmapViewOfFile(mmap_file->memory);
+	}
+	CloseHandle(mmap_file->handle);
+#else
+	munmap(mmap_file->memory, mmap_file->length);
+#endif
+
+	MEM_freeN(mmap_file);
+}
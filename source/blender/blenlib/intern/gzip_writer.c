@@ -0,0 +1,495 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file blender/blenlib/intern/gzip_writer.c
+ *  \ingroup bli
+ *
+ * The data is split in parts compressed on worker threads, each part is written as a
+ * complete gzip member once it's compressed and all the previous ones are written.
+ * Concatenated members are read back as a single stream by gzread, so the files stay
+ * readable by any gzip reader.
+ *
+ * The file ends with an empty member whose header extra field is the index of the
+ * other members, so that any part of the data can be decompressed alone:
+ * - subfield "BI": the compressed and decompressed size of each member,
+ *   as 32 bit little endian integers.
+ * - subfield "BE": the size of the index member, the last bytes of the extra field
+ *   are then at a fixed distance from the end of the file.
+ *
+ * Files with more members than fit in the 64kb extra field have no index.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+
+#include "zlib.h"
+
+#ifdef WIN32
+#  include <io.h>
+#  include "BLI_winstuff.h"
+#else
+#  include <unistd.h>
+#endif
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BLI_gzip_writer.h"  /* own include */
+
+/* Deflate only looks back 32kb, splitting the data in parts of this size barely
+ * changes the compression ratio. */
+#define GZIP_PART_SIZE  (1 << 18)  /* 256kb */
+/* Parts compressed at the same time per thread, and at most, which bounds the memory used. */
+#define GZIP_PARTS_PER_THREAD 2
+#define GZIP_PARTS_MAX 16
+/* Bound of the compressed size of a part, with the gzip header and trailer. */
+#define GZIP_PART_BOUND (compressBound(GZIP_PART_SIZE) + 32)
+
+#define GZIP_HEADER_SIZE 10
+#define GZIP_XLEN_SIZE 2
+#define GZIP_TRAILER_SIZE 8
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_EXTRA_MAX 0xFFFF
+/* Two identifier bytes and the length of a subfield of the extra field. */
+#define GZIP_SUBFIELD_HEADER_SIZE 4
+
+#define GZIP_INDEX_ENTRY_SIZE 8
+#define GZIP_INDEX_END_SIZE (GZIP_SUBFIELD_HEADER_SIZE + 4)
+#define GZIP_INDEX_MEMBERS_MAX \
+	((GZIP_EXTRA_MAX - GZIP_SUBFIELD_HEADER_SIZE - GZIP_INDEX_END_SIZE) / GZIP_INDEX_ENTRY_SIZE)
+/* Deflate data of the empty index member and its trailer, no checksum and no size. */
+static const unsigned char gzip_index_data[] = {0x03, 0x00, 0, 0, 0, 0, 0, 0, 0, 0};
+
+typedef struct GzipWriterPart {
+	struct GzipWriter *gw;
+	char *in, *out;
+	unsigned int in_len, out_len;
+	/* set by the compressing thread under the writer mutex */
+	bool done, error;
+} GzipWriterPart;
+
+struct GzipWriter {
+	int file_handle;
+	int level;
+	TaskPool *pool;
+	ThreadMutex mutex;
+	ThreadCondition cond;
+	/* ring of parts, the queued parts from 'head' in the file order, then the filled one */
+	GzipWriterPart *parts;
+	int parts_len, head, queued;
+	/* compressed and decompressed size of each written member */
+	unsigned int *index;
+	unsigned int index_len, index_alloc;
+	bool error;
+};
+
+static void gzip_part_compress(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	GzipWriterPart *part = taskdata;
+	GzipWriter *gw = part->gw;
+	z_stream stream = {NULL};
+	bool error = true;
+
+	/* window bits over 15 write a gzip header */
+	if (deflateInit2(&stream, gw->level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+		stream.next_in = (Bytef *)part->in;
+		stream.avail_in = part->in_len;
+		stream.next_out = (Bytef *)part->out;
+		stream.avail_out = GZIP_PART_BOUND;
+
+		if (deflate(&stream, Z_FINISH) == Z_STREAM_END) {
+			part->out_len = (unsigned int)stream.total_out;
+			error = false;
+		}
+
+		deflateEnd(&stream);
+	}
+
+	BLI_mutex_lock(&gw->mutex);
+	part->error = error;
+	part->done = true;
+	BLI_condition_notify_all(&gw->cond);
+	BLI_mutex_unlock(&gw->mutex);
+}
+
+static void gzip_member_write(GzipWriter *gw, const void *data, unsigned int size, unsigned int data_size)
+{
+	if (gw->error) {
+		return;
+	}
+
+	if (write(gw->file_handle, data, size) != (int)size) {
+		gw->error = true;
+		return;
+	}
+
+	if (gw->index_len == gw->index_alloc) {
+		gw->index_alloc *= 2;
+		gw->index = MEM_reallocN(gw->index, sizeof(*gw->index) * 2 * gw->index_alloc);
+	}
+	gw->index[gw->index_len * 2] = size;
+	gw->index[gw->index_len * 2 + 1] = data_size;
+	gw->index_len++;
+}
+
+static GzipWriterPart *gzip_part_filled(GzipWriter *gw)
+{
+	return &gw->parts[(gw->head + gw->queued) % gw->parts_len];
+}
+
+/* Write the compressed parts in the file order, waiting for them while more than
+ * 'queued_max' parts are queued. */
+static void gzip_parts_write(GzipWriter *gw, int queued_max)
+{
+	while (gw->queued > 0) {
+		GzipWriterPart *part = &gw->parts[gw->head];
+
+		BLI_mutex_lock(&gw->mutex);
+		if (gw->queued > queued_max) {
+			while (!part->done) {
+				BLI_condition_wait(&gw->cond, &gw->mutex);
+			}
+		}
+		const bool done = part->done;
+		BLI_mutex_unlock(&gw->mutex);
+
+		if (!done) {
+			break;
+		}
+
+		if (part->error) {
+			gw->error = true;
+		}
+		gzip_member_write(gw, part->out, part->out_len, part->in_len);
+
+		gw->head = (gw->head + 1) % gw->parts_len;
+		gw->queued--;
+	}
+}
+
+static void gzip_part_push(GzipWriter *gw)
+{
+	GzipWriterPart *part = gzip_part_filled(gw);
+
+	if (part->in_len == 0) {
+		return;
+	}
+
+	part->done = false;
+	BLI_task_pool_push(gw->pool, gzip_part_compress, part, false, TASK_PRIORITY_HIGH);
+	gw->queued++;
+
+	/* the compressed parts are written while the next one is filled, a part is waited
+	 * for only when all of them are queued */
+	gzip_parts_write(gw, gw->parts_len - 1);
+
+	gzip_part_filled(gw)->in_len = 0;
+}
+
+static unsigned char *gzip_le16_write(unsigned char *p, unsigned int value)
+{
+	p[0] = value & 0xFF;
+	p[1] = (value >> 8) & 0xFF;
+	return p + 2;
+}
+
+static unsigned char *gzip_le32_write(unsigned char *p, unsigned int value)
+{
+	p = gzip_le16_write(p, value & 0xFFFF);
+	return gzip_le16_write(p, value >> 16);
+}
+
+static unsigned int gzip_le16_read(const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static unsigned int gzip_le32_read(const unsigned char *p)
+{
+	return gzip_le16_read(p) | (gzip_le16_read(p + 2) << 16);
+}
+
+static unsigned int gzip_index_member_size(unsigned int extra_len)
+{
+	return GZIP_HEADER_SIZE + GZIP_XLEN_SIZE + extra_len + sizeof(gzip_index_data);
+}
+
+static void gzip_index_write(GzipWriter *gw)
+{
+	if (gw->error || gw->index_len > GZIP_INDEX_MEMBERS_MAX) {
+		return;
+	}
+
+	const unsigned int entries_len = gw->index_len * GZIP_INDEX_ENTRY_SIZE;
+	const unsigned int extra_len = GZIP_SUBFIELD_HEADER_SIZE + entries_len + GZIP_INDEX_END_SIZE;
+	const unsigned int member_size = gzip_index_member_size(extra_len);
+	unsigned char *extra = MEM_mallocN(extra_len, __func__);
+	unsigned char *out = MEM_mallocN(member_size + 32, __func__);
+
+	unsigned char *p = extra;
+	*p++ = 'B';
+	*p++ = 'I';
+	p = gzip_le16_write(p, entries_len);
+	for (unsigned int i = 0; i < gw->index_len * 2; i++) {
+		p = gzip_le32_write(p, gw->index[i]);
+	}
+	*p++ = 'B';
+	*p++ = 'E';
+	p = gzip_le16_write(p, 4);
+	p = gzip_le32_write(p, member_size);
+
+	gz_header header = {0};
+	header.extra = extra;
+	header.extra_len = extra_len;
+	header.os = 255;
+
+	z_stream stream = {NULL};
+	/* any level but 0 writes the same empty data */
+	if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+		stream.next_out = out;
+		stream.avail_out = member_size + 32;
+
+		if (deflateSetHeader(&stream, &header) == Z_OK &&
+		    deflate(&stream, Z_FINISH) == Z_STREAM_END &&
+		    stream.total_out == member_size)
+		{
+			if (write(gw->file_handle, out, member_size) != (int)member_size) {
+				gw->error = true;
+			}
+		}
+
+		deflateEnd(&stream);
+	}
+
+	MEM_freeN(extra);
+	MEM_freeN(out);
+}
+
+/**
+ * Open a gzip file compressed on the threads of the global task scheduler.
+ *
+ * \param level: The zlib compression level.
+ */
+GzipWriter *BLI_gzip_writer_open(const char *filepath, int level)
+{
+	const int file = BLI_open(filepath, O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+	if (file == -1) {
+		return NULL;
+	}
+
+	TaskScheduler *scheduler = BLI_task_scheduler_get();
+	GzipWriter *gw = MEM_callocN(sizeof(*gw), __func__);
+
+	gw->file_handle = file;
+	gw->level = level;
+	/* the parts are waited for outside of the pool, a background pool is run by a worker
+	 * thread even when the scheduler has no other one */
+	gw->pool = BLI_task_pool_create_background(scheduler, NULL);
+	BLI_mutex_init(&gw->mutex);
+	BLI_condition_init(&gw->cond);
+
+	/* one more part is filled while the others are compressed */
+	gw->parts_len = MIN2(BLI_task_scheduler_num_threads(scheduler) * GZIP_PARTS_PER_THREAD, GZIP_PARTS_MAX) + 1;
+	gw->parts = MEM_callocN(sizeof(*gw->parts) * gw->parts_len, __func__);
+	for (int i = 0; i < gw->parts_len; i++) {
+		gw->parts[i].gw = gw;
+		gw->parts[i].in = MEM_mallocN(GZIP_PART_SIZE, __func__);
+		gw->parts[i].out = MEM_mallocN(GZIP_PART_BOUND, __func__);
+	}
+
+	gw->index_alloc = 64;
+	gw->index = MEM_mallocN(sizeof(*gw->index) * 2 * gw->index_alloc, __func__);
+
+	return gw;
+}
+
+/**
+ * \return false if an error occurred since the file was opened.
+ */
+bool BLI_gzip_writer_write(GzipWriter *gw, const void *buf, size_t buf_len)
+{
+	const char *data = buf;
+
+	while (buf_len != 0) {
+		GzipWriterPart *part = gzip_part_filled(gw);
+		const unsigned int part_len = (unsigned int)MIN2(buf_len, GZIP_PART_SIZE - part->in_len);
+
+		memcpy(part->in + part->in_len, data, part_len);
+		part->in_len += part_len;
+		data += part_len;
+		buf_len -= part_len;
+
+		if (part->in_len == GZIP_PART_SIZE) {
+			gzip_part_push(gw);
+		}
+	}
+
+	return !gw->error;
+}
+
+/**
+ * Write the remaining data and the index, and free the writer.
+ *
+ * \return false if any data couldn't be written.
+ */
+bool BLI_gzip_writer_close(GzipWriter *gw)
+{
+	gzip_part_push(gw);
+	gzip_parts_write(gw, 0);
+	/* the tasks still hold the mutex after the last part is done */
+	BLI_task_pool_work_and_wait(gw->pool);
+
+	gzip_index_write(gw);
+
+	bool success = !gw->error;
+	if (close(gw->file_handle) == -1) {
+		success = false;
+	}
+
+	BLI_task_pool_free(gw->pool);
+	BLI_mutex_end(&gw->mutex);
+	BLI_condition_end(&gw->cond);
+	for (int i = 0; i < gw->parts_len; i++) {
+		MEM_freeN(gw->parts[i].in);
+		MEM_freeN(gw->parts[i].out);
+	}
+	MEM_freeN(gw->parts);
+	MEM_freeN(gw->index);
+	MEM_freeN(gw);
+
+	return success;
+}
+
+/**
+ * Read the index of a file written by #BLI_gzip_writer_open.
+ *
+ * \param r_members: The members in the file order, to free with MEM_freeN.
+ * \return false if the file has no valid index.
+ */
+bool BLI_gzip_index_read(int file, GzipMember **r_members, unsigned int *r_members_len)
+{
+	const size_t file_size = BLI_file_descriptor_size(file);
+	unsigned char end[GZIP_INDEX_END_SIZE + sizeof(gzip_index_data)];
+
+	if (file_size == (size_t)-1 || file_size < sizeof(end) ||
+	    lseek(file, file_size - sizeof(end), SEEK_SET) == -1 ||
+	    read(file, end, sizeof(end)) != sizeof(end))
+	{
+		return false;
+	}
+
+	if (end[0] != 'B' || end[1] != 'E' || gzip_le16_read(end + 2) != 4 ||
+	    memcmp(end + GZIP_INDEX_END_SIZE, gzip_index_data, sizeof(gzip_index_data)) != 0)
+	{
+		return false;
+	}
+
+	/* the size is only trusted once the whole member is checked */
+	const size_t member_size = gzip_le32_read(end + GZIP_SUBFIELD_HEADER_SIZE);
+	if (member_size < gzip_index_member_size(GZIP_SUBFIELD_HEADER_SIZE + GZIP_INDEX_END_SIZE) ||
+	    member_size > gzip_index_member_size(GZIP_EXTRA_MAX) ||
+	    member_size > file_size)
+	{
+		return false;
+	}
+
+	unsigned char *member = MEM_mallocN(member_size, __func__);
+	bool success = false;
+
+	if (lseek(file, file_size - member_size, SEEK_SET) != -1 &&
+	    read(file, member, member_size) == (int)member_size &&
+	    member[0] == 0x1f && member[1] == 0x8b && member[2] == Z_DEFLATED && member[3] == GZIP_FLAG_EXTRA)
+	{
+		const unsigned int extra_len = gzip_le16_read(member + GZIP_HEADER_SIZE);
+		const unsigned char *extra = member + GZIP_HEADER_SIZE + GZIP_XLEN_SIZE;
+		const unsigned int entries_len = gzip_le16_read(extra + 2);
+
+		if (gzip_index_member_size(extra_len) == member_size && extra[0] == 'B' && extra[1] == 'I' &&
+		    GZIP_SUBFIELD_HEADER_SIZE + entries_len + GZIP_INDEX_END_SIZE == extra_len &&
+		    entries_len % GZIP_INDEX_ENTRY_SIZE == 0)
+		{
+			const unsigned int members_len = entries_len / GZIP_INDEX_ENTRY_SIZE;
+			GzipMember *members = MEM_mallocN(sizeof(*members) * MAX2(members_len, 1), __func__);
+			const unsigned char *entry = extra + GZIP_SUBFIELD_HEADER_SIZE;
+			size_t offset = 0, data_offset = 0;
+
+			for (unsigned int i = 0; i < members_len; i++, entry += GZIP_INDEX_ENTRY_SIZE) {
+				members[i].offset = offset;
+				members[i].data_offset = data_offset;
+				members[i].size = gzip_le32_read(entry);
+				members[i].data_size = gzip_le32_read(entry + 4);
+				offset += members[i].size;
+				data_offset += members[i].data_size;
+			}
+
+			/* the members must exactly fill the file */
+			if (offset + member_size == file_size) {
+				*r_members = members;
+				*r_members_len = members_len;
+				success = true;
+			}
+			else {
+				MEM_freeN(members);
+			}
+		}
+	}
+
+	MEM_freeN(member);
+
+	return success;
+}
+
+/**
+ * Decompress a single member of a file.
+ *
+ * \param r_data: Buffer of the decompressed size of the member.
+ */
+bool BLI_gzip_member_read(int file, const GzipMember *member, void *r_data)
+{
+	char *in = MEM_mallocN(MAX2(member->size, 1), __func__);
+	bool success = false;
+
+	if (lseek(file, member->offset, SEEK_SET) != -1 &&
+	    read(file, in, member->size) == (int)member->size)
+	{
+		z_stream stream = {NULL};
+
+		if (inflateInit2(&stream, 15 + 16) == Z_OK) {
+			stream.next_in = (Bytef *)in;
+			stream.avail_in = member->size;
+			stream.next_out = r_data;
+			stream.avail_out = member->data_size;
+
+			success = (inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out == member->data_size);
+
+			inflateEnd(&stream);
+		}
+	}
+
+	MEM_freeN(in);
+
+	return success;
+}
@@ -33,11 +33,21 @@
  *  \ingroup blenloader
  */
 
+/* chunk data, shared by the identical chunks of all the undo steps */
+typedef struct MemFileBuffer {
+	unsigned int users;
+	unsigned int size;
+	/* followed by the data */
+} MemFileBuffer;
+
 typedef struct {
 	void *next, *prev;
 	
-	char *buf;
-	unsigned int ident, size;
+	const char *buf;
+	unsigned int size;
+	/* hash of the data, used to find identical chunks in the next undo step */
+	unsigned int hash;
+	MemFileBuffer *buffer;
 	
 } MemFileChunk;
 
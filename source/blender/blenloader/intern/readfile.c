@@ -110,6 +110,8 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -224,6 +226,18 @@
 /* Use GHash for restoring pointers by name */
 #define USE_GHASH_RESTORE_POINTER
 
+/* Use the block headers and data of uncompressed files mapped in memory without copying them
+ * in a BHeadN. The headers are not aligned in the file, so only for architectures allowing
+ * unaligned loads. */
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86) || \
+    defined(__aarch64__) || defined(_M_ARM64)
+#  define USE_BHEAD_IN_PLACE
+#endif
+
+/* Read the data blocks of meshes and link them on the task scheduler once all the blocks
+ * of the file are indexed, each task uses its own data map. */
+#define USE_PARALLEL_DIRECT_LINK
+
 /***/
 
 typedef struct OldNew {
@@ -237,8 +251,25 @@ typedef struct OldNewMap {
 	int nentries, entriessize;
 	bool sorted;
 	int lasthit;
+
+	/* Open addressing index of the entries by old address, NULL until the full lookups
+	 * compared more entries than the map contains, see: oldnewmap_lookup_entry. */
+	int *hash;
+	/* The hash index contains 2^hash_bits slots. */
+	unsigned int hash_bits;
+	/* Entries compared by full lookups since the map was cleared. */
+	size_t scanned;
+
+	/* Statistics printed with --debug-io, not reset when the map is cleared. */
+	struct {
+		size_t lookups, lasthit, misses, scanned, probes;
+		int builds;
+	} stats;
 } OldNewMap;
 
+/* Maps with less entries are always searched by a full lookup. */
+#define OLDNEWMAP_HASH_MIN_ENTRIES 64
+
 
 /* local prototypes */
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
@@ -299,11 +330,58 @@ static int verg_oldnewmap(const void *v1, const void *v2)
 }
 
 
+#define OLDNEWMAP_HASH_MASK(onm) ((1u << (onm)->hash_bits) - 1)
+
+BLI_INLINE unsigned int oldnewmap_hash(const void *addr, unsigned int bits)
+{
+	/* Fibonacci hashing, the high bits of the product depend on all the bits of the address. */
+	return (unsigned int)(((uint64_t)(uintptr_t)addr * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+static void oldnewmap_hash_insert(OldNewMap *onm, int index)
+{
+	const void *addr = onm->entries[index].old;
+	unsigned int slot = oldnewmap_hash(addr, onm->hash_bits);
+
+	while (onm->hash[slot] != -1) {
+		/* Same as a full lookup, the last entry inserted wins. */
+		if (onm->entries[onm->hash[slot]].old == addr) {
+			break;
+		}
+		slot = (slot + 1) & OLDNEWMAP_HASH_MASK(onm);
+	}
+	onm->hash[slot] = index;
+}
+
+static void oldnewmap_hash_build(OldNewMap *onm)
+{
+	unsigned int bits = 7;
+	int i;
+
+	/* Keep the load factor under one half. */
+	while ((1u << bits) < (unsigned int)onm->nentries * 2) {
+		bits++;
+	}
+
+	MEM_SAFE_FREE(onm->hash);
+	onm->hash = MEM_mallocN(sizeof(*onm->hash) * (1u << bits), "OldNewMap.hash");
+	copy_vn_i(onm->hash, 1 << bits, -1);
+	onm->hash_bits = bits;
+
+	for (i = 0; i < onm->nentries; i++) {
+		oldnewmap_hash_insert(onm, i);
+	}
+
+	onm->stats.builds++;
+}
+
 static void oldnewmap_sort(FileData *fd) 
 {
 	BLI_assert(fd->libmap->sorted == false);
 	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
 	fd->libmap->sorted = 1;
+	/* The entries moved, bsearch is used from now. */
+	MEM_SAFE_FREE(fd->libmap->hash);
 }
 
 /* nr is zero for data, and ID code for libdata */
@@ -322,6 +400,15 @@ static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr,
 	entry->old = oldaddr;
 	entry->newp = newaddr;
 	entry->nr = nr;
+
+	if (onm->hash) {
+		if ((unsigned int)onm->nentries * 2 > (1u << onm->hash_bits)) {
+			oldnewmap_hash_build(onm);
+		}
+		else {
+			oldnewmap_hash_insert(onm, onm->nentries - 1);
+		}
+	}
 }
 
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
@@ -335,11 +422,8 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void
  * \param lasthit: Use as a reference position to avoid a full search
  * from either end of the array, giving more efficient lookups.
  *
- * \note This would seem an ideal case for hash or btree lookups.
- * However the data is written in-order, using the \a lasthit will normally avoid calling this function.
- * Creating a btree/hash structure adds overhead for the common-case to optimize the corner-case
- * (since most entries will never be retrieved).
- * So just keep full lookups as a fall-back.
+ * \note The data is written in-order, using the \a lasthit will normally avoid calling this function.
+ * Files with many out of order references use the hash index instead, see: oldnewmap_lookup_entry.
  */
 static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, int lasthit)
 {
@@ -379,23 +463,76 @@ static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, i
 	return -1;
 }
 
+/**
+ * Search an entry with the hash index, or a full lookup while the full lookups are cheap.
+ *
+ * The index is built once the full lookups compared more entries than the map contains,
+ * so the cost of the lookups missing \a lasthit stays linear in the number of entries.
+ */
+static int oldnewmap_lookup_entry(OldNewMap *onm, const void *addr, int lasthit)
+{
+	unsigned int slot;
+	int i;
+
+	onm->stats.misses++;
+
+	if (onm->hash == NULL) {
+		size_t scanned;
+
+		i = oldnewmap_lookup_entry_full(onm, addr, lasthit);
+
+		/* The full lookup searches forwards from lasthit and then backwards. */
+		if (i == -1) {
+			scanned = onm->nentries;
+		}
+		else if (lasthit >= 0 && i > lasthit) {
+			scanned = i - lasthit;
+		}
+		else {
+			scanned = onm->nentries - i;
+		}
+		onm->scanned += scanned;
+		onm->stats.scanned += scanned;
+
+		if (onm->nentries >= OLDNEWMAP_HASH_MIN_ENTRIES && onm->scanned > (size_t)onm->nentries) {
+			oldnewmap_hash_build(onm);
+		}
+
+		return i;
+	}
+
+	slot = oldnewmap_hash(addr, onm->hash_bits);
+	while ((i = onm->hash[slot]) != -1) {
+		onm->stats.probes++;
+		if (onm->entries[i].old == addr) {
+			return i;
+		}
+		slot = (slot + 1) & OLDNEWMAP_HASH_MASK(onm);
+	}
+
+	return -1;
+}
+
 static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
 {
 	int i;
 	
 	if (addr == NULL) return NULL;
 	
+	onm->stats.lookups++;
+
 	if (onm->lasthit < onm->nentries-1) {
 		OldNew *entry = &onm->entries[++onm->lasthit];
 		
 		if (entry->old == addr) {
+			onm->stats.lasthit++;
 			if (increase_users)
 				entry->nr++;
 			return entry->newp;
 		}
 	}
 	
-	i = oldnewmap_lookup_entry_full(onm, addr, onm->lasthit);
+	i = oldnewmap_lookup_entry(onm, addr, onm->lasthit);
 	if (i != -1) {
 		OldNew *entry = &onm->entries[i];
 		BLI_assert(entry->old == addr);
@@ -415,6 +552,8 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
 		return NULL;
 	}
 
+	onm->stats.lookups++;
+
 	/* lasthit works fine for non-libdata, linking there is done in same sequence as writing */
 	if (onm->sorted) {
 		const OldNew entry_s = {.old = addr};
@@ -428,8 +567,7 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
 		}
 	}
 	else {
-		/* note, this can be a bottle neck when loading some files */
-		const int i = oldnewmap_lookup_entry_full(onm, addr, -1);
+		const int i = oldnewmap_lookup_entry(onm, addr, -1);
 		if (i != -1) {
 			OldNew *entry = &onm->entries[i];
 			ID *id = entry->newp;
@@ -460,14 +598,25 @@ static void oldnewmap_clear(OldNewMap *onm)
 {
 	onm->nentries = 0;
 	onm->lasthit = 0;
+	onm->scanned = 0;
+	MEM_SAFE_FREE(onm->hash);
 }
 
 static void oldnewmap_free(OldNewMap *onm) 
 {
+	MEM_SAFE_FREE(onm->hash);
 	MEM_freeN(onm->entries);
 	MEM_freeN(onm);
 }
 
+static void oldnewmap_print_stats(const char *name, const OldNewMap *onm)
+{
+	printf("OldNewMap %s: %zu lookups, %zu lasthit, %zu misses, %zu entries scanned, "
+	       "%zu hash probes, %d hash builds\n",
+	       name, onm->stats.lookups, onm->stats.lasthit, onm->stats.misses, onm->stats.scanned,
+	       onm->stats.probes, onm->stats.builds);
+}
+
 /***/
 
 static void read_libraries(FileData *basefd, ListBase *mainlist);
@@ -823,11 +972,91 @@ static BHeadN *get_bhead(FileData *fd)
 	return(new_bhead);
 }
 
+#ifdef USE_BHEAD_IN_PLACE
+/**
+ * Index the block headers of a mapped file in place, when the headers of the file
+ * match the ones in memory.
+ */
+static void bhead_index_build(FileData *fd)
+{
+	const char *cursor = fd->mmap_cursor;
+	int tot_alloc = 0;
+
+	if (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS)) {
+		return;
+	}
+
+	while ((size_t)(fd->mmap_end - cursor) >= sizeof(BHead)) {
+		BHead *bhead = (BHead *)cursor;
+
+		/* The file can't be read further, the blocks after are zeros. */
+		if (BLI_mmap_any_io_error(fd->mmap_file)) {
+			break;
+		}
+
+		/* Truncated block, as with the copied blocks the reading stops before. */
+		if (bhead->len < 0 || (size_t)bhead->len > (size_t)(fd->mmap_end - cursor) - sizeof(BHead)) {
+			break;
+		}
+
+		if (fd->tot_bhead_index == tot_alloc) {
+			tot_alloc = max_ii(tot_alloc * 2, 1024);
+			fd->bhead_index = MEM_reallocN(fd->bhead_index, sizeof(BHead *) * tot_alloc);
+		}
+		fd->bhead_index[fd->tot_bhead_index++] = bhead;
+
+		if (bhead->code == ENDB) {
+			break;
+		}
+
+		cursor += sizeof(BHead) + bhead->len;
+	}
+
+	/* Old files can end with a partial 'ENDB' header, read these blocks by copy. */
+	if ((size_t)(fd->mmap_end - cursor) < sizeof(BHead) && (size_t)(fd->mmap_end - cursor) >= sizeof(int) &&
+	    ((BHead *)cursor)->code == ENDB)
+	{
+		MEM_SAFE_FREE(fd->bhead_index);
+		fd->tot_bhead_index = 0;
+		return;
+	}
+
+	fd->flags |= FD_FLAGS_BHEAD_IN_PLACE;
+}
+
+static BHead *bhead_in_place_prev(FileData *fd, BHead *thisblock)
+{
+	int low = 0;
+	int high = fd->tot_bhead_index - 1;
+
+	while (low <= high) {
+		const int mid = (low + high) / 2;
+		if (fd->bhead_index[mid] < thisblock) {
+			low = mid + 1;
+		}
+		else if (fd->bhead_index[mid] > thisblock) {
+			high = mid - 1;
+		}
+		else {
+			return (mid > 0) ? fd->bhead_index[mid - 1] : NULL;
+		}
+	}
+
+	return NULL;
+}
+#endif  /* USE_BHEAD_IN_PLACE */
+
 BHead *blo_firstbhead(FileData *fd)
 {
 	BHeadN *new_bhead;
 	BHead *bhead = NULL;
 	
+#ifdef USE_BHEAD_IN_PLACE
+	if (fd->flags & FD_FLAGS_BHEAD_IN_PLACE) {
+		return (fd->tot_bhead_index) ? fd->bhead_index[0] : NULL;
+	}
+#endif
+
 	/* Rewind the file
 	 * Read in a new block if necessary
 	 */
@@ -843,10 +1072,20 @@ BHead *blo_firstbhead(FileData *fd)
 	return(bhead);
 }
 
-BHead *blo_prevbhead(FileData *UNUSED(fd), BHead *thisblock)
+BHead *blo_prevbhead(FileData *fd, BHead *thisblock)
 {
-	BHeadN *bheadn = (BHeadN *)POINTER_OFFSET(thisblock, -offsetof(BHeadN, bhead));
-	BHeadN *prev = bheadn->prev;
+	BHeadN *bheadn, *prev;
+
+#ifdef USE_BHEAD_IN_PLACE
+	if (fd->flags & FD_FLAGS_BHEAD_IN_PLACE) {
+		return bhead_in_place_prev(fd, thisblock);
+	}
+#else
+	UNUSED_VARS(fd);
+#endif
+
+	bheadn = (BHeadN *)POINTER_OFFSET(thisblock, -offsetof(BHeadN, bhead));
+	prev = bheadn->prev;
 	
 	return (prev) ? &prev->bhead : NULL;
 }
@@ -856,6 +1095,19 @@ BHead *blo_nextbhead(FileData *fd, BHead *thisblock)
 	BHeadN *new_bhead = NULL;
 	BHead *bhead = NULL;
 	
+#ifdef USE_BHEAD_IN_PLACE
+	if (fd->flags & FD_FLAGS_BHEAD_IN_PLACE) {
+		/* The blocks follow each other in the file up to the last indexed one,
+		 * after an I/O error the mapping is zeroed and the reading stops as for a truncated file. */
+		if (thisblock == NULL || thisblock == fd->bhead_index[fd->tot_bhead_index - 1] ||
+		    BLI_mmap_any_io_error(fd->mmap_file))
+		{
+			return NULL;
+		}
+		return (BHead *)POINTER_OFFSET(thisblock, sizeof(BHead) + thisblock->len);
+	}
+#endif
+
 	if (thisblock) {
 		/* bhead is actually a sub part of BHeadN
 		 * We calculate the BHeadN pointer from the BHead pointer below */
@@ -1029,6 +1281,22 @@ static int fd_read_from_memory(FileData *filedata, void *buffer, unsigned int si
 	return (readsize);
 }
 
+static int fd_read_from_mmap(FileData *filedata, void *buffer, unsigned int size)
+{
+	/* don't read more bytes then there are available in the mapped file */
+	const size_t readsize = MIN2((size_t)size, (size_t)(filedata->mmap_end - filedata->mmap_cursor));
+
+	memcpy(buffer, filedata->mmap_cursor, readsize);
+	filedata->mmap_cursor += readsize;
+
+	/* the file was truncated or couldn't be read, the copied data are zeros */
+	if (BLI_mmap_any_io_error(filedata->mmap_file)) {
+		return 0;
+	}
+
+	return (int)readsize;
+}
+
 static int fd_read_from_memfile(FileData *filedata, void *buffer, unsigned int size)
 {
 	static unsigned int seek = (1<<30);	/* the current position */
@@ -1104,10 +1372,58 @@ static FileData *filedata_new(void)
 	return fd;
 }
 
+/**
+ * Map an uncompressed blend file starting at \a offset in memory.
+ * \param size The size of the blend data after \a offset, 0 to read up to the end of the file.
+ * \return NULL if the file can't be mapped or is compressed.
+ */
+static FileData *blo_filedata_from_mmap(int file, size_t offset, size_t size)
+{
+	BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+	const unsigned char *memory;
+	size_t length;
+	FileData *fd;
+
+	if (mmap_file == NULL) {
+		return NULL;
+	}
+
+	memory = BLI_mmap_get_pointer(mmap_file);
+	length = BLI_mmap_get_length(mmap_file);
+
+	/* compressed files are read by zlib */
+	if (offset > length || length - offset < SIZEOFBLENDERHEADER ||
+	    (memory[offset] == 0x1f && memory[offset + 1] == 0x8b))
+	{
+		BLI_mmap_free(mmap_file);
+		return NULL;
+	}
+
+	/* data appended after the blend data, e.g. the size footer of a runtime */
+	if (size != 0 && size < length - offset) {
+		length = offset + size;
+	}
+
+	fd = filedata_new();
+	fd->filedes = file;
+	fd->mmap_file = mmap_file;
+	fd->mmap_cursor = (const char *)memory + offset;
+	fd->mmap_end = (const char *)memory + length;
+	fd->read = fd_read_from_mmap;
+
+	return fd;
+}
+
 static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 {
 	decode_blender_header(fd);
 	
+#ifdef USE_BHEAD_IN_PLACE
+	if (fd->mmap_file && (fd->flags & FD_FLAGS_FILE_OK)) {
+		bhead_index_build(fd);
+	}
+#endif
+
 	if (fd->flags & FD_FLAGS_FILE_OK) {
 		const char *error_message = NULL;
 		if (read_file_dna(fd, &error_message) == false) {
@@ -1136,7 +1452,22 @@ FileData *blo_openblenderfile(const char *filepath, ReportList *reports)
 	if (typeencryption <= SPINDLE_NO_ENCRYPTION) {
 #endif
 		gzFile gzfile;
+		int file;
 		errno = 0;
+
+		/* uncompressed files are mapped in memory */
+		file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
+		if (file != -1) {
+			FileData *fd = blo_filedata_from_mmap(file, 0, 0);
+			if (fd) {
+				/* needed for library_append and read_libraries */
+				BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+				return blo_decode_and_check(fd, reports);
+			}
+			close(file);
+		}
+
 		gzfile = BLI_gzopen(filepath, "rb");
 
 		if (gzfile == (gzFile)Z_NULL) {
@@ -1309,11 +1640,31 @@ void blo_freefiledata(FileData *fd)
 		// Free all BHeadN data blocks
 		BLI_freelistN(&fd->listbase);
 
+		if (fd->bhead_index) {
+			MEM_freeN(fd->bhead_index);
+		}
+		if (fd->mmap_file) {
+			if (BLI_mmap_any_io_error(fd->mmap_file)) {
+				BKE_reportf(fd->reports, RPT_ERROR, "Failed to read blend file '%s', the data read are incomplete",
+				            fd->relabase);
+			}
+			BLI_mmap_free(fd->mmap_file);
+		}
+
 		if (fd->filesdna)
 			DNA_sdna_free(fd->filesdna);
 		if (fd->compflags)
 			MEM_freeN((void *)fd->compflags);
 		
+		if (G.debug & G_DEBUG_IO) {
+			if (fd->datamap)
+				oldnewmap_print_stats("datamap", fd->datamap);
+			if (fd->globmap)
+				oldnewmap_print_stats("globmap", fd->globmap);
+			if (fd->libmap && !(fd->flags & FD_FLAGS_NOT_MY_LIBMAP))
+				oldnewmap_print_stats("libmap", fd->libmap);
+		}
+
 		if (fd->datamap)
 			oldnewmap_free(fd->datamap);
 		if (fd->globmap)
@@ -1330,6 +1681,8 @@ void blo_freefiledata(FileData *fd)
 			oldnewmap_free(fd->libmap);
 		if (fd->bheadmap)
 			MEM_freeN(fd->bheadmap);
+		if (fd->deferred_links)
+			MEM_freeN(fd->deferred_links);
 		
 #ifdef USE_GHASH_BHEAD
 		if (fd->bhead_idname_hash) {
@@ -1794,6 +2147,7 @@ void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 	VFont *vfont;
 	bSound *sound;
 	Library *lib;
+	Scene *sce;
 	
 	fd->packedmap = oldnewmap_new();
 	
@@ -1820,6 +2174,10 @@ void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 		if (lib->packedfile)
 			insert_packedmap(fd, lib->packedfile);
 
+	for (sce = oldmain->scene.first; sce; sce = sce->id.next)
+		if (sce->gm.pybytecode)
+			insert_packedmap(fd, sce->gm.pybytecode);
+
 }
 
 /* set old main packed data to zero if it has been restored */
@@ -1830,6 +2188,7 @@ void blo_end_packed_pointer_map(FileData *fd, Main *oldmain)
 	VFont *vfont;
 	bSound *sound;
 	Library *lib;
+	Scene *sce;
 	OldNew *entry = fd->packedmap->entries;
 	int i;
 	
@@ -1856,6 +2215,9 @@ void blo_end_packed_pointer_map(FileData *fd, Main *oldmain)
 		
 	for (lib = oldmain->library.first; lib; lib = lib->id.next)
 		lib->packedfile = newpackedadr(fd, lib->packedfile);
+
+	for (sce = oldmain->scene.first; sce; sce = sce->id.next)
+		sce->gm.pybytecode = newpackedadr(fd, sce->gm.pybytecode);
 }
 
 
@@ -4488,13 +4850,20 @@ static void lib_link_mesh(FileData *fd, Main *main)
 			/*check if we need to convert mfaces to mpolys*/
 			if (me->totface && !me->totpoly) {
 				/* temporarily switch main so that reading from
-				 * external CustomData works */
-				Main *gmain = G.main;
-				G.main = main;
-				
-				BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
-				
-				G.main = gmain;
+				 * external CustomData works, linked meshes use
+				 * the library path and leave G.main untouched,
+				 * libraries can be read outside of the main thread */
+				if (main->curlib) {
+					BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
+				}
+				else {
+					Main *gmain = G.main;
+					G.main = main;
+
+					BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
+
+					G.main = gmain;
+				}
 			}
 
 			/*
@@ -6252,6 +6621,8 @@ static void direct_link_scene(FileData *fd, Scene *sce)
 		}
 	}
 
+	sce->gm.pybytecode = direct_link_packedfile(fd, sce->gm.pybytecode);
+
 	sce->preview = direct_link_preview_image(fd, sce->preview);
 
 	direct_link_curvemapping(fd, &sce->r.mblur_shutter_curve);
@@ -8152,6 +8523,106 @@ static BHead *read_data_into_oldnewmap(FileData *fd, BHead *bhead, const char *a
 	return bhead;
 }
 
+#ifdef USE_PARALLEL_DIRECT_LINK
+typedef struct DeferredDirectLink {
+	ID *id;
+	/* The first data block of the ID and the number of data blocks. */
+	BHead *bhead;
+	int tot_bhead;
+	const char *allocname;
+} DeferredDirectLink;
+
+/* Skip the data blocks of an ID, they are read by direct_link_deferred. */
+static BHead *defer_direct_link(FileData *fd, ID *id, BHead *bhead, const char *allocname)
+{
+	DeferredDirectLink *link;
+
+	if (fd->tot_deferred_links == fd->deferred_links_size) {
+		fd->deferred_links_size = max_ii(fd->deferred_links_size * 2, 64);
+		fd->deferred_links = MEM_reallocN(fd->deferred_links, sizeof(*fd->deferred_links) * fd->deferred_links_size);
+	}
+
+	link = &fd->deferred_links[fd->tot_deferred_links++];
+	link->id = id;
+	link->allocname = allocname;
+	link->tot_bhead = 0;
+
+	bhead = blo_nextbhead(fd, bhead);
+	link->bhead = bhead;
+
+	while (bhead && bhead->code == DATA) {
+		link->tot_bhead++;
+		bhead = blo_nextbhead(fd, bhead);
+	}
+
+	return bhead;
+}
+
+static void direct_link_deferred_cb(void *userdata, void *userdata_chunk, const int iter, const int UNUSED(thread_id))
+{
+	FileData *basefd = userdata;
+	/* Copy of the file data with its own data map, all the blocks are already read so
+	 * nothing else is modified. */
+	FileData *fd = userdata_chunk;
+	const DeferredDirectLink *link = &basefd->deferred_links[iter];
+	BHead *bhead = link->bhead;
+	int i;
+
+	if (fd->datamap == NULL) {
+		fd->datamap = oldnewmap_new();
+	}
+
+	for (i = 0; i < link->tot_bhead; i++) {
+		void *data = read_struct(fd, bhead, link->allocname);
+		if (data) {
+			oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+		}
+
+		/* Don't look past the last data block, it could read the file. */
+		if (i + 1 < link->tot_bhead) {
+			bhead = blo_nextbhead(fd, bhead);
+		}
+	}
+
+	direct_link_id(fd, link->id);
+
+	switch (GS(link->id->name)) {
+		case ID_ME:
+			direct_link_mesh(fd, (Mesh *)link->id);
+			break;
+		default:
+			BLI_assert(0);
+			break;
+	}
+
+	oldnewmap_free_unused(fd->datamap);
+	oldnewmap_clear(fd->datamap);
+}
+
+static void direct_link_deferred_finalize(void *UNUSED(userdata), void *userdata_chunk)
+{
+	FileData *fd = userdata_chunk;
+
+	if (fd->datamap) {
+		oldnewmap_free(fd->datamap);
+	}
+}
+
+/* Read and link the IDs skipped by defer_direct_link. */
+static void direct_link_deferred(FileData *fd)
+{
+	FileData fd_chunk = *fd;
+	fd_chunk.datamap = NULL;
+
+	BLI_task_parallel_range_finalize(
+	        0, fd->tot_deferred_links, fd, &fd_chunk, sizeof(fd_chunk),
+	        direct_link_deferred_cb, direct_link_deferred_finalize, fd->tot_deferred_links > 1, true);
+
+	MEM_SAFE_FREE(fd->deferred_links);
+	fd->tot_deferred_links = fd->deferred_links_size = 0;
+}
+#endif  /* USE_PARALLEL_DIRECT_LINK */
+
 static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short tag, ID **r_id)
 {
 	/* this routine reads a libblock and its direct data. Use link functions to connect it all
@@ -8269,6 +8740,12 @@ static BHead *read_libblock(FileData *fd, Main *main, BHead *bhead, const short
 	/* need a name for the mallocN, just for debugging and sane prints on leaks */
 	allocname = dataname(GS(id->name));
 	
+#ifdef USE_PARALLEL_DIRECT_LINK
+	if ((fd->flags & FD_FLAGS_DEFER_DIRECT_LINK) && GS(id->name) == ID_ME) {
+		return defer_direct_link(fd, id, bhead, allocname);
+	}
+#endif
+
 	/* read all data into fd->datamap */
 	bhead = read_data_into_oldnewmap(fd, bhead, allocname);
 	
@@ -8451,17 +8928,21 @@ static void convert_tface_mt(FileData *fd, Main *main)
 	
 	/* this is a delayed do_version (so it can create new materials) */
 	if (main->versionfile < 259 || (main->versionfile == 259 && main->subversionfile < 3)) {
-		//XXX hack, material.c uses G.main all over the place, instead of main
-		// temporarily set G.main to the current main
+		/* Image paths of local data are resolved from G.main, temporarily set it to the current main.
+		 * Linked data uses the library path, libraries keep G.main untouched as they can be read
+		 * outside of the main thread (e.g. the asynchronous LibLoad of the game engine). */
 		gmain = G.main;
-		G.main = main;
+		if (!main->curlib) {
+			G.main = main;
+		}
 		
 		if (!(do_version_tface(main))) {
 			BKE_report(fd->reports, RPT_WARNING, "Texface conversion problem (see error in console)");
 		}
 		
-		//XXX hack, material.c uses G.main allover the place, instead of main
-		G.main = gmain;
+		if (!main->curlib) {
+			G.main = gmain;
+		}
 	}
 }
 
@@ -8688,6 +9169,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 		}
 	}
 
+#ifdef USE_PARALLEL_DIRECT_LINK
+	/* Undo keeps the serial reading, it restores data from the previous state. */
+	if (fd->memfile == NULL) {
+		fd->flags |= FD_FLAGS_DEFER_DIRECT_LINK;
+	}
+#endif
+
 	while (bhead) {
 		switch (bhead->code) {
 		case DATA:
@@ -8736,6 +9224,11 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 		}
 	}
 	
+#ifdef USE_PARALLEL_DIRECT_LINK
+	fd->flags &= ~FD_FLAGS_DEFER_DIRECT_LINK;
+	direct_link_deferred(fd);
+#endif
+
 	/* do before read_libraries, but skip undo case */
 	if (fd->memfile == NULL) {
 		do_versions(fd, NULL, bfd->main);
@@ -10679,10 +11172,13 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 BlendFileData *blo_read_blendafterruntime(int file, const char *name, int actualsize, ReportList *reports)
 {
 	BlendFileData *bfd = NULL;
-	FileData *fd = filedata_new();
-	fd->filedes = file;
-	fd->buffersize = actualsize;
-	fd->read = fd_read_from_file;
+	FileData *fd = blo_filedata_from_mmap(file, (size_t)lseek(file, 0, SEEK_CUR), (size_t)actualsize);
+	if (fd == NULL) {
+		fd = filedata_new();
+		fd->filedes = file;
+		fd->buffersize = actualsize;
+		fd->read = fd_read_from_file;
+	}
 	
 	/* needed for library_append and read_libraries */
 	BLI_strncpy(fd->relabase, name, sizeof(fd->relabase));
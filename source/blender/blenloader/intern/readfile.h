@@ -62,6 +62,14 @@ typedef struct FileData {
 	int filedes;
 	gzFile gzfiledes;
 
+	// variables needed for reading from a file mapped in memory
+	struct BLI_mmap_file *mmap_file;
+	const char *mmap_cursor;
+	const char *mmap_end;
+	/* Block headers used in place in the mapped file, sorted by address, see: USE_BHEAD_IN_PLACE */
+	struct BHead **bhead_index;
+	int tot_bhead_index;
+
 	// now only in use for library appending
 	char relabase[FILE_MAX];
 	
@@ -94,6 +102,10 @@ typedef struct FileData {
 	struct BHeadSort *bheadmap;
 	int tot_bheadmap;
 
+	/* IDs read and linked once all the blocks are read, see: USE_PARALLEL_DIRECT_LINK */
+	struct DeferredDirectLink *deferred_links;
+	int tot_deferred_links, deferred_links_size;
+
 	/* see: USE_GHASH_BHEAD */
 	struct GHash *bhead_idname_hash;
 	
@@ -120,6 +132,8 @@ enum {
 	FD_FLAGS_FILE_OK               = 1 << 3,
 	FD_FLAGS_NOT_MY_BUFFER         = 1 << 4,
 	FD_FLAGS_NOT_MY_LIBMAP         = 1 << 5,  /* XXX Unused in practice (checked once but never set). */
+	FD_FLAGS_BHEAD_IN_PLACE        = 1 << 6,  /* Block headers and data are read from the mapped file. */
+	FD_FLAGS_DEFER_DIRECT_LINK     = 1 << 7,  /* Meshes are read and linked in parallel after all the blocks. */
 };
 
 #define SIZEOFBLENDERHEADER 12
@@ -129,7 +129,8 @@ BlendFileData *BLO_read_runtime(const char *path, ReportList *reports)
 	else {
 		//printf("starting to read runtime from %s at datastart %d\n", path, datastart);
 		lseek(fd, datastart, SEEK_SET);
-		bfd = blo_read_blendafterruntime(fd, path, actualsize - datastart, reports);
+		/* the blend data are followed by the 12 bytes of the data start and "BRUNTIME" */
+		bfd = blo_read_blendafterruntime(fd, path, actualsize - datastart - 12, reports);
 		fd = -1; // file was closed in blo_read_blendafterruntime()
 	}
 	
@@ -40,19 +40,32 @@
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_utildefines.h"
 
 #include "BLO_undofile.h"
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* Chunks are shared by content rather than by position: a block inserted or removed
+ * between two undo steps would otherwise make all the following chunks differ. */
+
+static void memfile_buffer_release(MemFileBuffer *buffer)
+{
+	BLI_assert(buffer->users > 0);
+	if (--buffer->users == 0) {
+		MEM_freeN(buffer);
+	}
+}
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
 	MemFileChunk *chunk;
 	
 	while ((chunk = BLI_pophead(&memfile->chunks))) {
-		if (chunk->ident == 0)
-			MEM_freeN(chunk->buf);
+		memfile_buffer_release(chunk->buffer);
 		MEM_freeN(chunk);
 	}
 	memfile->size = 0;
@@ -60,63 +73,84 @@ void BLO_memfile_free(MemFile *memfile)
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
-void BLO_memfile_merge(MemFile *first, MemFile *second)
+void BLO_memfile_merge(MemFile *first, MemFile *UNUSED(second))
 {
-	MemFileChunk *fc, *sc;
+	/* the buffers used by 'second' are kept alive by their own reference */
+	BLO_memfile_free(first);
+}
+
+static unsigned int memfile_chunk_hash(const void *key)
+{
+	return ((const MemFileChunk *)key)->hash;
+}
+
+static bool memfile_chunk_cmp(const void *a, const void *b)
+{
+	const MemFileChunk *chunk_a = a, *chunk_b = b;
 	
-	fc = first->chunks.first;
-	sc = second->chunks.first;
-	while (fc || sc) {
-		if (fc && sc) {
-			if (sc->ident) {
-				sc->ident = 0;
-				fc->ident = 1;
-			}
-		}
-		if (fc) fc = fc->next;
-		if (sc) sc = sc->next;
+	if (chunk_a->hash != chunk_b->hash || chunk_a->size != chunk_b->size) {
+		return true;
 	}
-	
-	BLO_memfile_free(first);
+	if (chunk_a->buf == chunk_b->buf) {
+		return false;
+	}
+	return (memcmp(chunk_a->buf, chunk_b->buf, chunk_a->size) != 0);
 }
 
 void memfile_chunk_add(MemFile *compare, MemFile *current, const char *buf, unsigned int size)
 {
-	static MemFileChunk *compchunk = NULL;
-	MemFileChunk *curchunk;
+	/* chunks of the previous and current undo steps, by content */
+	static GHash *chunk_hash = NULL;
+	MemFileChunk *curchunk, *compchunk;
+	void **val_p;
 	
-	/* this function inits when compare != NULL or when current == NULL  */
-	if (compare) {
-		compchunk = compare->chunks.first;
-		return;
-	}
-	if (current == NULL) {
-		compchunk = NULL;
+	/* this function inits when compare != NULL or when current == NULL,
+	 * calling it with NULL arguments releases the lookup table */
+	if (compare || current == NULL) {
+		if (chunk_hash) {
+			BLI_ghash_free(chunk_hash, NULL, NULL);
+			chunk_hash = NULL;
+		}
+		
+		if (compare) {
+			chunk_hash = BLI_ghash_new_ex(memfile_chunk_hash, memfile_chunk_cmp, __func__,
+			                              (unsigned int)BLI_listbase_count(&compare->chunks) * 2);
+			for (compchunk = compare->chunks.first; compchunk; compchunk = compchunk->next) {
+				if (!BLI_ghash_ensure_p(chunk_hash, compchunk, &val_p)) {
+					*val_p = compchunk;
+				}
+			}
+		}
 		return;
 	}
 	
 	curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
+	curchunk->buf = buf;
 	curchunk->size = size;
-	curchunk->buf = NULL;
-	curchunk->ident = 0;
+	curchunk->hash = BLI_hash_mm2((const unsigned char *)buf, size, 0);
+	curchunk->buffer = NULL;
 	BLI_addtail(&current->chunks, curchunk);
 	
-	/* we compare compchunk with buf */
-	if (compchunk) {
-		if (compchunk->size == curchunk->size) {
-			if (memcmp(compchunk->buf, buf, size) == 0) {
-				curchunk->buf = compchunk->buf;
-				curchunk->ident = 1;
-			}
-		}
-		compchunk = compchunk->next;
+	/* identical chunks of this step are shared too */
+	if (chunk_hash == NULL) {
+		chunk_hash = BLI_ghash_new(memfile_chunk_hash, memfile_chunk_cmp, __func__);
 	}
 	
-	/* not equal... */
-	if (curchunk->buf == NULL) {
-		curchunk->buf = MEM_mallocN(size, "Chunk buffer");
-		memcpy(curchunk->buf, buf, size);
+	if (BLI_ghash_ensure_p(chunk_hash, curchunk, &val_p)) {
+		compchunk = *val_p;
+		curchunk->buf = compchunk->buf;
+		curchunk->buffer = compchunk->buffer;
+		curchunk->buffer->users++;
+	}
+	else {
+		MemFileBuffer *buffer = MEM_mallocN(sizeof(MemFileBuffer) + size, "Chunk buffer");
+		buffer->users = 1;
+		buffer->size = size;
+		memcpy(buffer + 1, buf, size);
+		
+		curchunk->buf = (const char *)(buffer + 1);
+		curchunk->buffer = buffer;
+		*val_p = curchunk;
 		current->size += size;
 	}
 }
-
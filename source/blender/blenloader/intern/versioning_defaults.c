@@ -179,6 +179,7 @@ void BLO_update_defaults_startup_blend(Main *bmain)
 
 		scene->gm.lodflag |= SCE_LOD_USE_HYST;
 		scene->gm.scehysteresis = 10;
+		scene->gm.batchSize = 32;
 
 		scene->r.ffcodecdata.audio_mixrate = 48000;
 	}
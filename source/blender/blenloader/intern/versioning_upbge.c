@@ -266,4 +266,12 @@ void blo_do_versions_upbge(FileData *fd, Library *lib, Main *main)
 			camera->gameviewport.topratio = 1.0f;
 		}
 	}
+
+	if (!MAIN_VERSION_UPBGE_ATLEAST(main, 2, 3)) {
+		if (!DNA_struct_elem_find(fd->filesdna, "GameData", "short", "batchSize")) {
+			for (Scene *scene = main->scene.first; scene; scene = scene->id.next) {
+				scene->gm.batchSize = 32;
+			}
+		}
+	}
 }
@@ -155,6 +155,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_linklist.h"
 #include "BLI_mempool.h"
+#include "BLI_gzip_writer.h"
 
 #include "BKE_action.h"
 #include "BKE_blender_version.h"
@@ -216,7 +217,7 @@ struct WriteWrap {
 	/* internal */
 	union {
 		int file_handle;
-		gzFile gz_handle;
+		struct GzipWriter *gz_handle;
 	} _user_data;
 };
 
@@ -248,18 +249,19 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
+/* zlib
+ *
+ * Compressed on worker threads, see BLI_gzip_writer.h. */
 #define FILE_HANDLE(ww) \
 	(ww)->_user_data.gz_handle
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-	gzFile file;
-
-	file = BLI_gzopen(filepath, "wb1");
+	/* same level as gzopen "wb1" */
+	GzipWriter *gw = BLI_gzip_writer_open(filepath, Z_BEST_SPEED);
 
-	if (file != Z_NULL) {
-		FILE_HANDLE(ww) = file;
+	if (gw != NULL) {
+		FILE_HANDLE(ww) = gw;
 		return true;
 	}
 	else {
@@ -268,11 +270,11 @@ static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-	return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+	return BLI_gzip_writer_close(FILE_HANDLE(ww));
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-	return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+	return BLI_gzip_writer_write(FILE_HANDLE(ww), buf, buf_len) ? buf_len : 0;
 }
 #undef FILE_HANDLE
 
@@ -461,6 +463,11 @@ static bool endwrite(WriteData *wd)
 		wd->count = 0;
 	}
 
+	/* release the chunk lookup of the undo step */
+	if (wd->current) {
+		memfile_chunk_add(NULL, NULL, NULL, 0);
+	}
+
 	const bool err = wd->error;
 	writedata_free(wd);
 
@@ -496,6 +503,13 @@ static void writestruct_at_address_nr(
 		return;
 	}
 
+	/* Start a new undo chunk with each datablock, so the chunks of unchanged
+	 * datablocks stay identical when other datablocks are added or removed. */
+	if (wd->current && filecode != DATA && wd->count) {
+		writedata_do_write(wd, wd->buf, wd->count);
+		wd->count = 0;
+	}
+
 	mywrite(wd, &bh, sizeof(BHead));
 	mywrite(wd, data, bh.len);
 }
@@ -2771,6 +2785,12 @@ static void write_scene(WriteData *wd, Scene *sce)
 		write_pointcaches(wd, &(sce->rigidbody_world->ptcaches));
 	}
 
+	if (sce->gm.pybytecode) {
+		PackedFile *pf = sce->gm.pybytecode;
+		writestruct(wd, DATA, PackedFile, 1, pf);
+		writedata(wd, DATA, pf->size, pf->data);
+	}
+
 	write_previews(wd, sce->preview);
 	write_curvemapping_curves(wd, &sce->r.mblur_shutter_curve);
 }
@@ -4137,9 +4157,12 @@ bool BLO_write_file(
 	}
 
 	/* actual file writing */
-	const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
+	bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, thumb);
 
-	ww.close(&ww);
+	/* compressed data may only be written on closing */
+	if (ww.close(&ww) == false) {
+		err = true;
+	}
 
 	if (UNLIKELY(path_list_backup)) {
 		BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -138,6 +138,7 @@ typedef enum eArmature_Flag {
 	ARM_GHOST_ONLYSEL   = (1<<12),  /* when ghosting, only show selected bones (this should belong to ghostflag instead) */ /* XXX deprecated */
 	ARM_DS_EXPAND       = (1<<13),  /* dopesheet channel is expanded */
 	ARM_HAS_VIZ_DEPS    = (1<<14),  /* other objects are used for visualizing various states (hack for efficient updates) */
+	ARM_GAME_SHARE_DEFORM = (1<<15),  /* game engine: share the vertex deformation of instances in the same pose */
 } eArmature_Flag;
 
 /* armature->drawtype */
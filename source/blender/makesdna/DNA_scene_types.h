@@ -59,6 +59,7 @@ struct Group;
 struct Text;
 struct bNodeTree;
 struct AnimData;
+struct PackedFile;
 struct Editing;
 struct SceneStats;
 struct bGPdata;
@@ -844,7 +845,7 @@ typedef struct GameData {
 	short vsync; /* Controls vsync: off, on, or adaptive (if supported) */
 	short obstacleSimulation;
 	short ticrate, maxlogicstep, physubstep, maxphystep;
-	short pad5;
+	short batchSize; /* maximum number of objects merged in an automatic batch group */
 	float timeScale;
 	float levelHeight;
 	float deactivationtime, lineardeactthreshold, angulardeactthreshold;
@@ -858,6 +859,10 @@ typedef struct GameData {
 	/* Scene LoD */
 	short lodflag, pad2;
 	int scehysteresis;
+
+	/* compiled python scripts, packed with the blend file (see GAME_PYTHON_BYTECODE_PACK) */
+	struct PackedFile *pybytecode;
+	void *pad3;
 } GameData;
 
 #define STEREO_NOSTEREO		1
@@ -908,6 +913,11 @@ typedef struct GameData {
 #define GAME_PYTHON_CONSOLE					(1 << 20)
 #define GAME_GLSL_NO_ENV_LIGHTING			(1 << 21)
 #define GAME_SHOW_RENDER_QUERIES			(1 << 22)
+#define GAME_PARALLEL_SCENES				(1 << 23)
+#define GAME_PARALLEL_PHYSICS				(1 << 24)
+#define GAME_AUTO_BATCHING					(1 << 25)
+#define GAME_PYTHON_BYTECODE_CACHE			(1 << 26)
+#define GAME_PYTHON_BYTECODE_PACK			(1 << 27)
 /* Note: GameData.flag is now an int (max 32 flags). A short could only take 16 flags */
 
 #define GAME_DEBUG_DISABLE	0
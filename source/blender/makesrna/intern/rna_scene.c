@@ -4796,6 +4796,17 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
 	                         "Restrict the number of animation updates to the animation FPS (this is "
 	                         "better for performance, but can cause issues with smooth playback)");
 
+	prop = RNA_def_property(srna, "use_parallel_scenes", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_PARALLEL_SCENES);
+	RNA_def_property_ui_text(prop, "Parallel Scenes",
+	                         "Process the scene graph, physics and activity culling of all the scenes in parallel "
+	                         "(logic is still executed scene by scene)");
+
+	prop = RNA_def_property(srna, "use_parallel_physics", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_PARALLEL_PHYSICS);
+	RNA_def_property_ui_text(prop, "Parallel Physics",
+	                         "Solve the constraints of independent simulation islands in parallel");
+
 
 	prop = RNA_def_property(srna, "show_bounding_box", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "showBoundingBox");
@@ -4822,6 +4833,18 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
 	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_PYTHON_CONSOLE);
 	RNA_def_property_ui_text(prop, "Python Console", "Create a python interpreter console in game");
 
+	prop = RNA_def_property(srna, "use_python_bytecode_cache", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_PYTHON_BYTECODE_CACHE);
+	RNA_def_property_ui_text(prop, "Python Bytecode Cache",
+	                         "Store the compiled scripts in a .bgepyc file next to the blend file or the runtime "
+	                         "and reuse them at the next game starts");
+
+	prop = RNA_def_property(srna, "use_python_bytecode_pack", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_PYTHON_BYTECODE_PACK);
+	RNA_def_property_ui_text(prop, "Pack Python Bytecode",
+	                         "Store the compiled scripts of the cache in the blend file when the game ends in Blender, "
+	                         "the runtimes then don't compile them nor write a .bgepyc file");
+
 	prop = RNA_def_property(srna, "python_console_key1", PROP_ENUM, PROP_NONE);
 	RNA_def_property_enum_sdna(prop, NULL, "pythonkeys[0]");
 	RNA_def_property_enum_items(prop, rna_enum_event_type_items);
@@ -4939,6 +4962,21 @@ static void rna_def_scene_game_data(BlenderRNA *brna)
 	RNA_def_property_ui_text(prop, "Hysteresis %",
 	                         "Minimum distance change required to transition to the previous level of detail");
 	RNA_def_property_update(prop, NC_SCENE, NULL);
+
+	/* Automatic batching */
+	prop = RNA_def_property(srna, "use_auto_batching", PROP_BOOLEAN, PROP_NONE);
+	RNA_def_property_boolean_sdna(prop, NULL, "flag", GAME_AUTO_BATCHING);
+	RNA_def_property_ui_text(prop, "Automatic Batching",
+	                         "Merge the meshes of static objects without logic sharing the same materials "
+	                         "into batch groups of neighbouring objects");
+
+	prop = RNA_def_property(srna, "batch_size", PROP_INT, PROP_NONE);
+	RNA_def_property_int_sdna(prop, NULL, "batchSize");
+	RNA_def_property_range(prop, 2, 4096);
+	RNA_def_property_ui_range(prop, 2, 256, 1, 1);
+	RNA_def_property_int_default(prop, 32);
+	RNA_def_property_ui_text(prop, "Batch Size", "Maximum number of objects merged in a batch group");
+	RNA_def_property_update(prop, NC_SCENE, NULL);
 }
 
 static void rna_def_gpu_dof_fx(BlenderRNA *brna)
@@ -0,0 +1,112 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file CM_RingBuffer.h
+ *  \ingroup common
+ */
+
+#ifndef __CM_RINGBUFFER_H__
+#define __CM_RINGBUFFER_H__
+
+#include <vector>
+#include <atomic>
+
+/** \brief Lock-free queue of a bounded number of items between a single producer thread
+ * and a single consumer thread. The producer only calls Push, the consumer only calls
+ * Front and Pop. The storage is allocated at construction, the queue never allocates after.
+ */
+template <class Item>
+class CM_RingBuffer
+{
+private:
+	/// One slot is always left empty to distinguish a full queue from an empty one.
+	std::vector<Item> m_items;
+	/// Index of the next item to pop, written by the consumer.
+	std::atomic<unsigned int> m_head;
+	/// Index of the next item to push, written by the producer.
+	std::atomic<unsigned int> m_tail;
+
+	inline unsigned int Next(unsigned int index) const
+	{
+		return (index + 1 == m_items.size()) ? 0 : index + 1;
+	}
+
+public:
+	CM_RingBuffer(unsigned int capacity)
+		:m_items(capacity + 1),
+		m_head(0),
+		m_tail(0)
+	{
+	}
+
+	/// Add an item at the end of the queue, return false if the queue is full.
+	bool Push(const Item& item)
+	{
+		const unsigned int tail = m_tail.load(std::memory_order_relaxed);
+		const unsigned int next = Next(tail);
+		if (next == m_head.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		m_items[tail] = item;
+		m_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	/// Get the first item without removing it, return false if the queue is empty.
+	bool Front(Item& item) const
+	{
+		const unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		item = m_items[head];
+		return true;
+	}
+
+	/// Remove the first item, return false if the queue is empty.
+	bool Pop(Item& item)
+	{
+		const unsigned int head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+
+		item = m_items[head];
+		m_head.store(Next(head), std::memory_order_release);
+		return true;
+	}
+
+	/// Return true if the queue is empty, only exact from the consumer thread.
+	bool Empty() const
+	{
+		return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+	}
+
+	unsigned int GetCapacity() const
+	{
+		return m_items.size() - 1;
+	}
+};
+
+#endif  // __CM_RINGBUFFER_H__
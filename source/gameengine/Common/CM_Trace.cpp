@@ -0,0 +1,257 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file CM_Trace.cpp
+ *  \ingroup common
+ */
+
+#include "CM_Trace.h"
+#include "CM_Thread.h"
+
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+
+/** Ring of the spans of a single thread, written without lock by this thread only.
+ * Other threads copy the spans and then discard the ones the writer may have overwritten meanwhile.
+ */
+struct CM_TraceBuffer
+{
+	std::unique_ptr<CM_Trace::Span[]> m_spans;
+	/// Number of spans ever written, the ring index is the write index modulo the capacity.
+	std::atomic<uint64_t> m_writeIndex;
+	unsigned int m_id;
+	bool m_main;
+
+	CM_TraceBuffer(unsigned int id, bool main)
+		:m_spans(new CM_Trace::Span[CM_TRACE_CAPACITY]),
+		m_writeIndex(0),
+		m_id(id),
+		m_main(main)
+	{
+	}
+};
+
+std::atomic<bool> CM_Trace::m_recording(false);
+
+/// Start time of the recording, read by all the recording threads.
+static std::atomic<std::chrono::steady_clock::rep> traceStartTime(std::chrono::steady_clock::now().time_since_epoch().count());
+/// Incremented to clear the spans, only the spans of the current generation are read.
+static std::atomic<unsigned int> traceGeneration(0);
+static std::vector<std::unique_ptr<CM_TraceBuffer> > traceBuffers;
+static CM_ThreadMutex traceBuffersMutex;
+static thread_local CM_TraceBuffer *traceThreadBuffer = nullptr;
+
+static CM_TraceBuffer *cm_trace_thread_buffer()
+{
+	if (!traceThreadBuffer) {
+		// Registration is done once per thread, it's the only locked operation.
+		traceBuffersMutex.Lock();
+		traceBuffers.emplace_back(new CM_TraceBuffer(traceBuffers.size(), BLI_thread_is_main()));
+		traceThreadBuffer = traceBuffers.back().get();
+		traceBuffersMutex.Unlock();
+	}
+
+	return traceThreadBuffer;
+}
+
+/// Return the buffers, they are never freed, only the list can change when a thread starts recording.
+static std::vector<CM_TraceBuffer *> cm_trace_buffers()
+{
+	std::vector<CM_TraceBuffer *> buffers;
+	traceBuffersMutex.Lock();
+	for (const std::unique_ptr<CM_TraceBuffer>& buffer : traceBuffers) {
+		buffers.push_back(buffer.get());
+	}
+	traceBuffersMutex.Unlock();
+
+	return buffers;
+}
+
+/// Copy the spans of the current generation from the ring of a thread, from the oldest to the newest.
+static void cm_trace_read_spans(const CM_TraceBuffer *buffer, std::vector<CM_Trace::Span>& spans)
+{
+	spans.clear();
+
+	const unsigned int generation = traceGeneration.load(std::memory_order_acquire);
+	const uint64_t end = buffer->m_writeIndex.load(std::memory_order_acquire);
+	const uint64_t begin = (end > CM_TRACE_CAPACITY) ? end - CM_TRACE_CAPACITY : 0;
+
+	std::vector<CM_Trace::Span> copies(end - begin);
+	for (uint64_t i = begin; i < end; ++i) {
+		copies[i - begin] = buffer->m_spans[i % CM_TRACE_CAPACITY];
+	}
+
+	// The spans written during the copy overwrote the oldest ones, which are possibly torn.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const uint64_t newEnd = buffer->m_writeIndex.load(std::memory_order_relaxed);
+	const uint64_t overwritten = (newEnd > begin + CM_TRACE_CAPACITY) ? newEnd - begin - CM_TRACE_CAPACITY : 0;
+
+	for (uint64_t i = overwritten; i < copies.size(); ++i) {
+		if (copies[i].m_generation == generation) {
+			spans.push_back(copies[i]);
+		}
+	}
+}
+
+void CM_Trace::Start()
+{
+	Clear();
+	traceStartTime.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+	m_recording.store(true, std::memory_order_release);
+}
+
+void CM_Trace::Stop()
+{
+	m_recording.store(false, std::memory_order_release);
+}
+
+void CM_Trace::Clear()
+{
+	// The rings are kept as the threads write into them, their spans are only marked as outdated.
+	traceGeneration.fetch_add(1, std::memory_order_acq_rel);
+}
+
+double CM_Trace::GetTime()
+{
+	const std::chrono::steady_clock::duration startTime(traceStartTime.load(std::memory_order_relaxed));
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch() - startTime).count();
+}
+
+void CM_Trace::Record(const char *name, const char *category, const char *detail, double start, double end)
+{
+	CM_TraceBuffer *buffer = cm_trace_thread_buffer();
+	// Only this thread writes the index.
+	const uint64_t index = buffer->m_writeIndex.load(std::memory_order_relaxed);
+	Span& span = buffer->m_spans[index % CM_TRACE_CAPACITY];
+
+	span.m_name = name;
+	span.m_category = category;
+	if (detail) {
+		BLI_strncpy(span.m_detail, detail, CM_TRACE_DETAIL_SIZE);
+	}
+	else {
+		span.m_detail[0] = '\0';
+	}
+	span.m_start = start;
+	span.m_duration = end - start;
+	span.m_generation = traceGeneration.load(std::memory_order_relaxed);
+
+	buffer->m_writeIndex.store(index + 1, std::memory_order_release);
+}
+
+unsigned int CM_Trace::GetNumSpans()
+{
+	unsigned int numSpans = 0;
+
+	std::vector<Span> spans;
+	for (CM_TraceBuffer *buffer : cm_trace_buffers()) {
+		cm_trace_read_spans(buffer, spans);
+		numSpans += spans.size();
+	}
+
+	return numSpans;
+}
+
+static void cm_trace_write_string(FILE *file, const char *str)
+{
+	fputc('"', file);
+	for (const char *c = str; *c; ++c) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', file);
+			fputc(*c, file);
+		}
+		else if ((unsigned char)*c < 0x20) {
+			fprintf(file, "\\u%04x", (unsigned int)*c);
+		}
+		else {
+			fputc(*c, file);
+		}
+	}
+	fputc('"', file);
+}
+
+bool CM_Trace::Write(const std::string& filepath)
+{
+	FILE *file = BLI_fopen(filepath.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+
+	fputs("{\"traceEvents\":[\n", file);
+
+	bool first = true;
+	// The spans are copied to not block the recording thread while the file is written.
+	std::vector<Span> spans;
+	for (CM_TraceBuffer *buffer : cm_trace_buffers()) {
+		cm_trace_read_spans(buffer, spans);
+		const unsigned int count = spans.size();
+
+		if (count == 0) {
+			continue;
+		}
+
+		if (!first) {
+			fputs(",\n", file);
+		}
+		first = false;
+
+		if (buffer->m_main) {
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Main\"}}",
+					buffer->m_id);
+		}
+		else {
+			fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Worker %u\"}}",
+					buffer->m_id, buffer->m_id);
+		}
+
+		for (unsigned int i = 0; i < count; ++i) {
+			const Span& span = spans[i];
+
+			fputs(",\n{\"name\":", file);
+			cm_trace_write_string(file, span.m_name);
+			fputs(",\"cat\":", file);
+			cm_trace_write_string(file, span.m_category);
+			fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u",
+					span.m_start, span.m_duration, buffer->m_id);
+			if (span.m_detail[0] != '\0') {
+				fputs(",\"args\":{\"detail\":", file);
+				cm_trace_write_string(file, span.m_detail);
+				fputc('}', file);
+			}
+			fputc('}', file);
+		}
+	}
+
+	fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+
+	const bool success = (ferror(file) == 0);
+	fclose(file);
+
+	return success;
+}
@@ -0,0 +1,125 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file CM_Trace.h
+ *  \ingroup common
+ */
+
+#ifndef __CM_TRACE_H__
+#define __CM_TRACE_H__
+
+#include <string>
+#include <atomic>
+
+/// Number of spans kept per thread, the oldest spans are overwritten.
+#define CM_TRACE_CAPACITY (1 << 15)
+/// Maximum length of the detail of a span, scene or object name.
+#define CM_TRACE_DETAIL_SIZE 64
+
+/** \brief Timeline capture of nested spans recorded by any thread.
+ * Each thread writes completed spans into its own lock-free ring buffer, clearing
+ * only increments the generation of the spans to record. The spans of all the threads
+ * are written in the Chrome trace event format (chrome://tracing or https://ui.perfetto.dev).
+ * All the functions can be called from any thread, while other threads record spans.
+ */
+class CM_Trace
+{
+public:
+	struct Span
+	{
+		/// Static name of the span.
+		const char *m_name;
+		/// Static category of the span.
+		const char *m_category;
+		/// Scene or object name.
+		char m_detail[CM_TRACE_DETAIL_SIZE];
+		/// Start time and duration in microseconds.
+		double m_start;
+		double m_duration;
+		/// Generation of the recording, incremented when the spans are cleared.
+		unsigned int m_generation;
+	};
+
+	/// Start recording spans, the previous spans are cleared.
+	static void Start();
+	static void Stop();
+	/// Remove the recorded spans of all the threads.
+	static void Clear();
+
+	static inline bool IsRecording()
+	{
+		return m_recording.load(std::memory_order_relaxed);
+	}
+
+	/// Return the time in microseconds since the start of the recording.
+	static double GetTime();
+
+	/** Record a completed span in the buffer of the calling thread.
+	 * \param detail Optional scene or object name, copied.
+	 */
+	static void Record(const char *name, const char *category, const char *detail, double start, double end);
+
+	/// Return the number of spans available, at most CM_TRACE_CAPACITY per thread.
+	static unsigned int GetNumSpans();
+
+	/** Write the recorded spans into a Chrome trace event file.
+	 * \return True on success.
+	 */
+	static bool Write(const std::string& filepath);
+
+private:
+	static std::atomic<bool> m_recording;
+};
+
+/// Record a span of the lifetime of the scope.
+class CM_TraceScope
+{
+private:
+	const char *m_name;
+	const char *m_category;
+	const char *m_detail;
+	double m_start;
+
+public:
+	CM_TraceScope(const char *name, const char *category, const char *detail = nullptr)
+		:m_name(name),
+		m_category(category),
+		m_detail(detail),
+		m_start(CM_Trace::IsRecording() ? CM_Trace::GetTime() : -1.0)
+	{
+	}
+
+	~CM_TraceScope()
+	{
+		if (m_start >= 0.0 && CM_Trace::IsRecording()) {
+			CM_Trace::Record(m_name, m_category, m_detail, m_start, CM_Trace::GetTime());
+		}
+	}
+};
+
+#define CM_TRACE_CONCAT_IMPL(a, b) a##b
+#define CM_TRACE_CONCAT(a, b) CM_TRACE_CONCAT_IMPL(a, b)
+
+/// Trace the current scope, the detail is optional.
+#define CM_TRACE_SCOPE(...) CM_TraceScope CM_TRACE_CONCAT(_cm_trace_scope_, __LINE__)(__VA_ARGS__)
+
+#endif  // __CM_TRACE_H__
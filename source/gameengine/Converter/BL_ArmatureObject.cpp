@@ -475,6 +475,11 @@ int BL_ArmatureObject::GetVertDeformType() const
 	return ((bArmature *)m_objArma->data)->gevertdeformer;
 }
 
+bool BL_ArmatureObject::GetShareDeformation() const
+{
+	return (((bArmature *)m_objArma->data)->flag & ARM_GAME_SHARE_DEFORM) != 0;
+}
+
 void BL_ArmatureObject::GetPose(bPose **pose) const
 {
 	/* If the caller supplies a null pose, create a new one. */
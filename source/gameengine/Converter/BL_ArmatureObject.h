@@ -96,6 +96,8 @@ public:
 	Object *GetArmatureObject();
 	Object *GetOrigArmatureObject();
 	int GetVertDeformType() const;
+	/// Return true if the meshes deformed with the BGE deformer share the deformation of identical poses.
+	bool GetShareDeformation() const;
 	bool GetDrawDebug() const;
 	void DrawDebug(RAS_DebugDraw& debugDraw);
 
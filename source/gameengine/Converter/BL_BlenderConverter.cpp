@@ -38,6 +38,7 @@
 #include "KX_WorldInfo.h"
 #include "RAS_MeshObject.h"
 #include "RAS_BucketManager.h"
+#include "RAS_BoundingBoxManager.h"
 #include "KX_PhysicsEngineEnums.h"
 #include "KX_KetsjiEngine.h"
 #include "KX_PythonInit.h" // So we can handle adding new text datablocks for Python to import
@@ -82,9 +83,34 @@ extern "C" {
 }
 
 #include "BLI_task.h"
+#include "PIL_time.h"
 #include "CM_Message.h"
+#include "CM_Trace.h"
 
 #include <cstring>
+#include <algorithm>
+
+/// Maximum number of objects merged between two checks of the merge budget.
+#define BL_LIBLOAD_MERGE_OBJECTS 32
+
+struct BL_BlenderConverter::AsyncLibLoad
+{
+	BL_BlenderConverter *m_converter;
+	KX_LibLoadStatus *m_status;
+	std::string m_path;
+	int m_idcode;
+	short m_options;
+	/// Copy of the blend file data for a load from memory, empty for a load from file.
+	std::vector<char> m_data;
+	/// The linked library, nullptr if the blend file couldn't be read.
+	Main *m_main;
+	/// Number of scene converters of the status already merged.
+	unsigned int m_mergedScenes;
+	/// True when the library was registered in the main thread.
+	bool m_registered;
+	/// Progress of the merge of the current scene converter.
+	KX_Scene::MergeProgress m_sceneMerge;
+};
 
 BL_BlenderConverter::SceneSlot::SceneSlot() = default;
 
@@ -120,7 +146,8 @@ void BL_BlenderConverter::SceneSlot::Merge(const BL_BlenderSceneConverter& conve
 }
 
 BL_BlenderConverter::BL_BlenderConverter(Main *maggie, KX_KetsjiEngine *engine)
-	:m_maggie(maggie),
+	:m_mergeBudget(0.0f),
+	m_maggie(maggie),
 	m_ketsjiEngine(engine),
 	m_alwaysUseExpandFraming(false)
 {
@@ -137,6 +164,10 @@ BL_BlenderConverter::~BL_BlenderConverter()
 
 	m_DynamicMaggie.clear();
 
+	for (KX_LibLoadStatus *status : m_failedStatus) {
+		delete status;
+	}
+
 	/* Thread infos like mutex must be freed after FreeBlendFile function.
 	   Because it needs to lock the mutex, even if there's no active task when it's
 	   in the scene converter destructor. */
@@ -310,23 +341,117 @@ Main *BL_BlenderConverter::GetMainDynamicPath(const std::string& path) const
 void BL_BlenderConverter::MergeAsyncLoads()
 {
 	m_threadinfo.m_mutex.Lock();
+	m_mergingLoads.insert(m_mergingLoads.end(), m_mergequeue.begin(), m_mergequeue.end());
+	m_mergequeue.clear();
+	m_threadinfo.m_mutex.Unlock();
 
-	for (KX_LibLoadStatus *libload : m_mergequeue) {
-		KX_Scene *mergeScene = libload->GetMergeScene();
-		for (const BL_BlenderSceneConverter& converter : libload->GetSceneConverters()) {
-			KX_Scene *scene = converter.GetScene();
-			MergeScene(mergeScene, scene);
-			// Finalize material and mesh conversion.
+	const double starttime = PIL_check_seconds_timer();
+	const double budget = m_mergeBudget * 1.0e-3;
+
+	// At least one step is merged per call to always progress.
+	while (!m_mergingLoads.empty()) {
+		AsyncLibLoad *load = m_mergingLoads.front();
+		if (MergeAsyncLoadStep(load)) {
+			m_mergingLoads.pop_front();
+			delete load;
+		}
+
+		if (budget > 0.0 && (PIL_check_seconds_timer() - starttime) >= budget) {
+			break;
+		}
+	}
+}
+
+bool BL_BlenderConverter::MergeAsyncLoadStep(AsyncLibLoad *load)
+{
+	CM_TRACE_SCOPE("LibLoad Merge", "converter", load->m_path.c_str());
+
+	KX_LibLoadStatus *status = load->m_status;
+	KX_Scene *mergeScene = status->GetMergeScene();
+
+	if (!load->m_main) {
+		CM_Error("could not open blendfile \"" << load->m_path << "\"");
+		// Allow to load the library again.
+		m_status_map.erase(load->m_path);
+		m_failedStatus.push_back(status);
+		status->Finish();
+		return true;
+	}
+
+	if (!load->m_registered) {
+		// Needed for lookups.
+		m_DynamicMaggie.push_back(load->m_main);
+
+		if (load->m_idcode == ID_AC || (load->m_idcode == ID_SCE && load->m_options & LIB_LOAD_LOAD_ACTIONS)) {
+			RegisterLibraryActions(load->m_main, mergeScene, load->m_options);
+		}
+
+#ifdef WITH_PYTHON
+		// Handle any text datablocks
+		if (load->m_idcode == ID_SCE && load->m_options & LIB_LOAD_LOAD_SCRIPTS) {
+			addImportMain(load->m_main);
+		}
+#endif
+
+		if (load->m_idcode == ID_SCE) {
+			for (const BL_BlenderSceneConverter& converter : status->GetSceneConverters()) {
+				KX_Scene *scene = converter.GetScene();
+				status->AddMergeObjects(scene->GetObjectList()->GetCount() + scene->GetInactiveList()->GetCount());
+			}
+		}
+
+		load->m_registered = true;
+	}
+	else if (load->m_idcode == ID_ME) {
+		const BL_BlenderSceneConverter& converter = status->GetSceneConverters()[load->m_mergedScenes++];
+		KX_Scene *scene = converter.GetScene();
+
+		// Only the meshes and their materials are taken from the temporary scene.
+		mergeScene->GetBucketManager()->MergeBucketManager(scene->GetBucketManager(), mergeScene);
+		mergeScene->GetBoundingBoxManager()->Merge(scene->GetBoundingBoxManager());
+		for (RAS_MeshObject *meshobj : converter.m_meshobjects) {
+			mergeScene->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
+		}
+		m_sceneSlots[mergeScene].Merge(converter);
+
+		// Finalize material and mesh conversion.
+		InitSceneShaders(converter, mergeScene);
+		delete scene;
+
+		status->AddProgress(0.1f);
+	}
+	else {
+		const BL_BlenderSceneConverter& converter = status->GetSceneConverters()[load->m_mergedScenes];
+		KX_Scene *scene = converter.GetScene();
+		KX_Scene::MergeProgress& progress = load->m_sceneMerge;
+
+		const bool begin = (progress.m_stage == KX_Scene::MergeProgress::MERGE_BEGIN);
+		const unsigned int merged = mergeScene->MergeSceneStep(scene, progress, BL_LIBLOAD_MERGE_OBJECTS);
+
+		status->AddMergedObjects(merged);
+		status->AddProgress(0.1f * merged / std::max(status->GetNumMergeObjects(), 1u));
+
+		/* The materials are initialized once the lights are merged in the first step and
+		 * before any object using them is merged. */
+		if (begin) {
 			InitSceneShaders(converter, mergeScene);
-			delete scene;
 		}
 
-		libload->Finish();
+		if (progress.m_stage == KX_Scene::MergeProgress::MERGE_DONE) {
+			MergeSceneSlot(mergeScene, scene);
+			delete scene;
+
+			load->m_sceneMerge = KX_Scene::MergeProgress();
+			++load->m_mergedScenes;
+		}
 	}
 
-	m_mergequeue.clear();
+	if (load->m_mergedScenes < status->GetSceneConverters().size()) {
+		return false;
+	}
 
-	m_threadinfo.m_mutex.Unlock();
+	status->Finish();
+	return true;
 }
 
 void BL_BlenderConverter::FinalizeAsyncLoads()
@@ -334,40 +459,95 @@ void BL_BlenderConverter::FinalizeAsyncLoads()
 	// Finish all loading libraries.
 	BLI_task_pool_work_and_wait(m_threadinfo.m_pool);
 	// Merge all libraries data in the current scene, to avoid memory leak of unmerged scenes.
+	const float budget = m_mergeBudget;
+	m_mergeBudget = 0.0f;
 	MergeAsyncLoads();
+	m_mergeBudget = budget;
 }
 
-void BL_BlenderConverter::AddScenesToMergeQueue(KX_LibLoadStatus *status)
+float BL_BlenderConverter::GetMergeBudget() const
 {
-	m_threadinfo.m_mutex.Lock();
-	m_mergequeue.push_back(status);
-	m_threadinfo.m_mutex.Unlock();
+	return m_mergeBudget;
+}
+
+void BL_BlenderConverter::SetMergeBudget(float budget)
+{
+	m_mergeBudget = std::max(budget, 0.0f);
 }
 
-static void async_convert(TaskPool *pool, void *ptr, int UNUSED(threadid))
+void BL_BlenderConverter::AsyncLoadTask(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
 {
-	KX_LibLoadStatus *status = static_cast<KX_LibLoadStatus *>(ptr);
+	AsyncLibLoad *load = static_cast<AsyncLibLoad *>(taskdata);
+	BL_BlenderConverter *converter = load->m_converter;
+	KX_LibLoadStatus *status = load->m_status;
 	KX_KetsjiEngine *engine = status->GetEngine();
-	BL_BlenderConverter *converter = status->GetConverter();
 
-	const std::vector<Scene *>& blenderScenes = status->GetBlenderScenes();
+	{
+		CM_TRACE_SCOPE("LibLoad Read", "converter", load->m_path.c_str());
+
+		BlendHandle *bpy_openlib = load->m_data.empty() ?
+			BLO_blendhandle_from_file(load->m_path.c_str(), nullptr) :
+			BLO_blendhandle_from_memory(load->m_data.data(), load->m_data.size());
+
+		if (bpy_openlib) {
+			load->m_main = LinkBlendHandle(bpy_openlib, load->m_path.c_str(), load->m_idcode, load->m_options);
+		}
+
+		// The data is only read while linking.
+		std::vector<char>().swap(load->m_data);
+	}
+
+	if (load->m_main) {
+		status->AddProgress(0.1f);
+
+		if (load->m_idcode == ID_ME) {
+			CM_TRACE_SCOPE("LibLoad Convert", "converter", load->m_path.c_str());
+
+			/* The meshes are converted in a temporary scene, the buckets of the merge
+			 * scene can't be modified outside of the main thread. */
+			KX_Scene *scene = engine->CreateScene(status->GetMergeScene()->GetBlenderScene());
+
+			BL_BlenderSceneConverter sceneConverter(scene);
+			converter->ConvertLibraryMeshes(load->m_main, scene, sceneConverter, load->m_options);
 
-	for (Scene *blenderScene : blenderScenes) {
-		KX_Scene *scene = engine->CreateScene(blenderScene);
+			status->AddSceneConverter(std::move(sceneConverter));
+			status->AddProgress(0.8f);
+		}
+		else if (load->m_idcode == ID_SCE) {
+			const unsigned int numScenes = BLI_listbase_count(&load->m_main->scene);
+			for (Scene *blenderScene = (Scene *)load->m_main->scene.first; blenderScene; blenderScene = (Scene *)blenderScene->id.next) {
+				CM_TRACE_SCOPE("LibLoad Convert", "converter", blenderScene->id.name + 2);
+
+				if (load->m_options & LIB_LOAD_VERBOSE) {
+					CM_Debug("scene name: " << blenderScene->id.name + 2);
+				}
 
-		BL_BlenderSceneConverter sceneConverter(scene);
-		converter->ConvertScene(sceneConverter, true);
+				KX_Scene *scene = engine->CreateScene(blenderScene);
 
-		status->AddSceneConverter(std::move(sceneConverter));
+				BL_BlenderSceneConverter sceneConverter(scene);
+				converter->ConvertScene(sceneConverter, true);
 
-		status->AddProgress((1.0f / blenderScenes.size()) * 0.9f); // We'll call conversion 90% and merging 10% for now
+				status->AddSceneConverter(std::move(sceneConverter));
+
+				// We'll call reading 10%, conversion 80% and merging 10% for now.
+				status->AddProgress(0.8f / numScenes);
+			}
+		}
 	}
 
-	status->GetConverter()->AddScenesToMergeQueue(status);
+	converter->m_threadinfo.m_mutex.Lock();
+	converter->m_mergequeue.push_back(load);
+	converter->m_threadinfo.m_mutex.Unlock();
 }
 
 KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFileMemory(void *data, int length, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
 {
+	if (options & LIB_LOAD_ASYNC) {
+		// The data is owned by the caller, the task reads a copy.
+		std::vector<char> buffer((char *)data, (char *)data + length);
+		return LinkBlendFileAsync(path, group, std::move(buffer), scene_merge, err_str, options);
+	}
+
 	BlendHandle *bpy_openlib = BLO_blendhandle_from_memory(data, length);
 
 	// Error checking is done in LinkBlendFile
@@ -376,12 +556,36 @@ KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFileMemory(void *data, int lengt
 
 KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFilePath(const char *filepath, char *group, KX_Scene *scene_merge, char **err_str, short options)
 {
+	if (options & LIB_LOAD_ASYNC) {
+		// The file is opened by the task.
+		return LinkBlendFileAsync(filepath, group, std::vector<char>(), scene_merge, err_str, options);
+	}
+
 	BlendHandle *bpy_openlib = BLO_blendhandle_from_file(filepath, nullptr);
 
 	// Error checking is done in LinkBlendFile
 	return LinkBlendFile(bpy_openlib, filepath, group, scene_merge, err_str, options);
 }
 
+KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFileAsync(const char *path, char *group, std::vector<char>&& data,
+														  KX_Scene *scene_merge, char **err_str, short options)
+{
+	const int idcode = BKE_idcode_from_name(group);
+
+	if (!CheckLinkBlendFile(path, idcode, group, err_str)) {
+		return nullptr;
+	}
+
+	KX_LibLoadStatus *status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
+	// Registered now to refuse a second load of the library while it's read.
+	m_status_map[path] = status;
+
+	AsyncLibLoad *load = new AsyncLibLoad{this, status, path, idcode, options, std::move(data), nullptr, 0, false};
+	BLI_task_pool_push(m_threadinfo.m_pool, AsyncLoadTask, load, false, TASK_PRIORITY_LOW);
+
+	return status;
+}
+
 static void load_datablocks(Main *main_tmp, BlendHandle *bpy_openlib, const char *path, int idcode)
 {
 	LinkNode *names = nullptr;
@@ -399,37 +603,31 @@ static void load_datablocks(Main *main_tmp, BlendHandle *bpy_openlib, const char
 	BLI_linklist_free(names, free); // free linklist *and* each node's data
 }
 
-KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
+bool BL_BlenderConverter::CheckLinkBlendFile(const char *path, int idcode, const char *group, char **err_str) const
 {
-	Main *main_newlib; // stored as a dynamic 'main' until we free it
-	const int idcode = BKE_idcode_from_name(group);
-	ReportList reports;
 	static char err_local[255];
 
-	KX_LibLoadStatus *status;
-
 	// only scene and mesh supported right now
 	if (idcode != ID_SCE && idcode != ID_ME && idcode != ID_AC) {
 		snprintf(err_local, sizeof(err_local), "invalid ID type given \"%s\"\n", group);
 		*err_str = err_local;
-		BLO_blendhandle_close(bpy_openlib);
-		return nullptr;
+		return false;
 	}
 
-	if (GetMainDynamicPath(path)) {
+	// An asynchronous library is registered in the dynamic mains only once read.
+	if (GetMainDynamicPath(path) || m_status_map.find(path) != m_status_map.end()) {
 		snprintf(err_local, sizeof(err_local), "blend file already open \"%s\"\n", path);
 		*err_str = err_local;
-		BLO_blendhandle_close(bpy_openlib);
-		return nullptr;
+		return false;
 	}
 
-	if (bpy_openlib == nullptr) {
-		snprintf(err_local, sizeof(err_local), "could not open blendfile \"%s\"\n", path);
-		*err_str = err_local;
-		return nullptr;
-	}
+	return true;
+}
 
-	main_newlib = BKE_main_new();
+Main *BL_BlenderConverter::LinkBlendHandle(BlendHandle *bpy_openlib, const char *path, int idcode, short options)
+{
+	Main *main_newlib = BKE_main_new(); // stored as a dynamic 'main' until we free it
+	ReportList reports;
 	BKE_reports_init(&reports, RPT_STORE);
 
 	short flag = 0; // don't need any special options
@@ -454,23 +652,62 @@ KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, c
 	BKE_reports_clear(&reports);
 	// done linking
 
-	// needed for lookups
-	m_DynamicMaggie.push_back(main_newlib);
 	BLI_strncpy(main_newlib->name, path, sizeof(main_newlib->name));
 
+	return main_newlib;
+}
+
+void BL_BlenderConverter::ConvertLibraryMeshes(Main *maggie, KX_Scene *scene, BL_BlenderSceneConverter& converter, short options)
+{
+	for (ID *mesh = (ID *)maggie->mesh.first; mesh; mesh = (ID *)mesh->next) {
+		if (options & LIB_LOAD_VERBOSE) {
+			CM_Debug("mesh name: " << mesh->name + 2);
+		}
+		BL_ConvertMesh((Mesh *)mesh, nullptr, scene, converter);
+	}
+}
+
+void BL_BlenderConverter::RegisterLibraryActions(Main *maggie, KX_Scene *scene, short options)
+{
+	for (ID *action = (ID *)maggie->action.first; action; action = (ID *)action->next) {
+		if (options & LIB_LOAD_VERBOSE) {
+			CM_Debug("action name: " << action->name + 2);
+		}
+		scene->GetLogicManager()->RegisterActionName(action->name + 2, action);
+	}
+}
+
+KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, const char *path, char *group, KX_Scene *scene_merge, char **err_str, short options)
+{
+	const int idcode = BKE_idcode_from_name(group);
+	static char err_local[255];
+
+	if (!CheckLinkBlendFile(path, idcode, group, err_str)) {
+		if (bpy_openlib) {
+			BLO_blendhandle_close(bpy_openlib);
+		}
+		return nullptr;
+	}
+
+	if (bpy_openlib == nullptr) {
+		snprintf(err_local, sizeof(err_local), "could not open blendfile \"%s\"\n", path);
+		*err_str = err_local;
+		return nullptr;
+	}
+
+	Main *main_newlib = LinkBlendHandle(bpy_openlib, path, idcode, options);
+
+	// needed for lookups
+	m_DynamicMaggie.push_back(main_newlib);
 
-	status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
+	KX_LibLoadStatus *status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
 
 	if (idcode == ID_ME) {
 		// Convert all new meshes into BGE meshes
-		ID *mesh;
-
 		BL_BlenderSceneConverter sceneConverter(scene_merge);
-		for (mesh = (ID *)main_newlib->mesh.first; mesh; mesh = (ID *)mesh->next) {
-			if (options & LIB_LOAD_VERBOSE) {
-				CM_Debug("mesh name: " << mesh->name + 2);
-			}
-			RAS_MeshObject *meshobj = BL_ConvertMesh((Mesh *)mesh, nullptr, scene_merge, sceneConverter);
+		ConvertLibraryMeshes(main_newlib, scene_merge, sceneConverter, options);
+
+		for (RAS_MeshObject *meshobj : sceneConverter.m_meshobjects) {
 			scene_merge->GetLogicManager()->RegisterMeshName(meshobj->GetName(), meshobj);
 		}
 
@@ -480,51 +717,27 @@ KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, c
 	}
 	else if (idcode == ID_AC) {
 		// Convert all actions
-		ID *action;
-
-		for (action = (ID *)main_newlib->action.first; action; action = (ID *)action->next) {
-			if (options & LIB_LOAD_VERBOSE) {
-				CM_Debug("action name: " << action->name + 2);
-			}
-			scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
-		}
+		RegisterLibraryActions(main_newlib, scene_merge, options);
 	}
 	else if (idcode == ID_SCE) {
 		// Merge all new linked in scene into the existing one
-
-		if (options & LIB_LOAD_ASYNC) {
-			std::vector<Scene *> blenderScenes;
-			for (Scene *scene = (Scene *)main_newlib->scene.first; scene; scene = (Scene *)scene->id.next) {
-				if (options & LIB_LOAD_VERBOSE) {
-					CM_Debug("scene name: " << scene->id.name + 2);
-				}
-
-				// Build list of scene to convert.
-				blenderScenes.push_back(scene);
+		for (Scene *scene = (Scene *)main_newlib->scene.first; scene; scene = (Scene *)scene->id.next) {
+			if (options & LIB_LOAD_VERBOSE) {
+				CM_Debug("scene name: " << scene->id.name + 2);
 			}
 
-			status->SetBlenderScenes(blenderScenes);
-			BLI_task_pool_push(m_threadinfo.m_pool, async_convert, (void *)status, false, TASK_PRIORITY_LOW);
-		}
-		else {
-			for (Scene *scene = (Scene *)main_newlib->scene.first; scene; scene = (Scene *)scene->id.next) {
-				if (options & LIB_LOAD_VERBOSE) {
-					CM_Debug("scene name: " << scene->id.name + 2);
-				}
-
-				// merge into the base  scene
-				KX_Scene *other = m_ketsjiEngine->CreateScene(scene);
+			// merge into the base  scene
+			KX_Scene *other = m_ketsjiEngine->CreateScene(scene);
 
-				BL_BlenderSceneConverter sceneConverter(other);
-				ConvertScene(sceneConverter, true);
+			BL_BlenderSceneConverter sceneConverter(other);
+			ConvertScene(sceneConverter, true);
 
-				MergeScene(scene_merge, other);
+			MergeScene(scene_merge, other);
 
-				// Finalize material and mesh conversion.
-				InitSceneShaders(sceneConverter, scene_merge);
+			// Finalize material and mesh conversion.
+			InitSceneShaders(sceneConverter, scene_merge);
 
-				delete other;
-			}
+			delete other;
 		}
 
 #ifdef WITH_PYTHON
@@ -536,20 +749,11 @@ KX_LibLoadStatus *BL_BlenderConverter::LinkBlendFile(BlendHandle *bpy_openlib, c
 
 		// Now handle all the actions
 		if (options & LIB_LOAD_LOAD_ACTIONS) {
-			ID *action;
-
-			for (action = (ID *)main_newlib->action.first; action; action = (ID *)action->next) {
-				if (options & LIB_LOAD_VERBOSE) {
-					CM_Debug("action name: " << action->name + 2);
-				}
-				scene_merge->GetLogicManager()->RegisterActionName(action->name + 2, action);
-			}
+			RegisterLibraryActions(main_newlib, scene_merge, options);
 		}
 	}
 
-	if (!(options & LIB_LOAD_ASYNC)) {
-		status->Finish();
-	}
+	status->Finish();
 
 	m_status_map[main_newlib->name] = status;
 	return status;
@@ -743,7 +947,11 @@ bool BL_BlenderConverter::FreeBlendFile(const std::string& path)
 void BL_BlenderConverter::MergeScene(KX_Scene *to, KX_Scene *from)
 {
 	to->MergeScene(from);
+	MergeSceneSlot(to, from);
+}
 
+void BL_BlenderConverter::MergeSceneSlot(KX_Scene *to, KX_Scene *from)
+{
 	m_sceneSlots[to].Merge(m_sceneSlots[from]);
 	m_sceneSlots.erase(from);
 
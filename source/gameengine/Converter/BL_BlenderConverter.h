@@ -34,6 +34,8 @@
 
 #include <map>
 #include <vector>
+#include <deque>
+#include <string>
 
 #ifdef _MSC_VER // MSVC doesn't support incomplete type in std::unique_ptr.
 #  include "KX_BlenderMaterial.h"
@@ -48,6 +50,7 @@ class EXP_StringValue;
 class BL_BlenderSceneConverter;
 class KX_KetsjiEngine;
 class KX_LibLoadStatus;
+class KX_Scene;
 class KX_BlenderMaterial;
 class BL_InterpolatorList;
 class SCA_IActuator;
@@ -93,9 +96,21 @@ private:
 		CM_ThreadMutex m_mutex;
 	} m_threadinfo;
 
+	/** Library loaded asynchronously, the blend file is read, linked and converted
+	 * by a task and the result is merged by the main thread in MergeAsyncLoads.
+	 */
+	struct AsyncLibLoad;
+
 	// Saved KX_LibLoadStatus objects
 	std::map<std::string, KX_LibLoadStatus *> m_status_map;
-	std::vector<KX_LibLoadStatus *> m_mergequeue;
+	/// Libraries loaded by a task and waiting to be merged, protected by m_threadinfo.m_mutex.
+	std::vector<AsyncLibLoad *> m_mergequeue;
+	/// Libraries being merged by the main thread, the first one is merged first.
+	std::deque<AsyncLibLoad *> m_mergingLoads;
+	/// Status of the asynchronous libraries which failed to load, kept for their python proxy.
+	std::vector<KX_LibLoadStatus *> m_failedStatus;
+	/// Time in milliseconds allowed to merge the asynchronous libraries per logic frame, 0 for unlimited.
+	float m_mergeBudget;
 
 	Main *m_maggie;
 	std::vector<Main *> m_DynamicMaggie;
@@ -103,6 +118,22 @@ private:
 	KX_KetsjiEngine *m_ketsjiEngine;
 	bool m_alwaysUseExpandFraming;
 
+	/// Return false and set the error string if the library can't be loaded.
+	bool CheckLinkBlendFile(const char *path, int idcode, const char *group, char **err_str) const;
+	/// Link the data blocks of a blend file in a new main and close the handle.
+	static Main *LinkBlendHandle(BlendHandle *bpy_openlib, const char *path, int idcode, short options);
+	/// Convert all the meshes of a library in a scene.
+	void ConvertLibraryMeshes(Main *maggie, KX_Scene *scene, BL_BlenderSceneConverter& converter, short options);
+	void RegisterLibraryActions(Main *maggie, KX_Scene *scene, short options);
+
+	KX_LibLoadStatus *LinkBlendFileAsync(const char *path, char *group, std::vector<char>&& data, KX_Scene *scene_merge,
+										 char **err_str, short options);
+	static void AsyncLoadTask(TaskPool *pool, void *taskdata, int threadid);
+	/** Merge a part of an asynchronous library, either its registration, the meshes or a part of a scene.
+	 * \return True when the library is fully merged.
+	 */
+	bool MergeAsyncLoadStep(AsyncLibLoad *load);
+
 public:
 	BL_BlenderConverter(Main *maggie, KX_KetsjiEngine *engine);
 	virtual ~BL_BlenderConverter();
@@ -149,10 +180,16 @@ public:
 	RAS_MeshObject *ConvertMeshSpecial(KX_Scene *kx_scene, Main *maggie, const std::string& name);
 
 	void MergeScene(KX_Scene *to, KX_Scene *from);
+	/// Move the converted data of a merged scene and delete its world.
+	void MergeSceneSlot(KX_Scene *to, KX_Scene *from);
 
+	/// Merge the asynchronous libraries loaded by the tasks until the merge budget is spent.
 	void MergeAsyncLoads();
+	/// Wait for all the asynchronous libraries and merge them regardless of the budget.
 	void FinalizeAsyncLoads();
-	void AddScenesToMergeQueue(KX_LibLoadStatus *status);
+
+	float GetMergeBudget() const;
+	void SetMergeBudget(float budget);
 
 	void PrintStats();
 
@@ -49,6 +49,8 @@
 
 #include <math.h>
 #include <vector>
+#include <map>
+#include <tuple>
 #include <algorithm>
 
 
@@ -57,6 +59,7 @@
 
 #include "PHY_Pro.h"
 #include "PHY_IPhysicsEnvironment.h"
+#include "PHY_IPhysicsController.h"
 
 #ifdef WITH_BULLET
 #  include "CcdPhysicsEnvironment.h"
@@ -72,6 +75,10 @@
 #include "RAS_BucketManager.h"
 #include "RAS_BoundingBoxManager.h"
 #include "RAS_IPolygonMaterial.h"
+#include "RAS_MaterialBucket.h"
+#include "RAS_DisplayArrayBucket.h"
+#include "RAS_MeshUser.h"
+#include "RAS_MeshSlot.h"
 
 #include "SG_Node.h"
 #include "SG_BBox.h"
@@ -100,6 +107,7 @@
 #include "KX_MotionState.h"
 #include "KX_NavMeshObject.h"
 #include "KX_ObstacleSimulation.h"
+#include "KX_BatchGroup.h"
 
 #include "BL_BlenderDataConversion.h"
 #include "BL_ModifierDeformer.h"
@@ -1184,7 +1192,7 @@ static void bl_ConvertBlenderObject_Single(BL_BlenderSceneConverter& converter,
 	if (blenderobject->parent != 0) {
 		// Blender has an additional 'parentinverse' offset in each object.
 		SG_Callbacks callback(nullptr, nullptr, nullptr, KX_Scene::KX_ScenegraphUpdateFunc, KX_Scene::KX_ScenegraphRescheduleFunc);
-		SG_Node *parentinversenode = new SG_Node(nullptr, kxscene, callback);
+		SG_Node *parentinversenode = new SG_Node(nullptr, kxscene, callback, kxscene->GetTransformPool());
 
 		// Define a normal parent relationship for this node.
 		KX_NormalParentRelation *parent_relation = new KX_NormalParentRelation();
@@ -1249,6 +1257,158 @@ static void bl_ConvertBlenderObject_Single(BL_BlenderSceneConverter& converter,
 }
 
 
+/// Minimum number of objects merged in an automatic batch group.
+#define BL_BATCH_MIN_OBJECTS 2
+
+/// The materials, vertex formats and primitive types of all the mesh slots of an object.
+using BL_BatchSignature = std::vector<std::tuple<RAS_IPolyMaterial *, unsigned short, unsigned short, int> >;
+
+struct BL_BatchObject
+{
+	KX_GameObject *m_gameobj;
+	/// The world center of the object bounding box.
+	MT_Vector3 m_center;
+};
+
+/// Check if an object and its parents can't be moved or animated by the game.
+static bool BL_IsStaticObject(KX_GameObject *gameobj)
+{
+	for (; gameobj; gameobj = gameobj->GetParent()) {
+		Object *blenderobj = gameobj->GetBlenderObject();
+		if (!blenderobj || blenderobj->adt || gameobj->GetGameObjectType() == SCA_IObject::OBJ_ARMATURE) {
+			return false;
+		}
+
+		if (!gameobj->GetSensors().empty() || !gameobj->GetControllers().empty() ||
+		    !gameobj->GetActuators().empty() || gameobj->GetComponents())
+		{
+			return false;
+		}
+
+		PHY_IPhysicsController *ctrl = gameobj->GetPhysicsController();
+		if (ctrl && ctrl->IsDynamic()) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/** Compute the batch signature of an object, objects with different signatures can't
+ * be merged in the same batch group.
+ * \return false if the object can't be batched.
+ */
+static bool BL_GetBatchSignature(KX_GameObject *gameobj, BL_BatchSignature& signature)
+{
+	RAS_MeshUser *meshUser = gameobj->GetMeshUser();
+	if (!meshUser || meshUser->GetBatchGroup() || meshUser->GetMeshSlots().empty()) {
+		return false;
+	}
+
+	for (RAS_MeshSlot *slot : meshUser->GetMeshSlots()) {
+		RAS_DisplayArrayBucket *arrayBucket = slot->m_displayArrayBucket;
+		RAS_MaterialBucket *bucket = arrayBucket->GetBucket();
+		RAS_IDisplayArray *array = arrayBucket->GetDisplayArray();
+		// Instancing materials are drawn per object.
+		if (!array || bucket->UseInstancing()) {
+			return false;
+		}
+
+		const RAS_VertexFormat& format = array->GetFormat();
+		signature.emplace_back(bucket->GetPolyMaterial(), format.uvSize, format.colorSize, array->GetPrimitiveType());
+	}
+
+	std::sort(signature.begin(), signature.end());
+
+	return true;
+}
+
+/** Split objects into clusters of at most size objects, each time at the median
+ * of the object centers along the axis of largest extent.
+ */
+static void BL_SplitBatchCluster(std::vector<BL_BatchObject>::iterator begin, std::vector<BL_BatchObject>::iterator end,
+                                 unsigned int size, std::vector<std::vector<KX_GameObject *> >& clusters)
+{
+	const unsigned int count = end - begin;
+	if (count <= size) {
+		clusters.emplace_back();
+		std::vector<KX_GameObject *>& cluster = clusters.back();
+		for (std::vector<BL_BatchObject>::iterator it = begin; it != end; ++it) {
+			cluster.push_back(it->m_gameobj);
+		}
+		return;
+	}
+
+	MT_Vector3 min = begin->m_center;
+	MT_Vector3 max = min;
+	for (std::vector<BL_BatchObject>::iterator it = begin + 1; it != end; ++it) {
+		for (unsigned short i = 0; i < 3; ++i) {
+			MT_set_min(min[i], it->m_center[i]);
+			MT_set_max(max[i], it->m_center[i]);
+		}
+	}
+
+	const int axis = (max - min).closestAxis();
+	std::vector<BL_BatchObject>::iterator middle = begin + count / 2;
+	std::nth_element(begin, middle, end, [axis](const BL_BatchObject& a, const BL_BatchObject& b) {
+		return a.m_center[axis] < b.m_center[axis];
+	});
+
+	BL_SplitBatchCluster(begin, middle, size, clusters);
+	BL_SplitBatchCluster(middle, end, size, clusters);
+}
+
+/** Merge the static mesh objects into batch groups. The objects sharing the same
+ * materials are clustered spatially, one batch group is created per cluster to
+ * keep the culling of the batched objects efficient.
+ * \param size The maximum number of objects per batch group.
+ */
+static void BL_CreateBatchGroups(EXP_ListValue<KX_GameObject> *objectlist, unsigned int size)
+{
+	std::map<BL_BatchSignature, std::vector<BL_BatchObject> > candidates;
+
+	for (KX_GameObject *gameobj : objectlist) {
+		Object *blenderobj = gameobj->GetBlenderObject();
+		if (blenderobj->type != OB_MESH || (blenderobj->gameflag & OB_NAVMESH) || gameobj->GetDeformer() ||
+		    gameobj->GetLodManager() || !BL_IsStaticObject(gameobj))
+		{
+			continue;
+		}
+
+		BL_BatchSignature signature;
+		if (!BL_GetBatchSignature(gameobj, signature)) {
+			continue;
+		}
+
+		const MT_Vector3 center = gameobj->NodeGetWorldTransform()(gameobj->GetCullingNode()->GetAabb().GetCenter());
+		candidates[signature].push_back({gameobj, center});
+	}
+
+	for (auto& pair : candidates) {
+		std::vector<BL_BatchObject>& objects = pair.second;
+		if (objects.size() < BL_BATCH_MIN_OBJECTS) {
+			continue;
+		}
+
+		std::vector<std::vector<KX_GameObject *> > clusters;
+		BL_SplitBatchCluster(objects.begin(), objects.end(), size, clusters);
+
+		for (const std::vector<KX_GameObject *>& cluster : clusters) {
+			if (cluster.size() < BL_BATCH_MIN_OBJECTS) {
+				continue;
+			}
+
+			// The batch group is owned by the mesh users of the merged objects.
+			KX_BatchGroup *batchGroup = new KX_BatchGroup();
+			batchGroup->MergeObjects(cluster);
+
+			if (batchGroup->GetObjects()->GetCount() == 0) {
+				delete batchGroup;
+			}
+		}
+	}
+}
+
 /// Convert blender objects into ketsji gameobjects.
 void BL_ConvertBlenderObjects(struct Main *maggie,
                               KX_Scene *kxscene,
@@ -1814,6 +1974,13 @@ void BL_ConvertBlenderObjects(struct Main *maggie,
 		}
 	}
 
+	/* Merge the static objects once their logic and physics are known, the merged
+	 * objects of a libloaded scene would be moved to an other scene.
+	 */
+	if ((blenderscene->gm.flag & GAME_AUTO_BATCHING) && !libloading) {
+		BL_CreateBatchGroups(objectlist, max_ii(blenderscene->gm.batchSize, BL_BATCH_MIN_OBJECTS));
+	}
+
 	// Cleanup converted set of group objects.
 	convertedlist->Release();
 	sumolist->Release();
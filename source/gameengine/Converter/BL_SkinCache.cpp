@@ -0,0 +1,136 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_SkinCache.cpp
+ *  \ingroup bgeconv
+ */
+
+#include "BL_SkinCache.h"
+
+#include <cmath>
+
+/// Quantization step of the skinning matrices, poses closer than this share their deformation.
+#define BL_SKIN_CACHE_PRECISION 1.0e-4f
+
+std::atomic<unsigned int> BL_SkinCache::m_hits(0);
+std::atomic<unsigned int> BL_SkinCache::m_misses(0);
+
+BL_SkinCache::BL_SkinCache()
+	:m_currentTime(-1.0),
+	m_previousTime(-1.0)
+{
+}
+
+BL_SkinCache::~BL_SkinCache()
+{
+}
+
+size_t BL_SkinCache::KeyHash::operator()(const Key& key) const
+{
+	// FNV-1a over the quantized values.
+	size_t hash = 2166136261u;
+	for (int value : key) {
+		hash = (hash ^ (unsigned int)value) * 16777619u;
+	}
+	return hash;
+}
+
+void BL_SkinCache::ComputeKey(const BL_SkinInfluences& influences, const std::vector<BL_SkinInfluences::Matrix>& matrices,
+							  Key& key)
+{
+	const std::vector<bool>& deformGroups = influences.GetDeformGroups();
+	key.clear();
+
+	for (unsigned int i = 0, size = matrices.size(); i < size; ++i) {
+		if (!deformGroups[i]) {
+			continue;
+		}
+
+		// The last row of an affine matrix is constant.
+		const float (*mat)[4] = matrices[i].m_data;
+		for (unsigned short col = 0; col < 4; ++col) {
+			for (unsigned short row = 0; row < 3; ++row) {
+				key.push_back((int)std::lround(mat[col][row] / BL_SKIN_CACHE_PRECISION));
+			}
+		}
+	}
+}
+
+std::shared_ptr<BL_SkinCache::Entry> BL_SkinCache::Find(const Key& key, double time)
+{
+	std::shared_ptr<Entry> entry;
+
+	m_mutex.Lock();
+	const auto it = m_entries.find(key);
+	if (it != m_entries.end()) {
+		entry = it->second;
+		entry->m_lastUse = time;
+	}
+	m_mutex.Unlock();
+
+	if (entry) {
+		++m_hits;
+	}
+	else {
+		++m_misses;
+	}
+
+	return entry;
+}
+
+void BL_SkinCache::Insert(const Key& key, const std::shared_ptr<Entry>& entry)
+{
+	m_mutex.Lock();
+
+	if (entry->m_lastUse != m_currentTime) {
+		m_previousTime = m_currentTime;
+		m_currentTime = entry->m_lastUse;
+
+		/* The entries of the previous frame are kept for the instances not yet deformed in this
+		 * frame, the older entries are removed. The entries are immutable so they stay valid
+		 * for the deformers holding them. */
+		for (auto it = m_entries.begin(); it != m_entries.end();) {
+			if (it->second->m_lastUse < m_previousTime) {
+				it = m_entries.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
+	m_entries[key] = entry;
+
+	m_mutex.Unlock();
+}
+
+void BL_SkinCache::GetStatistics(unsigned int& hits, unsigned int& misses)
+{
+	hits = m_hits;
+	misses = m_misses;
+}
+
+void BL_SkinCache::ResetStatistics()
+{
+	m_hits = 0;
+	m_misses = 0;
+}
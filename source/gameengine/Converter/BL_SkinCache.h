@@ -0,0 +1,102 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_SkinCache.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_SKINCACHE_H__
+#define __BL_SKINCACHE_H__
+
+#include "BL_SkinInfluences.h"
+
+#include "CM_Thread.h"
+
+#include "MT_Vector3.h"
+
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+
+/** \brief Deformation results of a skinned mesh shared by all the instances in the same pose.
+ * A pose is identified by the skinning matrices of the deform groups quantized to
+ * BL_SKIN_CACHE_PRECISION, instances playing the same action at the same frame reuse the
+ * positions, normals and bounding box of the first instance deformed. Entries not used
+ * during a frame are dropped so the cache size follows the number of distinct poses.
+ */
+class BL_SkinCache
+{
+public:
+	/// Quantized skinning matrices of a pose.
+	typedef std::vector<int> Key;
+
+	struct Entry
+	{
+		std::vector<std::array<float, 3> > m_positions;
+		std::vector<std::array<float, 3> > m_normals;
+		/// The bounding box is only available if computed by the deformer creating the entry.
+		bool m_hasAabb;
+		MT_Vector3 m_aabbMin;
+		MT_Vector3 m_aabbMax;
+		/// Last frame time the entry was used.
+		double m_lastUse;
+	};
+
+private:
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const;
+	};
+
+	std::unordered_map<Key, std::shared_ptr<Entry>, KeyHash> m_entries;
+	CM_ThreadMutex m_mutex;
+	/// Frame time of the last insertion and of the frame before.
+	double m_currentTime;
+	double m_previousTime;
+
+	/// Statistics of all the caches.
+	static std::atomic<unsigned int> m_hits;
+	static std::atomic<unsigned int> m_misses;
+
+public:
+	BL_SkinCache();
+	~BL_SkinCache();
+
+	/** Compute the key of a pose.
+	 * \param influences The influences of the mesh, only the matrices of their deform groups are used.
+	 * \param matrices The skinning matrix of each deform group.
+	 */
+	static void ComputeKey(const BL_SkinInfluences& influences, const std::vector<BL_SkinInfluences::Matrix>& matrices,
+						   Key& key);
+
+	/** Find the entry of a pose and mark it used at the given frame time.
+	 * \return The entry or nullptr if the pose was not deformed yet.
+	 */
+	std::shared_ptr<Entry> Find(const Key& key, double time);
+	/// Add the entry of a pose, on a new frame the entries not used since the previous frame are removed.
+	void Insert(const Key& key, const std::shared_ptr<Entry>& entry);
+
+	static void GetStatistics(unsigned int& hits, unsigned int& misses);
+	static void ResetStatistics();
+};
+
+#endif  // __BL_SKINCACHE_H__
@@ -33,10 +33,6 @@
 #  pragma warning (disable:4786)
 #endif
 
-// Eigen3 stuff used for BGEDeformVerts
-#include <Eigen/Core>
-#include <Eigen/LU>
-
 #include "BL_SkinDeformer.h"
 #include <string>
 #include "RAS_IPolygonMaterial.h"
@@ -47,6 +43,8 @@
 
 //#include "BL_ArmatureController.h"
 #include "BL_DeformableGameObject.h"
+#include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
 #include "DNA_armature_types.h"
 #include "DNA_action_types.h"
 #include "DNA_mesh_types.h"
@@ -90,7 +88,8 @@ BL_SkinDeformer::BL_SkinDeformer(
 	:BL_MeshDeformer(gameobj, bmeshobj_old, mesh),
 	m_armobj(arma),
 	m_lastArmaUpdate(-1),
-	m_copyNormals(false)
+	m_copyNormals(false),
+	m_skinCacheInsert(false)
 {
 	// this is needed to ensure correct deformation of mesh:
 	// the deformation is done with Blender's armature_deform_verts() function
@@ -99,6 +98,11 @@ BL_SkinDeformer::BL_SkinDeformer(
 	// simulate a pure replacement of the mesh.
 	copy_m4_m4(m_obmat, bmeshobj_new->obmat);
 	m_deformflags = get_deformflags(bmeshobj_new);
+
+	// Build the vertex influences at conversion, they are shared with all the replicas.
+	if (m_armobj && m_armobj->GetVertDeformType() == ARM_VDEF_BGE_CPU) {
+		BuildInfluences();
+	}
 }
 
 BL_SkinDeformer::~BL_SkinDeformer()
@@ -150,6 +154,8 @@ void BL_SkinDeformer::ProcessReplica()
 	BL_MeshDeformer::ProcessReplica();
 	m_lastArmaUpdate = -1.0;
 	m_dfnrToPC.clear();
+	m_skinCacheEntry.reset();
+	m_skinCacheInsert = false;
 }
 
 void BL_SkinDeformer::BlenderDeformVerts()
@@ -170,90 +176,85 @@ void BL_SkinDeformer::BlenderDeformVerts()
 	RecalcNormals();
 }
 
-void BL_SkinDeformer::BGEDeformVerts()
+void BL_SkinDeformer::VerifyDeformGroups()
 {
-	Object *par_arma = m_armobj->GetArmatureObject();
-	MDeformVert *dverts = m_bmesh->dvert;
-	Eigen::Matrix4f pre_mat, post_mat, chan_mat, norm_chan_mat;
-
-	if (!dverts)
+	if (!m_dfnrToPC.empty()) {
 		return;
+	}
 
+	Object *par_arma = m_armobj->GetArmatureObject();
 	const unsigned short defbase_tot = BLI_listbase_count(&m_objMesh->defbase);
 
-	if (m_dfnrToPC.empty()) {
-		m_dfnrToPC.resize(defbase_tot);
-		int i;
-		bDeformGroup *dg;
-		for (i = 0, dg = (bDeformGroup *)m_objMesh->defbase.first; dg; ++i, dg = dg->next) {
-			m_dfnrToPC[i] = BKE_pose_channel_find_name(par_arma->pose, dg->name);
+	m_dfnrToPC.resize(defbase_tot);
+	int i;
+	bDeformGroup *dg;
+	for (i = 0, dg = (bDeformGroup *)m_objMesh->defbase.first; dg; ++i, dg = dg->next) {
+		m_dfnrToPC[i] = BKE_pose_channel_find_name(par_arma->pose, dg->name);
 
-			if (m_dfnrToPC[i] && m_dfnrToPC[i]->bone->flag & BONE_NO_DEFORM) {
-				m_dfnrToPC[i] = nullptr;
-			}
+		if (m_dfnrToPC[i] && m_dfnrToPC[i]->bone->flag & BONE_NO_DEFORM) {
+			m_dfnrToPC[i] = nullptr;
 		}
 	}
+}
 
-	post_mat = Eigen::Matrix4f::Map((float *)m_obmat).inverse() * Eigen::Matrix4f::Map((float *)m_armobj->GetArmatureObject()->obmat);
-	pre_mat = post_mat.inverse();
-
-	MDeformVert *dv = dverts;
-	MDeformWeight *dw;
-
-	for (int i = 0; i < m_bmesh->totvert; ++i, dv++) {
-		float contrib = 0.0f, weight, max_weight = -1.0f;
-		bPoseChannel *pchan = nullptr;
-		Eigen::Vector3f normorg(m_bmesh->mvert[i].no[0], m_bmesh->mvert[i].no[1], m_bmesh->mvert[i].no[2]);
-		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(m_transnors[i].data());
-		Eigen::Vector4f vec(0.0f, 0.0f, 0.0f, 1.0f);
-		Eigen::Vector4f co(m_transverts[i][0],
-		                   m_transverts[i][1],
-		                   m_transverts[i][2],
-		                   1.0f);
-
-		if (!dv->totweight)
-			continue;
-
-		co = pre_mat * co;
-
-		dw = dv->dw;
-
-		for (unsigned int j = dv->totweight; j != 0; j--, dw++) {
-			const int index = dw->def_nr;
+void BL_SkinDeformer::BuildInfluences()
+{
+	VerifyDeformGroups();
 
-			if (index < defbase_tot && (pchan = m_dfnrToPC[index])) {
-				weight = dw->weight;
+	std::vector<bool> deformGroups(m_dfnrToPC.size());
+	for (unsigned int i = 0, size = m_dfnrToPC.size(); i < size; ++i) {
+		deformGroups[i] = (m_dfnrToPC[i] != nullptr);
+	}
 
-				if (weight) {
-					chan_mat = Eigen::Matrix4f::Map((float *)pchan->chan_mat);
+	m_influences.reset(new BL_SkinInfluences(m_bmesh, deformGroups));
+	m_skinCache.reset(new BL_SkinCache());
+}
 
-					// Update Vertex Position
-					vec.noalias() += (chan_mat * co - co) * weight;
+void BL_SkinDeformer::BGEDeformVerts(bool useCache)
+{
+	if (!m_bmesh->dvert) {
+		return;
+	}
 
-					// Save the most influential channel so we can use it to update the vertex normal
-					if (weight > max_weight)
-					{
-						max_weight = weight;
-						norm_chan_mat = chan_mat;
-					}
+	VerifyDeformGroups();
+	if (!m_influences) {
+		BuildInfluences();
+	}
 
-					contrib += weight;
-				}
-			}
+	float obmat_inv[4][4], pre_mat[4][4], post_mat[4][4];
+	invert_m4_m4(obmat_inv, m_obmat);
+	mul_m4_m4m4(post_mat, obmat_inv, m_armobj->GetArmatureObject()->obmat);
+	invert_m4_m4(pre_mat, post_mat);
+
+	/* The blended matrix of a vertex is applied in the armature space, the conversion
+	 * from and to the mesh space is merged into the matrix of each deform group. */
+	m_skinMatrices.resize(m_dfnrToPC.size());
+	for (unsigned int i = 0, size = m_dfnrToPC.size(); i < size; ++i) {
+		bPoseChannel *pchan = m_dfnrToPC[i];
+		if (pchan) {
+			mul_m4_series(m_skinMatrices[i].m_data, post_mat, pchan->chan_mat, pre_mat);
 		}
+	}
 
-		// Update Vertex Normal
-		norm = norm_chan_mat.topLeftCorner<3, 3>() * normorg;
+	m_skinCacheEntry.reset();
+	m_skinCacheInsert = false;
+
+	if (useCache && m_armobj->GetShareDeformation()) {
+		BL_SkinCache::ComputeKey(*m_influences, m_skinMatrices, m_skinCacheKey);
+		m_skinCacheEntry = m_skinCache->Find(m_skinCacheKey, m_armobj->GetLastFrame());
+		if (m_skinCacheEntry) {
+			m_transverts = m_skinCacheEntry->m_positions;
+			m_transnors = m_skinCacheEntry->m_normals;
+			m_copyNormals = true;
+			return;
+		}
 
-		co.noalias() += vec / contrib;
-		co[3] = 1.0f; // Make sure we have a 1 for the w component!
+		// Added once the bounding box is computed in UpdateTransverts().
+		m_skinCacheInsert = true;
+	}
 
-		co = post_mat * co;
+	m_influences->Deform(m_skinMatrices, m_transverts.data(), m_transnors.data(), KX_GetActiveEngine()->GetTaskScheduler());
 
-		m_transverts[i][0] = co[0];
-		m_transverts[i][1] = co[1];
-		m_transverts[i][2] = co[2];
-	}
 	m_copyNormals = true;
 }
 
@@ -267,6 +268,14 @@ void BL_SkinDeformer::UpdateTransverts()
 	MT_Vector3 aabbMin(FLT_MAX, FLT_MAX, FLT_MAX);
 	MT_Vector3 aabbMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
 
+	bool updateBounds = m_gameobj->GetAutoUpdateBounds();
+	// Reuse the bounding box of a shared deformation.
+	if (updateBounds && m_skinCacheEntry && m_skinCacheEntry->m_hasAabb) {
+		aabbMin = m_skinCacheEntry->m_aabbMin;
+		aabbMax = m_skinCacheEntry->m_aabbMax;
+		updateBounds = false;
+	}
+
 	// the vertex cache is unique to this deformer, no need to update it
 	// if it wasn't updated! We must update all the materials at once
 	// because we will not get here again for the other material
@@ -282,7 +291,7 @@ void BL_SkinDeformer::UpdateTransverts()
 
 			MT_Vector3 vertpos = v.xyz();
 
-			if (!m_gameobj->GetAutoUpdateBounds()) {
+			if (!updateBounds) {
 				continue;
 			}
 
@@ -299,6 +308,17 @@ void BL_SkinDeformer::UpdateTransverts()
 
 	m_boundingBox->SetAabb(aabbMin, aabbMax);
 
+	if (m_skinCacheInsert) {
+		std::shared_ptr<BL_SkinCache::Entry> entry(new BL_SkinCache::Entry());
+		entry->m_positions = m_transverts;
+		entry->m_normals = m_transnors;
+		entry->m_hasAabb = updateBounds;
+		entry->m_aabbMin = aabbMin;
+		entry->m_aabbMax = aabbMax;
+		entry->m_lastUse = m_armobj->GetLastFrame();
+		m_skinCache->Insert(m_skinCacheKey, entry);
+		m_skinCacheInsert = false;
+	}
 
 	if (m_copyNormals)
 		m_copyNormals = false;
@@ -316,7 +336,7 @@ bool BL_SkinDeformer::UpdateInternal(bool shape_applied)
 		m_armobj->ApplyPose();
 
 		if (m_armobj->GetVertDeformType() == ARM_VDEF_BGE_CPU)
-			BGEDeformVerts();
+			BGEDeformVerts(!shape_applied);
 		else
 			BlenderDeformVerts();
 
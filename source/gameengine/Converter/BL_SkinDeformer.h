@@ -38,6 +38,8 @@
 
 #include "BL_MeshDeformer.h"
 #include "BL_ArmatureObject.h"
+#include "BL_SkinInfluences.h"
+#include "BL_SkinCache.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -46,6 +48,8 @@
 
 #include "RAS_Deformer.h"
 
+#include <memory>
+
 struct Object;
 struct bPoseChannel;
 class RAS_MeshObject;
@@ -94,9 +98,27 @@ protected:
 	bool m_copyNormals; // dirty flag so we know if Apply() needs to copy normal information (used for BGEDeformVerts())
 	std::vector<bPoseChannel *> m_dfnrToPC;
 	short m_deformflags;
+	/// Vertex influences used by BGEDeformVerts(), shared by the replicas.
+	std::shared_ptr<BL_SkinInfluences> m_influences;
+	/// Skinning matrix of each deform group for the current pose.
+	std::vector<BL_SkinInfluences::Matrix> m_skinMatrices;
+	/// Deformations of the poses shared by the replicas.
+	std::shared_ptr<BL_SkinCache> m_skinCache;
+	BL_SkinCache::Key m_skinCacheKey;
+	/// Cached deformation used for the current pose.
+	std::shared_ptr<BL_SkinCache::Entry> m_skinCacheEntry;
+	/// True when the current deformation must be added to the cache.
+	bool m_skinCacheInsert;
+
+	/// Find the pose channel of each deform group of the mesh object.
+	void VerifyDeformGroups();
+	void BuildInfluences();
 
 	void BlenderDeformVerts();
-	void BGEDeformVerts();
+	/** Deform the vertices with BL_SkinInfluences.
+	 * \param useCache Share the deformation of the pose, only valid if the vertices are at rest.
+	 */
+	void BGEDeformVerts(bool useCache);
 
 	virtual void UpdateTransverts();
 };
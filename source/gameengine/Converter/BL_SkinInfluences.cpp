@@ -0,0 +1,204 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_SkinInfluences.cpp
+ *  \ingroup bgeconv
+ */
+
+#include "BL_SkinInfluences.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+extern "C" {
+#  include "BLI_utildefines.h"
+#  include "BLI_math.h"
+#  include "BLI_task.h"
+}
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include <algorithm>
+
+/// Number of vertices skinned by a task.
+#define BL_SKIN_TASK_SIZE 2048
+
+BL_SkinInfluences::BL_SkinInfluences(const Mesh *mesh, const std::vector<bool>& deformGroups)
+	:m_deformGroups(deformGroups)
+{
+	const unsigned int totvert = mesh->dvert ? mesh->totvert : 0;
+	m_offsets.reserve(totvert + 1);
+
+	for (unsigned int i = 0; i < totvert; ++i) {
+		const MDeformVert& dv = mesh->dvert[i];
+		const unsigned int start = m_groups.size();
+		m_offsets.push_back(start);
+
+		float contrib = 0.0f;
+		for (unsigned int j = 0; j < dv.totweight; ++j) {
+			const MDeformWeight& dw = dv.dw[j];
+			if (dw.def_nr < deformGroups.size() && deformGroups[dw.def_nr] && dw.weight != 0.0f) {
+				m_groups.push_back(dw.def_nr);
+				m_weights.push_back(dw.weight);
+				contrib += dw.weight;
+			}
+		}
+
+		if (contrib == 0.0f) {
+			// Weights cancelling each other can't be normalized, keep the vertex unchanged.
+			m_groups.resize(start);
+			m_weights.resize(start);
+			continue;
+		}
+
+		for (unsigned int j = start, end = m_weights.size(); j < end; ++j) {
+			m_weights[j] /= contrib;
+		}
+	}
+
+	m_offsets.push_back(m_groups.size());
+
+	m_groups.shrink_to_fit();
+	m_weights.shrink_to_fit();
+}
+
+unsigned int BL_SkinInfluences::GetNumVertices() const
+{
+	return m_offsets.size() - 1;
+}
+
+unsigned int BL_SkinInfluences::GetNumInfluences() const
+{
+	return m_groups.size();
+}
+
+const std::vector<bool>& BL_SkinInfluences::GetDeformGroups() const
+{
+	return m_deformGroups;
+}
+
+void BL_SkinInfluences::DeformRange(const std::vector<Matrix>& matrices, std::array<float, 3> *positions,
+									std::array<float, 3> *normals, unsigned int begin, unsigned int end) const
+{
+	for (unsigned int i = begin; i < end; ++i) {
+		const unsigned int first = m_offsets[i];
+		const unsigned int last = m_offsets[i + 1];
+		if (first == last) {
+			continue;
+		}
+
+		float *co = positions[i].data();
+		float *no = normals[i].data();
+
+#ifdef __SSE2__
+		// Blend the columns of the group matrices.
+		const float (*mat)[4] = matrices[m_groups[first]].m_data;
+		__m128 weight = _mm_set1_ps(m_weights[first]);
+		__m128 col0 = _mm_mul_ps(_mm_loadu_ps(mat[0]), weight);
+		__m128 col1 = _mm_mul_ps(_mm_loadu_ps(mat[1]), weight);
+		__m128 col2 = _mm_mul_ps(_mm_loadu_ps(mat[2]), weight);
+		__m128 col3 = _mm_mul_ps(_mm_loadu_ps(mat[3]), weight);
+
+		for (unsigned int j = first + 1; j < last; ++j) {
+			mat = matrices[m_groups[j]].m_data;
+			weight = _mm_set1_ps(m_weights[j]);
+			col0 = _mm_add_ps(col0, _mm_mul_ps(_mm_loadu_ps(mat[0]), weight));
+			col1 = _mm_add_ps(col1, _mm_mul_ps(_mm_loadu_ps(mat[1]), weight));
+			col2 = _mm_add_ps(col2, _mm_mul_ps(_mm_loadu_ps(mat[2]), weight));
+			col3 = _mm_add_ps(col3, _mm_mul_ps(_mm_loadu_ps(mat[3]), weight));
+		}
+
+		const __m128 co4 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(co[0])), _mm_mul_ps(col1, _mm_set1_ps(co[1]))),
+									  _mm_add_ps(_mm_mul_ps(col2, _mm_set1_ps(co[2])), col3));
+		const __m128 no4 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(col0, _mm_set1_ps(no[0])), _mm_mul_ps(col1, _mm_set1_ps(no[1]))),
+									  _mm_mul_ps(col2, _mm_set1_ps(no[2])));
+
+		// The arrays are only 3 floats, store the 4 components aside.
+		float result[2][4];
+		_mm_storeu_ps(result[0], co4);
+		_mm_storeu_ps(result[1], no4);
+		copy_v3_v3(co, result[0]);
+		copy_v3_v3(no, result[1]);
+#else
+		float blend[4][3] = {{0.0f}};
+		for (unsigned int j = first; j < last; ++j) {
+			const float (*mat)[4] = matrices[m_groups[j]].m_data;
+			const float weight = m_weights[j];
+			for (unsigned short col = 0; col < 4; ++col) {
+				madd_v3_v3fl(blend[col], mat[col], weight);
+			}
+		}
+
+		float result[3];
+		for (unsigned short row = 0; row < 3; ++row) {
+			result[row] = blend[0][row] * co[0] + blend[1][row] * co[1] + blend[2][row] * co[2] + blend[3][row];
+		}
+		copy_v3_v3(co, result);
+		for (unsigned short row = 0; row < 3; ++row) {
+			result[row] = blend[0][row] * no[0] + blend[1][row] * no[1] + blend[2][row] * no[2];
+		}
+		copy_v3_v3(no, result);
+#endif
+
+		normalize_v3(no);
+	}
+}
+
+struct BL_SkinTaskData
+{
+	const BL_SkinInfluences *influences;
+	const std::vector<BL_SkinInfluences::Matrix> *matrices;
+	std::array<float, 3> *positions;
+	std::array<float, 3> *normals;
+};
+
+static void skin_task_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	const BL_SkinTaskData *data = (BL_SkinTaskData *)BLI_task_pool_userdata(pool);
+	const unsigned int begin = GET_UINT_FROM_POINTER(taskdata);
+	const unsigned int end = std::min(begin + BL_SKIN_TASK_SIZE, data->influences->GetNumVertices());
+
+	data->influences->DeformRange(*data->matrices, data->positions, data->normals, begin, end);
+}
+
+void BL_SkinInfluences::Deform(const std::vector<Matrix>& matrices, std::array<float, 3> *positions,
+							   std::array<float, 3> *normals, TaskScheduler *scheduler) const
+{
+	const unsigned int totvert = GetNumVertices();
+
+	if (!scheduler || totvert <= BL_SKIN_TASK_SIZE) {
+		DeformRange(matrices, positions, normals, 0, totvert);
+		return;
+	}
+
+	BL_SkinTaskData data = {this, &matrices, positions, normals};
+	/* The pool can be created from a task of the animation pool, its tasks
+	 * are then run by this worker and the idle threads. */
+	TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+	for (unsigned int begin = 0; begin < totvert; begin += BL_SKIN_TASK_SIZE) {
+		BLI_task_pool_push(pool, skin_task_func, SET_UINT_IN_POINTER(begin), false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
@@ -0,0 +1,84 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_SkinInfluences.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_SKININFLUENCES_H__
+#define __BL_SKININFLUENCES_H__
+
+#include <vector>
+#include <array>
+
+struct Mesh;
+struct TaskScheduler;
+
+/** \brief Bone influences of the vertices of a skinned mesh, built once from the deform weights.
+ * The influences of a vertex are stored contiguously with normalized weights so that skinning
+ * is a blend of the group matrices applied to the position and the normal. The blend is
+ * vectorized with SSE2 and processed in chunks of vertices on the task scheduler.
+ */
+class BL_SkinInfluences
+{
+public:
+	/// Skinning matrix of a deform group, column major as Blender matrices.
+	struct Matrix
+	{
+		float m_data[4][4];
+	};
+
+private:
+	/// First influence of each vertex, the last value is the total number of influences.
+	std::vector<unsigned int> m_offsets;
+	/// Deform group index and normalized weight of each influence.
+	std::vector<unsigned short> m_groups;
+	std::vector<float> m_weights;
+	/// Deform groups used by the influences.
+	std::vector<bool> m_deformGroups;
+
+public:
+	/** Build the influences of all the vertices of a mesh.
+	 * \param mesh The mesh owning the deform weights.
+	 * \param deformGroups True for every deform group moved by a bone, the others are ignored.
+	 */
+	BL_SkinInfluences(const Mesh *mesh, const std::vector<bool>& deformGroups);
+
+	unsigned int GetNumVertices() const;
+	unsigned int GetNumInfluences() const;
+	const std::vector<bool>& GetDeformGroups() const;
+
+	/** Skin a range of vertices in place.
+	 * \param matrices The skinning matrix of each deform group.
+	 * Vertices without influence are left unchanged.
+	 */
+	void DeformRange(const std::vector<Matrix>& matrices, std::array<float, 3> *positions,
+					 std::array<float, 3> *normals, unsigned int begin, unsigned int end) const;
+
+	/** Skin all the vertices in place, in parallel for large meshes.
+	 * \param scheduler The task scheduler, nullptr to skin on the calling thread only.
+	 */
+	void Deform(const std::vector<Matrix>& matrices, std::array<float, 3> *positions,
+				std::array<float, 3> *normals, TaskScheduler *scheduler) const;
+};
+
+#endif  // __BL_SKININFLUENCES_H__
@@ -46,6 +46,7 @@ public:
 	virtual EXP_Value *GetReplica();
 #ifdef WITH_PYTHON
 	virtual PyObject *ConvertValueToPython();
+	virtual bool SetValueFromPython(PyObject *pyobj);
 #endif
 
 private:
@@ -41,6 +41,7 @@ public:
 	virtual EXP_Value *CalcFinal(VALUE_DATA_TYPE dtype, VALUE_OPERATOR op, EXP_Value *val);
 #ifdef WITH_PYTHON
 	virtual PyObject *ConvertValueToPython();
+	virtual bool SetValueFromPython(PyObject *pyobj);
 #endif
 
 protected:
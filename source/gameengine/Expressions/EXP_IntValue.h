@@ -47,6 +47,7 @@ public:
 
 #ifdef WITH_PYTHON
 	virtual PyObject *ConvertValueToPython();
+	virtual bool SetValueFromPython(PyObject *pyobj);
 #endif
 
 private:
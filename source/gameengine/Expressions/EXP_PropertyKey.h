@@ -0,0 +1,82 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_PropertyKey.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_PROPERTYKEY_H__
+#define __EXP_PROPERTYKEY_H__
+
+#include <string>
+
+/** \brief Interned name of a property.
+ * Every distinct name is stored once for the whole engine, two keys of the same
+ * name point to the same string and are compared without comparing characters.
+ * Interning is thread safe, the interned names are never freed.
+ */
+class EXP_PropertyKey
+{
+private:
+	/// The interned name, nullptr for an invalid key.
+	const std::string *m_name;
+
+	explicit EXP_PropertyKey(const std::string *name)
+		:m_name(name)
+	{
+	}
+
+public:
+	/// Construct an invalid key.
+	EXP_PropertyKey()
+		:m_name(nullptr)
+	{
+	}
+
+	/// Construct the key of a name, interning the name if needed.
+	explicit EXP_PropertyKey(const std::string& name);
+
+	/// Get the key of a name only if the name was already interned, return an invalid key otherwise.
+	static EXP_PropertyKey Find(const std::string& name);
+
+	inline bool IsValid() const
+	{
+		return m_name != nullptr;
+	}
+
+	inline const std::string& GetName() const
+	{
+		return *m_name;
+	}
+
+	inline bool operator==(const EXP_PropertyKey& other) const
+	{
+		return m_name == other.m_name;
+	}
+
+	inline bool operator!=(const EXP_PropertyKey& other) const
+	{
+		return m_name != other.m_name;
+	}
+};
+
+#endif  // __EXP_PROPERTYKEY_H__
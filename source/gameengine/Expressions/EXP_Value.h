@@ -24,8 +24,9 @@
 #endif
 
 #include "CM_RefCount.h"
+#include "EXP_PropertyKey.h"
 
-#include <map> // Array functionality for the property list.
+#include <map>
 #include <vector>
 #include <string> // std::string class.
 
@@ -112,6 +113,10 @@ public:
 	}
 
 	virtual EXP_Value *ConvertPythonToValue(PyObject *pyobj, const bool do_type_exception, const char *error_prefix);
+	/** Set the value from a python object of the same type without allocating a temporary value,
+	 * return false if the value can't be set this way.
+	 */
+	virtual bool SetValueFromPython(PyObject *pyobj);
 
 	static PyObject *pyattr_get_name(EXP_PyObjectPlus *self, const EXP_PYATTRIBUTE_DEF *attrdef);
 
@@ -126,11 +131,18 @@ public:
 	/// Set property <ioProperty>, overwrites and releases a previous property with the same name if needed.
 	virtual void SetProperty(const std::string& name, EXP_Value *ioProperty);
 	virtual EXP_Value *GetProperty(const std::string & inName);
+	void SetProperty(const EXP_PropertyKey& key, EXP_Value *ioProperty);
+	EXP_Value *GetProperty(const EXP_PropertyKey& key);
+	/** Get a property, slot is a hint of the property index updated by the function.
+	 * Used by the logic bricks referencing a property of a constant name.
+	 */
+	EXP_Value *GetProperty(const EXP_PropertyKey& key, unsigned int& slot);
 	/// Get text description of property with name <inName>, returns an empty string if there is no property named <inName>.
 	const std::string GetPropertyText(const std::string & inName);
 	float GetPropertyNumber(const std::string& inName, float defnumber);
 	/// Remove the property named <inName>, returns true if the property was succesfully removed, false if property was not found or could not be removed.
 	virtual bool RemoveProperty(const std::string& inName);
+	bool RemoveProperty(const EXP_PropertyKey& key);
 	virtual std::vector<std::string>    GetPropertyNames();
 	/// Clear all properties.
 	virtual void ClearProperties();
@@ -166,8 +178,18 @@ protected:
 	virtual void DestructFromPython();
 
 private:
-	/// Properties for user/game etc.
-	std::map<std::string, EXP_Value *> m_properties;
+	struct Property
+	{
+		EXP_PropertyKey m_key;
+		EXP_Value *m_value;
+	};
+
+	/** Properties for user/game etc, sorted by name.
+	 * Objects have few properties, a linear search over the keys is faster than a tree of strings.
+	 */
+	std::vector<Property> m_properties;
+
+	int FindProperty(const EXP_PropertyKey& key) const;
 };
 
 /** EXP_PropValue is a EXP_Value derived class, that implements the identification (String name)
@@ -167,4 +167,14 @@ PyObject *EXP_BoolValue::ConvertValueToPython()
 {
 	return PyBool_FromLong(m_bool != 0);
 }
+
+bool EXP_BoolValue::SetValueFromPython(PyObject *pyobj)
+{
+	if (!PyBool_Check(pyobj)) {
+		return false;
+	}
+
+	m_bool = (pyobj == Py_True);
+	return true;
+}
 #endif  // WITH_PYTHON
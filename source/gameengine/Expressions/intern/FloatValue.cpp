@@ -332,4 +332,20 @@ PyObject *EXP_FloatValue::ConvertValueToPython()
 {
 	return PyFloat_FromDouble(m_float);
 }
+
+bool EXP_FloatValue::SetValueFromPython(PyObject *pyobj)
+{
+	if (!PyFloat_Check(pyobj)) {
+		return false;
+	}
+
+	// Let the overflow be reported by the generic conversion.
+	const double tval = PyFloat_AsDouble(pyobj);
+	if (tval > (double)FLT_MAX || tval < (double)-FLT_MAX) {
+		return false;
+	}
+
+	m_float = (float)tval;
+	return true;
+}
 #endif  // WITH_PYTHON
@@ -333,4 +333,15 @@ PyObject *EXP_IntValue::ConvertValueToPython()
 {
 	return PyLong_FromLongLong(m_int);
 }
+
+bool EXP_IntValue::SetValueFromPython(PyObject *pyobj)
+{
+	// Booleans are python integers too.
+	if (!PyLong_Check(pyobj) || PyBool_Check(pyobj)) {
+		return false;
+	}
+
+	m_int = (cInt)PyLong_AsLongLong(pyobj);
+	return true;
+}
 #endif  // WITH_PYTHON
@@ -0,0 +1,54 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/intern/PropertyKey.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_PropertyKey.h"
+
+#include "CM_Thread.h"
+
+#include <unordered_set>
+
+/* The elements of an unordered set are not moved when the set grows,
+ * the keys can point to them. Properties are created by the conversion
+ * of asynchronously loaded libraries, the set is protected by a lock. */
+static std::unordered_set<std::string> internedNames;
+static CM_ThreadSpinLock internedNamesLock;
+
+EXP_PropertyKey::EXP_PropertyKey(const std::string& name)
+{
+	internedNamesLock.Lock();
+	m_name = &*internedNames.insert(name).first;
+	internedNamesLock.Unlock();
+}
+
+EXP_PropertyKey EXP_PropertyKey::Find(const std::string& name)
+{
+	internedNamesLock.Lock();
+	std::unordered_set<std::string>::const_iterator it = internedNames.find(name);
+	const std::string *interned = (it != internedNames.end()) ? &*it : nullptr;
+	internedNamesLock.Unlock();
+
+	return EXP_PropertyKey(interned);
+}
@@ -144,8 +144,23 @@ std::string EXP_Value::op2str(VALUE_OPERATOR op)
 //	Property Management
 //---------------------------------------------------------------------------------------------------------------------
 
+int EXP_Value::FindProperty(const EXP_PropertyKey& key) const
+{
+	for (unsigned int i = 0, size = m_properties.size(); i < size; ++i) {
+		if (m_properties[i].m_key == key) {
+			return i;
+		}
+	}
+	return -1;
+}
+
 /// Set property <ioProperty>, overwrites and releases a previous property with the same name if needed.
 void EXP_Value::SetProperty(const std::string & name, EXP_Value *ioProperty)
+{
+	SetProperty(EXP_PropertyKey(name), ioProperty);
+}
+
+void EXP_Value::SetProperty(const EXP_PropertyKey& key, EXP_Value *ioProperty)
 {
 	// Check if somebody is setting an empty property.
 	if (ioProperty == nullptr) {
@@ -154,23 +169,53 @@ void EXP_Value::SetProperty(const std::string & name, EXP_Value *ioProperty)
 	}
 
 	// Try to replace property (if so -> exit as soon as we replaced it).
-	EXP_Value *oldval = m_properties[name];
-	if (oldval) {
-		oldval->Release();
+	const int index = FindProperty(key);
+	if (index != -1) {
+		Property& prop = m_properties[index];
+		prop.m_value->Release();
+		prop.m_value = ioProperty->AddRef();
+		return;
 	}
 
-	// Add property at end of array.
-	m_properties[name] = ioProperty->AddRef();
+	// Insert the property sorted by name.
+	std::vector<Property>::iterator it = m_properties.begin();
+	while (it != m_properties.end() && it->m_key.GetName() < key.GetName()) {
+		++it;
+	}
+	m_properties.insert(it, {key, ioProperty->AddRef()});
 }
 
 /// Get pointer to a property with name <inName>, returns nullptr if there is no property named <inName>.
 EXP_Value *EXP_Value::GetProperty(const std::string & inName)
 {
-	std::map<std::string, EXP_Value *>::iterator it = m_properties.find(inName);
-	if (it != m_properties.end()) {
-		return it->second;
+	// A name never interned can't be the name of a property.
+	const EXP_PropertyKey key = EXP_PropertyKey::Find(inName);
+	if (!key.IsValid()) {
+		return nullptr;
 	}
-	return nullptr;
+
+	return GetProperty(key);
+}
+
+EXP_Value *EXP_Value::GetProperty(const EXP_PropertyKey& key)
+{
+	const int index = FindProperty(key);
+	return (index != -1) ? m_properties[index].m_value : nullptr;
+}
+
+EXP_Value *EXP_Value::GetProperty(const EXP_PropertyKey& key, unsigned int& slot)
+{
+	if (slot < m_properties.size() && m_properties[slot].m_key == key) {
+		return m_properties[slot].m_value;
+	}
+
+	const int index = FindProperty(key);
+	if (index == -1) {
+		return nullptr;
+	}
+
+	slot = index;
+	return m_properties[index].m_value;
 }
 
 /// Get text description of property with name <inName>, returns an empty string if there is no property named <inName>.
@@ -199,10 +244,20 @@ float EXP_Value::GetPropertyNumber(const std::string& inName, float defnumber)
 /// Remove the property named <inName>, returns true if the property was succesfully removed, false if property was not found or could not be removed.
 bool EXP_Value::RemoveProperty(const std::string& inName)
 {
-	std::map<std::string, EXP_Value *>::iterator it = m_properties.find(inName);
-	if (it != m_properties.end()) {
-		(*it).second->Release();
-		m_properties.erase(it);
+	const EXP_PropertyKey key = EXP_PropertyKey::Find(inName);
+	if (!key.IsValid()) {
+		return false;
+	}
+
+	return RemoveProperty(key);
+}
+
+bool EXP_Value::RemoveProperty(const EXP_PropertyKey& key)
+{
+	const int index = FindProperty(key);
+	if (index != -1) {
+		m_properties[index].m_value->Release();
+		m_properties.erase(m_properties.begin() + index);
 		return true;
 	}
 
@@ -215,9 +270,8 @@ std::vector<std::string> EXP_Value::GetPropertyNames()
 	const unsigned short size = m_properties.size();
 	std::vector<std::string> result(size);
 
-	unsigned short i = 0;
-	for (const auto& pair : m_properties) {
-		result[i++] = pair.first;
+	for (unsigned short i = 0; i < size; ++i) {
+		result[i] = m_properties[i].m_key.GetName();
 	}
 	return result;
 }
@@ -226,8 +280,8 @@ std::vector<std::string> EXP_Value::GetPropertyNames()
 void EXP_Value::ClearProperties()
 {
 	// Remove all properties.
-	for (const auto& pair : m_properties) {
-		pair.second->Release();
+	for (const Property& prop : m_properties) {
+		prop.m_value->Release();
 	}
 	m_properties.clear();
 }
@@ -235,13 +289,10 @@ void EXP_Value::ClearProperties()
 /// Get property number <inIndex>.
 EXP_Value *EXP_Value::GetProperty(int inIndex)
 {
-	int count = 0;
-	for (const auto& pair : m_properties) {
-		if (count++ == inIndex) {
-			return pair.second;
-		}
+	if (inIndex < 0 || inIndex >= (int)m_properties.size()) {
+		return nullptr;
 	}
-	return nullptr;
+	return m_properties[inIndex].m_value;
 }
 
 /// Get the amount of properties assiocated with this value.
@@ -264,8 +315,8 @@ void EXP_Value::ProcessReplica()
 	EXP_PyObjectPlus::ProcessReplica();
 
 	// Copy all props.
-	for (auto& pair : m_properties) {
-		pair.second = pair.second->GetReplica();
+	for (Property& prop : m_properties) {
+		prop.m_value = prop.m_value->GetReplica();
 	}
 }
 
@@ -359,13 +410,18 @@ EXP_Value *EXP_Value::ConvertPythonToValue(PyObject *pyobj, const bool do_type_e
 
 }
 
+bool EXP_Value::SetValueFromPython(PyObject *pyobj)
+{
+	return false;
+}
+
 PyObject *EXP_Value::ConvertKeysToPython(void)
 {
 	PyObject *pylist = PyList_New(m_properties.size());
 
 	Py_ssize_t i = 0;
-	for (const auto& pair : m_properties) {
-		PyList_SET_ITEM(pylist, i++, PyUnicode_FromStdString(pair.first));
+	for (const Property& prop : m_properties) {
+		PyList_SET_ITEM(pylist, i++, PyUnicode_FromStdString(prop.m_key.GetName()));
 	}
 
 	return pylist;
@@ -160,6 +160,7 @@ int SCA_ILogicBrick::CheckProperty(EXP_PyObjectPlus *self, const PyAttributeDef
 		PyErr_SetString(PyExc_ValueError, "string does not correspond to a property");
 		return 1;
 	}
+	brick->UpdatePropertyKey();
 	return 0;
 }
 
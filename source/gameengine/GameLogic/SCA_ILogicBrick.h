@@ -119,6 +119,9 @@ public:
 	virtual void SetLogicManager(SCA_LogicManager *logicmgr);
 	SCA_LogicManager *GetLogicManager();
 
+	/// Update the cached key of the property used by the brick after its name changed.
+	virtual void UpdatePropertyKey() {}
+
 	/* for moving logic bricks between scenes */
 	virtual void		Replace_IScene(SCA_IScene *val) {}
 	virtual void		Replace_NetworkScene(KX_NetworkMessageScene *val) {}
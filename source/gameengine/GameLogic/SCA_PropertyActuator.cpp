@@ -48,6 +48,8 @@ SCA_PropertyActuator::SCA_PropertyActuator(SCA_IObject* gameobj,SCA_IObject* sou
    :	SCA_IActuator(gameobj, KX_ACT_PROPERTY),
 	m_type(acttype),
 	m_propname(propname),
+	m_propkey(propname),
+	m_propslot(0),
 	m_exprtxt(expr),
 	m_sourceObj(sourceObj)
 {
@@ -63,6 +65,12 @@ SCA_PropertyActuator::~SCA_PropertyActuator()
 		m_sourceObj->UnregisterActuator(this);
 }
 
+void SCA_PropertyActuator::UpdatePropertyKey()
+{
+	m_propkey = EXP_PropertyKey(m_propname);
+	m_propslot = 0;
+}
+
 bool SCA_PropertyActuator::Update()
 {
 	bool result = false;
@@ -76,7 +84,7 @@ bool SCA_PropertyActuator::Update()
 		if (m_type==KX_ACT_PROP_LEVEL)
 		{
 			EXP_Value* newval = new EXP_BoolValue(false);
-			EXP_Value* oldprop = propowner->GetProperty(m_propname);
+			EXP_Value* oldprop = propowner->GetProperty(m_propkey, m_propslot);
 			if (oldprop)
 			{
 				oldprop->SetValue(newval);
@@ -96,7 +104,7 @@ bool SCA_PropertyActuator::Update()
 	{
 		/* don't use */
 		EXP_Value* newval;
-		EXP_Value* oldprop = propowner->GetProperty(m_propname);
+		EXP_Value* oldprop = propowner->GetProperty(m_propkey, m_propslot);
 		if (oldprop)
 		{
 			newval = new EXP_BoolValue((oldprop->GetNumber()==0.0) ? true:false);
@@ -104,20 +112,20 @@ bool SCA_PropertyActuator::Update()
 		} else
 		{	/* as not been assigned, evaluate as false, so assign true */
 			newval = new EXP_BoolValue(true);
-			propowner->SetProperty(m_propname,newval);
+			propowner->SetProperty(m_propkey,newval);
 		}
 		newval->Release();
 	}
 	else if (m_type==KX_ACT_PROP_LEVEL)
 	{
 		EXP_Value* newval = new EXP_BoolValue(true);
-		EXP_Value* oldprop = propowner->GetProperty(m_propname);
+		EXP_Value* oldprop = propowner->GetProperty(m_propkey, m_propslot);
 		if (oldprop)
 		{
 			oldprop->SetValue(newval);
 		} else
 		{
-			propowner->SetProperty(m_propname,newval);
+			propowner->SetProperty(m_propkey,newval);
 		}
 		newval->Release();
 	}
@@ -129,20 +137,20 @@ bool SCA_PropertyActuator::Update()
 			{
 				
 				EXP_Value* newval = userexpr->Calculate();
-				EXP_Value* oldprop = propowner->GetProperty(m_propname);
+				EXP_Value* oldprop = propowner->GetProperty(m_propkey, m_propslot);
 				if (oldprop)
 				{
 					oldprop->SetValue(newval);
 				} else
 				{
-					propowner->SetProperty(m_propname,newval);
+					propowner->SetProperty(m_propkey,newval);
 				}
 				newval->Release();
 				break;
 			}
 		case KX_ACT_PROP_ADD:
 			{
-				EXP_Value* oldprop = propowner->GetProperty(m_propname);
+				EXP_Value* oldprop = propowner->GetProperty(m_propkey, m_propslot);
 				if (oldprop)
 				{
 					// int waarde = (int)oldprop->GetNumber();  /*unused*/
@@ -167,7 +175,7 @@ bool SCA_PropertyActuator::Update()
 					{
 						EXP_Value *val = copyprop->GetReplica();
 						GetParent()->SetProperty(
-							 m_propname,
+							 m_propkey,
 							 val);
 						val->Release();
 
@@ -50,6 +50,9 @@ class SCA_PropertyActuator : public SCA_IActuator
 
 	int			m_type;
 	std::string	m_propname;
+	/// Key and slot hint of the property in the owner.
+	EXP_PropertyKey m_propkey;
+	unsigned int m_propslot;
 	std::string	m_exprtxt;
 	SCA_IObject* m_sourceObj; // for copy property actuator
 
@@ -78,6 +81,8 @@ public:
 	virtual bool 
 	Update();
 
+	virtual void UpdatePropertyKey();
+
 	/* --------------------------------------------------------------------- */
 	/* Python interface ---------------------------------------------------- */
 	/* --------------------------------------------------------------------- */
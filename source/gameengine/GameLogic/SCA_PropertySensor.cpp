@@ -60,16 +60,42 @@ SCA_PropertySensor::SCA_PropertySensor(SCA_EventManager* eventmgr,
 	//pars.SetContext(this->AddRef());
 	//EXP_Value* resultval = m_rightexpr->Calculate();
 
-	EXP_Value* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-	if (!orgprop->IsError())
+	UpdatePropertyKey();
+
+	EXP_Value* orgprop = FindCheckProperty();
+	if (orgprop)
 	{
 		m_previoustext = orgprop->GetText();
 	}
-	orgprop->Release();
 
 	Init();
 }
 
+void SCA_PropertySensor::UpdatePropertyKey()
+{
+	// Names of sub properties are resolved by FindIdentifier.
+	if (m_checkpropname.find('.') == std::string::npos) {
+		m_checkpropkey = EXP_PropertyKey(m_checkpropname);
+	}
+	else {
+		m_checkpropkey = EXP_PropertyKey();
+	}
+	m_checkpropslot = 0;
+}
+
+EXP_Value *SCA_PropertySensor::FindCheckProperty()
+{
+	if (m_checkpropkey.IsValid()) {
+		return GetParent()->GetProperty(m_checkpropkey, m_checkpropslot);
+	}
+
+	// The sub property is owned by its property, it stays valid once released.
+	EXP_Value *prop = GetParent()->FindIdentifier(m_checkpropname);
+	const bool error = prop->IsError();
+	prop->Release();
+	return error ? nullptr : prop;
+}
+
 void SCA_PropertySensor::Init()
 {
 	m_recentresult = false;
@@ -133,8 +159,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		ATTR_FALLTHROUGH;
 	case KX_PROPSENSOR_EQUAL:
 		{
-			EXP_Value* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			EXP_Value* orgprop = FindCheckProperty();
+			if (orgprop)
 			{
 				const std::string& testprop = orgprop->GetText();
 				// Force strings to upper case, to avoid confusion in
@@ -156,7 +182,6 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 				}
 				/* end patch */
 			}
-			orgprop->Release();
 
 			if (reverse)
 				result = !result;
@@ -170,8 +195,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		}
 	case KX_PROPSENSOR_INTERVAL:
 		{
-			EXP_Value* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			EXP_Value* orgprop = FindCheckProperty();
+			if (orgprop)
 			{
 				float min;
 				float max;
@@ -188,15 +213,14 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 
 				result = (min <= val) && (val <= max);
 			}
-			orgprop->Release();
 
 		break;
 		}
 	case KX_PROPSENSOR_CHANGED:
 		{
-			EXP_Value* orgprop = GetParent()->FindIdentifier(m_checkpropname);
+			EXP_Value* orgprop = FindCheckProperty();
 				
-			if (!orgprop->IsError())
+			if (orgprop)
 			{
 				if (m_previoustext != orgprop->GetText())
 				{
@@ -204,7 +228,6 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 					result = true;
 				}
 			}
-			orgprop->Release();
 
 			break;
 		}
@@ -213,8 +236,8 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 		ATTR_FALLTHROUGH;
 	case KX_PROPSENSOR_GREATERTHAN:
 		{
-			EXP_Value* orgprop = GetParent()->FindIdentifier(m_checkpropname);
-			if (!orgprop->IsError())
+			EXP_Value* orgprop = FindCheckProperty();
+			if (orgprop)
 			{
 				float ref;
 				CM_StringTo(m_checkpropval, ref);
@@ -235,7 +258,6 @@ bool	SCA_PropertySensor::CheckPropertyCondition()
 				}
 
 			}
-			orgprop->Release();
 
 			break;
 		}
@@ -43,10 +43,16 @@ class SCA_PropertySensor : public SCA_ISensor
 	std::string		m_checkpropval;
 	std::string		m_checkpropmaxval;
 	std::string		m_checkpropname;
+	/// Key of the checked property, invalid for the names of sub properties.
+	EXP_PropertyKey	m_checkpropkey;
+	unsigned int	m_checkpropslot;
 	std::string		m_previoustext;
 	bool			m_lastresult;
 	bool			m_recentresult;
 
+	/// Get the checked property, nullptr if it doesn't exist.
+	EXP_Value *FindCheckProperty();
+
  protected:
 
 public:
@@ -79,6 +85,7 @@ public:
 	virtual bool Evaluate();
 	virtual bool	IsPositiveTrigger();
 	virtual EXP_Value*		FindIdentifier(const std::string& identifiername);
+	virtual void UpdatePropertyKey();
 
 #ifdef WITH_PYTHON
 
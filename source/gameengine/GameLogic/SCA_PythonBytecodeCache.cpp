@@ -0,0 +1,332 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/GameLogic/SCA_PythonBytecodeCache.cpp
+ *  \ingroup gamelogic
+ */
+
+#ifdef WITH_PYTHON
+
+#include "SCA_PythonBytecodeCache.h"
+
+#include "CM_Message.h"
+
+extern "C" {
+#  include "BLI_hash_md5.h"
+#  include "BLI_fileops.h"
+
+#  include "marshal.h"
+}
+
+#include <cstring>
+
+/// Identifier at the start of a cache file.
+#define SCA_BYTECODE_CACHE_MAGIC "BGEPYC02"
+/// Number of game starts after which an unused entry is removed from the cache file.
+#define SCA_BYTECODE_CACHE_MAX_AGE 8
+
+std::map<SCA_PythonBytecodeCache::Key, SCA_PythonBytecodeCache::Entry> SCA_PythonBytecodeCache::m_entries;
+bool SCA_PythonBytecodeCache::m_modified = false;
+
+SCA_PythonBytecodeCache::Key SCA_PythonBytecodeCache::GetKey(const std::string& text, const std::string& name)
+{
+	// The name is part of the key because it is stored in the code object.
+	std::string buffer;
+	buffer.reserve(name.size() + text.size() + 1);
+	buffer.append(name);
+	buffer.push_back('\0');
+	buffer.append(text);
+
+	Key key;
+	BLI_hash_md5_buffer(buffer.data(), buffer.size(), key.data());
+	return key;
+}
+
+PyObject *SCA_PythonBytecodeCache::GetCode(Entry& entry)
+{
+	if (!entry.m_code) {
+		entry.m_code = PyMarshal_ReadObjectFromString(entry.m_data.data(), entry.m_data.size());
+		if (!entry.m_code || !PyCode_Check(entry.m_code)) {
+			Py_XDECREF(entry.m_code);
+			entry.m_code = nullptr;
+			PyErr_Clear();
+			return nullptr;
+		}
+	}
+
+	entry.m_used = true;
+	Py_INCREF(entry.m_code);
+	return entry.m_code;
+}
+
+PyObject *SCA_PythonBytecodeCache::Find(const std::string& text, const std::string& name)
+{
+	std::map<Key, Entry>::iterator it = m_entries.find(GetKey(text, name));
+	if (it == m_entries.end()) {
+		return nullptr;
+	}
+
+	PyObject *code = GetCode(it->second);
+	if (!code) {
+		// Invalid marshalled data, the script will be compiled again.
+		m_entries.erase(it);
+		m_modified = true;
+	}
+
+	return code;
+}
+
+PyObject *SCA_PythonBytecodeCache::Compile(const std::string& text, const std::string& name)
+{
+	PyObject *code = Find(text, name);
+	if (code) {
+		return code;
+	}
+
+	code = Py_CompileString(text.c_str(), name.c_str(), Py_file_input);
+	if (code) {
+		Add(text, name, code);
+	}
+
+	return code;
+}
+
+void SCA_PythonBytecodeCache::Add(const std::string& text, const std::string& name, PyObject *code)
+{
+	Entry& entry = m_entries[GetKey(text, name)];
+	if (entry.m_code == code) {
+		entry.m_used = true;
+		return;
+	}
+
+	Py_INCREF(code);
+	Py_XDECREF(entry.m_code);
+	entry.m_code = code;
+	entry.m_data.clear();
+	entry.m_age = 0;
+	entry.m_used = true;
+
+	m_modified = true;
+}
+
+/// Read a value from a buffer, false if the buffer is too short.
+template <class Type>
+static bool sca_bytecode_read(const char *&data, const char *end, Type *value, size_t size = sizeof(Type))
+{
+	if ((size_t)(end - data) < size) {
+		return false;
+	}
+	memcpy(value, data, size);
+	data += size;
+	return true;
+}
+
+bool SCA_PythonBytecodeCache::LoadData(const char *data, size_t size)
+{
+	const char *end = data + size;
+
+	char magic[sizeof(SCA_BYTECODE_CACHE_MAGIC) - 1];
+	long pythonMagic;
+	unsigned int count;
+	if (!sca_bytecode_read(data, end, magic, sizeof(magic)) || memcmp(magic, SCA_BYTECODE_CACHE_MAGIC, sizeof(magic)) != 0 ||
+	    !sca_bytecode_read(data, end, &pythonMagic) || !sca_bytecode_read(data, end, &count))
+	{
+		return false;
+	}
+
+	// The marshal format and the bytecode change with the Python version.
+	if (pythonMagic != PyImport_GetMagicNumber()) {
+		return false;
+	}
+
+	// The entries are read aside to not keep a part of a corrupted cache.
+	std::map<Key, Entry> entries;
+	bool dropped = false;
+	for (unsigned int i = 0; i < count; ++i) {
+		Key key;
+		unsigned short age;
+		Key checksum;
+		unsigned int dataSize;
+		if (!sca_bytecode_read(data, end, key.data(), key.size()) || !sca_bytecode_read(data, end, &age) ||
+		    !sca_bytecode_read(data, end, checksum.data(), checksum.size()) ||
+		    !sca_bytecode_read(data, end, &dataSize) || (size_t)(end - data) < dataSize)
+		{
+			return false;
+		}
+
+		// A damaged entry is dropped alone, its script is compiled again.
+		Key dataChecksum;
+		BLI_hash_md5_buffer(data, dataSize, dataChecksum.data());
+		if (dataChecksum != checksum) {
+			data += dataSize;
+			dropped = true;
+			continue;
+		}
+
+		Entry& entry = entries[key];
+		entry.m_code = nullptr;
+		entry.m_data.assign(data, dataSize);
+		entry.m_age = age;
+		entry.m_used = false;
+
+		data += dataSize;
+	}
+
+	if (data != end) {
+		return false;
+	}
+
+	for (auto& pair : entries) {
+		// Keep the entries compiled in this session.
+		m_entries.emplace(pair.first, std::move(pair.second));
+	}
+
+	// Save the cache again without the dropped entries.
+	if (dropped) {
+		m_modified = true;
+	}
+
+	return true;
+}
+
+void SCA_PythonBytecodeCache::GetData(std::string& data)
+{
+	for (std::map<Key, Entry>::iterator it = m_entries.begin(); it != m_entries.end();) {
+		Entry& entry = it->second;
+		if (!entry.m_used && (entry.m_age + 1) > SCA_BYTECODE_CACHE_MAX_AGE) {
+			Py_XDECREF(entry.m_code);
+			it = m_entries.erase(it);
+			continue;
+		}
+
+		if (entry.m_data.empty()) {
+			PyObject *code = PyMarshal_WriteObjectToString(entry.m_code, Py_MARSHAL_VERSION);
+			if (!code) {
+				PyErr_Clear();
+				Py_XDECREF(entry.m_code);
+				it = m_entries.erase(it);
+				continue;
+			}
+			entry.m_data.assign(PyBytes_AS_STRING(code), PyBytes_GET_SIZE(code));
+			Py_DECREF(code);
+		}
+
+		++it;
+	}
+
+	const long pythonMagic = PyImport_GetMagicNumber();
+	const unsigned int count = m_entries.size();
+
+	data.assign(SCA_BYTECODE_CACHE_MAGIC, sizeof(SCA_BYTECODE_CACHE_MAGIC) - 1);
+	data.append((const char *)&pythonMagic, sizeof(pythonMagic));
+	data.append((const char *)&count, sizeof(count));
+
+	for (const auto& pair : m_entries) {
+		const Entry& entry = pair.second;
+		const unsigned short age = entry.m_used ? 0 : entry.m_age + 1;
+		const unsigned int size = entry.m_data.size();
+		Key checksum;
+		BLI_hash_md5_buffer(entry.m_data.data(), size, checksum.data());
+		data.append((const char *)pair.first.data(), pair.first.size());
+		data.append((const char *)&age, sizeof(age));
+		data.append((const char *)checksum.data(), checksum.size());
+		data.append((const char *)&size, sizeof(size));
+		data.append(entry.m_data);
+	}
+}
+
+bool SCA_PythonBytecodeCache::IsModified()
+{
+	return m_modified;
+}
+
+bool SCA_PythonBytecodeCache::Load(const std::string& path)
+{
+	FILE *fp = BLI_fopen(path.c_str(), "rb");
+	if (!fp) {
+		return false;
+	}
+
+	// The sizes in the file are checked against the file size, never trusted.
+	long size = -1;
+	if (fseek(fp, 0, SEEK_END) == 0) {
+		size = ftell(fp);
+	}
+	if (size < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+		fclose(fp);
+		return false;
+	}
+
+	std::string data(size, '\0');
+	const bool success = (size == 0 || fread(&data[0], size, 1, fp) == 1);
+	fclose(fp);
+
+	if (!success) {
+		return false;
+	}
+
+	return LoadData(data.data(), data.size());
+}
+
+bool SCA_PythonBytecodeCache::Save(const std::string& path)
+{
+	if (!m_modified) {
+		return true;
+	}
+
+	std::string data;
+	GetData(data);
+
+	// Write to a temporary file to never leave a partial cache.
+	const std::string tmpPath = path + "@";
+	FILE *fp = BLI_fopen(tmpPath.c_str(), "wb");
+	if (!fp) {
+		return false;
+	}
+
+	bool success = (fwrite(data.data(), data.size(), 1, fp) == 1);
+
+	if (fclose(fp) != 0) {
+		success = false;
+	}
+
+	if (!success || BLI_rename(tmpPath.c_str(), path.c_str()) != 0) {
+		BLI_delete(tmpPath.c_str(), false, false);
+		return false;
+	}
+
+	m_modified = false;
+
+	return true;
+}
+
+void SCA_PythonBytecodeCache::Clear()
+{
+	for (auto& pair : m_entries) {
+		Py_XDECREF(pair.second.m_code);
+	}
+
+	m_entries.clear();
+	m_modified = false;
+}
+
+#endif  // WITH_PYTHON
@@ -0,0 +1,119 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file SCA_PythonBytecodeCache.h
+ *  \ingroup gamelogic
+ *  \brief Share and store the bytecode of compiled Python scripts.
+ */
+
+#ifndef __SCA_PYTHON_BYTECODE_CACHE_H__
+#define __SCA_PYTHON_BYTECODE_CACHE_H__
+
+#ifdef WITH_PYTHON
+
+#include "EXP_Python.h"
+
+#include <string>
+#include <array>
+#include <map>
+
+/** \brief Cache of the code objects compiled from a script text and its name.
+ * The code objects are shared by all the users of the same script, as the replicated
+ * controllers. The cache can be loaded from and saved to a file of marshalled code
+ * objects, or to data packed in the blend file, to avoid compiling the scripts again
+ * at the next game start.
+ * The cache must be cleared before Python is finalized.
+ */
+class SCA_PythonBytecodeCache
+{
+public:
+	/// MD5 of the script name and text.
+	using Key = std::array<unsigned char, 16>;
+
+private:
+	struct Entry
+	{
+		/// The code object, nullptr while the marshalled data loaded from a file is not used.
+		PyObject *m_code;
+		/// The marshalled code object, computed when the cache is saved.
+		std::string m_data;
+		/// Number of game starts since the last use of the entry.
+		unsigned short m_age;
+		/// The entry was used since the cache was loaded.
+		bool m_used;
+	};
+
+	static std::map<Key, Entry> m_entries;
+	/// Entries were added or removed since the cache was loaded.
+	static bool m_modified;
+
+	/// Return the code object of an entry, unmarshalling it if needed.
+	static PyObject *GetCode(Entry& entry);
+
+public:
+	static Key GetKey(const std::string& text, const std::string& name);
+
+	/** Find the code object of a script.
+	 * \return A new reference to the code object or nullptr if the script was never compiled.
+	 */
+	static PyObject *Find(const std::string& text, const std::string& name);
+
+	/** Compile a script or reuse the code object of the same script.
+	 * \return A new reference to the code object or nullptr with a Python error set.
+	 */
+	static PyObject *Compile(const std::string& text, const std::string& name);
+
+	/// Register a code object compiled outside of the cache.
+	static void Add(const std::string& text, const std::string& name, PyObject *code);
+
+	/** Load the entries from the content of a cache file or packed data.
+	 * The entries are added only if the whole data is valid, an entry whose
+	 * marshalled code doesn't match its checksum is dropped.
+	 * \return false if the data is invalid or from another Python version.
+	 */
+	static bool LoadData(const char *data, size_t size);
+
+	/** Serialize all the entries recently used, the content of a cache file.
+	 * The entries unused since too many game starts are removed.
+	 */
+	static void GetData(std::string& data);
+
+	/// Return true if entries were added or removed since the cache was loaded or saved.
+	static bool IsModified();
+
+	/** Load the entries of a cache file, invalid files are ignored.
+	 * \return false if the file can't be read or is invalid.
+	 */
+	static bool Load(const std::string& path);
+
+	/** Save all the entries recently used, only if the entries changed.
+	 * \return false if the file can't be written.
+	 */
+	static bool Save(const std::string& path);
+
+	/// Release all the code objects.
+	static void Clear();
+};
+
+#endif  // WITH_PYTHON
+
+#endif  // __SCA_PYTHON_BYTECODE_CACHE_H__
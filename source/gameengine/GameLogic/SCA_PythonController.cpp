@@ -33,6 +33,7 @@
  */
 
 #include "SCA_PythonController.h"
+#include "SCA_PythonBytecodeCache.h"
 #include "SCA_LogicManager.h"
 #include "SCA_ISensor.h"
 #include "SCA_IActuator.h"
@@ -246,8 +247,8 @@ bool SCA_PythonController::Compile()
 		m_bytecode=nullptr;
 	}
 
-	// recompile the scripttext into bytecode
-	m_bytecode = Py_CompileString(m_scriptText.c_str(), m_scriptName.c_str(), Py_file_input);
+	// recompile the scripttext into bytecode, or share the bytecode of the same script
+	m_bytecode = SCA_PythonBytecodeCache::Compile(m_scriptText, m_scriptName);
 	
 	if (m_bytecode) {
 		return true;
@@ -56,6 +56,8 @@ SCA_RandomActuator::SCA_RandomActuator(SCA_IObject *gameobj,
                                        const std::string &propName)
     : SCA_IActuator(gameobj, KX_ACT_RANDOM),
       m_propname(propName),
+      m_propkey(propName),
+      m_propslot(0),
 	  m_parameter1(para1),
 	  m_parameter2(para2),
 	  m_distribution(mode)
@@ -244,7 +246,7 @@ bool SCA_RandomActuator::Update()
 	}
 
 	/* Round up: assign it */
-	EXP_Value *prop = GetParent()->GetProperty(m_propname);
+	EXP_Value *prop = GetParent()->GetProperty(m_propkey, m_propslot);
 	if (prop) {
 		prop->SetValue(tmpval);
 	}
@@ -253,6 +255,12 @@ bool SCA_RandomActuator::Update()
 	return false;
 }
 
+void SCA_RandomActuator::UpdatePropertyKey()
+{
+	m_propkey = EXP_PropertyKey(m_propname);
+	m_propslot = 0;
+}
+
 void SCA_RandomActuator::enforceConstraints()
 {
 	/* The constraints that are checked here are the ones fundamental to     */
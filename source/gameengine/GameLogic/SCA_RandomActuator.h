@@ -41,6 +41,9 @@ class SCA_RandomActuator : public SCA_IActuator
 	Py_Header
 	/** Property to assign to */
 	std::string m_propname;
+	/** Key and slot hint of the property */
+	EXP_PropertyKey m_propkey;
+	unsigned int m_propslot;
 	
 	/** First parameter. The meaning of the parameters depends on the        
 	 *  distribution */
@@ -91,6 +94,7 @@ class SCA_RandomActuator : public SCA_IActuator
 	
 	virtual EXP_Value* GetReplica();
 	virtual void ProcessReplica();
+	virtual void UpdatePropertyKey();
 
 #ifdef WITH_PYTHON
 	
@@ -497,6 +497,8 @@ static void usage(const std::string& program, bool isBlenderPlayer)
 	CM_Message("       show_armatures                 0         Show debug armatures");
 	CM_Message("       show_camera_frustum            0         Show debug camera frustum volume");
 	CM_Message("       show_shadow_frustum            0         Show debug light shadow frustum volume");
+	CM_Message("       parallel_scenes                0         Process scenes physics and scene graph in parallel");
+	CM_Message("       trace_file                               Record a timeline of the game in this Chrome trace file");
 	CM_Message("       ignore_deprecation_warnings    1         Ignore deprecation warnings" << std::endl);
 	CM_Message("  -p: override python main loop script");
 	CM_Message(std::endl);
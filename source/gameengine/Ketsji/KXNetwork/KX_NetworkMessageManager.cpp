@@ -31,54 +31,148 @@
  */
 
 #include "KX_NetworkMessageManager.h"
-#include <iostream>
+
+#include <algorithm>
 
 KX_NetworkMessageManager::KX_NetworkMessageManager()
 	:m_currentList(0)
 {
+	// The empty name is always the id 0.
+	InternName("");
 }
 
 KX_NetworkMessageManager::~KX_NetworkMessageManager()
 {
-	ClearMessages();
 }
 
-void KX_NetworkMessageManager::AddMessage(KX_NetworkMessageManager::Message message)
+KX_NetworkMessageManager::NameId KX_NetworkMessageManager::InternName(const std::string& name)
 {
-	// Put the new message in map for the given receiver and subject.
-	m_messages[m_currentList][message.to][message.subject].push_back(message);
+	const auto it = m_nameIds.find(name);
+	if (it != m_nameIds.end()) {
+		return it->second;
+	}
+
+	const NameId id = m_names.size();
+	m_names.push_back(name);
+	m_nameIds.emplace(name, id);
+	return id;
 }
 
-const std::vector<KX_NetworkMessageManager::Message> KX_NetworkMessageManager::GetMessages(std::string to, std::string subject)
+int KX_NetworkMessageManager::FindName(const std::string& name) const
 {
-	std::vector<KX_NetworkMessageManager::Message> messages;
-
-	// look at messages without receiver.
-	std::map<std::string, std::vector<Message> >& messagesNoReceiver = m_messages[1 - m_currentList][""];
-	std::map<std::string, std::vector<Message> >& messagesReceiver = m_messages[1 - m_currentList][to];
-	if (subject.empty()) {
-		// Add all message without receiver and subject.
-		for (const auto& pair : messagesNoReceiver) {
-			messages.insert(messages.end(), pair.second.begin(), pair.second.end());
-		}
-		// Add all message with the given receiver and no subject.
-		for (const auto& pair : messagesReceiver) {
-			messages.insert(messages.end(), pair.second.begin(), pair.second.end());
+	const auto it = m_nameIds.find(name);
+	return (it != m_nameIds.end()) ? it->second : -1;
+}
+
+const std::string& KX_NetworkMessageManager::GetName(NameId id) const
+{
+	return m_names[id];
+}
+
+void KX_NetworkMessageManager::AddMessage(const std::string& to, SCA_IObject *from, const std::string& subject,
+		const std::string& body)
+{
+	MessageList& list = m_messages[m_currentList];
+
+	Message message;
+	message.to = InternName(to);
+	message.subject = InternName(subject);
+	message.from = from;
+	// The body address is resolved once all the bodies of the frame are added.
+	message.body = nullptr;
+	message.bodyLength = body.size();
+	message.bodyOffset = list.m_bodies.size();
+	message.index = list.m_messages.size();
+
+	list.m_messages.push_back(message);
+	list.m_bodies.insert(list.m_bodies.end(), body.begin(), body.end());
+	list.m_bodies.push_back('\0');
+}
+
+/// Order of the messages of a frame, by receiver, subject and send order.
+static bool message_less(const KX_NetworkMessageManager::Message& a, const KX_NetworkMessageManager::Message& b)
+{
+	if (a.to != b.to) {
+		return a.to < b.to;
+	}
+	if (a.subject != b.subject) {
+		return a.subject < b.subject;
+	}
+	return a.index < b.index;
+}
+
+/// Key of a receiver and an optional subject to search in the sorted messages.
+struct MessageKey
+{
+	KX_NetworkMessageManager::NameId to;
+	/// Subject id or -1 for all the subjects.
+	int subject;
+};
+
+static bool message_key_less(const KX_NetworkMessageManager::Message& message, const MessageKey& key)
+{
+	return (message.to != key.to) ? (message.to < key.to) :
+		   (key.subject != -1 && (int)message.subject < key.subject);
+}
+
+static bool key_message_less(const MessageKey& key, const KX_NetworkMessageManager::Message& message)
+{
+	return (key.to != message.to) ? (key.to < message.to) :
+		   (key.subject != -1 && key.subject < (int)message.subject);
+}
+
+KX_NetworkMessageManager::MessageSpan KX_NetworkMessageManager::GetMessages(NameId to, int subject) const
+{
+	const std::vector<Message>& messages = m_messages[1 - m_currentList].m_messages;
+	const MessageKey key = {to, subject};
+
+	const std::vector<Message>::const_iterator begin = std::lower_bound(messages.begin(), messages.end(), key, message_key_less);
+	const std::vector<Message>::const_iterator end = std::upper_bound(begin, messages.end(), key, key_message_less);
+
+	if (begin == end) {
+		return MessageSpan();
+	}
+
+	return MessageSpan(&*begin, &*begin + (end - begin));
+}
+
+KX_NetworkMessageManager::MessageSpans KX_NetworkMessageManager::GetMessages(const std::string& to, const std::string& subject) const
+{
+	MessageSpans spans;
+
+	int subjectId = -1;
+	if (!subject.empty()) {
+		subjectId = FindName(subject);
+		// A subject never sent can't match any message.
+		if (subjectId == -1) {
+			return spans;
 		}
 	}
-	else {
-		std::vector<KX_NetworkMessageManager::Message>& messagesNoReceiverSubject = messagesNoReceiver[subject];
-		messages.insert(messages.end(), messagesNoReceiverSubject.begin(), messagesNoReceiverSubject.end());
-		std::vector<KX_NetworkMessageManager::Message>& messagesReceiverSubject = messagesReceiver[subject];
-		messages.insert(messages.end(), messagesReceiverSubject.begin(), messagesReceiverSubject.end());
+
+	// Look at messages without receiver.
+	spans.noReceiver = GetMessages(0, subjectId);
+
+	const int toId = FindName(to);
+	if (toId > 0) {
+		spans.receiver = GetMessages(toId, subjectId);
 	}
 
-	return messages;
+	return spans;
 }
 
 void KX_NetworkMessageManager::ClearMessages()
 {
-	// Clear previous list.
-	m_messages[1 - m_currentList].clear();
+	// Clear previous list, the memory is kept for the next frame.
+	MessageList& previousList = m_messages[1 - m_currentList];
+	previousList.m_messages.clear();
+	previousList.m_bodies.clear();
+
 	m_currentList = 1 - m_currentList;
+
+	// The messages sent during the frame are now read only, sort them for the lookups.
+	MessageList& list = m_messages[1 - m_currentList];
+	std::sort(list.m_messages.begin(), list.m_messages.end(), message_less);
+	for (Message& message : list.m_messages) {
+		message.body = &list.m_bodies[message.bodyOffset];
+	}
 }
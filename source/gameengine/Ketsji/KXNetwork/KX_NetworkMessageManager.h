@@ -36,53 +36,150 @@ conflicts with KX_NetworkMessageManager::SendMessage */
 #endif
 
 #include <string>
-#include <map>
 #include <vector>
+#include <unordered_map>
 
 class SCA_IObject;
 
+/** \brief Message bus between the objects of all the scenes.
+ * Receiver and subject names are interned into ids and the message bodies of a frame
+ * are stored in a single buffer, once the frame is over the messages are sorted by
+ * receiver and subject so that they are retrieved without copy. The memory of the
+ * messages is reused every frame.
+ */
 class KX_NetworkMessageManager
 {
 public:
+	/// Interned receiver or subject name, 0 is the empty name.
+	typedef unsigned int NameId;
+
 	struct Message
 	{
 		/// Receiver object(s) name.
-		std::string to;
+		NameId to;
+		/// Message subject, used as filter.
+		NameId subject;
 		/// Sender game object.
 		SCA_IObject *from;
-		/// Message subject, used as filter.
-		std::string subject;
-		/// Message body.
-		std::string body;
+		/// Message body, valid until the next call to ClearMessages.
+		const char *body;
+		unsigned int bodyLength;
+		/// Offset of the body in the bodies of the frame.
+		unsigned int bodyOffset;
+		/// Send order of the message in its frame.
+		unsigned int index;
+	};
+
+	/// Range of contiguous messages.
+	class MessageSpan
+	{
+	private:
+		const Message *m_begin;
+		const Message *m_end;
+
+	public:
+		MessageSpan()
+			:m_begin(nullptr),
+			m_end(nullptr)
+		{
+		}
+
+		MessageSpan(const Message *begin, const Message *end)
+			:m_begin(begin),
+			m_end(end)
+		{
+		}
+
+		const Message *begin() const
+		{
+			return m_begin;
+		}
+
+		const Message *end() const
+		{
+			return m_end;
+		}
+
+		unsigned int size() const
+		{
+			return m_end - m_begin;
+		}
+
+		bool empty() const
+		{
+			return m_begin == m_end;
+		}
+	};
+
+	/// Messages received by an object, the messages without receiver are first.
+	struct MessageSpans
+	{
+		MessageSpan noReceiver;
+		MessageSpan receiver;
+
+		unsigned int size() const
+		{
+			return noReceiver.size() + receiver.size();
+		}
+
+		bool empty() const
+		{
+			return noReceiver.empty() && receiver.empty();
+		}
 	};
 
 private:
-	/** List of all messages, filtered by receiver object(s) name and subject name.
-	 * We use two lists, one handle sended message in the current frame and the other
+	struct MessageList
+	{
+		std::vector<Message> m_messages;
+		/// Bodies of all the messages of the frame, null terminated.
+		std::vector<char> m_bodies;
+	};
+
+	/** We use two lists, one handle sended message in the current frame and the other
 	 * is used for handle message sended in the last frame for sensors.
 	 */
-	std::map<std::string, std::map<std::string, std::vector<Message> > > m_messages[2];
+	MessageList m_messages[2];
 
 	/** Since we use two list for the current and last frame we have to switch of
 	 * current message list each frame. This value is only 0 or 1.
 	 */
 	unsigned short m_currentList;
 
+	/// Interned names indexed by id and their id.
+	std::vector<std::string> m_names;
+	std::unordered_map<std::string, NameId> m_nameIds;
+
+	/// Return the id of a name, the name is interned if not found.
+	NameId InternName(const std::string& name);
+	/// Return the id of a name or -1 if it was never interned.
+	int FindName(const std::string& name) const;
+
+	/// Return the messages of the last frame sent to a receiver and optionally matching a subject.
+	MessageSpan GetMessages(NameId to, int subject) const;
+
 public:
 	KX_NetworkMessageManager();
 	virtual ~KX_NetworkMessageManager();
 
 	/** Add a message in the next message list.
-	 * \param message The given message to add.
+	 * \param to The receiver object(s) name, empty for all objects.
+	 * \param from The sender game object.
+	 * \param subject The message subject.
+	 * \param body The message body, copied.
 	 */
-	void AddMessage(Message message);
-	/** Get all messages for a given receiver object name and message subject.
+	void AddMessage(const std::string& to, SCA_IObject *from, const std::string& subject, const std::string& body);
+	/** Get all messages of the last frame for a given receiver object name and message subject.
+	 * The returned messages are valid until the next call to ClearMessages.
 	 * \param to The object(s) name.
-	 * \param subject The message subject/filter.
+	 * \param subject The message subject/filter, empty for all subjects.
 	 */
-	const std::vector<Message> GetMessages(std::string to, std::string subject);
+	MessageSpans GetMessages(const std::string& to, const std::string& subject) const;
+
+	/// Return an interned receiver or subject name.
+	const std::string& GetName(NameId id) const;
 
-	/// Clear all messages
+	/// Clear the messages of the last frame and make the current messages available.
 	void ClearMessages();
 };
 
@@ -61,13 +61,16 @@ public:
 	 * \param subject The message subject, used as filter for receiver object(s).
 	 * \param message The body of the message.
 	 */
-	void SendMessage(std::string to, SCA_IObject *from, std::string subject, std::string body);
+	void SendMessage(const std::string& to, SCA_IObject *from, const std::string& subject, const std::string& body);
 
 	/** Get all messages for a given receiver object name and message subject.
 	 * \param to The object(s) name.
 	 * \param subject The message subject/filter.
 	 */
-	const std::vector<KX_NetworkMessageManager::Message> FindMessages(std::string to, std::string subject);
+	KX_NetworkMessageManager::MessageSpans FindMessages(const std::string& to, const std::string& subject) const;
+
+	/// Return the subject name of a message.
+	const std::string& GetSubject(const KX_NetworkMessageManager::Message& message) const;
 };
 
 #endif // __KX_NETWORKMESSAGESCENE_H__
@@ -31,6 +31,8 @@
 
 #include "CM_Message.h"
 
+#include <set>
+
 KX_BatchGroup::KX_BatchGroup()
 {
 	m_objects = new EXP_ListValue<KX_GameObject>();
@@ -55,6 +57,11 @@ EXP_ListValue<KX_GameObject> *KX_BatchGroup::GetObjects() const
 
 void KX_BatchGroup::MergeObjects(const std::vector<KX_GameObject *>& objects)
 {
+	std::vector<KX_GameObject *> mergeObjects;
+	std::vector<RAS_MeshUser *> meshUsers;
+	std::vector<MT_Matrix4x4> matrices;
+	std::set<RAS_MeshUser *> meshUserSet;
+
 	for (KX_GameObject *gameobj : objects) {
 		RAS_MeshUser *meshUser = gameobj->GetMeshUser();
 
@@ -63,7 +70,7 @@ void KX_BatchGroup::MergeObjects(const std::vector<KX_GameObject *>& objects)
 			continue;
 		}
 
-		if (meshUser->GetBatchGroup()) {
+		if (meshUser->GetBatchGroup() || !meshUserSet.insert(meshUser).second) {
 			CM_Error("object \"" << gameobj->GetName() << "\" already used in a batch group");
 			continue;
 		}
@@ -72,7 +79,17 @@ void KX_BatchGroup::MergeObjects(const std::vector<KX_GameObject *>& objects)
 		const MT_Vector3& scale = gameobj->NodeGetWorldScaling();
 		trans.scale(scale.x(), scale.y(), scale.z());
 
-		if (MergeMeshUser(meshUser, trans.toMatrix())) {
+		mergeObjects.push_back(gameobj);
+		meshUsers.push_back(meshUser);
+		matrices.push_back(trans.toMatrix());
+	}
+
+	// Merge all the objects at once to append the vertices of a material in one pass.
+	MergeMeshUsers(meshUsers, matrices);
+
+	for (unsigned int i = 0, size = mergeObjects.size(); i < size; ++i) {
+		KX_GameObject *gameobj = mergeObjects[i];
+		if (meshUsers[i]->GetBatchGroup() == this) {
 			m_objects->Add(gameobj);
 		}
 		else {
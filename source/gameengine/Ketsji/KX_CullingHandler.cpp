@@ -3,36 +3,128 @@
 
 #include "SG_Node.h"
 
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+
+#include <algorithm>
+
+/// Number of objects culled in a single task.
+static const unsigned int cullingTaskSize = 256;
+
+struct CullingTaskData
+{
+	KX_CullingHandler *m_handler;
+	const std::vector<KX_GameObject *> *m_objects;
+	unsigned int m_begin;
+	unsigned int m_end;
+};
+
 KX_CullingHandler::KX_CullingHandler(std::vector<KX_GameObject *>& objects, const SG_Frustum& frustum)
 	:m_activeObjects(objects),
 	m_frustum(frustum)
 {
 }
 
-void KX_CullingHandler::Process(KX_GameObject *object)
+void KX_CullingHandler::GetSphere(KX_GameObject *object, MT_Vector3& center, float& radius) const
 {
 	SG_Node *sgnode = object->GetSGNode();
-	SG_CullingNode *node = object->GetCullingNode();
+	const SG_BBox& aabb = object->GetCullingNode()->GetAabb();
 
 	const MT_Transform trans = sgnode->GetWorldTransform();
 	const MT_Vector3 &scale = sgnode->GetWorldScaling();
-	const SG_BBox& aabb = node->GetAabb();
 
-	bool culled = true;
-	const SG_Frustum::TestType sphereTest = m_frustum.SphereInsideFrustum(trans(aabb.GetCenter()), fabs(scale[scale.closestAxis()]) * aabb.GetRadius());
+	center = trans(aabb.GetCenter());
+	radius = fabs(scale[scale.closestAxis()]) * aabb.GetRadius();
+}
 
+bool KX_CullingHandler::Test(KX_GameObject *object, SG_Frustum::TestType sphereTest) const
+{
 	// First test if the sphere is in the frustum as it is faster to test than box.
 	if (sphereTest == SG_Frustum::INSIDE) {
-		culled = false;
+		return false;
 	}
 	// If the sphere intersects we made a box test because the box could be not homogeneous.
 	else if (sphereTest == SG_Frustum::INTERSECT) {
-		const MT_Matrix4x4 mat = MT_Matrix4x4(trans);
-		culled = (m_frustum.AabbInsideFrustum(aabb.GetMin(), aabb.GetMax(), mat) == SG_Frustum::OUTSIDE);
+		const SG_BBox& aabb = object->GetCullingNode()->GetAabb();
+		const MT_Matrix4x4 mat = MT_Matrix4x4(object->GetSGNode()->GetWorldTransform());
+		return (m_frustum.AabbInsideFrustum(aabb.GetMin(), aabb.GetMax(), mat) == SG_Frustum::OUTSIDE);
 	}
 
-	node->SetCulled(culled);
+	return true;
+}
+
+void KX_CullingHandler::Process(KX_GameObject *object)
+{
+	MT_Vector3 center;
+	float radius;
+	GetSphere(object, center, radius);
+
+	const bool culled = Test(object, m_frustum.SphereInsideFrustum(center, radius));
+
+	object->GetCullingNode()->SetCulled(culled);
 	if (!culled) {
 		m_activeObjects.push_back(object);
 	}
 }
+
+void KX_CullingHandler::CullingTaskFunc(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	CullingTaskData *data = (CullingTaskData *)taskdata;
+	data->m_handler->ProcessRange(*data->m_objects, data->m_begin, data->m_end);
+}
+
+void KX_CullingHandler::ProcessRange(const std::vector<KX_GameObject *>& objects, unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; ++i) {
+		MT_Vector3 center;
+		GetSphere(objects[i], center, m_sphereRadius[i]);
+		m_sphereX[i] = center[0];
+		m_sphereY[i] = center[1];
+		m_sphereZ[i] = center[2];
+	}
+
+	m_frustum.SpheresInsideFrustum(&m_sphereX[begin], &m_sphereY[begin], &m_sphereZ[begin], &m_sphereRadius[begin],
+			&m_sphereTests[begin], end - begin);
+
+	for (unsigned int i = begin; i < end; ++i) {
+		m_culled[i] = Test(objects[i], m_sphereTests[i]);
+	}
+}
+
+void KX_CullingHandler::Process(const std::vector<KX_GameObject *>& objects, TaskPool *pool)
+{
+	const unsigned int size = objects.size();
+	if (size == 0) {
+		return;
+	}
+
+	m_sphereX.resize(size);
+	m_sphereY.resize(size);
+	m_sphereZ.resize(size);
+	m_sphereRadius.resize(size);
+	m_sphereTests.resize(size);
+	m_culled.resize(size);
+
+	if (size <= cullingTaskSize || !pool) {
+		ProcessRange(objects, 0, size);
+	}
+	else {
+		std::vector<CullingTaskData> tasks;
+		for (unsigned int begin = 0; begin < size; begin += cullingTaskSize) {
+			tasks.push_back({this, &objects, begin, std::min(begin + cullingTaskSize, size)});
+		}
+		for (CullingTaskData& task : tasks) {
+			BLI_task_pool_push(pool, CullingTaskFunc, &task, false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+	}
+
+	// Merge the results serially to keep the objects order.
+	for (unsigned int i = 0; i < size; ++i) {
+		KX_GameObject *object = objects[i];
+		object->GetCullingNode()->SetCulled(m_culled[i]);
+		if (!m_culled[i]) {
+			m_activeObjects.push_back(object);
+		}
+	}
+}
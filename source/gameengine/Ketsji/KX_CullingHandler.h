@@ -5,6 +5,7 @@
 #include <vector>
 
 class KX_GameObject;
+struct TaskPool;
 
 class KX_CullingHandler
 {
@@ -14,6 +15,24 @@ private:
 	/// The camera frustum data.
 	const SG_Frustum& m_frustum;
 
+	/// Bounding spheres of the objects culled in batch, one array per component.
+	std::vector<float> m_sphereX;
+	std::vector<float> m_sphereY;
+	std::vector<float> m_sphereZ;
+	std::vector<float> m_sphereRadius;
+	std::vector<SG_Frustum::TestType> m_sphereTests;
+	/// Culling result of the objects culled in batch, a byte per object as tasks write concurrently.
+	std::vector<unsigned char> m_culled;
+
+	/// Compute the bounding sphere of an object in world space.
+	void GetSphere(KX_GameObject *object, MT_Vector3& center, float& radius) const;
+	/// Finish the culling of an object with the result of its sphere test.
+	bool Test(KX_GameObject *object, SG_Frustum::TestType sphereTest) const;
+
+	static void CullingTaskFunc(TaskPool *pool, void *taskdata, int threadid);
+	/// Cull the objects in the range [begin, end[ of the batch.
+	void ProcessRange(const std::vector<KX_GameObject *>& objects, unsigned int begin, unsigned int end);
+
 public:
 	KX_CullingHandler(std::vector<KX_GameObject *>& objects, const SG_Frustum& frustum);
 	~KX_CullingHandler() = default;
@@ -22,6 +41,12 @@ public:
 	 * object is added in m_activeObjects.
 	 */
 	void Process(KX_GameObject *object);
+
+	/** Process the culling of a list of objects, the sphere tests are made several
+	 * objects at once and big lists are split in tasks of pool. The visible objects
+	 * are added in m_activeObjects in the same order as in objects.
+	 */
+	void Process(const std::vector<KX_GameObject *>& objects, TaskPool *pool);
 };
 
 #endif  // __KX_CULLING_HANDLER_H__
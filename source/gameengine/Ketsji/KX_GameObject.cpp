@@ -135,7 +135,8 @@ KX_GameObject::KX_GameObject(
 #endif
 {
 	m_pClient_info = new KX_ClientObjectInfo(this, KX_ClientObjectInfo::ACTOR);
-	m_pSGNode = new SG_Node(this,sgReplicationInfo,callbacks);
+	// Store the transform with the other objects of the scene.
+	m_pSGNode = new SG_Node(this,sgReplicationInfo,callbacks, static_cast<KX_Scene *>(sgReplicationInfo)->GetTransformPool());
 
 	// define the relationship between this node and it's parent.
 	KX_NormalParentRelation *parent_relation = new KX_NormalParentRelation();
@@ -1362,32 +1363,32 @@ void KX_GameObject::NodeUpdateGS(double time)
 	m_pSGNode->UpdateWorldData(time);
 }
 
-const MT_Matrix3x3& KX_GameObject::NodeGetWorldOrientation() const
+MT_Matrix3x3 KX_GameObject::NodeGetWorldOrientation() const
 {
 	return m_pSGNode->GetWorldOrientation();
 }
 
-const MT_Matrix3x3& KX_GameObject::NodeGetLocalOrientation() const
+MT_Matrix3x3 KX_GameObject::NodeGetLocalOrientation() const
 {
 	return m_pSGNode->GetLocalOrientation();
 }
 
-const MT_Vector3& KX_GameObject::NodeGetWorldScaling() const
+MT_Vector3 KX_GameObject::NodeGetWorldScaling() const
 {
 	return m_pSGNode->GetWorldScaling();
 }
 
-const MT_Vector3& KX_GameObject::NodeGetLocalScaling() const
+MT_Vector3 KX_GameObject::NodeGetLocalScaling() const
 {
 	return m_pSGNode->GetLocalScale();
 }
 
-const MT_Vector3& KX_GameObject::NodeGetWorldPosition() const
+MT_Vector3 KX_GameObject::NodeGetWorldPosition() const
 {
 	return m_pSGNode->GetWorldPosition();
 }
 
-const MT_Vector3& KX_GameObject::NodeGetLocalPosition() const
+MT_Vector3 KX_GameObject::NodeGetLocalPosition() const
 {
 	return m_pSGNode->GetLocalPosition();
 }
@@ -2137,27 +2138,33 @@ static int Map_SetItem(PyObject *self_v, PyObject *key, PyObject *val)
 		/* as EXP_Value */
 		if (attr_str && PyObject_TypeCheck(val, &EXP_PyObjectPlus::Type)==0) /* don't allow GameObjects for eg to be assigned to EXP_Value props */
 		{
-			EXP_Value *vallie = self->ConvertPythonToValue(val, false, "gameOb[key] = value: ");
-			
-			if (vallie) {
-				EXP_Value* oldprop = self->GetProperty(attr_str);
-				
-				if (oldprop)
-					oldprop->SetValue(vallie);
-				else
-					self->SetProperty(attr_str, vallie);
-				
-				vallie->Release();
+			EXP_Value *oldprop = self->GetProperty(attr_str);
+
+			/* int, float and bool properties are set in place */
+			if (oldprop && oldprop->SetValueFromPython(val)) {
 				set = true;
-				
-				/* try remove dict value to avoid double ups */
-				if (self->m_attr_dict) {
-					if (PyDict_DelItem(self->m_attr_dict, key) != 0)
-						PyErr_Clear();
+			}
+			else {
+				EXP_Value *vallie = self->ConvertPythonToValue(val, false, "gameOb[key] = value: ");
+
+				if (vallie) {
+					if (oldprop)
+						oldprop->SetValue(vallie);
+					else
+						self->SetProperty(attr_str, vallie);
+
+					vallie->Release();
+					set = true;
+				}
+				else if (PyErr_Occurred()) {
+					return -1;
 				}
 			}
-			else if (PyErr_Occurred()) {
-				return -1;
+
+			/* try remove dict value to avoid double ups */
+			if (set && self->m_attr_dict) {
+				if (PyDict_DelItem(self->m_attr_dict, key) != 0)
+					PyErr_Clear();
 			}
 		}
 		
@@ -521,14 +521,14 @@ public:
 		double time
 	);
 
-	const MT_Matrix3x3& NodeGetWorldOrientation(  ) const;
-	const MT_Vector3& NodeGetWorldScaling(  ) const;
-	const MT_Vector3& NodeGetWorldPosition(  ) const;
+	MT_Matrix3x3 NodeGetWorldOrientation(  ) const;
+	MT_Vector3 NodeGetWorldScaling(  ) const;
+	MT_Vector3 NodeGetWorldPosition(  ) const;
 	MT_Transform NodeGetWorldTransform() const;
 
-	const MT_Matrix3x3& NodeGetLocalOrientation(  ) const;
-	const MT_Vector3& NodeGetLocalScaling(  ) const;
-	const MT_Vector3& NodeGetLocalPosition(  ) const;
+	MT_Matrix3x3 NodeGetLocalOrientation(  ) const;
+	MT_Vector3 NodeGetLocalScaling(  ) const;
+	MT_Vector3 NodeGetLocalPosition(  ) const;
 	MT_Transform NodeGetLocalTransform() const;
 
 	/**
@@ -35,9 +35,12 @@
 #endif
 
 #include "CM_Message.h"
+#include "CM_Trace.h"
 
 #include <boost/format.hpp>
 
+#include <algorithm>
+
 #include "BLI_task.h"
 
 #include "KX_KetsjiEngine.h"
@@ -71,6 +74,7 @@
 
 #include "BL_BlenderConverter.h"
 #include "BL_BlenderSceneConverter.h"
+#include "BL_SkinCache.h"
 
 #include "RAS_FramingManager.h"
 #include "DNA_world_types.h"
@@ -122,6 +126,12 @@ KX_KetsjiEngine::RenderData::RenderData(RAS_Rasterizer::StereoMode stereoMode, b
 {
 }
 
+KX_KetsjiEngine::SceneTaskData::SceneTaskData(KX_Scene *scene)
+	:m_scene(scene)
+{
+	std::fill(m_times, m_times + tc_numCategories, 0.0);
+}
+
 
 const std::string KX_KetsjiEngine::m_profileLabels[tc_numCategories] = {
 	"Physics:", // tc_physics
@@ -188,6 +198,8 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem *system)
 #endif
 
 	m_taskscheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	m_scenePoolData.m_engine = this;
+	m_scenePool = BLI_task_pool_create(m_taskscheduler, &m_scenePoolData);
 
 	m_scenes = new EXP_ListValue<KX_Scene>();
 }
@@ -201,6 +213,8 @@ KX_KetsjiEngine::~KX_KetsjiEngine()
 	Py_CLEAR(m_pyprofiledict);
 #endif
 
+	BLI_task_pool_free(m_scenePool);
+
 	if (m_taskscheduler)
 		BLI_task_scheduler_free(m_taskscheduler);
 
@@ -248,6 +262,8 @@ void KX_KetsjiEngine::StartEngine()
 {
 	m_previousRealTime = m_kxsystem->GetTimeInSeconds();
 
+	BL_SkinCache::ResetStatistics();
+
 	m_bInitialized = true;
 }
 
@@ -322,6 +338,8 @@ void KX_KetsjiEngine::EndFrame()
 
 bool KX_KetsjiEngine::NextFrame()
 {
+	CM_TRACE_SCOPE("Next Frame", "engine");
+
 	m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
 
 	/*
@@ -411,56 +429,65 @@ bool KX_KetsjiEngine::NextFrame()
 		}
 #endif  // WITH_SDL
 
-		// for each scene, call the proceed functions
-		for (KX_Scene *scene : m_scenes) {
-			/* Suspension holds the physics and logic processing for an
-			 * entire scene. Objects can be suspended individually, and
-			 * the settings for that precede the logic and physics
-			 * update. */
-			m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+		if (m_flags & PARALLEL_SCENES) {
+			ProceedScenesParallel(timestep, framestep);
+		}
+		else {
+			// for each scene, call the proceed functions
+			for (KX_Scene *scene : m_scenes) {
+				/* Suspension holds the physics and logic processing for an
+				 * entire scene. Objects can be suspended individually, and
+				 * the settings for that precede the logic and physics
+				 * update. */
+				m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
 
-			scene->UpdateObjectActivity();
+				scene->UpdateObjectActivity();
 
-			if (!scene->IsSuspended()) {
-				m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
-				// set Python hooks for each scene
+				if (!scene->IsSuspended()) {
+					m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
+					// set Python hooks for each scene
 #ifdef WITH_PYTHON
-				PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
+					PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
 #endif
-				KX_SetActiveScene(scene);
+					KX_SetActiveScene(scene);
 
-				// Process sensors, and controllers
-				m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
-				scene->LogicBeginFrame(m_frameTime, framestep);
+					// Process sensors, and controllers
+					m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+					scene->LogicBeginFrame(m_frameTime, framestep);
 
-				// Scenegraph needs to be updated again, because Logic Controllers
-				// can affect the local matrices.
-				m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
-				scene->UpdateParents(m_frameTime);
+					// Scenegraph needs to be updated again, because Logic Controllers
+					// can affect the local matrices.
+					m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
+					scene->UpdateParents(m_frameTime);
 
-				// Process actuators
+					// Process actuators
 
-				// Do some cleanup work for this logic frame
-				m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
-				scene->LogicUpdateFrame(m_frameTime);
+					// Do some cleanup work for this logic frame
+					m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+					scene->LogicUpdateFrame(m_frameTime);
+
+					scene->LogicEndFrame();
 
-				scene->LogicEndFrame();
+					// Actuators can affect the scenegraph
+					m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
+					scene->UpdateParents(m_frameTime);
 
-				// Actuators can affect the scenegraph
-				m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
-				scene->UpdateParents(m_frameTime);
+					m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
 
-				m_logger.StartLog(tc_physics, m_kxsystem->GetTimeInSeconds());
+					// Perform physics calculations on the scene. This can involve
+					// many iterations of the physics solver.
+					{
+						const std::string name = CM_Trace::IsRecording() ? scene->GetName() : std::string();
+						CM_TRACE_SCOPE("Physics", "physics", name.c_str());
+						scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);//m_deltatimerealDeltaTime);
+					}
 
-				// Perform physics calculations on the scene. This can involve
-				// many iterations of the physics solver.
-				scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);//m_deltatimerealDeltaTime);
+					m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
+					scene->UpdateParents(m_frameTime);
+				}
 
-				m_logger.StartLog(tc_scenegraph, m_kxsystem->GetTimeInSeconds());
-				scene->UpdateParents(m_frameTime);
+				m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
 			}
-
-			m_logger.StartLog(tc_services, m_kxsystem->GetTimeInSeconds());
 		}
 
 		m_logger.StartLog(tc_network, m_kxsystem->GetTimeInSeconds());
@@ -483,6 +510,169 @@ bool KX_KetsjiEngine::NextFrame()
 	return doRender && m_doRender;
 }
 
+void KX_KetsjiEngine::SceneTaskFunc(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	SceneTaskPoolData *pooldata = (SceneTaskPoolData *)BLI_task_pool_userdata(pool);
+	SceneTaskData *data = (SceneTaskData *)taskdata;
+
+	pooldata->m_engine->ProceedSceneStep(*data, pooldata->m_step, pooldata->m_timestep, pooldata->m_framestep);
+}
+
+void KX_KetsjiEngine::ProceedSceneStep(SceneTaskData& data, SceneTaskStep step, double timestep, double framestep)
+{
+	KX_Scene *scene = data.m_scene;
+	double time = m_kxsystem->GetTimeInSeconds();
+
+	// Accumulate the time elapsed since the previous call into the category.
+	auto logTime = [this, &data, &time](KX_TimeCategory category) {
+		const double now = m_kxsystem->GetTimeInSeconds();
+		data.m_times[category] += now - time;
+		time = now;
+	};
+
+	switch (step) {
+		case SCENE_TASK_ACTIVITY:
+		{
+			scene->UpdateObjectActivity();
+			logTime(tc_logic);
+			break;
+		}
+		case SCENE_TASK_SCENEGRAPH:
+		{
+			scene->UpdateParents(m_frameTime);
+			logTime(tc_scenegraph);
+			break;
+		}
+		case SCENE_TASK_PHYSICS:
+		{
+			// Actuators can affect the scenegraph
+			scene->UpdateParents(m_frameTime);
+			logTime(tc_scenegraph);
+
+			{
+				const std::string name = CM_Trace::IsRecording() ? scene->GetName() : std::string();
+				CM_TRACE_SCOPE("Physics", "physics", name.c_str());
+				scene->GetPhysicsEnvironment()->ProceedDeltaTime(m_frameTime, timestep, framestep);
+			}
+			logTime(tc_physics);
+
+			scene->UpdateParents(m_frameTime);
+			logTime(tc_scenegraph);
+			break;
+		}
+	}
+}
+
+void KX_KetsjiEngine::ProceedScenesStep(std::vector<SceneTaskData>& scenes, SceneTaskStep step, double timestep, double framestep)
+{
+	const double starttime = m_kxsystem->GetTimeInSeconds();
+	m_logger.EndLog(starttime);
+
+	for (SceneTaskData& data : scenes) {
+		std::fill(data.m_times, data.m_times + tc_numCategories, 0.0);
+	}
+
+	// A single scene doesn't deserve the tasks overhead.
+	if (scenes.size() == 1) {
+		ProceedSceneStep(scenes.front(), step, timestep, framestep);
+	}
+	else {
+		m_scenePoolData.m_step = step;
+		m_scenePoolData.m_timestep = timestep;
+		m_scenePoolData.m_framestep = framestep;
+
+		for (SceneTaskData& data : scenes) {
+			BLI_task_pool_push(m_scenePool, SceneTaskFunc, &data, false, TASK_PRIORITY_HIGH);
+		}
+
+		BLI_task_pool_work_and_wait(m_scenePool);
+	}
+
+	const double endtime = m_kxsystem->GetTimeInSeconds();
+
+	/* The tasks overlap, their times can't be added as is to the logger. Instead the
+	 * elapsed time of the step is shared between categories in proportion of the time
+	 * spent in each category by all the tasks. */
+	double times[tc_numCategories] = {0.0};
+	double totaltime = 0.0;
+	for (const SceneTaskData& data : scenes) {
+		for (unsigned short i = tc_first; i < tc_numCategories; ++i) {
+			times[i] += data.m_times[i];
+			totaltime += data.m_times[i];
+		}
+	}
+
+	if (totaltime > 0.0) {
+		const double factor = (endtime - starttime) / totaltime;
+		for (unsigned short i = tc_first; i < tc_numCategories; ++i) {
+			if (times[i] > 0.0) {
+				m_logger.AddTime((KX_TimeCategory)i, times[i] * factor);
+			}
+		}
+	}
+
+	m_logger.StartLog(tc_services, endtime);
+}
+
+void KX_KetsjiEngine::ProceedScenesParallel(double timestep, double framestep)
+{
+	std::vector<SceneTaskData> scenes;
+	for (KX_Scene *scene : m_scenes) {
+		scenes.emplace_back(scene);
+	}
+
+	/* Activity culling of all the scenes, it must be done before the logic of any
+	 * scene as it suspends and resumes the logic of the objects. */
+	ProceedScenesStep(scenes, SCENE_TASK_ACTIVITY, timestep, framestep);
+
+	/* Suspension holds the physics and logic processing for an entire scene, the
+	 * list of running scenes is computed once before the logic to always process
+	 * a complete logic frame of these scenes even if the logic of a previous scene
+	 * suspends them. */
+	std::vector<SceneTaskData> runningScenes;
+	for (KX_Scene *scene : m_scenes) {
+		if (!scene->IsSuspended()) {
+			runningScenes.emplace_back(scene);
+		}
+	}
+
+	if (runningScenes.empty()) {
+		return;
+	}
+
+	// Process sensors and controllers serially, they can call python.
+	m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+	for (SceneTaskData& data : runningScenes) {
+		KX_Scene *scene = data.m_scene;
+		// set Python hooks for each scene
+#ifdef WITH_PYTHON
+		PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
+#endif
+		KX_SetActiveScene(scene);
+
+		scene->LogicBeginFrame(m_frameTime, framestep);
+	}
+
+	// Scenegraph needs to be updated again, because Logic Controllers can affect the local matrices.
+	ProceedScenesStep(runningScenes, SCENE_TASK_SCENEGRAPH, timestep, framestep);
+
+	// Process actuators and do some cleanup work for this logic frame.
+	m_logger.StartLog(tc_logic, m_kxsystem->GetTimeInSeconds());
+	for (SceneTaskData& data : runningScenes) {
+		KX_Scene *scene = data.m_scene;
+#ifdef WITH_PYTHON
+		PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
+#endif
+		KX_SetActiveScene(scene);
+
+		scene->LogicUpdateFrame(m_frameTime);
+		scene->LogicEndFrame();
+	}
+
+	// Perform physics calculations of all the scenes with the scene graph updates around.
+	ProceedScenesStep(runningScenes, SCENE_TASK_PHYSICS, timestep, framestep);
+}
+
 void KX_KetsjiEngine::UpdateSuspendedScenes(double framestep)
 {
 	for (KX_Scene *scene : m_scenes) {
@@ -630,6 +820,8 @@ KX_KetsjiEngine::RenderData KX_KetsjiEngine::GetRenderData()
 
 void KX_KetsjiEngine::Render()
 {
+	CM_TRACE_SCOPE("Render", "render");
+
 	m_logger.StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds());
 
 	BeginFrame();
@@ -866,36 +1058,51 @@ void KX_KetsjiEngine::RenderShadowBuffers(KX_Scene *scene)
 	}
 
 	if (m_rasterizer->GetDrawingMode() == RAS_Rasterizer::RAS_TEXTURED) {
+		std::vector<KX_LightObject *> shadowLights;
+		std::vector<SG_Frustum> frustums;
+		std::vector<int> layers;
 		for (KX_LightObject *light : lightlist) {
 			RAS_ILightObject *raslight = light->GetLightData();
 			if (light->GetVisible() && raslight->HasShadowBuffer() && raslight->NeedShadowUpdate()) {
-				/* make temporary camera */
-				RAS_CameraData camdata = RAS_CameraData();
-				KX_Camera *cam = new KX_Camera(scene, scene->m_callbacks, camdata, true, true);
-				cam->SetName("__shadow__cam__");
+				shadowLights.push_back(light);
+				frustums.emplace_back(raslight->GetShadowFrustumMatrix());
+				layers.push_back(raslight->GetShadowLayer());
+			}
+		}
 
-				MT_Transform camtrans;
+		// Cull the objects of all the shadow buffers at once.
+		std::vector<std::vector<KX_GameObject *> > visibleObjects;
+		scene->CalculateVisibleMeshes(visibleObjects, frustums, layers);
 
-				/* binds framebuffer object, sets up camera .. */
-				raslight->BindShadowBuffer(m_canvas, cam, camtrans);
+		for (unsigned short i = 0, size = shadowLights.size(); i < size; ++i) {
+			RAS_ILightObject *raslight = shadowLights[i]->GetLightData();
 
-				std::vector<KX_GameObject *> objects;
-				/* update scene */
-				scene->CalculateVisibleMeshes(objects, cam, raslight->GetShadowLayer());
+			/* make temporary camera */
+			RAS_CameraData camdata = RAS_CameraData();
+			KX_Camera *cam = new KX_Camera(scene, scene->m_callbacks, camdata, true, true);
+			cam->SetName("__shadow__cam__");
 
-				m_logger.StartLog(tc_animations, m_kxsystem->GetTimeInSeconds());
-				UpdateAnimations(scene);
-				m_logger.StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds());
+			MT_Transform camtrans;
 
-				/* render */
-				m_rasterizer->Clear(RAS_Rasterizer::RAS_DEPTH_BUFFER_BIT | RAS_Rasterizer::RAS_COLOR_BUFFER_BIT);
-				// Send a nullptr off screen because the viewport is binding it's using its own private one.
-				scene->RenderBuckets(objects, RAS_Rasterizer::RAS_SHADOW, camtrans, m_rasterizer, nullptr);
+			/* binds framebuffer object, sets up camera .. */
+			raslight->BindShadowBuffer(m_canvas, cam, camtrans);
 
-				/* unbind framebuffer object, restore drawmode, free camera */
-				raslight->UnbindShadowBuffer();
-				cam->Release();
-			}
+			const std::vector<KX_GameObject *>& objects = visibleObjects[i];
+			/* update scene */
+			scene->ApplyCulling(i);
+
+			m_logger.StartLog(tc_animations, m_kxsystem->GetTimeInSeconds());
+			UpdateAnimations(scene);
+			m_logger.StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds());
+
+			/* render */
+			m_rasterizer->Clear(RAS_Rasterizer::RAS_DEPTH_BUFFER_BIT | RAS_Rasterizer::RAS_COLOR_BUFFER_BIT);
+			// Send a nullptr off screen because the viewport is binding it's using its own private one.
+			scene->RenderBuckets(objects, RAS_Rasterizer::RAS_SHADOW, camtrans, m_rasterizer, nullptr);
+
+			/* unbind framebuffer object, restore drawmode, free camera */
+			raslight->UnbindShadowBuffer();
+			cam->Release();
 		}
 	}
 }
@@ -45,6 +45,7 @@
 #include <vector>
 
 struct TaskScheduler;
+struct TaskPool;
 class KX_ISystem;
 class BL_BlenderConverter;
 class KX_NetworkMessageManager;
@@ -102,7 +103,9 @@ public:
 		/// Automatic add debug properties to the debug list.
 		AUTO_ADD_DEBUG_PROPERTIES = (1 << 7),
 		/// Use override camera?
-		CAMERA_OVERRIDE = (1 << 8)
+		CAMERA_OVERRIDE = (1 << 8),
+		/// Process scene graph, physics and activity culling of scenes in parallel?
+		PARALLEL_SCENES = (1 << 9)
 	};
 
 private:
@@ -261,6 +264,53 @@ private:
 	/// Task scheduler for multi-threading
 	TaskScheduler *m_taskscheduler;
 
+	/// Steps of a logic frame which can be executed in parallel for each scene.
+	enum SceneTaskStep {
+		/// Object activity culling.
+		SCENE_TASK_ACTIVITY = 0,
+		/// Scene graph update after the sensors and controllers.
+		SCENE_TASK_SCENEGRAPH,
+		/// Scene graph update after the actuators, physics step and final scene graph update.
+		SCENE_TASK_PHYSICS
+	};
+
+	/// Data of a scene processed in a task.
+	struct SceneTaskData
+	{
+		SceneTaskData(KX_Scene *scene);
+
+		KX_Scene *m_scene;
+		/// Time spent in each category during the task.
+		double m_times[tc_numCategories];
+	};
+
+	/// Data shared by all the scene tasks of a step.
+	struct SceneTaskPoolData
+	{
+		KX_KetsjiEngine *m_engine;
+		SceneTaskStep m_step;
+		double m_timestep;
+		double m_framestep;
+	};
+
+	/// Task pool used to process scenes in parallel.
+	TaskPool *m_scenePool;
+	SceneTaskPoolData m_scenePoolData;
+
+	static void SceneTaskFunc(TaskPool *pool, void *taskdata, int threadid);
+	/// Execute a step of a logic frame for a single scene, the time spent per category is stored in the task data.
+	void ProceedSceneStep(SceneTaskData& data, SceneTaskStep step, double timestep, double framestep);
+	/** Execute a step of a logic frame for all the passed scenes using the task pool.
+	 * The time of the whole step is distributed to the categories in proportion to the
+	 * time spent by the tasks in each category.
+	 */
+	void ProceedScenesStep(std::vector<SceneTaskData>& scenes, SceneTaskStep step, double timestep, double framestep);
+	/** Proceed a logic frame for all the scenes, the logic (and so python) is still
+	 * executed serially for each scene on the main thread but activity culling, scene graph
+	 * update and physics step are executed in parallel.
+	 */
+	void ProceedScenesParallel(double timestep, double framestep);
+
 	/** Set scene's total pause duration for animations process.
 	 * This is done in a separate loop to get the proper state of each scenes.
 	 * eg: There's 2 scenes, the first is suspended and the second is active.
@@ -27,12 +27,16 @@
 #include "KX_LibLoadStatus.h"
 #include "PIL_time.h"
 
+#include <algorithm>
+
 KX_LibLoadStatus::KX_LibLoadStatus(BL_BlenderConverter *converter, KX_KetsjiEngine *engine, KX_Scene *merge_scene, const std::string& path)
 	:m_converter(converter),
 	m_engine(engine),
 	m_mergescene(merge_scene),
 	m_libname(path),
 	m_progress(0.0f),
+	m_numMergeObjects(0),
+	m_mergedObjects(0),
 	m_finished(false)
 #ifdef WITH_PYTHON
 	,
@@ -88,16 +92,6 @@ KX_Scene *KX_LibLoadStatus::GetMergeScene() const
 	return m_mergescene;
 }
 
-const std::vector<Scene *>& KX_LibLoadStatus::GetBlenderScenes() const
-{
-	return m_blenderScenes;
-}
-
-void KX_LibLoadStatus::SetBlenderScenes(const std::vector<Scene *>& scenes)
-{
-	m_blenderScenes = scenes;
-}
-
 const std::vector<BL_BlenderSceneConverter>& KX_LibLoadStatus::GetSceneConverters() const
 {
 	return m_sceneConvertes;
@@ -130,6 +124,33 @@ void KX_LibLoadStatus::AddProgress(float progress)
 	RunProgressCallback();
 }
 
+void KX_LibLoadStatus::AddMergeObjects(unsigned int count)
+{
+	m_numMergeObjects += count;
+}
+
+void KX_LibLoadStatus::AddMergedObjects(unsigned int count)
+{
+	m_mergedObjects += count;
+}
+
+unsigned int KX_LibLoadStatus::GetNumMergeObjects() const
+{
+	return m_numMergeObjects;
+}
+
+float KX_LibLoadStatus::GetMergeProgress() const
+{
+	if (m_finished) {
+		return 1.0f;
+	}
+	if (m_numMergeObjects == 0) {
+		return 0.0f;
+	}
+
+	return std::min((float)m_mergedObjects / (float)m_numMergeObjects, 1.0f);
+}
+
 #ifdef WITH_PYTHON
 
 PyMethodDef KX_LibLoadStatus::Methods[] = {
@@ -142,6 +163,7 @@ PyAttributeDef KX_LibLoadStatus::Attributes[] = {
 	EXP_PYATTRIBUTE_FLOAT_RO("progress", KX_LibLoadStatus, m_progress),
 	EXP_PYATTRIBUTE_STRING_RO("libraryName", KX_LibLoadStatus, m_libname),
 	EXP_PYATTRIBUTE_RO_FUNCTION("timeTaken", KX_LibLoadStatus, pyattr_get_timetaken),
+	EXP_PYATTRIBUTE_RO_FUNCTION("mergeProgress", KX_LibLoadStatus, pyattr_get_mergeprogress),
 	EXP_PYATTRIBUTE_BOOL_RO("finished", KX_LibLoadStatus, m_finished),
 	EXP_PYATTRIBUTE_NULL // Sentinel
 };
@@ -238,4 +260,11 @@ PyObject *KX_LibLoadStatus::pyattr_get_timetaken(EXP_PyObjectPlus *self_v, const
 	return PyFloat_FromDouble(self->m_endtime - self->m_starttime);
 }
 
+PyObject *KX_LibLoadStatus::pyattr_get_mergeprogress(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef)
+{
+	KX_LibLoadStatus *self = static_cast<KX_LibLoadStatus *>(self_v);
+
+	return PyFloat_FromDouble(self->GetMergeProgress());
+}
+
 #endif  // WITH_PYTHON
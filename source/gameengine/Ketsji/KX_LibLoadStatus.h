@@ -33,7 +33,6 @@
 class BL_BlenderConverter;
 class KX_KetsjiEngine;
 class KX_Scene;
-struct Scene;
 
 class KX_LibLoadStatus : public EXP_PyObjectPlus
 {
@@ -42,11 +41,13 @@ private:
 	BL_BlenderConverter *m_converter;
 	KX_KetsjiEngine *m_engine;
 	KX_Scene *m_mergescene;
-	std::vector<Scene *> m_blenderScenes;
 	std::vector<BL_BlenderSceneConverter> m_sceneConvertes;
 	std::string m_libname;
 
 	float m_progress;
+	/// Number of objects to merge in the merge scene and already merged.
+	unsigned int m_numMergeObjects;
+	unsigned int m_mergedObjects;
 	double m_starttime;
 	double m_endtime;
 
@@ -70,8 +71,6 @@ public:
 	KX_KetsjiEngine *GetEngine() const;
 	KX_Scene *GetMergeScene() const;
 
-	const std::vector<Scene *>& GetBlenderScenes() const;
-	void SetBlenderScenes(const std::vector<Scene *>& scenes);
 	const std::vector<BL_BlenderSceneConverter>& GetSceneConverters() const;
 	void AddSceneConverter(BL_BlenderSceneConverter&& converter);
 
@@ -81,6 +80,12 @@ public:
 	float GetProgress() const;
 	void AddProgress(float progress);
 
+	void AddMergeObjects(unsigned int count);
+	void AddMergedObjects(unsigned int count);
+	unsigned int GetNumMergeObjects() const;
+	/// Return the normalized progress of the merge of the objects.
+	float GetMergeProgress() const;
+
 #ifdef WITH_PYTHON
 	static PyObject *pyattr_get_onfinish(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef);
 	static int pyattr_set_onfinish(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef, PyObject *value);
@@ -88,6 +93,7 @@ public:
 	static int pyattr_set_onprogress(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef, PyObject *value);
 
 	static PyObject *pyattr_get_timetaken(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef);
+	static PyObject *pyattr_get_mergeprogress(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef);
 #endif
 };
 
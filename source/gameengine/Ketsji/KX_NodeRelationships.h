@@ -55,6 +55,8 @@ public:
 
 	/// Method inherited from KX_ParentRelation.
 	virtual SG_ParentRelation *NewCopy();
+
+	virtual bool IsNormalRelation();
 };
 
 class KX_VertexParentRelation : public SG_ParentRelation
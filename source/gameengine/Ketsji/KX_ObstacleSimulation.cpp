@@ -28,9 +28,21 @@
 
 #include "KX_ObstacleSimulation.h"
 #include "KX_NavMeshObject.h"
+#include "KX_SteeringActuator.h"
+#include "KX_KetsjiEngine.h"
 #include "KX_Globals.h"
 #include "DNA_object_types.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
+
+#include <algorithm>
+
+/// Number of obstacle velocities adjusted by a task.
+#define KX_OBSTACLE_TASK_SIZE 8
+/// Size of the grid cells relative to the mean radius of the circle obstacles.
+#define KX_OBSTACLE_CELL_RADIUS_FACTOR 4.0f
+/// Maximum number of grid cells per obstacle.
+#define KX_OBSTACLE_CELLS_PER_OBSTACLE 4
 
 namespace
 {
@@ -169,11 +181,35 @@ static float interpolateToi(float a, const float* dir, const float* toi, const i
 	return 0;
 }
 
+static void obstacleBounds(KX_Obstacle *obstacle, float min[2], float max[2])
+{
+	if (obstacle->m_shape == KX_OBSTACLE_SEGMENT) {
+		min[0] = std::min(obstacle->m_worldPos.x(), obstacle->m_worldPos2.x());
+		min[1] = std::min(obstacle->m_worldPos.y(), obstacle->m_worldPos2.y());
+		max[0] = std::max(obstacle->m_worldPos.x(), obstacle->m_worldPos2.x());
+		max[1] = std::max(obstacle->m_worldPos.y(), obstacle->m_worldPos2.y());
+	}
+	else {
+		min[0] = max[0] = obstacle->m_pos.x();
+		min[1] = max[1] = obstacle->m_pos.y();
+	}
+
+	const float rad = obstacle->m_rad;
+	min[0] -= rad;
+	min[1] -= rad;
+	max[0] += rad;
+	max[1] += rad;
+}
+
 KX_ObstacleSimulation::KX_ObstacleSimulation(MT_Scalar levelHeight, bool enableVisualization)
 :	m_levelHeight(levelHeight)
 ,	m_enableVisualization(enableVisualization)
+,	m_cellSize(1.0f)
+,	m_gridDirty(true)
+,	m_maxObstacleSpeed(0.0f)
 {
-
+	zero_v2(m_gridMin);
+	m_gridSize[0] = m_gridSize[1] = 0;
 }
 
 KX_ObstacleSimulation::~KX_ObstacleSimulation()
@@ -198,7 +234,9 @@ KX_Obstacle* KX_ObstacleSimulation::CreateObstacle(KX_GameObject* gameobj)
 		vset(&obstacle->hvel[i*2], 0,0);
 	obstacle->hhead = 0;
 
+	obstacle->m_index = m_obstacles.size();
 	m_obstacles.push_back(obstacle);
+	m_gridDirty = true;
 	return obstacle;
 }
 
@@ -209,6 +247,7 @@ void KX_ObstacleSimulation::AddObstacleForObj(KX_GameObject* gameobj)
 	obstacle->m_type = KX_OBSTACLE_OBJ;
 	obstacle->m_shape = KX_OBSTACLE_CIRCLE;
 	obstacle->m_rad = blenderobject->obstacleRad;
+	obstacle->m_pos = gameobj->NodeGetWorldPosition();
 }
 
 void KX_ObstacleSimulation::AddObstaclesForNavMesh(KX_NavMeshObject* navmeshobj)
@@ -233,6 +272,8 @@ void KX_ObstacleSimulation::AddObstaclesForNavMesh(KX_NavMeshObject* navmeshobj)
 				obstacle->m_pos = MT_Vector3(vj[0], vj[2], vj[1]);
 				obstacle->m_pos2 = MT_Vector3(vi[0], vi[2], vi[1]);
 				obstacle->m_rad = 0;
+				obstacle->m_worldPos = navmeshobj->TransformToWorldCoords(obstacle->m_pos);
+				obstacle->m_worldPos2 = navmeshobj->TransformToWorldCoords(obstacle->m_pos2);
 			}
 		}
 	}
@@ -240,14 +281,21 @@ void KX_ObstacleSimulation::AddObstaclesForNavMesh(KX_NavMeshObject* navmeshobj)
 
 void KX_ObstacleSimulation::DestroyObstacleForObj(KX_GameObject* gameobj)
 {
+	// Drop the pending requests of the object, its actuators are destructed with it.
+	m_requests.erase(std::remove_if(m_requests.begin(), m_requests.end(),
+	                                [gameobj](const KX_ObstacleRequest& request) { return request.m_obstacle->m_gameObj == gameobj; }),
+	                 m_requests.end());
+
 	for (size_t i=0; i<m_obstacles.size(); )
 	{
 		if (m_obstacles[i]->m_gameObj == gameobj)
 		{
 			KX_Obstacle* obstacle = m_obstacles[i];
 			m_obstacles[i] = m_obstacles.back();
+			m_obstacles[i]->m_index = i;
 			m_obstacles.pop_back();
 			delete obstacle;
+			m_gridDirty = true;
 		}
 		else
 			i++;
@@ -259,7 +307,22 @@ void KX_ObstacleSimulation::UpdateObstacles()
 	for (size_t i=0; i<m_obstacles.size(); i++)
 	{
 		if (m_obstacles[i]->m_type==KX_OBSTACLE_NAV_MESH || m_obstacles[i]->m_shape==KX_OBSTACLE_SEGMENT)
+		{
+			KX_Obstacle* obs = m_obstacles[i];
+			//apply world transform once for all the velocity samples
+			if (obs->m_type == KX_OBSTACLE_NAV_MESH)
+			{
+				KX_NavMeshObject* navmeshobj = static_cast<KX_NavMeshObject*>(obs->m_gameObj);
+				obs->m_worldPos = navmeshobj->TransformToWorldCoords(obs->m_pos);
+				obs->m_worldPos2 = navmeshobj->TransformToWorldCoords(obs->m_pos2);
+			}
+			else
+			{
+				obs->m_worldPos = obs->m_pos;
+				obs->m_worldPos2 = obs->m_pos2;
+			}
 			continue;
+		}
 
 		KX_Obstacle* obs = m_obstacles[i];
 		obs->m_pos = obs->m_gameObj->NodeGetWorldPosition();
@@ -274,6 +337,146 @@ void KX_ObstacleSimulation::UpdateObstacles()
 			add_v2_v2v2(obs->pvel, obs->pvel, &obs->hvel[j * 2]);
 		mul_v2_fl(obs->pvel, 1.0f / VEL_HIST_SIZE);
 	}
+
+	UpdateGrid();
+}
+
+void KX_ObstacleSimulation::UpdateGrid()
+{
+	m_gridDirty = false;
+	m_cellStart.clear();
+	m_cellObstacles.clear();
+	m_maxObstacleSpeed = 0.0f;
+
+	const unsigned int nobs = m_obstacles.size();
+	if (nobs == 0) {
+		m_gridSize[0] = m_gridSize[1] = 0;
+		return;
+	}
+
+	float min[2] = {FLT_MAX, FLT_MAX};
+	float max[2] = {-FLT_MAX, -FLT_MAX};
+	float sumRad = 0.0f;
+	unsigned int ncircles = 0;
+	for (KX_Obstacle *obs : m_obstacles) {
+		float obsMin[2], obsMax[2];
+		obstacleBounds(obs, obsMin, obsMax);
+		minmax_v2v2_v2(min, max, obsMin);
+		minmax_v2v2_v2(min, max, obsMax);
+
+		if (obs->m_shape == KX_OBSTACLE_CIRCLE) {
+			sumRad += obs->m_rad;
+			++ncircles;
+			m_maxObstacleSpeed = std::max(m_maxObstacleSpeed, len_v2(obs->vel));
+		}
+	}
+
+	/* Cells of a few agents wide, but large enough to keep the number of cells
+	 * proportional to the number of obstacles. */
+	const float extent = std::max(max[0] - min[0], max[1] - min[1]);
+	const float meanRad = ncircles ? sumRad / ncircles : 0.0f;
+	m_cellSize = std::max(meanRad * KX_OBSTACLE_CELL_RADIUS_FACTOR,
+	                      extent / sqrtf((float)(nobs * KX_OBSTACLE_CELLS_PER_OBSTACLE)));
+	if (!(m_cellSize > FLT_EPSILON)) {
+		m_cellSize = 1.0f;
+	}
+
+	copy_v2_v2(m_gridMin, min);
+	m_gridSize[0] = (int)((max[0] - min[0]) / m_cellSize) + 1;
+	m_gridSize[1] = (int)((max[1] - min[1]) / m_cellSize) + 1;
+
+	// Count the obstacles per cell, then place them in the cells by increasing index.
+	const unsigned int ncells = m_gridSize[0] * m_gridSize[1];
+	m_cellStart.assign(ncells + 1, 0);
+	for (KX_Obstacle *obs : m_obstacles) {
+		float obsMin[2], obsMax[2];
+		int range[4];
+		obstacleBounds(obs, obsMin, obsMax);
+		GetCellRange(obsMin, obsMax, range);
+		for (int y = range[1]; y <= range[3]; ++y) {
+			for (int x = range[0]; x <= range[2]; ++x) {
+				++m_cellStart[y * m_gridSize[0] + x + 1];
+			}
+		}
+	}
+	for (unsigned int i = 0; i < ncells; ++i) {
+		m_cellStart[i + 1] += m_cellStart[i];
+	}
+
+	m_cellObstacles.resize(m_cellStart[ncells]);
+	std::vector<unsigned int> cellEnd(m_cellStart.begin(), m_cellStart.end() - 1);
+	for (unsigned int i = 0; i < nobs; ++i) {
+		float obsMin[2], obsMax[2];
+		int range[4];
+		obstacleBounds(m_obstacles[i], obsMin, obsMax);
+		GetCellRange(obsMin, obsMax, range);
+		for (int y = range[1]; y <= range[3]; ++y) {
+			for (int x = range[0]; x <= range[2]; ++x) {
+				m_cellObstacles[cellEnd[y * m_gridSize[0] + x]++] = i;
+			}
+		}
+	}
+}
+
+void KX_ObstacleSimulation::GetCellRange(const float min[2], const float max[2], int range[4]) const
+{
+	for (unsigned short axis = 0; axis < 2; ++axis) {
+		const int size = m_gridSize[axis];
+		// Clamp in float first, the coordinates can be far outside of the grid.
+		const float cmin = (min[axis] - m_gridMin[axis]) / m_cellSize;
+		const float cmax = (max[axis] - m_gridMin[axis]) / m_cellSize;
+		range[axis] = (int)clamp(cmin, 0.0f, (float)(size - 1));
+		range[axis + 2] = (int)clamp(cmax, 0.0f, (float)(size - 1));
+	}
+}
+
+void KX_ObstacleSimulation::GetNeighbours(KX_Obstacle *activeObst, float range, KX_Obstacles& neighbours) const
+{
+	neighbours.clear();
+	if (m_cellStart.empty()) {
+		return;
+	}
+
+	const float pos[2] = {(float)activeObst->m_pos.x(), (float)activeObst->m_pos.y()};
+	const float min[2] = {pos[0] - range, pos[1] - range};
+	const float max[2] = {pos[0] + range, pos[1] + range};
+	int cells[4];
+	GetCellRange(min, max, cells);
+
+	std::vector<unsigned int> indices;
+	for (int y = cells[1]; y <= cells[3]; ++y) {
+		for (int x = cells[0]; x <= cells[2]; ++x) {
+			const unsigned int cell = y * m_gridSize[0] + x;
+			indices.insert(indices.end(), m_cellObstacles.begin() + m_cellStart[cell],
+			               m_cellObstacles.begin() + m_cellStart[cell + 1]);
+		}
+	}
+
+	// Obstacles overlapping several cells are found several times, keep the simulation order.
+	std::sort(indices.begin(), indices.end());
+	indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+	for (unsigned int index : indices) {
+		KX_Obstacle *obs = m_obstacles[index];
+		if (obs == activeObst) {
+			continue;
+		}
+
+		float dist;
+		if (obs->m_shape == KX_OBSTACLE_SEGMENT) {
+			const float p[2] = {(float)obs->m_worldPos.x(), (float)obs->m_worldPos.y()};
+			const float q[2] = {(float)obs->m_worldPos2.x(), (float)obs->m_worldPos2.y()};
+			dist = sqrtf(dist_squared_to_line_segment_v2(pos, p, q));
+		}
+		else {
+			const float p[2] = {(float)obs->m_pos.x(), (float)obs->m_pos.y()};
+			dist = len_v2v2(pos, p);
+		}
+
+		if (dist - obs->m_rad <= range) {
+			neighbours.push_back(obs);
+		}
+	}
 }
 
 KX_Obstacle* KX_ObstacleSimulation::GetObstacle(KX_GameObject* gameobj)
@@ -287,6 +490,74 @@ KX_Obstacle* KX_ObstacleSimulation::GetObstacle(KX_GameObject* gameobj)
 	return nullptr;
 }
 
+void KX_ObstacleSimulation::RequestObstacleVelocity(KX_SteeringActuator *actuator, KX_Obstacle *activeObst,
+                                                    KX_NavMeshObject *activeNavMeshObj, const MT_Vector3& velocity,
+                                                    MT_Scalar maxDeltaSpeed, MT_Scalar maxDeltaAngle)
+{
+	/* The desired velocity is set now so that all the requests are solved
+	 * with the desired velocities of the current frame. */
+	vset(activeObst->dvel, velocity.x(), velocity.y());
+
+	KX_ObstacleRequest request;
+	request.m_obstacle = activeObst;
+	request.m_navmesh = activeNavMeshObj;
+	request.m_actuator = actuator;
+	request.m_velocity = velocity;
+	request.m_maxDeltaSpeed = maxDeltaSpeed;
+	request.m_maxDeltaAngle = maxDeltaAngle;
+	m_requests.push_back(request);
+}
+
+void KX_ObstacleSimulation::SolveRequests(unsigned int begin, unsigned int end)
+{
+	for (unsigned int i = begin; i < end; ++i) {
+		KX_ObstacleRequest& request = m_requests[i];
+		AdjustObstacleVelocity(request.m_obstacle, request.m_navmesh, request.m_velocity,
+		                       request.m_maxDeltaSpeed, request.m_maxDeltaAngle);
+	}
+}
+
+void KX_ObstacleSimulation::SolveTask(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	KX_ObstacleSimulation *simulation = (KX_ObstacleSimulation *)BLI_task_pool_userdata(pool);
+	const unsigned int begin = GET_UINT_FROM_POINTER(taskdata);
+	const unsigned int end = std::min(begin + KX_OBSTACLE_TASK_SIZE, (unsigned int)simulation->m_requests.size());
+	simulation->SolveRequests(begin, end);
+}
+
+void KX_ObstacleSimulation::SolveObstacles()
+{
+	if (m_requests.empty()) {
+		return;
+	}
+
+	// Obstacles were added or removed during the logic frame.
+	if (m_gridDirty) {
+		UpdateGrid();
+	}
+
+	const unsigned int nreq = m_requests.size();
+	TaskScheduler *scheduler = KX_GetActiveEngine()->GetTaskScheduler();
+	if (!scheduler || nreq <= KX_OBSTACLE_TASK_SIZE) {
+		SolveRequests(0, nreq);
+	}
+	else {
+		// Each request only writes the new velocity of its obstacle.
+		TaskPool *pool = BLI_task_pool_create(scheduler, this);
+		for (unsigned int begin = 0; begin < nreq; begin += KX_OBSTACLE_TASK_SIZE) {
+			BLI_task_pool_push(pool, SolveTask, SET_UINT_IN_POINTER(begin), false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+
+	// The actuators move their objects, apply the velocities in the logic order.
+	for (KX_ObstacleRequest& request : m_requests) {
+		request.m_actuator->ApplyVelocity(request.m_velocity);
+	}
+	m_requests.clear();
+}
+
 void KX_ObstacleSimulation::AdjustObstacleVelocity(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
 										MT_Vector3& velocity, MT_Scalar maxDeltaSpeed,MT_Scalar maxDeltaAngle)
 {
@@ -381,15 +652,20 @@ KX_ObstacleSimulationTOI::KX_ObstacleSimulationTOI(MT_Scalar levelHeight, bool e
 void KX_ObstacleSimulationTOI::AdjustObstacleVelocity(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
                                                       MT_Vector3& velocity, MT_Scalar maxDeltaSpeed, MT_Scalar maxDeltaAngle)
 {
-	int nobs = m_obstacles.size();
-	int obstidx = std::find(m_obstacles.begin(), m_obstacles.end(), activeObst) - m_obstacles.begin();
-	if (obstidx == nobs)
+	if (activeObst->m_index >= m_obstacles.size() || m_obstacles[activeObst->m_index] != activeObst)
 		return;
 
-	vset(activeObst->dvel, velocity.x(), velocity.y());
+	/* Only the obstacles reachable before the maximum time of impact change the
+	 * sampling, bound the relative speed of all the velocity samples. */
+	const float sampleSpeed = 2.0f * len_v2(activeObst->dvel);
+	const float relSpeed = 2.0f * sampleSpeed + len_v2(activeObst->vel) + m_maxObstacleSpeed;
+	const float range = relSpeed * m_maxToi + std::max((float)activeObst->m_rad, 0.01f);
+
+	KX_Obstacles neighbours;
+	GetNeighbours(activeObst, range, neighbours);
 
 	//apply RVO
-	sampleRVO(activeObst, activeNavMeshObj, maxDeltaAngle);
+	sampleRVO(activeObst, activeNavMeshObj, neighbours, maxDeltaAngle);
 
 	// Fake dynamic constraint.
 	float dv[2];
@@ -429,7 +705,7 @@ KX_ObstacleSimulationTOI_rays::KX_ObstacleSimulationTOI_rays(MT_Scalar levelHeig
 
 
 void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-										const float maxDeltaAngle)
+										const KX_Obstacles& neighbours, const float maxDeltaAngle)
 {
 	MT_Vector2 vel(activeObst->dvel[0], activeObst->dvel[1]);
 	float vmax = (float) vel.length();
@@ -450,7 +726,7 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 	const int iforw = m_maxSamples/2;
 	const float aoff = (float)iforw / (float)m_maxSamples;
 
-	size_t nobs = m_obstacles.size();
+	const size_t nobs = neighbours.size();
 	for (int iter = 0; iter < m_maxSamples; ++iter)
 	{
 		// Calculate sample velocity
@@ -463,9 +739,9 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 		// Find min time of impact and exit amongst all obstacles.
 		float tmin = m_maxToi;
 		float tmine = 0.0f;
-		for (int i = 0; i < nobs; ++i)
+		for (size_t i = 0; i < nobs; ++i)
 		{
-			KX_Obstacle* ob = m_obstacles[i];
+			KX_Obstacle* ob = neighbours[i];
 			bool res = filterObstacle(activeObst, activeNavMeshObj, ob, m_levelHeight);
 			if (!res)
 				continue;
@@ -493,15 +769,8 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 			}
 			else if (ob->m_shape == KX_OBSTACLE_SEGMENT)
 			{
-				MT_Vector3 p1 = ob->m_pos;
-				MT_Vector3 p2 = ob->m_pos2;
-				//apply world transform
-				if (ob->m_type == KX_OBSTACLE_NAV_MESH)
-				{
-					KX_NavMeshObject* navmeshobj = static_cast<KX_NavMeshObject*>(ob->m_gameObj);
-					p1 = navmeshobj->TransformToWorldCoords(p1);
-					p2 = navmeshobj->TransformToWorldCoords(p2);
-				}
+				const MT_Vector3& p1 = ob->m_worldPos;
+				const MT_Vector3& p2 = ob->m_worldPos2;
 
 				if (!sweepCircleSegment(activeObst->m_pos.to2d(), activeObst->m_rad, svel,
 				                        p1.to2d(), p2.to2d(), ob->m_rad, htmin, htmax))
@@ -576,7 +845,7 @@ void KX_ObstacleSimulationTOI_rays::sampleRVO(KX_Obstacle* activeObst, KX_NavMes
 ///////////********* TOI_cells**********/////////////////
 
 static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-                           KX_Obstacles& obstacles,  float levelHeight, const float vmax,
+                           const KX_Obstacles& obstacles,  float levelHeight, const float vmax,
                            const float* spos, const float cs, const int nspos, float* res,
                            float maxToi, float velWeight, float curVelWeight, float sideWeight,
                            float toiWeight)
@@ -665,15 +934,8 @@ static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 			}
 			else if (ob->m_shape == KX_OBSTACLE_SEGMENT)
 			{
-				MT_Vector3 p1 = ob->m_pos;
-				MT_Vector3 p2 = ob->m_pos2;
-				//apply world transform
-				if (ob->m_type == KX_OBSTACLE_NAV_MESH)
-				{
-					KX_NavMeshObject* navmeshobj = static_cast<KX_NavMeshObject*>(ob->m_gameObj);
-					p1 = navmeshobj->TransformToWorldCoords(p1);
-					p2 = navmeshobj->TransformToWorldCoords(p2);
-				}
+				const MT_Vector3& p1 = ob->m_worldPos;
+				const MT_Vector3& p2 = ob->m_worldPos2;
 				float p[2], q[2];
 				vset(p, p1.x(), p1.y());
 				vset(q, p2.x(), p2.y());
@@ -736,7 +998,7 @@ static void processSamples(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavM
 }
 
 void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-					   const float maxDeltaAngle)
+					   const KX_Obstacles& neighbours, const float maxDeltaAngle)
 {
 	vset(activeObst->nvel, 0.f, 0.f);
 	float vmax = len_v2(activeObst->dvel);
@@ -767,7 +1029,7 @@ void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMe
 				}
 			}
 		}
-		processSamples(activeObst, activeNavMeshObj, m_obstacles, m_levelHeight, vmax, spos, cs/2, 
+		processSamples(activeObst, activeNavMeshObj, neighbours, m_levelHeight, vmax, spos, cs/2, 
 			nspos,  activeObst->nvel, m_maxToi, m_velWeight, m_curVelWeight, m_collisionWeight, m_toiWeight);
 	}
 	else
@@ -802,7 +1064,7 @@ void KX_ObstacleSimulationTOI_cells::sampleRVO(KX_Obstacle* activeObst, KX_NavMe
 				}
 			}
 
-			processSamples(activeObst, activeNavMeshObj, m_obstacles, m_levelHeight, vmax, spos, cs/2,
+			processSamples(activeObst, activeNavMeshObj, neighbours, m_levelHeight, vmax, spos, cs/2,
 			               nspos,  res, m_maxToi, m_velWeight, m_curVelWeight, m_collisionWeight, m_toiWeight);
 
 			cs *= 0.5f;
@@ -32,6 +32,7 @@
 
 class KX_GameObject;
 class KX_NavMeshObject;
+class KX_SteeringActuator;
 
 enum KX_OBSTACLE_TYPE
 {
@@ -61,11 +62,28 @@ struct KX_Obstacle
 	float hvel[VEL_HIST_SIZE*2];
 	int hhead;
 
-	
+	/// World position of the segment ends, updated with the obstacles.
+	MT_Vector3 m_worldPos;
+	MT_Vector3 m_worldPos2;
+
+	/// Index of the obstacle in the simulation list.
+	unsigned int m_index;
+
 	KX_GameObject* m_gameObj;
 };
 typedef std::vector<KX_Obstacle*> KX_Obstacles;
 
+/// Velocity adjustment requested by a steering actuator, solved at the end of the logic frame.
+struct KX_ObstacleRequest
+{
+	KX_Obstacle *m_obstacle;
+	KX_NavMeshObject *m_navmesh;
+	KX_SteeringActuator *m_actuator;
+	MT_Vector3 m_velocity;
+	MT_Scalar m_maxDeltaSpeed;
+	MT_Scalar m_maxDeltaAngle;
+};
+
 class KX_ObstacleSimulation
 {
 protected:
@@ -74,7 +92,29 @@ protected:
 	MT_Scalar m_levelHeight;
 	bool m_enableVisualization;
 
+	/** Uniform grid of the obstacles in the XY plane, each cell lists the obstacles
+	 * overlapping it in m_cellObstacles from m_cellStart[cell] to m_cellStart[cell + 1].
+	 */
+	float m_gridMin[2];
+	int m_gridSize[2];
+	float m_cellSize;
+	std::vector<unsigned int> m_cellStart;
+	std::vector<unsigned int> m_cellObstacles;
+	/// The obstacles were added or removed since the last grid update.
+	bool m_gridDirty;
+	/// Maximum speed of the circle obstacles, used to bound the neighbour queries.
+	float m_maxObstacleSpeed;
+
+	std::vector<KX_ObstacleRequest> m_requests;
+	void SolveRequests(unsigned int begin, unsigned int end);
+	static void SolveTask(struct TaskPool *__restrict pool, void *taskdata, int threadid);
+
 	KX_Obstacle* CreateObstacle(KX_GameObject* gameobj);
+	void UpdateGrid();
+	/// Get the cells overlapped by a box as [xmin, ymin, xmax, ymax].
+	void GetCellRange(const float min[2], const float max[2], int range[4]) const;
+	/// Fill neighbours with the obstacles closer than range to the active obstacle, in simulation order.
+	void GetNeighbours(KX_Obstacle *activeObst, float range, KX_Obstacles& neighbours) const;
 public:
 	KX_ObstacleSimulation(MT_Scalar levelHeight, bool enableVisualization);
 	virtual ~KX_ObstacleSimulation();
@@ -87,6 +127,17 @@ public:
 	void AddObstaclesForNavMesh(KX_NavMeshObject* navmesh);
 	KX_Obstacle* GetObstacle(KX_GameObject* gameobj);
 	void UpdateObstacles();
+	/** Request the adjustment of the velocity of an obstacle, the adjusted velocity is
+	 * applied to the actuator by SolveObstacles.
+	 */
+	void RequestObstacleVelocity(KX_SteeringActuator *actuator, KX_Obstacle *activeObst, KX_NavMeshObject *activeNavMeshObj,
+	                             const MT_Vector3& velocity, MT_Scalar maxDeltaSpeed, MT_Scalar maxDeltaAngle);
+	/// Adjust the velocities of all the requests in parallel and apply them to the actuators.
+	void SolveObstacles();
+	/** Adjust the desired velocity of an obstacle to avoid the other obstacles.
+	 * The desired velocity of the obstacle (dvel) must be set before, this function only
+	 * writes the obstacle new velocity and can be called for several obstacles in parallel.
+	 */
 	virtual void AdjustObstacleVelocity(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
 	                                    MT_Vector3& velocity, MT_Scalar maxDeltaSpeed,MT_Scalar maxDeltaAngle);
 
@@ -103,7 +154,7 @@ protected:
 	float m_collisionWeight;		// Sample selection collision weight
 
 	virtual void sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-							const float maxDeltaAngle) = 0;
+							const KX_Obstacles& neighbours, const float maxDeltaAngle) = 0;
 public:
 	KX_ObstacleSimulationTOI(MT_Scalar levelHeight, bool enableVisualization);
 	virtual void AdjustObstacleVelocity(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
@@ -114,7 +165,7 @@ class KX_ObstacleSimulationTOI_rays: public KX_ObstacleSimulationTOI
 {
 protected:
 	virtual void sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-							const float maxDeltaAngle);
+							const KX_Obstacles& neighbours, const float maxDeltaAngle);
 public:
 	KX_ObstacleSimulationTOI_rays(MT_Scalar levelHeight, bool enableVisualization);
 };
@@ -126,7 +177,7 @@ protected:
 	bool m_adaptive;
 	int m_sampleRadius;
 	virtual void sampleRVO(KX_Obstacle* activeObst, KX_NavMeshObject* activeNavMeshObj, 
-							const float maxDeltaAngle);
+							const KX_Obstacles& neighbours, const float maxDeltaAngle);
 public:
 	KX_ObstacleSimulationTOI_cells(MT_Scalar levelHeight, bool enableVisualization);
 };
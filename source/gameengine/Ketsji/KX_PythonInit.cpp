@@ -94,12 +94,14 @@ extern "C" {
 #include "SCA_PythonJoystick.h"
 #include "SCA_PythonKeyboard.h"
 #include "SCA_PythonMouse.h"
+#include "SCA_PythonBytecodeCache.h"
 #include "SCA_2DFilterActuator.h"
 #include "KX_ConstraintActuator.h"
 #include "KX_SoundActuator.h"
 #include "KX_StateActuator.h"
 #include "BL_ActionActuator.h"
 #include "BL_ArmatureObject.h"
+#include "BL_SkinCache.h"
 #include "RAS_Rasterizer.h"
 #include "RAS_ICanvas.h"
 #include "RAS_BucketManager.h"
@@ -123,10 +125,13 @@ extern "C" {
 #include "KX_PythonInitTypes.h"
 
 #include "CM_Message.h"
+#include "CM_Trace.h"
 
 /* we only need this to get a list of libraries from the main struct */
 #include "DNA_ID.h"
 #include "DNA_scene_types.h"
+#include "DNA_text_types.h"
+#include "DNA_packedFile_types.h"
 
 #include "PHY_IPhysicsEnvironment.h"
 
@@ -136,6 +141,8 @@ extern "C" {
 #include "BKE_library.h"
 #include "BKE_appdir.h"
 #include "BKE_blender_version.h"
+#include "BKE_text.h"
+#include "BKE_packedFile.h"
 #include "BLI_blenlib.h"
 #include "GPU_material.h"
 #include "MEM_guardedalloc.h"
@@ -156,6 +163,8 @@ extern "C" {
 static SCA_PythonKeyboard* gp_PythonKeyboard = nullptr;
 static SCA_PythonMouse* gp_PythonMouse = nullptr;
 static SCA_PythonJoystick* gp_PythonJoysticks[JOYINDEX_MAX] = {nullptr};
+/// Path of the bytecode cache file, empty if the cache is not saved.
+static std::string gp_BytecodeCachePath;
 
 static struct {
 	PyObject *path;
@@ -301,6 +310,61 @@ static PyObject *gPyGetProfileInfo(PyObject *)
 	return KX_GetActiveEngine()->GetPyProfileDict();
 }
 
+PyDoc_STRVAR(gPyGetSkinningCacheInfo_doc,
+"getSkinningCacheInfo()\n"
+"returns a dictionary with the hits and misses of the shared armature deformations since the game start"
+);
+static PyObject *gPyGetSkinningCacheInfo(PyObject *)
+{
+	unsigned int hits;
+	unsigned int misses;
+	BL_SkinCache::GetStatistics(hits, misses);
+
+	const unsigned int total = hits + misses;
+	return Py_BuildValue("{s:I,s:I,s:f}", "hits", hits, "misses", misses,
+						 "hitRatio", (total > 0) ? (float)hits / (float)total : 0.0f);
+}
+
+PyDoc_STRVAR(gPyStartTrace_doc,
+"startTrace()\n"
+"Start recording a timeline of the engine, the previously recorded spans are cleared"
+);
+static PyObject *gPyStartTrace(PyObject *)
+{
+	CM_Trace::Start();
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyStopTrace_doc,
+"stopTrace()\n"
+"Stop recording a timeline of the engine"
+);
+static PyObject *gPyStopTrace(PyObject *)
+{
+	CM_Trace::Stop();
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyWriteTrace_doc,
+"writeTrace(filepath)\n"
+"Write the recorded timeline in a Chrome trace event file, returns True on success\n"
+" filepath - the file path, '//' at the start of the string defines a path relative to the .blend file"
+);
+static PyObject *gPyWriteTrace(PyObject *, PyObject *args)
+{
+	char expanded[FILE_MAX];
+	char *filepath;
+
+	if (!PyArg_ParseTuple(args, "s:writeTrace", &filepath)) {
+		return nullptr;
+	}
+
+	BLI_strncpy(expanded, filepath, FILE_MAX);
+	BLI_path_abs(expanded, KX_GetMainPath().c_str());
+
+	return PyBool_FromLong(CM_Trace::Write(expanded));
+}
+
 PyDoc_STRVAR(gPySendMessage_doc,
 "sendMessage(subject, [body, to, from])\n"
 "sends a message in same manner as a message actuator"
@@ -402,6 +466,29 @@ static PyObject *gPyGetMaxLogicFrame(PyObject *)
 	return PyLong_FromLong(KX_GetActiveEngine()->GetMaxLogicFrame());
 }
 
+PyDoc_STRVAR(gPySetLibLoadMergeBudget_doc,
+"setLibLoadMergeBudget(budget)\n"
+"Sets the time in milliseconds allowed per logic frame to merge the asynchronously loaded libraries, 0 for unlimited"
+);
+static PyObject *gPySetLibLoadMergeBudget(PyObject *, PyObject *args)
+{
+	float budget;
+	if (!PyArg_ParseTuple(args, "f:setLibLoadMergeBudget", &budget))
+		return nullptr;
+
+	KX_GetActiveEngine()->GetConverter()->SetMergeBudget(budget);
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gPyGetLibLoadMergeBudget_doc,
+"getLibLoadMergeBudget()\n"
+"Gets the time in milliseconds allowed per logic frame to merge the asynchronously loaded libraries"
+);
+static PyObject *gPyGetLibLoadMergeBudget(PyObject *)
+{
+	return PyFloat_FromDouble(KX_GetActiveEngine()->GetConverter()->GetMergeBudget());
+}
+
 static PyObject *gPySetMaxPhysicsFrame(PyObject *, PyObject *args)
 {
 	int frame;
@@ -832,11 +919,17 @@ static struct PyMethodDef game_methods[] = {
 	{"PrintMemInfo", (PyCFunction)pyPrintStats, METH_NOARGS, (const char *)"Print engine statistics"},
 	{"NextFrame", (PyCFunction)gPyNextFrame, METH_NOARGS, (const char *)"Render next frame (if Python has control)"},
 	{"getProfileInfo", (PyCFunction)gPyGetProfileInfo, METH_NOARGS, gPyGetProfileInfo_doc},
+	{"getSkinningCacheInfo", (PyCFunction)gPyGetSkinningCacheInfo, METH_NOARGS, gPyGetSkinningCacheInfo_doc},
+	{"startTrace", (PyCFunction)gPyStartTrace, METH_NOARGS, gPyStartTrace_doc},
+	{"stopTrace", (PyCFunction)gPyStopTrace, METH_NOARGS, gPyStopTrace_doc},
+	{"writeTrace", (PyCFunction)gPyWriteTrace, METH_VARARGS, gPyWriteTrace_doc},
 	/* library functions */
 	{"LibLoad", (PyCFunction)gLibLoad, METH_VARARGS|METH_KEYWORDS, (const char *)""},
 	{"LibNew", (PyCFunction)gLibNew, METH_VARARGS, (const char *)""},
 	{"LibFree", (PyCFunction)gLibFree, METH_VARARGS, (const char *)""},
 	{"LibList", (PyCFunction)gLibList, METH_VARARGS, (const char *)""},
+	{"getLibLoadMergeBudget", (PyCFunction)gPyGetLibLoadMergeBudget, METH_NOARGS, gPyGetLibLoadMergeBudget_doc},
+	{"setLibLoadMergeBudget", (PyCFunction)gPySetLibLoadMergeBudget, METH_VARARGS, gPySetLibLoadMergeBudget_doc},
 	
 	{nullptr, (PyCFunction) nullptr, 0, nullptr }
 };
@@ -2158,6 +2251,106 @@ void setupGamePython(KX_KetsjiEngine* ketsjiengine, Main *blenderdata,
 		PyDict_SetItemString(PyModule_GetDict(*gameLogic), "globalDict", pyGlobalDict); // Same as importing the module.z
 }
 
+/// Return the source and the file name used to compile a text block module.
+static bool getPythonTextSource(Text *text, std::string& source, std::string& name)
+{
+	if (!BLI_testextensie(text->id.name + 2, ".py")) {
+		return false;
+	}
+
+	char fn[FILE_MAX];
+	bpy_text_filename_get(fn, sizeof(fn), text);
+	name = fn;
+
+	char *buf = txt_to_buf(text);
+	source = buf;
+	MEM_freeN(buf);
+
+	return true;
+}
+
+void initGamePythonBytecodeCache(Main *maggie, GameData *gm, bool player)
+{
+	gp_BytecodeCachePath.clear();
+	if (gm->flag & GAME_PYTHON_BYTECODE_CACHE) {
+		if (gm->flag & GAME_PYTHON_BYTECODE_PACK) {
+			/* In Blender the texts can be edited, the scripts are compiled from them and packed
+			 * again at the end of the game, only the player runs the packed bytecode. */
+			if (player && gm->pybytecode && !SCA_PythonBytecodeCache::LoadData((const char *)gm->pybytecode->data, gm->pybytecode->size)) {
+				CM_Warning("invalid packed python bytecode cache, the scripts are compiled again");
+			}
+		}
+		else if (maggie->name[0] != '\0') {
+			// Next to the blend file or the runtime executable.
+			gp_BytecodeCachePath = maggie->name;
+			if (BLI_testextensie(maggie->name, ".blend")) {
+				gp_BytecodeCachePath.resize(gp_BytecodeCachePath.size() - 6);
+			}
+			gp_BytecodeCachePath += ".bgepyc";
+
+			SCA_PythonBytecodeCache::Load(gp_BytecodeCachePath);
+		}
+	}
+
+	// Text block modules are compiled only if no code is already set.
+	std::string source;
+	std::string name;
+	for (Text *text = (Text *)maggie->text.first; text; text = (Text *)text->id.next) {
+		if (text->compiled || !getPythonTextSource(text, source, name)) {
+			continue;
+		}
+
+		text->compiled = SCA_PythonBytecodeCache::Find(source, name);
+	}
+}
+
+/// Replace the packed cache of the game settings by the current entries.
+static void packGamePythonBytecodeCache(GameData *gm)
+{
+	std::string data;
+	SCA_PythonBytecodeCache::GetData(data);
+
+	void *mem = MEM_mallocN(data.size(), "pybytecode");
+	memcpy(mem, data.data(), data.size());
+
+	if (gm->pybytecode) {
+		freePackedFile(gm->pybytecode);
+	}
+	gm->pybytecode = newPackedFileMemory(mem, data.size());
+}
+
+void exitGamePythonBytecodeCache(Main *maggie, GameData *gm)
+{
+	std::string source;
+	std::string name;
+	for (Text *text = (Text *)maggie->text.first; text; text = (Text *)text->id.next) {
+		if (!text->compiled || !getPythonTextSource(text, source, name)) {
+			continue;
+		}
+
+		SCA_PythonBytecodeCache::Add(source, name, (PyObject *)text->compiled);
+	}
+
+	const bool pack = (gm->flag & GAME_PYTHON_BYTECODE_CACHE) && (gm->flag & GAME_PYTHON_BYTECODE_PACK);
+	if (pack) {
+		/* The packed data is saved with the blend file when the game ran in Blender,
+		 * in a runtime it's only refreshed for the next start of the same session. */
+		if (!gm->pybytecode || SCA_PythonBytecodeCache::IsModified()) {
+			packGamePythonBytecodeCache(gm);
+		}
+	}
+	else if (gm->pybytecode) {
+		freePackedFile(gm->pybytecode);
+		gm->pybytecode = nullptr;
+	}
+
+	if (!gp_BytecodeCachePath.empty() && !SCA_PythonBytecodeCache::Save(gp_BytecodeCachePath)) {
+		CM_Warning("failed to save the python bytecode cache: " << gp_BytecodeCachePath);
+	}
+
+	SCA_PythonBytecodeCache::Clear();
+}
+
 void createPythonConsole()
 {
 	// Use an external file, by this way the user can modify it.
@@ -61,6 +61,15 @@ std::string pathGamePythonConfig();
 void saveGamePythonConfig();
 void loadGamePythonConfig();
 
+/** Prepare the bytecode cache of the scripts and text block modules.
+ * \param gm The game settings of the start scene, the cache is loaded from the data
+ * packed in these settings or from the cache file next to the blend file.
+ * \param player The packed data is only loaded in the player, Blender compiles the edited texts.
+ */
+void initGamePythonBytecodeCache(Main *maggie, struct GameData *gm, bool player);
+/// Register the compiled text block modules, save or pack the cache if needed and release the cache.
+void exitGamePythonBytecodeCache(Main *maggie, struct GameData *gm);
+
 /// Create a python interpreter and stop the engine until the interpreter is active.
 void createPythonConsole();
 
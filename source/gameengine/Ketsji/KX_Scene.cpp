@@ -57,6 +57,7 @@
 #include "SCA_JoystickManager.h"
 #include "KX_PyMath.h"
 #include "RAS_MeshObject.h"
+#include "RAS_MeshUser.h"
 #include "SCA_IScene.h"
 #include "KX_LodManager.h"
 #include "KX_CullingHandler.h"
@@ -73,10 +74,13 @@
 #include "SCA_IActuator.h"
 #include "SG_Node.h"
 #include "SG_Controller.h"
+#include "SG_TransformPool.h"
 #include "SG_Node.h"
 #include "DNA_group_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_object_types.h"
 #include "DNA_property_types.h"
+#include "DNA_constraint_types.h"
 
 #include "KX_NodeRelationships.h"
 
@@ -106,6 +110,10 @@
 
 #include "CM_Message.h"
 #include "CM_List.h"
+#include "CM_Trace.h"
+
+#include <climits>
+#include <unordered_map>
 
 static void *KX_SceneReplicationFunc(SG_Node* node,void* gameobj,void* scene)
 {
@@ -198,8 +206,11 @@ KX_Scene::KX_Scene(SCA_IInputDevice *inputDevice,
 	KX_TextMaterial *textMaterial = new KX_TextMaterial();
 	m_bucketmanager=new RAS_BucketManager(textMaterial);
 	m_boundingBoxManager = new RAS_BoundingBoxManager();
+	m_transformPool = std::make_shared<SG_TransformPool>();
 
 	m_animationPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), &m_animationPoolData);
+	m_sceneGraphPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), nullptr);
+	m_cullingPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), nullptr);
 
 #ifdef WITH_PYTHON
 	m_attr_dict = nullptr;
@@ -232,6 +243,14 @@ KX_Scene::~KX_Scene()
 		BLI_task_pool_free(m_animationPool);
 	}
 
+	if (m_sceneGraphPool) {
+		BLI_task_pool_free(m_sceneGraphPool);
+	}
+
+	if (m_cullingPool) {
+		BLI_task_pool_free(m_cullingPool);
+	}
+
 	if (m_objectlist)
 		m_objectlist->Release();
 
@@ -318,6 +337,11 @@ RAS_BoundingBoxManager *KX_Scene::GetBoundingBoxManager() const
 	return m_boundingBoxManager;
 }
 
+const std::shared_ptr<SG_TransformPool>& KX_Scene::GetTransformPool() const
+{
+	return m_transformPool;
+}
+
 EXP_ListValue<KX_GameObject> *KX_Scene::GetObjectList() const
 {
 	return m_objectlist;
@@ -469,7 +493,7 @@ KX_GameObject* KX_Scene::AddNodeReplicaObject(SG_Node* node, KX_GameObject *game
 	}
 	else
 	{
-		m_rootnode = new SG_Node(newobj,this,KX_Scene::m_callbacks);
+		m_rootnode = new SG_Node(newobj,this,KX_Scene::m_callbacks, m_transformPool);
 	
 		// this fixes part of the scaling-added object bug
 		SG_Node* orgnode = gameobj->GetSGNode();
@@ -1132,6 +1156,8 @@ void KX_Scene::CalculateVisibleMeshes(std::vector<KX_GameObject *>& objects, KX_
 
 void KX_Scene::CalculateVisibleMeshes(std::vector<KX_GameObject *>& objects, const SG_Frustum& frustum, int layer)
 {
+	CM_TRACE_SCOPE("Culling", "culling", m_sceneName.c_str());
+
 	m_boundingBoxManager->Update(false);
 
 	bool dbvt_culling = false;
@@ -1162,7 +1188,7 @@ void KX_Scene::CalculateVisibleMeshes(std::vector<KX_GameObject *>& objects, con
 		dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback, &info, planes, m_dbvt_occlusion_res, viewport, matrix);
 	}
 	if (!dbvt_culling) {
-		KX_CullingHandler handler(objects, frustum);
+		m_cullingObjects.clear();
 		for (KX_GameObject *gameobj : m_objectlist) {
 			if (gameobj->UseCulling() && gameobj->GetVisible() && (layer == 0 || gameobj->GetLayer() & layer)) {
 				if (gameobj->GetDeformer()) {
@@ -1175,14 +1201,179 @@ void KX_Scene::CalculateVisibleMeshes(std::vector<KX_GameObject *>& objects, con
 				// Update the object bounding volume box.
 				gameobj->UpdateBounds(false);
 
-				handler.Process(gameobj);
+				m_cullingObjects.push_back(gameobj);
 			}
 		}
+
+		// The culling tests are read only and made in parallel, the updates above are not thread safe.
+		KX_CullingHandler handler(objects, frustum);
+		handler.Process(m_cullingObjects, m_cullingPool);
 	}
 
 	m_boundingBoxManager->ClearModified();
 }
 
+void KX_Scene::PhysicsMultiCullingCallback(KX_ClientObjectInfo *objectInfo, unsigned int viewMask, void *cullingInfo)
+{
+	MultiCullingInfo *info = static_cast<MultiCullingInfo *>(cullingInfo);
+	KX_GameObject *gameobj = objectInfo->m_gameobject;
+	if (!gameobj->GetVisible() || !gameobj->UseCulling()) {
+		return;
+	}
+
+	unsigned int layerViewMask = 0;
+	for (unsigned int i = 0, size = info->m_layers.size(); i < size; ++i) {
+		if (!(viewMask & (1u << i))) {
+			continue;
+		}
+		const int layer = info->m_layers[i];
+		if (layer && !(gameobj->GetLayer() & layer)) {
+			continue;
+		}
+		info->m_objects[info->m_begin + i].push_back(gameobj);
+		layerViewMask |= (1u << i);
+	}
+
+	if (layerViewMask != 0) {
+		info->m_viewCulling.push_back({gameobj, info->m_begin / PHY_MAX_CULLING_VIEWS, layerViewMask});
+	}
+}
+
+void KX_Scene::CalculateVisibleMeshes(std::vector<std::vector<KX_GameObject *> >& objects, const std::vector<SG_Frustum>& frustums,
+		const std::vector<int>& layers)
+{
+	CM_TRACE_SCOPE("Multi View Culling", "culling", m_sceneName.c_str());
+
+	const unsigned int numViews = frustums.size();
+	BLI_assert(layers.size() == numViews);
+
+	objects.resize(numViews);
+	for (std::vector<KX_GameObject *>& viewObjects : objects) {
+		viewObjects.clear();
+	}
+	m_viewCulling.clear();
+
+	// The view mask of the culling tree is limited, cull the views by group.
+	for (unsigned int begin = 0; begin < numViews; begin += PHY_MAX_CULLING_VIEWS) {
+		CalculateVisibleMeshesGroup(objects, frustums, layers, begin, std::min(begin + PHY_MAX_CULLING_VIEWS, numViews));
+	}
+}
+
+void KX_Scene::CalculateVisibleMeshesGroup(std::vector<std::vector<KX_GameObject *> >& objects, const std::vector<SG_Frustum>& frustums,
+		const std::vector<int>& layers, unsigned int begin, unsigned int end)
+{
+	// Occlusion culling uses a buffer per view, cull each view separately.
+	if (m_dbvt_culling && m_dbvt_occlusion_res) {
+		for (unsigned int i = begin; i < end; ++i) {
+			CalculateVisibleMeshes(objects[i], frustums[i], layers[i]);
+		}
+		AddViewCulling(objects, begin, end);
+		return;
+	}
+
+	m_boundingBoxManager->Update(false);
+
+	// Layers used by any view, 0 if a view uses all the layers.
+	int allLayers = 0;
+	for (unsigned int i = begin; i < end; ++i) {
+		if (layers[i] == 0) {
+			allLayers = 0;
+			break;
+		}
+		allLayers |= layers[i];
+	}
+
+	bool dbvt_culling = false;
+	if (m_dbvt_culling) {
+		for (KX_GameObject *gameobj : m_objectlist) {
+			// The views set the culling state of the objects they see in ApplyCulling.
+			gameobj->SetCulled(true);
+			if (gameobj->GetDeformer()) {
+				/** Update all the deformer, not only per material.
+				 * One of the side effect is to clear some flags about AABB calculation.
+				 * like in KX_SoftBodyDeformer.
+				 */
+				gameobj->GetDeformer()->UpdateBuckets();
+			}
+			// Update the object bounding volume box.
+			gameobj->UpdateBounds(false);
+		}
+
+		std::vector<std::array<MT_Vector4, 6> > planes;
+		for (unsigned int i = begin; i < end; ++i) {
+			planes.push_back(frustums[i].GetPlanes());
+		}
+		const std::vector<int> groupLayers(layers.begin() + begin, layers.begin() + end);
+		MultiCullingInfo info(groupLayers, objects, begin, m_viewCulling);
+
+		dbvt_culling = m_physicsEnvironment->MultiCullingTest(PhysicsMultiCullingCallback, &info, planes);
+	}
+	if (!dbvt_culling) {
+		m_cullingObjects.clear();
+		for (KX_GameObject *gameobj : m_objectlist) {
+			gameobj->SetCulled(true);
+			if (gameobj->UseCulling() && gameobj->GetVisible() && (allLayers == 0 || gameobj->GetLayer() & allLayers)) {
+				if (gameobj->GetDeformer()) {
+					gameobj->GetDeformer()->UpdateBuckets();
+				}
+				gameobj->UpdateBounds(false);
+
+				m_cullingObjects.push_back(gameobj);
+			}
+		}
+
+		std::vector<KX_GameObject *> viewObjects;
+		for (unsigned int i = begin; i < end; ++i) {
+			const int layer = layers[i];
+			viewObjects.clear();
+			for (KX_GameObject *gameobj : m_cullingObjects) {
+				if (layer == 0 || gameobj->GetLayer() & layer) {
+					viewObjects.push_back(gameobj);
+				}
+			}
+
+			KX_CullingHandler handler(objects[i], frustums[i]);
+			handler.Process(viewObjects, m_cullingPool);
+		}
+		AddViewCulling(objects, begin, end);
+	}
+
+	m_boundingBoxManager->ClearModified();
+}
+
+void KX_Scene::AddViewCulling(const std::vector<std::vector<KX_GameObject *> >& objects, unsigned int begin, unsigned int end)
+{
+	std::unordered_map<KX_GameObject *, unsigned int> viewMasks;
+	for (unsigned int i = begin; i < end; ++i) {
+		for (KX_GameObject *gameobj : objects[i]) {
+			viewMasks[gameobj] |= (1u << (i - begin));
+		}
+	}
+
+	const unsigned int group = begin / PHY_MAX_CULLING_VIEWS;
+	for (const std::pair<KX_GameObject * const, unsigned int>& pair : viewMasks) {
+		m_viewCulling.push_back({pair.first, group, pair.second});
+	}
+}
+
+void KX_Scene::ApplyCulling(unsigned int view)
+{
+	const unsigned int group = view / PHY_MAX_CULLING_VIEWS;
+	const unsigned int bit = 1u << (view % PHY_MAX_CULLING_VIEWS);
+
+	// An object can be seen by several groups of views, the other groups are culled first.
+	for (const ViewCullingEntry& entry : m_viewCulling) {
+		if (entry.m_group != group) {
+			entry.m_gameobj->SetCulled(true);
+		}
+	}
+	for (const ViewCullingEntry& entry : m_viewCulling) {
+		if (entry.m_group == group) {
+			entry.m_gameobj->SetCulled((entry.m_viewMask & bit) == 0);
+		}
+	}
+}
+
 void KX_Scene::DrawDebug(RAS_DebugDraw& debugDraw, const std::vector<KX_GameObject *>& objects)
 {
 	const KX_DebugOption showBoundingBox = KX_GetActiveEngine()->GetShowBoundingBox();
@@ -1273,6 +1464,8 @@ void KX_Scene::RenderDebugProperties(RAS_DebugDraw& debugDraw, int xindent, int
 // logic stuff
 void KX_Scene::LogicBeginFrame(double curtime, double framestep)
 {
+	CM_TRACE_SCOPE("Logic Begin Frame", "logic", m_sceneName.c_str());
+
 	// have a look at temp objects ...
 	for (KX_GameObject *gameobj : m_tempObjectList) {
 		EXP_FloatValue* propval = (EXP_FloatValue *)gameobj->GetProperty("::timebomb");
@@ -1310,6 +1503,9 @@ static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(t
 
 	gameobj = (KX_GameObject*)taskdata;
 
+	const std::string name = CM_Trace::IsRecording() ? gameobj->GetName() : std::string();
+	CM_TRACE_SCOPE("Animation", "animation", name.c_str());
+
 	// Non-armature updates are fast enough, so just update them
 	needs_update = gameobj->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE;
 
@@ -1362,6 +1558,8 @@ static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(t
 
 void KX_Scene::UpdateAnimations(double curtime)
 {
+	CM_TRACE_SCOPE("Animations", "animation", m_sceneName.c_str());
+
 	m_animationPoolData.curtime = curtime;
 
 	for (KX_GameObject *gameobj : m_animatedlist) {
@@ -1375,13 +1573,23 @@ void KX_Scene::UpdateAnimations(double curtime)
 
 void KX_Scene::LogicUpdateFrame(double curtime)
 {
-	m_componentManager.UpdateComponents();
+	{
+		CM_TRACE_SCOPE("Python Components", "python", m_sceneName.c_str());
+		m_componentManager.UpdateComponents();
+	}
 
+	CM_TRACE_SCOPE("Logic Update Frame", "logic", m_sceneName.c_str());
 	m_logicmgr->UpdateFrame(curtime);
 }
 
 void KX_Scene::LogicEndFrame()
 {
+	CM_TRACE_SCOPE("Logic End Frame", "logic", m_sceneName.c_str());
+
+	// avoid obstacles with the velocities requested by the steering actuators
+	if (m_obstacleSimulation)
+		m_obstacleSimulation->SolveObstacles();
+
 	m_logicmgr->EndFrame();
 
 	/* Don't remove the objects from the euthanasy list here as the child objects of a deleted
@@ -1410,16 +1618,14 @@ void KX_Scene::LogicEndFrame()
  */
 void KX_Scene::UpdateParents(double curtime)
 {
-	// we use the SG dynamic list
-	SG_Node* node;
+	CM_TRACE_SCOPE("Update Parents", "scenegraph", m_sceneName.c_str());
 
-	while ((node = SG_Node::GetNextScheduled(m_sghead)) != nullptr)
-	{
-		node->UpdateWorldData(curtime);
-	}
+	// we use the SG dynamic list, each hierarchy is updated in a task
+	SG_Node::UpdateScheduled(m_sghead, curtime, m_sceneGraphPool);
 
 	// the list must be empty here
 	BLI_assert(m_sghead.Empty());
+	SG_Node* node;
 	// some nodes may be ready for reschedule, move them to schedule list for next time
 	while ((node = SG_Node::GetNextRescheduled(m_sghead)) != nullptr)
 	{
@@ -1438,6 +1644,21 @@ RAS_MaterialBucket* KX_Scene::FindBucket(class RAS_IPolyMaterial* polymat, bool
 void KX_Scene::RenderBuckets(const std::vector<KX_GameObject *>& objects, RAS_Rasterizer::DrawType drawingMode, const MT_Transform& cameratransform,
 		RAS_Rasterizer *rasty, RAS_OffScreen *offScreen)
 {
+	CM_TRACE_SCOPE("Render Buckets", "render", m_sceneName.c_str());
+
+	// Compose the matrices of the moved objects in a single pass over the transform pool.
+	m_matrixSlots.clear();
+	m_matrixTargets.clear();
+	for (KX_GameObject *gameobj : objects) {
+		SG_Node *node = gameobj->GetSGNode();
+		if (node->IsDirty(SG_Node::DIRTY_RENDER) && node->GetTransformPool() == m_transformPool) {
+			m_matrixSlots.push_back(node->GetTransformSlot());
+			m_matrixTargets.push_back(gameobj->GetMeshUser()->GetMatrix());
+			node->ClearDirty(SG_Node::DIRTY_RENDER);
+		}
+	}
+	m_transformPool->ComputeMatrices(m_matrixSlots, m_matrixTargets);
+
 	for (KX_GameObject *gameobj : objects) {
 		/* This function update all mesh slot info (e.g culling, color, matrix) from the game object.
 		 * It's done just before the render to be sure of the object color and visibility. */
@@ -1503,13 +1724,21 @@ void KX_Scene::UpdateObjectActivity()
 		return;
 	}
 
+	// For each camera compute the distance to all objects and keep the minimum distance.
+	m_transformPool->ComputeMinDistances2(camPositions, m_activityDistances);
+
 	for (KX_GameObject *gameobj : m_objectlist) {
 		// If the object doesn't manage activity culling we don't compute distance.
 		if (gameobj->GetActivityCullingInfo().m_flags & KX_GameObject::ActivityCullingInfo::ACTIVITY_NONE) {
 			continue;
 		}
 
-		// For each camera compute the distance to objects and keep the minimum distance.
+		const SG_Node *node = gameobj->GetSGNode();
+		if (node->GetTransformPool() == m_transformPool) {
+			gameobj->UpdateActivity(m_activityDistances[node->GetTransformSlot()]);
+			continue;
+		}
+
 		const MT_Vector3& obpos = gameobj->NodeGetWorldPosition();
 		float dist = FLT_MAX;
 		for (const MT_Vector3& campos : camPositions) {
@@ -1630,6 +1859,13 @@ static void MergeScene_GameObject(KX_GameObject* gameobj, KX_Scene *to, KX_Scene
 				child->SetSGClientInfo(to);
 			}
 		}
+		/* Move the transform into the merged scene pool, with the children not tied to a game object */
+		sg->SetTransformPool(to->GetTransformPool());
+		for (SG_Node *child : sg->GetSGChildren()) {
+			if (!child->GetSGClientObject()) {
+				child->SetTransformPool(to->GetTransformPool());
+			}
+		}
 	}
 	/* If the object is a light, update it's scene */
 	if (gameobj->GetGameObjectType() == SCA_IObject::OBJ_LIGHT)
@@ -1650,42 +1886,240 @@ static void MergeScene_GameObject(KX_GameObject* gameobj, KX_Scene *to, KX_Scene
 	}
 }
 
-bool KX_Scene::MergeScene(KX_Scene *other)
+/// Move an object from a list of the merged scene to the same list of this scene.
+template <class ItemType>
+static bool MergeScene_MoveToList(KX_GameObject *gameobj, EXP_ListValue<ItemType> *from, EXP_ListValue<ItemType> *to)
 {
-	PHY_IPhysicsEnvironment *env = this->GetPhysicsEnvironment();
-	PHY_IPhysicsEnvironment *env_other = other->GetPhysicsEnvironment();
-
-	if ((env==nullptr) != (env_other==nullptr)) /* TODO - even when both scenes have NONE physics, the other is loaded with bullet enabled, ??? */
-	{
-		CM_FunctionError("physics scenes type differ, aborting\n\tsource " << (int)(env!=nullptr) << ", target " << (int)(env_other!=nullptr));
+	// The objects are mostly merged in the order of the lists.
+	if (from->GetCount() > 0 && from->GetFront() == gameobj) {
+		from->Remove(0);
+	}
+	else if (!from->RemoveValue(gameobj)) {
 		return false;
 	}
 
-	GetBucketManager()->MergeBucketManager(other->GetBucketManager(), this);
-	GetBoundingBoxManager()->Merge(other->GetBoundingBoxManager());
-	GetTextureRendererManager()->Merge(other->GetTextureRendererManager());
+	// The reference owned by the list is moved too.
+	to->Add(static_cast<ItemType *>(gameobj));
+	return true;
+}
 
-	/* active + inactive == all ??? - lets hope so */
-	for (KX_GameObject *gameobj : *other->GetObjectList()) {
-		MergeScene_GameObject(gameobj, this, other);
+/// Return true if the object was active in the merged scene.
+static bool MergeScene_Object(KX_GameObject *gameobj, KX_Scene *to, KX_Scene *from)
+{
+	MergeScene_GameObject(gameobj, to, from);
 
+	const bool active = MergeScene_MoveToList(gameobj, from->GetObjectList(), to->GetObjectList());
+	if (active) {
 		/* add properties to debug list for LibLoad objects */
 		if (KX_GetActiveEngine()->GetFlag(KX_KetsjiEngine::AUTO_ADD_DEBUG_PROPERTIES)) {
-			AddObjectDebugProperties(gameobj);
+			to->AddObjectDebugProperties(gameobj);
+		}
+	}
+	else {
+		MergeScene_MoveToList(gameobj, from->GetInactiveList(), to->GetInactiveList());
+	}
+
+	MergeScene_MoveToList(gameobj, from->GetRootParentList(), to->GetRootParentList());
+
+	switch (gameobj->GetGameObjectType()) {
+		case SCA_IObject::OBJ_LIGHT:
+		{
+			MergeScene_MoveToList(gameobj, from->GetLightList(), to->GetLightList());
+			break;
+		}
+		case SCA_IObject::OBJ_CAMERA:
+		{
+			MergeScene_MoveToList(gameobj, from->GetCameraList(), to->GetCameraList());
+			break;
+		}
+		case SCA_IObject::OBJ_TEXT:
+		{
+			MergeScene_MoveToList(gameobj, from->GetFontList(), to->GetFontList());
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+
+	return active;
+}
+
+static KX_GameObject *MergeScene_GetRoot(KX_GameObject *gameobj)
+{
+	KX_GameObject *root = gameobj;
+	while (KX_GameObject *parent = root->GetParent()) {
+		parent->Release();
+		root = parent;
+	}
+
+	return root;
+}
+
+/** Merge an object and all its children, a hierarchy is always merged at once to never
+ * have an object of this scene parented to an object still in the merged scene.
+ * \param activeObjects Filled with the merged objects which were active.
+ * \return The number of objects merged.
+ */
+static unsigned int MergeScene_Hierarchy(KX_GameObject *root, KX_Scene *to, KX_Scene *from,
+										 std::vector<KX_GameObject *>& activeObjects)
+{
+	std::vector<KX_GameObject *> objects = root->GetChildrenRecursive();
+	objects.insert(objects.begin(), root);
+
+	for (KX_GameObject *gameobj : objects) {
+		if (MergeScene_Object(gameobj, to, from)) {
+			activeObjects.push_back(gameobj);
+		}
+	}
+
+	return objects.size();
+}
+
+/// Merge the hierarchies of a list from the progress index, the deferred hierarchies are skipped.
+static unsigned int MergeScene_List(EXP_ListValue<KX_GameObject> *list, KX_Scene *to, KX_Scene *from,
+									KX_Scene::MergeProgress& progress, unsigned int maxObjects)
+{
+	unsigned int merged = 0;
+	std::vector<KX_GameObject *> activeObjects;
+
+	while (merged < maxObjects && progress.m_index < list->GetCount()) {
+		KX_GameObject *gameobj = list->GetValue(progress.m_index);
+		KX_GameObject *root = MergeScene_GetRoot(gameobj);
+
+		if (progress.m_deferredRoots.find(root) == progress.m_deferredRoots.end()) {
+			merged += MergeScene_Hierarchy(root, to, from, activeObjects);
+		}
+
+		// The object is still in the list when deferred, it's merged in the last stage.
+		if (progress.m_index < list->GetCount() && list->GetValue(progress.m_index) == gameobj) {
+			++progress.m_index;
 		}
 	}
 
-	for (KX_GameObject *gameobj : *other->GetInactiveList()) {
-		MergeScene_GameObject(gameobj, this, other);
+	return merged;
+}
+
+KX_Scene::MergeProgress::MergeProgress()
+	:m_stage(MERGE_BEGIN),
+	m_index(0),
+	m_success(true)
+{
+}
+
+bool KX_Scene::MergeScene(KX_Scene *other)
+{
+	MergeProgress progress;
+	while (progress.m_stage != MergeProgress::MERGE_DONE) {
+		MergeSceneStep(other, progress, UINT_MAX);
+	}
+
+	return progress.m_success;
+}
+
+unsigned int KX_Scene::MergeSceneStep(KX_Scene *other, MergeProgress& progress, unsigned int maxObjects)
+{
+	PHY_IPhysicsEnvironment *env = this->GetPhysicsEnvironment();
+	PHY_IPhysicsEnvironment *env_other = other->GetPhysicsEnvironment();
+
+	unsigned int merged = 0;
+
+	if (progress.m_stage == MergeProgress::MERGE_BEGIN) {
+		if ((env==nullptr) != (env_other==nullptr)) /* TODO - even when both scenes have NONE physics, the other is loaded with bullet enabled, ??? */
+		{
+			CM_FunctionError("physics scenes type differ, aborting\n\tsource " << (int)(env!=nullptr) << ", target " << (int)(env_other!=nullptr));
+			progress.m_success = false;
+			progress.m_stage = MergeProgress::MERGE_DONE;
+			return 0;
+		}
+
+		GetBucketManager()->MergeBucketManager(other->GetBucketManager(), this);
+		GetBoundingBoxManager()->Merge(other->GetBoundingBoxManager());
+		GetTextureRendererManager()->Merge(other->GetTextureRendererManager());
+
+		/* The objects using physics constraints and their targets are merged at once in the
+		 * last stage to replicate the constraints with all the objects in the same physics environment. */
+		std::set<std::string> constraintNames;
+		for (KX_GameObject *gameobj : *other->GetObjectList()) {
+			for (bRigidBodyJointConstraint *dat : gameobj->GetConstraints()) {
+				constraintNames.insert(gameobj->GetName());
+				constraintNames.insert(dat->tar->id.name + 2);
+			}
+		}
+
+		if (!constraintNames.empty()) {
+			for (KX_GameObject *gameobj : *other->GetObjectList()) {
+				if (constraintNames.find(gameobj->GetName()) != constraintNames.end()) {
+					progress.m_deferredRoots.insert(MergeScene_GetRoot(gameobj));
+				}
+			}
+		}
+
+		// The lights are merged first to be available when the materials are initialized.
+		std::vector<KX_LightObject *> lights;
+		for (KX_LightObject *light : *other->GetLightList()) {
+			lights.push_back(light);
+		}
+
+		std::vector<KX_GameObject *> activeObjects;
+		for (KX_LightObject *light : lights) {
+			// The light could be merged in the hierarchy of a previous light.
+			if (!other->GetLightList()->SearchValue(light)) {
+				continue;
+			}
+
+			KX_GameObject *root = MergeScene_GetRoot(light);
+			if (progress.m_deferredRoots.find(root) == progress.m_deferredRoots.end()) {
+				merged += MergeScene_Hierarchy(root, this, other, activeObjects);
+			}
+		}
+
+		progress.m_stage = MergeProgress::MERGE_OBJECTS;
+		return merged;
+	}
+
+	if (progress.m_stage == MergeProgress::MERGE_OBJECTS) {
+		merged += MergeScene_List(other->GetObjectList(), this, other, progress, maxObjects);
+		if (progress.m_index == other->GetObjectList()->GetCount()) {
+			progress.m_index = 0;
+			progress.m_stage = MergeProgress::MERGE_INACTIVE_OBJECTS;
+		}
+	}
+
+	if (progress.m_stage == MergeProgress::MERGE_INACTIVE_OBJECTS && merged < maxObjects) {
+		merged += MergeScene_List(other->GetInactiveList(), this, other, progress, maxObjects - merged);
+		if (progress.m_index == other->GetInactiveList()->GetCount()) {
+			progress.m_stage = MergeProgress::MERGE_END;
+		}
+	}
+
+	if (progress.m_stage != MergeProgress::MERGE_END || merged >= maxObjects) {
+		return merged;
+	}
+
+	// Merge the deferred hierarchies and any object not reached from its root.
+	std::vector<KX_GameObject *> activeObjects;
+	for (EXP_ListValue<KX_GameObject> *list : {other->GetObjectList(), other->GetInactiveList()}) {
+		while (list->GetCount() > 0) {
+			KX_GameObject *gameobj = list->GetFront();
+			merged += MergeScene_Hierarchy(MergeScene_GetRoot(gameobj), this, other, activeObjects);
+
+			if (list->GetCount() > 0 && list->GetFront() == gameobj) {
+				if (MergeScene_Object(gameobj, this, other)) {
+					activeObjects.push_back(gameobj);
+				}
+				++merged;
+			}
+		}
 	}
 
 	if (env) {
 		env->MergeEnvironment(env_other);
-		EXP_ListValue<KX_GameObject> *otherObjects = other->GetObjectList();
 
 		// List of all physics objects to merge (needed by ReplicateConstraints).
 		std::vector<KX_GameObject *> physicsObjects;
-		for (KX_GameObject *gameobj : *otherObjects) {
+		for (KX_GameObject *gameobj : activeObjects) {
 			if (gameobj->GetPhysicsController()) {
 				physicsObjects.push_back(gameobj);
 			}
@@ -1699,25 +2133,6 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 		}
 	}
 
-
-	GetObjectList()->MergeList(other->GetObjectList());
-	other->GetObjectList()->ReleaseAndRemoveAll();
-
-	GetInactiveList()->MergeList(other->GetInactiveList());
-	other->GetInactiveList()->ReleaseAndRemoveAll();
-
-	GetRootParentList()->MergeList(other->GetRootParentList());
-	other->GetRootParentList()->ReleaseAndRemoveAll();
-
-	GetLightList()->MergeList(other->GetLightList());
-	other->GetLightList()->ReleaseAndRemoveAll();
-
-	GetCameraList()->MergeList(other->GetCameraList());
-	other->GetCameraList()->ReleaseAndRemoveAll();
-
-	GetFontList()->MergeList(other->GetFontList());
-	other->GetFontList()->ReleaseAndRemoveAll();
-
 	/* merge logic */
 	{
 		SCA_LogicManager *logicmgr=			GetLogicManager();
@@ -1748,7 +2163,9 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 		}
 		
 	}
-	return true;
+
+	progress.m_stage = MergeProgress::MERGE_DONE;
+	return merged;
 }
 
 RAS_2DFilterManager *KX_Scene::Get2DFilterManager() const
@@ -1825,6 +2242,7 @@ PyMethodDef KX_Scene::Methods[] = {
 	EXP_PYMETHODTABLE(KX_Scene, suspend),
 	EXP_PYMETHODTABLE(KX_Scene, resume),
 	EXP_PYMETHODTABLE(KX_Scene, drawObstacleSimulation),
+	EXP_PYMETHODTABLE_KEYWORDS(KX_Scene, rayCastBatch),
 	
 	/* dict style access */
 	EXP_PYMETHODTABLE(KX_Scene, get),
@@ -2216,6 +2634,117 @@ EXP_PYMETHODDEF_DOC(KX_Scene, drawObstacleSimulation,
 	Py_RETURN_NONE;
 }
 
+EXP_PYMETHODDEF_DOC(KX_Scene, rayCastBatch,
+				   "rayCastBatch(origins, targets, mask, radius, ignore)\n"
+				   "Cast a ray or a sphere sweep from each origin to the target of same index.\n"
+				   "Return a tuple (objects, hits), objects is a list of the object hit by each ray or None and\n"
+				   "hits is a bytes object packing seven floats per ray: the hit position, the hit normal and the\n"
+				   "hit fraction along the ray.\n")
+{
+	PyObject *pyorigins;
+	PyObject *pytargets;
+	PyObject *pyignore = Py_None;
+	int mask = (1 << OB_MAX_COL_MASKS) - 1;
+	float radius = 0.0f;
+
+	if (!EXP_ParseTupleArgsAndKeywords(args, kwds, "OO|ifO:rayCastBatch", {"origins", "targets", "mask", "radius", "ignore", 0},
+			&pyorigins, &pytargets, &mask, &radius, &pyignore))
+	{
+		return nullptr;
+	}
+
+	KX_GameObject *ignore;
+	if (!ConvertPythonToGameObject(m_logicmgr, pyignore, &ignore, true, "scene.rayCastBatch(origins, targets, mask, radius, ignore): KX_Scene")) {
+		return nullptr;
+	}
+
+	if (mask == 0 || mask & ~((1 << OB_MAX_COL_MASKS) - 1)) {
+		PyErr_Format(PyExc_TypeError, "scene.rayCastBatch(origins, targets, mask, radius, ignore): KX_Scene, mask argument must be a int bitfield, 0 < mask < %i", (1 << OB_MAX_COL_MASKS));
+		return nullptr;
+	}
+
+	if (!PySequence_Check(pyorigins) || !PySequence_Check(pytargets) || PySequence_Size(pyorigins) != PySequence_Size(pytargets)) {
+		PyErr_SetString(PyExc_TypeError, "scene.rayCastBatch(origins, targets, mask, radius, ignore): KX_Scene, origins and targets must be sequences of same size");
+		return nullptr;
+	}
+
+	PHY_IPhysicsController *ignoreController = nullptr;
+	if (ignore) {
+		ignoreController = ignore->GetPhysicsController();
+		if (!ignoreController && ignore->GetParent()) {
+			ignoreController = ignore->GetParent()->GetPhysicsController();
+		}
+	}
+
+	const unsigned int count = PySequence_Size(pyorigins);
+	std::vector<PHY_RayCastQuery> queries(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		MT_Vector3 origin;
+		MT_Vector3 target;
+		PyObject *pyorigin = PySequence_GetItem(pyorigins, i); /* new ref */
+		PyObject *pytarget = PySequence_GetItem(pytargets, i); /* new ref */
+		const bool error = !pyorigin || !pytarget || !PyVecTo(pyorigin, origin) || !PyVecTo(pytarget, target);
+		Py_XDECREF(pyorigin);
+		Py_XDECREF(pytarget);
+		if (error) {
+			return nullptr;
+		}
+
+		PHY_RayCastQuery& query = queries[i];
+		origin.getValue(query.m_from);
+		target.getValue(query.m_to);
+		query.m_radius = radius;
+		query.m_mask = mask;
+		query.m_ignoreController = ignoreController;
+	}
+
+	std::vector<PHY_RayCastHit> hits;
+	m_physicsEnvironment->RayTestBatch(queries, hits);
+
+	PyObject *pyobjects = PyList_New(count);
+	PyObject *pyhits = PyBytes_FromStringAndSize(nullptr, count * 7 * sizeof(float));
+	if (!pyobjects || !pyhits) {
+		Py_XDECREF(pyobjects);
+		Py_XDECREF(pyhits);
+		return nullptr;
+	}
+
+	float *data = (float *)PyBytes_AS_STRING(pyhits);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		const PHY_RayCastHit& hit = hits[i];
+		KX_GameObject *gameobj = nullptr;
+		if (hit.m_controller) {
+			gameobj = KX_GameObject::GetClientObject((KX_ClientObjectInfo *)hit.m_controller->GetNewClientInfo());
+		}
+
+		if (gameobj) {
+			PyList_SET_ITEM(pyobjects, i, gameobj->GetProxy());
+			std::copy(hit.m_hitPoint, hit.m_hitPoint + 3, data);
+			std::copy(hit.m_hitNormal, hit.m_hitNormal + 3, data + 3);
+			data[6] = hit.m_hitFraction;
+		}
+		else {
+			Py_INCREF(Py_None);
+			PyList_SET_ITEM(pyobjects, i, Py_None);
+			std::fill(data, data + 6, 0.0f);
+			data[6] = 1.0f;
+		}
+		data += 7;
+	}
+
+	PyObject *ret = PyTuple_New(2);
+	if (!ret) {
+		Py_DECREF(pyobjects);
+		Py_DECREF(pyhits);
+		return nullptr;
+	}
+
+	PyTuple_SET_ITEM(ret, 0, pyobjects);
+	PyTuple_SET_ITEM(ret, 1, pyhits);
+	return ret;
+}
+
 /* Matches python dict.get(key, [default]) */
 EXP_PYMETHODDEF_DOC(KX_Scene, get, "")
 {
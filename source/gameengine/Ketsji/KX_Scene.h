@@ -40,6 +40,7 @@
 #include <vector>
 #include <set>
 #include <list>
+#include <memory>
 
 #include "SG_Node.h"
 #include "SG_Frustum.h"
@@ -74,6 +75,7 @@ class KX_NetworkMessageScene;
 class KX_NetworkMessageManager;
 class SG_Node;
 class SG_Node;
+class SG_TransformPool;
 class KX_WorldInfo;
 class KX_Camera;
 class KX_FontObject;
@@ -137,6 +139,32 @@ private:
 		}
 	};
 
+	/// An object seen by a group of views of the last multi view culling.
+	struct ViewCullingEntry {
+		KX_GameObject *m_gameobj;
+		/// Index of the group of PHY_MAX_CULLING_VIEWS views.
+		unsigned int m_group;
+		/// Mask of the views of the group seeing the object.
+		unsigned int m_viewMask;
+	};
+
+	struct MultiCullingInfo {
+		const std::vector<int>& m_layers;
+		std::vector<std::vector<KX_GameObject *> >& m_objects;
+		/// Index of the first view of the group culled.
+		unsigned int m_begin;
+		std::vector<ViewCullingEntry>& m_viewCulling;
+
+		MultiCullingInfo(const std::vector<int>& layers, std::vector<std::vector<KX_GameObject *> >& objects,
+				unsigned int begin, std::vector<ViewCullingEntry>& viewCulling)
+			:m_layers(layers),
+			m_objects(objects),
+			m_begin(begin),
+			m_viewCulling(viewCulling)
+		{
+		}
+	};
+
 protected:
 	KX_TextureRendererManager *m_rendererManager;
 	RAS_BucketManager*	m_bucketmanager;
@@ -293,6 +321,12 @@ protected:
 	 * Visibility testing functions.
 	 */
 	static void PhysicsCullingCallback(KX_ClientObjectInfo* objectInfo, void* cullingInfo);
+	static void PhysicsMultiCullingCallback(KX_ClientObjectInfo *objectInfo, unsigned int viewMask, void *cullingInfo);
+	/// Cull the views [begin, end), at most PHY_MAX_CULLING_VIEWS, of a multi view culling.
+	void CalculateVisibleMeshesGroup(std::vector<std::vector<KX_GameObject *> >& objects, const std::vector<SG_Frustum>& frustums,
+			const std::vector<int>& layers, unsigned int begin, unsigned int end);
+	/// Register the view masks of the objects seen by the views [begin, end) from their visible objects.
+	void AddViewCulling(const std::vector<std::vector<KX_GameObject *> >& objects, unsigned int begin, unsigned int end);
 
 	struct Scene* m_blenderScene;
 
@@ -302,6 +336,21 @@ protected:
 
 	AnimationPoolData m_animationPoolData;
 	TaskPool *m_animationPool;
+	/// Task pool used to update the scheduled scene graph hierarchies.
+	TaskPool *m_sceneGraphPool;
+	/// Task pool used to cull the objects without DBVT.
+	TaskPool *m_cullingPool;
+	/// Objects to cull, reused between calls of CalculateVisibleMeshes.
+	std::vector<KX_GameObject *> m_cullingObjects;
+	/// Objects seen by the views of the last multi view culling and their view masks, read by ApplyCulling.
+	std::vector<ViewCullingEntry> m_viewCulling;
+
+	/// World transforms of the scene objects stored contiguously.
+	std::shared_ptr<SG_TransformPool> m_transformPool;
+	/// Buffers reused by the batched transform queries.
+	std::vector<float> m_activityDistances;
+	std::vector<unsigned int> m_matrixSlots;
+	std::vector<float *> m_matrixTargets;
 
 	/**
 	 * LOD Hysteresis settings
@@ -322,6 +371,7 @@ public:
 	RAS_BucketManager* GetBucketManager() const;
 	KX_TextureRendererManager *GetTextureRendererManager() const;
 	RAS_BoundingBoxManager *GetBoundingBoxManager() const;
+	const std::shared_ptr<SG_TransformPool>& GetTransformPool() const;
 	RAS_MaterialBucket*	FindBucket(RAS_IPolyMaterial* polymat, bool &bucketCreated);
 	void RenderBuckets(const std::vector<KX_GameObject *>& objects, RAS_Rasterizer::DrawType drawingMode,
 			const MT_Transform& cameratransform, RAS_Rasterizer *rasty, RAS_OffScreen *offScreen);
@@ -436,6 +486,19 @@ public:
 	KX_WorldInfo* GetWorldInfo();
 	void CalculateVisibleMeshes(std::vector<KX_GameObject *>& objects, KX_Camera *cam, int layer);
 	void CalculateVisibleMeshes(std::vector<KX_GameObject *>& objects, const SG_Frustum& frustum, int layer);
+	/** Compute the visible objects of several views at once, the object list or the culling tree is
+	 * walked a single time for all the views. All the objects are culled, ApplyCulling must be called
+	 * with the index of a view before rendering it.
+	 * \param objects The visible objects of each view.
+	 * \param layers The layers of each view, 0 for all layers.
+	 */
+	void CalculateVisibleMeshes(std::vector<std::vector<KX_GameObject *> >& objects, const std::vector<SG_Frustum>& frustums,
+			const std::vector<int>& layers);
+	/** Set the culling state of the objects for a view of the last multi view CalculateVisibleMeshes,
+	 * only the objects seen by any of the views are modified, from their view mask.
+	 * Must be called before any object is removed from the scene.
+	 */
+	void ApplyCulling(unsigned int view);
 
 	/// \section Debug draw.
 	void DrawDebug(RAS_DebugDraw& debugDraw, const std::vector<KX_GameObject *>& objects);
@@ -517,6 +580,7 @@ public:
 	EXP_PYMETHOD_DOC(KX_Scene, resume);
 	EXP_PYMETHOD_DOC(KX_Scene, get);
 	EXP_PYMETHOD_DOC(KX_Scene, drawObstacleSimulation);
+	EXP_PYMETHOD_DOC(KX_Scene, rayCastBatch);
 
 	/* attributes */
 	static PyObject*	pyattr_get_name(EXP_PyObjectPlus *self_v, const EXP_PYATTRIBUTE_DEF *attrdef);
@@ -561,7 +625,41 @@ public:
 	 */
 	struct Scene *GetBlenderScene() { return m_blenderScene; }
 
+	/// Progress of a scene merged incrementally with MergeSceneStep.
+	struct MergeProgress
+	{
+		enum Stage {
+			/// Merge the managers and the lights.
+			MERGE_BEGIN = 0,
+			MERGE_OBJECTS,
+			MERGE_INACTIVE_OBJECTS,
+			/// Merge the objects using physics constraints and the logic.
+			MERGE_END,
+			MERGE_DONE
+		};
+
+		Stage m_stage;
+		/// Index of the next object to merge in the current list of the merged scene.
+		unsigned int m_index;
+		/// Root of the hierarchies using physics constraints, merged in the last stage.
+		std::set<KX_GameObject *> m_deferredRoots;
+		/// False if the scenes are not compatible.
+		bool m_success;
+
+		MergeProgress();
+	};
+
+	/// Merge all the content of a scene at once.
 	bool MergeScene(KX_Scene *other);
+	/** Merge a part of the content of a scene, to call until progress.m_stage is MERGE_DONE.
+	 * The objects are merged with their children and are fully part of this scene once merged.
+	 * \param other The scene to merge, emptied by the merge.
+	 * \param progress The progress of the merge kept between the calls.
+	 * \param maxObjects The number of objects to merge in this call, the first call only merges
+	 * the managers and the lights and the last call merges all the objects using physics constraints.
+	 * \return The number of objects merged.
+	 */
+	unsigned int MergeSceneStep(KX_Scene *other, MergeProgress& progress, unsigned int maxObjects);
 
 
 	//void PrintStats(int verbose_level) {
@@ -67,6 +67,7 @@ KX_SteeringActuator::KX_SteeringActuator(SCA_IObject *gameobj,
       m_turnspeed(turnspeed),
       m_simulation(simulation),
       m_updateTime(0),
+      m_updateDelta(0),
       m_obstacle(nullptr),
       m_isActive(false),
       m_isSelfTerminated(isSelfTerminated),
@@ -269,36 +270,21 @@ bool KX_SteeringActuator::Update(double curtime)
 		if (!m_steerVec.fuzzyZero())
 			m_steerVec.normalize();
 		MT_Vector3 newvel = m_velocity * m_steerVec;
+		m_updateDelta = delta;
 
 		//adjust velocity to avoid obstacles
 		if (m_simulation && m_obstacle /*&& !newvel.fuzzyZero()*/)
 		{
 			if (m_enableVisualization)
 				KX_RasterizerDrawDebugLine(mypos, mypos + newvel, MT_Vector4(1.0f, 0.0f, 0.0f, 1.0f));
-			m_simulation->AdjustObstacleVelocity(m_obstacle, m_mode!=KX_STEERING_PATHFOLLOWING ? m_navmesh : nullptr,
+			/* The velocities of all the agents are adjusted together at the end of the
+			 * logic frame, the simulation then calls ApplyVelocity. */
+			m_simulation->RequestObstacleVelocity(this, m_obstacle, m_mode!=KX_STEERING_PATHFOLLOWING ? m_navmesh : nullptr,
 							newvel, m_acceleration*(float)delta, m_turnspeed/(180.0f*(float)(M_PI*delta)));
-			if (m_enableVisualization)
-				KX_RasterizerDrawDebugLine(mypos, mypos + newvel, MT_Vector4(0.0f, 1.0f, 0.0f, 1.0f));
-		}
-
-		HandleActorFace(newvel);
-		if (isdyna)
-		{
-			//temporary solution: set 2D steering velocity directly to obj
-			//correct way is to apply physical force
-			MT_Vector3 curvel = obj->GetLinearVelocity();
-
-			if (m_lockzvel)
-				newvel.z() = 0.0f;
-			else
-				newvel.z() = curvel.z();
-
-			obj->setLinearVelocity(newvel, false);
 		}
 		else
 		{
-			MT_Vector3 movement = delta*newvel;
-			obj->ApplyMovement(movement, false);
+			ApplyVelocity(newvel);
 		}
 	}
 	else
@@ -317,6 +303,36 @@ bool KX_SteeringActuator::Update(double curtime)
 	return true;
 }
 
+void KX_SteeringActuator::ApplyVelocity(MT_Vector3 velocity)
+{
+	KX_GameObject *obj = (KX_GameObject*) GetParent();
+
+	if (m_enableVisualization && m_simulation && m_obstacle) {
+		const MT_Vector3& mypos = obj->NodeGetWorldPosition();
+		KX_RasterizerDrawDebugLine(mypos, mypos + velocity, MT_Vector4(0.0f, 1.0f, 0.0f, 1.0f));
+	}
+
+	HandleActorFace(velocity);
+	if (obj->IsDynamic())
+	{
+		//temporary solution: set 2D steering velocity directly to obj
+		//correct way is to apply physical force
+		MT_Vector3 curvel = obj->GetLinearVelocity();
+
+		if (m_lockzvel)
+			velocity.z() = 0.0f;
+		else
+			velocity.z() = curvel.z();
+
+		obj->setLinearVelocity(velocity, false);
+	}
+	else
+	{
+		MT_Vector3 movement = m_updateDelta*velocity;
+		obj->ApplyMovement(movement, false);
+	}
+}
+
 const MT_Vector3& KX_SteeringActuator::GetSteeringVec()
 {
 	static MT_Vector3 ZERO_VECTOR(0, 0, 0);
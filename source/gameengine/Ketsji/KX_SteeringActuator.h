@@ -52,6 +52,8 @@ class KX_SteeringActuator : public SCA_IActuator
 	KX_ObstacleSimulation* m_simulation;
 	
 	double m_updateTime;
+	/// Time step of the last update, used to apply the velocity.
+	double m_updateDelta;
 	KX_Obstacle* m_obstacle;
 	bool m_isActive;
 	bool m_isSelfTerminated;
@@ -101,6 +103,8 @@ public:
 	virtual void Relink(std::map<SCA_IObject *, SCA_IObject *>& obj_map);
 	virtual bool UnlinkObject(SCA_IObject* clientobj);
 	const MT_Vector3& GetSteeringVec();
+	/// Move the object with the steering velocity, called once the obstacles are avoided.
+	void ApplyVelocity(MT_Vector3 velocity);
 
 #ifdef WITH_PYTHON
 
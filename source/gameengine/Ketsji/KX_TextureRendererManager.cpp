@@ -140,10 +140,40 @@ bool KX_TextureRendererManager::RenderRenderer(RAS_Rasterizer *rasty, KX_Texture
 	m_camera->SetProjectionMatrix(projmat);
 	rasty->SetProjectionMatrix(projmat);
 
+	const unsigned short numFaces = renderer->GetNumFaces();
+	const int layer = ~renderer->GetIgnoreLayers();
+	std::vector<std::vector<KX_GameObject *> > visibleObjects(numFaces);
+	// Index of the culling view of each face.
+	std::vector<unsigned int> faceViews(numFaces, 0);
+
+	// Cull the objects of all the faces at once.
+	if (m_camera->GetFrustumCulling()) {
+		std::vector<unsigned short> faces;
+		std::vector<SG_Frustum> frustums;
+		for (unsigned short i = 0; i < numFaces; ++i) {
+			if (!renderer->SetupCameraFace(m_camera, i)) {
+				continue;
+			}
+
+			m_camera->NodeUpdateGS(0.0f);
+			m_camera->SetModelviewMatrix(MT_Matrix4x4(MT_Transform(m_camera->GetWorldToCamera())));
+
+			faces.push_back(i);
+			frustums.push_back(m_camera->GetFrustum());
+		}
+
+		std::vector<std::vector<KX_GameObject *> > faceObjects;
+		m_scene->CalculateVisibleMeshes(faceObjects, frustums, std::vector<int>(faces.size(), layer));
+		for (unsigned short i = 0, size = faces.size(); i < size; ++i) {
+			visibleObjects[faces[i]].swap(faceObjects[i]);
+			faceViews[faces[i]] = i;
+		}
+	}
+
 	// Begin rendering stuff
 	renderer->BeginRender(rasty);
 
-	for (unsigned short i = 0; i < renderer->GetNumFaces(); ++i) {
+	for (unsigned short i = 0; i < numFaces; ++i) {
 		// Set camera settings unique per faces.
 		if (!renderer->SetupCameraFace(m_camera, i)) {
 			continue;
@@ -159,8 +189,13 @@ bool KX_TextureRendererManager::RenderRenderer(RAS_Rasterizer *rasty, KX_Texture
 		rasty->SetViewMatrix(viewmat, m_camera->NodeGetWorldPosition(), MT_Vector3(1.0f, 1.0f, 1.0f));
 		m_camera->SetModelviewMatrix(viewmat);
 
-		std::vector<KX_GameObject *> objects;
-		m_scene->CalculateVisibleMeshes(objects, m_camera, ~renderer->GetIgnoreLayers());
+		std::vector<KX_GameObject *>& objects = visibleObjects[i];
+		if (m_camera->GetFrustumCulling()) {
+			m_scene->ApplyCulling(faceViews[i]);
+		}
+		else {
+			m_scene->CalculateVisibleMeshes(objects, m_camera, layer);
+		}
 
 		/* Updating the lod per face is normally not expensive because a cube map normally show every objects
 		 * but here we update only visible object of a face including the clip end and start.
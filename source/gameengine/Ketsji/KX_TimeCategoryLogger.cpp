@@ -79,10 +79,17 @@ void KX_TimeCategoryLogger::EndLog(TimeCategory tc, double now)
 
 void KX_TimeCategoryLogger::EndLog(double now)
 {
-	m_loggers[m_lastCategory].EndLog(now);
+	if (m_lastCategory != -1) {
+		m_loggers[m_lastCategory].EndLog(now);
+	}
 	m_lastCategory = -1;
 }
 
+void KX_TimeCategoryLogger::AddTime(TimeCategory tc, double time)
+{
+	m_loggers[tc].AddTime(time);
+}
+
 void KX_TimeCategoryLogger::NextMeasurement(double now)
 {
 	for (TimeLoggerMap::value_type& pair : m_loggers) {
@@ -99,6 +99,13 @@ public:
 	 */
 	void EndLog(double now);
 
+	/**
+	 * Adds a time to the current measurement of the given category.
+	 * \param tc	The category to log to.
+	 * \param time	The time to add.
+	 */
+	void AddTime(TimeCategory tc, double time);
+
 	/**
 	 * Logs time in next measurement.
 	 * \param now	The current time.
@@ -77,6 +77,13 @@ public:
 	 */
 	void EndLog(double now);
 
+	/**
+	 * Adds a time to the current measurement, used for time logged outside of
+	 * StartLog and EndLog.
+	 * \param time	The time to add.
+	 */
+	void AddTime(double time);
+
 	/**
 	 * Logs time in next measurement.
 	 * \param now	The current time.
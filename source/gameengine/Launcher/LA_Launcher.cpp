@@ -61,6 +61,7 @@
 #include "DEV_Joystick.h"
 
 #include "CM_Message.h"
+#include "CM_Trace.h"
 
 extern "C" {
 #  include "GPU_extensions.h"
@@ -154,12 +155,20 @@ void LA_Launcher::InitEngine()
 	short showShadowFrustum = SYS_GetCommandLineInt(syshandle, "show_shadow_frustum", gm.showShadowFrustum);
 	bool nodepwarnings = (SYS_GetCommandLineInt(syshandle, "ignore_deprecation_warnings", 1) != 0);
 	bool restrictAnimFPS = (gm.flag & GAME_RESTRICT_ANIM_UPDATES) != 0;
+	bool parallelScenes = (SYS_GetCommandLineInt(syshandle, "parallel_scenes", (gm.flag & GAME_PARALLEL_SCENES)) != 0);
+
+	// Record the timeline of the whole game.
+	m_traceFile = SYS_GetCommandLineString(syshandle, "trace_file", "");
+	if (!m_traceFile.empty()) {
+		CM_Trace::Start();
+	}
 
 	const KX_KetsjiEngine::FlagType flags = (KX_KetsjiEngine::FlagType)
 		((fixed_framerate ? KX_KetsjiEngine::FIXED_FRAMERATE : 0) |
 		(frameRate ? KX_KetsjiEngine::SHOW_FRAMERATE : 0) |
 		(renderQueries ? KX_KetsjiEngine::SHOW_RENDER_QUERIES : 0) |
 		(restrictAnimFPS ? KX_KetsjiEngine::RESTRICT_ANIMATION : 0) |
+		(parallelScenes ? KX_KetsjiEngine::PARALLEL_SCENES : 0) |
 		(properties ? KX_KetsjiEngine::SHOW_DEBUG_PROPERTIES : 0) |
 		(profile ? KX_KetsjiEngine::SHOW_PROFILE : 0));
 
@@ -277,6 +286,7 @@ void LA_Launcher::InitEngine()
 	KX_SetMainPath(std::string(m_maggie->name));
 	// Some python things.
 	setupGamePython(m_ketsjiEngine, m_maggie, m_globalDict, &m_gameLogic, m_argc, m_argv);
+	initGamePythonBytecodeCache(m_maggie, &m_startScene->gm, (m_argv != nullptr));
 #endif  // WITH_PYTHON
 
 	// Create a scene converter, create and convert the stratingscene.
@@ -325,6 +335,16 @@ void LA_Launcher::ExitEngine()
 	DEV_Joystick::Close();
 	m_ketsjiEngine->StopEngine();
 
+	if (!m_traceFile.empty()) {
+		CM_Trace::Stop();
+		if (CM_Trace::Write(m_traceFile)) {
+			CM_Message("Timeline written to " << m_traceFile);
+		}
+		else {
+			CM_Error("failed to write timeline to " << m_traceFile);
+		}
+	}
+
 #ifdef WITH_PYTHON
 
 	/* Clears the dictionary by hand:
@@ -386,6 +406,11 @@ void LA_Launcher::ExitEngine()
 		m_networkMessageManager = nullptr;
 	}
 
+#ifdef WITH_PYTHON
+	// All the controllers are freed, save the code objects still used by the text blocks.
+	exitGamePythonBytecodeCache(m_maggie, &m_startScene->gm);
+#endif  // WITH_PYTHON
+
 	// Call this after we're sure nothing needs Python anymore (e.g., destructors).
 	ExitPython();
 
@@ -91,6 +91,9 @@ protected:
 	/// The render stereo mode passed in constructor.
 	RAS_Rasterizer::StereoMode m_stereoMode;
 
+	/// The file receiving the timeline of the engine, empty if the timeline is not recorded.
+	std::string m_traceFile;
+
 	/// argc and argv need to be passed on to python
 	int m_argc;
 	char **m_argv;
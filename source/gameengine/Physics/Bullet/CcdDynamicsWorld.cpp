@@ -0,0 +1,282 @@
+#include "CcdDynamicsWorld.h"
+
+#include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
+#include "BulletDynamics/ConstraintSolver/btConstraintSolver.h"
+#include "BulletDynamics/ConstraintSolver/btTypedConstraint.h"
+
+extern "C" {
+#  include "BLI_utildefines.h"
+#  include "BLI_task.h"
+}
+
+/// Minimum number of bodies solved by a task, smaller groups of islands are packed together.
+#define CCD_SOLVER_BATCH_BODIES 64
+
+/// Copy the bodies and manifolds of each awake island, the island manager reuses its arrays.
+class CcdDynamicsWorld::IslandCollector : public btSimulationIslandManager::IslandCallback
+{
+private:
+	CcdDynamicsWorld *m_world;
+
+public:
+	IslandCollector(CcdDynamicsWorld *world)
+		:m_world(world)
+	{
+	}
+
+	virtual void processIsland(btCollisionObject **bodies, int numBodies, btPersistentManifold **manifolds,
+							   int numManifolds, int islandId)
+	{
+		BLI_assert(islandId >= 0 && islandId < (int)m_world->m_islandIndices.size());
+
+		Island island;
+		island.m_bodyStart = m_world->m_islandBodies.size();
+		island.m_numBodies = numBodies;
+		island.m_manifoldStart = m_world->m_islandManifolds.size();
+		island.m_numManifolds = numManifolds;
+		island.m_constraintStart = 0;
+		island.m_numConstraints = 0;
+		island.m_parent = m_world->m_islands.size();
+
+		m_world->m_islandIndices[islandId] = island.m_parent;
+		m_world->m_islands.push_back(island);
+		m_world->m_islandBodies.insert(m_world->m_islandBodies.end(), bodies, bodies + numBodies);
+		m_world->m_islandManifolds.insert(m_world->m_islandManifolds.end(), manifolds, manifolds + numManifolds);
+	}
+};
+
+/// Same island of a constraint as btDiscreteDynamicsWorld.
+static int ccd_constraint_island_id(const btTypedConstraint *constraint)
+{
+	const btCollisionObject& colObj0 = constraint->getRigidBodyA();
+	const btCollisionObject& colObj1 = constraint->getRigidBodyB();
+	return (colObj0.getIslandTag() >= 0) ? colObj0.getIslandTag() : colObj1.getIslandTag();
+}
+
+CcdDynamicsWorld::CcdDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+								   btCollisionConfiguration *collisionConfiguration)
+	:btSoftRigidDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+	m_scheduler(nullptr),
+	m_solverInfo(nullptr)
+{
+}
+
+CcdDynamicsWorld::~CcdDynamicsWorld()
+{
+	for (btConstraintSolver *solver : m_threadSolvers) {
+		delete solver;
+	}
+}
+
+void CcdDynamicsWorld::SetThreadSolvers(TaskScheduler *scheduler, const std::vector<btConstraintSolver *>& solvers)
+{
+	for (btConstraintSolver *solver : m_threadSolvers) {
+		delete solver;
+	}
+
+	m_scheduler = scheduler;
+	m_threadSolvers = solvers;
+}
+
+int CcdDynamicsWorld::FindIsland(int index)
+{
+	while (m_islands[index].m_parent != index) {
+		// Path halving.
+		m_islands[index].m_parent = m_islands[m_islands[index].m_parent].m_parent;
+		index = m_islands[index].m_parent;
+	}
+	return index;
+}
+
+void CcdDynamicsWorld::MergeIslands(int index1, int index2)
+{
+	index1 = FindIsland(index1);
+	index2 = FindIsland(index2);
+	if (index1 != index2) {
+		// Keep the lowest index as root to preserve the island manager order.
+		if (index1 < index2) {
+			m_islands[index2].m_parent = index1;
+		}
+		else {
+			m_islands[index1].m_parent = index2;
+		}
+	}
+}
+
+void CcdDynamicsWorld::GatherConstraints()
+{
+	m_islandConstraints.resize(m_constraints.size());
+
+	// Count the constraints of each island.
+	for (unsigned int i = 0, size = m_constraints.size(); i < size; ++i) {
+		const int islandId = ccd_constraint_island_id(m_constraints[i]);
+		if (islandId >= 0 && m_islandIndices[islandId] != -1) {
+			++m_islands[m_islandIndices[islandId]].m_numConstraints;
+		}
+	}
+
+	int start = 0;
+	for (Island& island : m_islands) {
+		island.m_constraintStart = start;
+		start += island.m_numConstraints;
+		island.m_numConstraints = 0;
+	}
+
+	// Fill the constraints in the world order.
+	for (unsigned int i = 0, size = m_constraints.size(); i < size; ++i) {
+		btTypedConstraint *constraint = m_constraints[i];
+		const int islandId = ccd_constraint_island_id(constraint);
+		if (islandId >= 0 && m_islandIndices[islandId] != -1) {
+			Island& island = m_islands[m_islandIndices[islandId]];
+			m_islandConstraints[island.m_constraintStart + island.m_numConstraints++] = constraint;
+		}
+	}
+}
+
+void CcdDynamicsWorld::MergeKinematicIslands()
+{
+	m_kinematicIslands.clear();
+
+	const auto mergeKinematic = [this](const btCollisionObject *body, int index) {
+		if (!body->isKinematicObject()) {
+			return;
+		}
+		const auto it = m_kinematicIslands.emplace(body, index);
+		if (!it.second) {
+			MergeIslands(it.first->second, index);
+		}
+	};
+
+	for (int i = 0, size = m_islands.size(); i < size; ++i) {
+		const Island& island = m_islands[i];
+		for (int j = island.m_manifoldStart, end = j + island.m_numManifolds; j < end; ++j) {
+			const btPersistentManifold *manifold = m_islandManifolds[j];
+			mergeKinematic(manifold->getBody0(), i);
+			mergeKinematic(manifold->getBody1(), i);
+		}
+		for (int j = island.m_constraintStart, end = j + island.m_numConstraints; j < end; ++j) {
+			const btTypedConstraint *constraint = m_islandConstraints[j];
+			mergeKinematic(&constraint->getRigidBodyA(), i);
+			mergeKinematic(&constraint->getRigidBodyB(), i);
+		}
+	}
+}
+
+void CcdDynamicsWorld::BuildBatches()
+{
+	const int numIslands = m_islands.size();
+
+	/* Sort the islands by group, a group is identified by its root island which
+	 * is also its first island, so that a counting sort keeps the island order. */
+	std::vector<int> roots(numIslands);
+	std::vector<int> groupStarts(numIslands + 1, 0);
+	for (int i = 0; i < numIslands; ++i) {
+		roots[i] = FindIsland(i);
+		++groupStarts[roots[i] + 1];
+	}
+	for (int i = 0; i < numIslands; ++i) {
+		groupStarts[i + 1] += groupStarts[i];
+	}
+	std::vector<int> sortedIslands(numIslands);
+	for (int i = 0; i < numIslands; ++i) {
+		sortedIslands[groupStarts[roots[i]]++] = i;
+	}
+
+	m_batches.clear();
+	m_batchBodies.clear();
+	m_batchManifolds.clear();
+	m_batchConstraints.clear();
+
+	Island batch = {0, 0, 0, 0, 0, 0, 0};
+	for (int i = 0; i < numIslands; ++i) {
+		const int index = sortedIslands[i];
+		const Island& island = m_islands[index];
+
+		m_batchBodies.insert(m_batchBodies.end(), m_islandBodies.begin() + island.m_bodyStart,
+							 m_islandBodies.begin() + island.m_bodyStart + island.m_numBodies);
+		m_batchManifolds.insert(m_batchManifolds.end(), m_islandManifolds.begin() + island.m_manifoldStart,
+								m_islandManifolds.begin() + island.m_manifoldStart + island.m_numManifolds);
+		m_batchConstraints.insert(m_batchConstraints.end(), m_islandConstraints.begin() + island.m_constraintStart,
+								  m_islandConstraints.begin() + island.m_constraintStart + island.m_numConstraints);
+		batch.m_numBodies += island.m_numBodies;
+		batch.m_numManifolds += island.m_numManifolds;
+		batch.m_numConstraints += island.m_numConstraints;
+
+		// A batch can only be closed at the end of a group.
+		const bool groupEnd = (i == numIslands - 1) || (roots[sortedIslands[i + 1]] != roots[index]);
+		if (groupEnd && (batch.m_numBodies >= CCD_SOLVER_BATCH_BODIES || i == numIslands - 1)) {
+			m_batches.push_back(batch);
+			batch.m_bodyStart += batch.m_numBodies;
+			batch.m_manifoldStart += batch.m_numManifolds;
+			batch.m_constraintStart += batch.m_numConstraints;
+			batch.m_numBodies = 0;
+			batch.m_numManifolds = 0;
+			batch.m_numConstraints = 0;
+		}
+	}
+}
+
+void CcdDynamicsWorld::SolveBatch(const Island& batch, int threadid)
+{
+	btConstraintSolver *solver = m_threadSolvers[threadid];
+	btCollisionObject **bodies = batch.m_numBodies ? &m_batchBodies[batch.m_bodyStart] : nullptr;
+	btPersistentManifold **manifolds = batch.m_numManifolds ? &m_batchManifolds[batch.m_manifoldStart] : nullptr;
+	btTypedConstraint **constraints = batch.m_numConstraints ? &m_batchConstraints[batch.m_constraintStart] : nullptr;
+
+	// The debug drawer is not thread safe.
+	solver->solveGroup(bodies, batch.m_numBodies, manifolds, batch.m_numManifolds, constraints, batch.m_numConstraints,
+					   *m_solverInfo, nullptr, getDispatcher());
+}
+
+void CcdDynamicsWorld::SolveBatchTask(TaskPool *pool, void *taskdata, int threadid)
+{
+	CcdDynamicsWorld *world = (CcdDynamicsWorld *)BLI_task_pool_userdata(pool);
+	world->SolveBatch(*(Island *)taskdata, threadid);
+}
+
+void CcdDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+	// Without split islands all the constraints are solved at once.
+	if (m_threadSolvers.empty() || !m_islandManager->getSplitIslands()) {
+		btSoftRigidDynamicsWorld::solveConstraints(solverInfo);
+		return;
+	}
+
+	m_islands.clear();
+	m_islandBodies.clear();
+	m_islandManifolds.clear();
+	m_islandIndices.assign(getNumCollisionObjects(), -1);
+
+	IslandCollector collector(this);
+	m_islandManager->buildAndProcessIslands(getDispatcher(), this, &collector);
+
+	if (m_islands.empty()) {
+		return;
+	}
+
+	GatherConstraints();
+	MergeKinematicIslands();
+	BuildBatches();
+
+	m_solverInfo = &solverInfo;
+	for (btConstraintSolver *solver : m_threadSolvers) {
+		solver->prepareSolve(getNumCollisionObjects(), getDispatcher()->getNumManifolds());
+	}
+
+	if (m_batches.size() == 1) {
+		SolveBatch(m_batches.front(), 0);
+	}
+	else {
+		TaskPool *pool = BLI_task_pool_create(m_scheduler, this);
+		for (Island& batch : m_batches) {
+			BLI_task_pool_push(pool, SolveBatchTask, &batch, false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+
+	for (btConstraintSolver *solver : m_threadSolvers) {
+		solver->allSolved(solverInfo, m_debugDrawer);
+	}
+	m_solverInfo = nullptr;
+}
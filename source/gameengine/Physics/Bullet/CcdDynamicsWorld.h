@@ -0,0 +1,83 @@
+#ifndef __CCD_DYNAMICS_WORLD_H__
+#define __CCD_DYNAMICS_WORLD_H__
+
+#include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
+
+#include <vector>
+#include <unordered_map>
+
+struct TaskScheduler;
+struct TaskPool;
+
+/** \brief Dynamics world solving the constraints of the simulation islands in parallel.
+ * Islands sharing a kinematic body are merged because the solver writes its companion id,
+ * the resulting groups are packed into batches solved by one constraint solver per thread.
+ * Collision detection, integration and soft bodies are still processed serially.
+ */
+class CcdDynamicsWorld : public btSoftRigidDynamicsWorld
+{
+private:
+	/// Range of bodies, manifolds and constraints of an island or a batch.
+	struct Island
+	{
+		int m_bodyStart;
+		int m_numBodies;
+		int m_manifoldStart;
+		int m_numManifolds;
+		int m_constraintStart;
+		int m_numConstraints;
+		/// Parent island in the union of the islands sharing a kinematic body.
+		int m_parent;
+	};
+
+	class IslandCollector;
+
+	TaskScheduler *m_scheduler;
+	/// One solver per thread of the scheduler, indexed by thread id, owned by the world.
+	std::vector<btConstraintSolver *> m_threadSolvers;
+
+	/// Islands in the order of the island manager.
+	std::vector<Island> m_islands;
+	std::vector<btCollisionObject *> m_islandBodies;
+	std::vector<btPersistentManifold *> m_islandManifolds;
+	std::vector<btTypedConstraint *> m_islandConstraints;
+	/// Island index of each island id, -1 for sleeping islands.
+	std::vector<int> m_islandIndices;
+	/// First island touching each kinematic body.
+	std::unordered_map<const btCollisionObject *, int> m_kinematicIslands;
+
+	/// Batches of islands with their concatenated data.
+	std::vector<Island> m_batches;
+	std::vector<btCollisionObject *> m_batchBodies;
+	std::vector<btPersistentManifold *> m_batchManifolds;
+	std::vector<btTypedConstraint *> m_batchConstraints;
+	/// Solver settings of the current step.
+	btContactSolverInfo *m_solverInfo;
+
+	int FindIsland(int index);
+	void MergeIslands(int index1, int index2);
+	void GatherConstraints();
+	void MergeKinematicIslands();
+	void BuildBatches();
+
+	void SolveBatch(const Island& batch, int threadid);
+
+	static void SolveBatchTask(TaskPool *pool, void *taskdata, int threadid);
+
+protected:
+	virtual void solveConstraints(btContactSolverInfo& solverInfo);
+
+public:
+	CcdDynamicsWorld(btDispatcher *dispatcher, btBroadphaseInterface *pairCache, btConstraintSolver *constraintSolver,
+					 btCollisionConfiguration *collisionConfiguration);
+	virtual ~CcdDynamicsWorld();
+
+	/** Use a solver per thread of the scheduler to solve the islands in parallel.
+	 * \param scheduler The task scheduler, nullptr to solve all the islands with the world solver.
+	 * \param solvers The solvers for the thread ids of the scheduler, including the main thread.
+	 * The world takes ownership of the solvers.
+	 */
+	void SetThreadSolvers(TaskScheduler *scheduler, const std::vector<btConstraintSolver *>& solvers);
+};
+
+#endif  // __CCD_DYNAMICS_WORLD_H__
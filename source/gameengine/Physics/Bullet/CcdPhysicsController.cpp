@@ -1399,7 +1399,7 @@ bool CcdPhysicsController::WantsSleeping()
 {
 	btRigidBody *body = GetRigidBody();
 	if (body) {
-		return body->wantsSleeping();
+		return body->wantsSleeping(m_cci.m_physicsEnv->GetDynamicsWorld()->getDeactivationTime());
 	}
 	//check it out
 	return true;
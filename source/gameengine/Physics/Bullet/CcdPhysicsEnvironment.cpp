@@ -59,6 +59,7 @@
 
 extern "C" {
 	#include "BLI_utildefines.h"
+	#include "BLI_task.h"
 	#include "BKE_object.h"
 }
 
@@ -82,6 +83,7 @@ void DrawRasterizerLine(const float *from, const float *to, int color);
 
 #include "CM_Message.h"
 #include "CM_List.h"
+#include "CM_Trace.h"
 
 // This was copied from the old KX_ConvertPhysicsObjects
 #ifdef WIN32
@@ -406,6 +408,8 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(PHY_SolverType solverType, bool use
 	m_angularDeactivationThreshold(1.0f),
 	m_contactBreakingThreshold(0.02f),
 	m_solver(nullptr),
+	m_parallelSolving(false),
+	m_subStepStartTime(0.0),
 	m_ownPairCache(nullptr),
 	m_filterCallback(nullptr),
 	m_ghostPairCallback(nullptr),
@@ -435,8 +439,12 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(PHY_SolverType solverType, bool use
 
 	SetSolverType(solverType);
 
-	m_dynamicsWorld = new btSoftRigidDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
+	m_dynamicsWorld = new CcdDynamicsWorld(dispatcher, m_broadphase, m_solver, m_collisionConfiguration);
 	m_dynamicsWorld->setInternalTickCallback(&CcdPhysicsEnvironment::StaticSimulationSubtickCallback, this);
+	/* The world and the dispatcher use their own values instead of the Bullet global
+	 * variables, environments of different scenes can then be used in parallel. */
+	m_dynamicsWorld->setDeactivationTime(m_deactivationTime);
+	dispatcher->setContactBreakingThreshold(m_contactBreakingThreshold);
 
 	SetGravity(0.0f, 0.0f, -9.81f);
 }
@@ -444,9 +452,10 @@ CcdPhysicsEnvironment::CcdPhysicsEnvironment(PHY_SolverType solverType, bool use
 void CcdPhysicsEnvironment::AddCcdPhysicsController(CcdPhysicsController *ctrl)
 {
 	// the controller is already added we do nothing
-	if (!m_controllers.insert(ctrl).second) {
+	if (!m_controllerIndices.emplace(ctrl, m_controllers.size()).second) {
 		return;
 	}
+	m_controllers.push_back(ctrl);
 
 	btRigidBody *body = ctrl->GetRigidBody();
 	btCollisionObject *obj = ctrl->GetCollisionObject();
@@ -580,10 +589,21 @@ void CcdPhysicsEnvironment::RestoreConstraint(CcdPhysicsController *ctrl, btType
 bool CcdPhysicsEnvironment::RemoveCcdPhysicsController(CcdPhysicsController *ctrl, bool freeConstraints)
 {
 	// if the physics controller is already removed we do nothing
-	if (!m_controllers.erase(ctrl)) {
+	std::unordered_map<CcdPhysicsController *, unsigned int>::iterator indexIt = m_controllerIndices.find(ctrl);
+	if (indexIt == m_controllerIndices.end()) {
 		return false;
 	}
 
+	// Move the last controller in place of the removed one.
+	const unsigned int index = indexIt->second;
+	m_controllerIndices.erase(indexIt);
+	CcdPhysicsController *last = m_controllers.back();
+	m_controllers.pop_back();
+	if (last != ctrl) {
+		m_controllers[index] = last;
+		m_controllerIndices[last] = index;
+	}
+
 	//also remove constraint
 	btRigidBody *body = ctrl->GetRigidBody();
 	if (body) {
@@ -665,7 +685,7 @@ void CcdPhysicsEnvironment::RefreshCcdPhysicsController(CcdPhysicsController *ct
 
 bool CcdPhysicsEnvironment::IsActiveCcdPhysicsController(CcdPhysicsController *ctrl)
 {
-	return (m_controllers.find(ctrl) != m_controllers.end());
+	return (m_controllerIndices.find(ctrl) != m_controllerIndices.end());
 }
 
 void CcdPhysicsEnvironment::AddCcdGraphicController(CcdGraphicController *ctrl)
@@ -726,42 +746,38 @@ void CcdPhysicsEnvironment::StaticSimulationSubtickCallback(btDynamicsWorld *wor
 
 void CcdPhysicsEnvironment::SimulationSubtickCallback(btScalar timeStep)
 {
-	std::set<CcdPhysicsController *>::iterator it;
+	for (CcdPhysicsController *ctrl : m_controllers) {
+		ctrl->SimulationTick(timeStep);
+	}
 
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		(*it)->SimulationTick(timeStep);
+	// The sub step started at the end of the previous one.
+	if (CM_Trace::IsRecording()) {
+		const double time = CM_Trace::GetTime();
+		CM_Trace::Record("Physics Substep", "physics", nullptr, m_subStepStartTime, time);
+		m_subStepStartTime = time;
 	}
 }
 
 bool CcdPhysicsEnvironment::ProceedDeltaTime(double curTime, float timeStep, float interval)
 {
-	std::set<CcdPhysicsController *>::iterator it;
 	int i;
 
-	// Update Bullet global variables.
-	gDeactivationTime = m_deactivationTime;
-	gContactBreakingThreshold = m_contactBreakingThreshold;
-
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		(*it)->SynchronizeMotionStates(timeStep);
+	for (CcdPhysicsController *ctrl : m_controllers) {
+		ctrl->SynchronizeMotionStates(timeStep);
 	}
 
 	float subStep = timeStep / float(m_numTimeSubSteps);
+	m_subStepStartTime = CM_Trace::IsRecording() ? CM_Trace::GetTime() : 0.0;
 	i = m_dynamicsWorld->stepSimulation(interval, 25, subStep);//perform always a full simulation step
 //uncomment next line to see where Bullet spend its time (printf in console)
 //CProfileManager::dumpAll();
 
 	ProcessFhSprings(curTime, i * subStep);
 
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		(*it)->SynchronizeMotionStates(timeStep);
+	for (CcdPhysicsController *ctrl : m_controllers) {
+		ctrl->SynchronizeMotionStates(timeStep);
 	}
 
-	//for (it=m_controllers.begin(); it!=m_controllers.end(); it++)
-	//{
-	//	(*it)->SynchronizeMotionStates(timeStep);
-	//}
-
 	for (i = 0; i < m_wrapperVehicles.size(); i++) {
 		WrapperVehicle *veh = m_wrapperVehicles[i];
 		veh->SyncWheels();
@@ -800,12 +816,9 @@ public:
 
 void CcdPhysicsEnvironment::ProcessFhSprings(double curTime, float interval)
 {
-	std::set<CcdPhysicsController *>::iterator it;
-
 	const float step = interval * KX_GetActiveEngine()->GetTicRate();
 
-	for (it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		CcdPhysicsController *ctrl = (*it);
+	for (CcdPhysicsController *ctrl : m_controllers) {
 		btRigidBody *body = ctrl->GetRigidBody();
 
 		if (body && (ctrl->GetConstructionInfo().m_do_fh || ctrl->GetConstructionInfo().m_do_rot_fh)) {
@@ -940,6 +953,7 @@ void CcdPhysicsEnvironment::SetNumIterations(int numIter)
 void CcdPhysicsEnvironment::SetDeactivationTime(float dTime)
 {
 	m_deactivationTime = dTime;
+	m_dynamicsWorld->setDeactivationTime(m_deactivationTime);
 }
 void CcdPhysicsEnvironment::SetDeactivationLinearTreshold(float linTresh)
 {
@@ -957,15 +971,17 @@ void CcdPhysicsEnvironment::SetDeactivationAngularTreshold(float angTresh)
 	m_angularDeactivationThreshold = angTresh;
 
 	// Update from all controllers.
-	for (std::set<CcdPhysicsController *>::iterator it = m_controllers.begin(); it != m_controllers.end(); it++) {
-		if ((*it)->GetRigidBody())
-			(*it)->GetRigidBody()->setSleepingThresholds(m_linearDeactivationThreshold, m_angularDeactivationThreshold);
+	for (CcdPhysicsController *ctrl : m_controllers) {
+		if (ctrl->GetRigidBody()) {
+			ctrl->GetRigidBody()->setSleepingThresholds(m_linearDeactivationThreshold, m_angularDeactivationThreshold);
+		}
 	}
 }
 
 void CcdPhysicsEnvironment::SetContactBreakingTreshold(float contactBreakingTreshold)
 {
 	m_contactBreakingThreshold = contactBreakingTreshold;
+	m_ownDispatcher->setContactBreakingThreshold(m_contactBreakingThreshold);
 }
 
 void CcdPhysicsEnvironment::SetCcdMode(int ccdMode)
@@ -997,40 +1013,73 @@ void CcdPhysicsEnvironment::SetUseEpa(bool epa)
 	//gUseEpa = epa;
 }
 
-void CcdPhysicsEnvironment::SetSolverType(PHY_SolverType solverType)
+btConstraintSolver *CcdPhysicsEnvironment::CreateSolver() const
 {
-	if (m_solverType == solverType) {
-		return;
-	}
-
-	switch (solverType)
+	switch (m_solverType)
 	{
 		case PHY_SOLVER_SEQUENTIAL:
 		{
-			m_solver = new btSequentialImpulseConstraintSolver();
-			break;
+			return new btSequentialImpulseConstraintSolver();
 		}
 		case PHY_SOLVER_NNCG:
 		{
-			m_solver = new btNNCGConstraintSolver();
-			break;
+			return new btNNCGConstraintSolver();
 		}
 		case PHY_SOLVER_MLCP_DANTZIG:
 		{
-			m_solver = new btMLCPSolver(new btDantzigSolver());
-			break;
+			return new btMLCPSolver(new btDantzigSolver());
 		}
 		case PHY_SOLVER_MLCP_LEMKE:
 		{
-			m_solver = new btMLCPSolver(new btLemkeSolver());
-			break;
+			return new btMLCPSolver(new btLemkeSolver());
 		}
 		default:
 		{
 			BLI_assert(false);
 		}
 	};
+
+	return nullptr;
+}
+
+void CcdPhysicsEnvironment::SetSolverType(PHY_SolverType solverType)
+{
+	if (m_solverType == solverType) {
+		return;
+	}
+
 	m_solverType = solverType;
+	m_solver = CreateSolver();
+
+	// Recreate the thread solvers with the new type.
+	if (m_parallelSolving) {
+		m_parallelSolving = false;
+		SetParallelSolving(true);
+	}
+}
+
+void CcdPhysicsEnvironment::SetParallelSolving(bool parallel)
+{
+	if (m_parallelSolving == parallel) {
+		return;
+	}
+
+	m_parallelSolving = parallel;
+
+	if (!parallel) {
+		m_dynamicsWorld->SetThreadSolvers(nullptr, {});
+		return;
+	}
+
+	/* A solver per thread id, the thread executing the step can be the main
+	 * thread (id 0) or any worker thread when scenes are updated in parallel. */
+	TaskScheduler *scheduler = KX_GetActiveEngine()->GetTaskScheduler();
+	std::vector<btConstraintSolver *> solvers(BLI_task_scheduler_num_threads(scheduler) + 1);
+	for (btConstraintSolver *&solver : solvers) {
+		solver = CreateSolver();
+	}
+
+	m_dynamicsWorld->SetThreadSolvers(scheduler, solvers);
 }
 
 void CcdPhysicsEnvironment::GetGravity(MT_Vector3& grav)
@@ -1311,534 +1360,226 @@ SKIP_UV_NORMAL:
 	return result.m_controller;
 }
 
-// Handles occlusion culling.
-// The implementation is based on the CDTestFramework
-struct OcclusionBuffer {
-	struct WriteOCL {
-		static inline bool Process(btScalar &q, btScalar v)
-		{
-			if (q < v) {
-				q = v;
-			}
-			return false;
-		}
-		static inline void Occlusion(bool &flag)
-		{
-			flag = true;
-		}
-	};
-
-	struct QueryOCL {
-		static inline bool Process(btScalar &q, btScalar v)
-		{
-			return (q <= v);
-		}
-		static inline void Occlusion(bool &flag)
-		{
-		}
-	};
-
-	btScalar *m_buffer;
-	size_t m_bufferSize;
-	bool m_initialized;
-	bool m_occlusion;
-	int m_sizes[2];
-	btScalar m_scales[2];
-	btScalar m_offsets[2];
-	btScalar m_wtc[16]; // world to clip transform
-	btScalar m_mtc[16]; // model to clip transform
-	// constructor: size=largest dimension of the buffer.
-	// Buffer size depends on aspect ratio
-	OcclusionBuffer()
-	{
-		m_initialized = false;
-		m_occlusion = false;
-		m_buffer = nullptr;
-		m_bufferSize = 0;
-	}
-	// multiplication of column major matrices: m = m1 * m2
-	template<typename T1, typename T2>
-	void CMmat4mul(btScalar *m, const T1 *m1, const T2 *m2)
-	{
-		m[0] = btScalar(m1[0] * m2[0] + m1[4] * m2[1] + m1[8] * m2[2] + m1[12] * m2[3]);
-		m[1] = btScalar(m1[1] * m2[0] + m1[5] * m2[1] + m1[9] * m2[2] + m1[13] * m2[3]);
-		m[2] = btScalar(m1[2] * m2[0] + m1[6] * m2[1] + m1[10] * m2[2] + m1[14] * m2[3]);
-		m[3] = btScalar(m1[3] * m2[0] + m1[7] * m2[1] + m1[11] * m2[2] + m1[15] * m2[3]);
+/// Return true if the object of a broadphase proxy can be hit by a query of a batch.
+static bool ray_cast_batch_filter(const PHY_RayCastQuery& query, btBroadphaseProxy *proxy)
+{
+	btCollisionObject *object = (btCollisionObject *)proxy->m_clientObject;
+	CcdPhysicsController *phyCtrl = static_cast<CcdPhysicsController *>(object->getUserPointer());
+	if (!phyCtrl || phyCtrl == query.m_ignoreController) {
+		return false;
+	}
 
-		m[4] = btScalar(m1[0] * m2[4] + m1[4] * m2[5] + m1[8] * m2[6] + m1[12] * m2[7]);
-		m[5] = btScalar(m1[1] * m2[4] + m1[5] * m2[5] + m1[9] * m2[6] + m1[13] * m2[7]);
-		m[6] = btScalar(m1[2] * m2[4] + m1[6] * m2[5] + m1[10] * m2[6] + m1[14] * m2[7]);
-		m[7] = btScalar(m1[3] * m2[4] + m1[7] * m2[5] + m1[11] * m2[6] + m1[15] * m2[7]);
+	KX_GameObject *gameObj = KX_GameObject::GetClientObject((KX_ClientObjectInfo *)phyCtrl->GetNewClientInfo());
+	return (gameObj && (gameObj->GetUserCollisionGroup() & query.m_mask));
+}
 
-		m[8] = btScalar(m1[0] * m2[8] + m1[4] * m2[9] + m1[8] * m2[10] + m1[12] * m2[11]);
-		m[9] = btScalar(m1[1] * m2[8] + m1[5] * m2[9] + m1[9] * m2[10] + m1[13] * m2[11]);
-		m[10] = btScalar(m1[2] * m2[8] + m1[6] * m2[9] + m1[10] * m2[10] + m1[14] * m2[11]);
-		m[11] = btScalar(m1[3] * m2[8] + m1[7] * m2[9] + m1[11] * m2[10] + m1[15] * m2[11]);
+struct BatchClosestRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+	const PHY_RayCastQuery& m_query;
 
-		m[12] = btScalar(m1[0] * m2[12] + m1[4] * m2[13] + m1[8] * m2[14] + m1[12] * m2[15]);
-		m[13] = btScalar(m1[1] * m2[12] + m1[5] * m2[13] + m1[9] * m2[14] + m1[13] * m2[15]);
-		m[14] = btScalar(m1[2] * m2[12] + m1[6] * m2[13] + m1[10] * m2[14] + m1[14] * m2[15]);
-		m[15] = btScalar(m1[3] * m2[12] + m1[7] * m2[13] + m1[11] * m2[14] + m1[15] * m2[15]);
+	BatchClosestRayResultCallback(const PHY_RayCastQuery& query, const btVector3& rayFrom, const btVector3& rayTo)
+		:btCollisionWorld::ClosestRayResultCallback(rayFrom, rayTo),
+		m_query(query)
+	{
+		// don't collision with sensor object
+		m_collisionFilterMask = CcdConstructionInfo::AllFilter ^ CcdConstructionInfo::SensorFilter;
+		// use faster (less accurate) ray callback, works better with 0 collision margins
+		m_flags |= btTriangleRaycastCallback::kF_UseSubSimplexConvexCastRaytest;
 	}
 
-	void setup(int size, const int *view, float mat[16])
-	{
-		m_initialized = false;
-		m_occlusion = false;
-		// compute the size of the buffer
-		int maxsize = (view[2] > view[3]) ? view[2] : view[3];
-		BLI_assert(maxsize > 0);
-		double ratio = 1.0 / (2 * maxsize);
-		// ensure even number
-		m_sizes[0] = 2 * ((int)(size * view[2] * ratio + 0.5));
-		m_sizes[1] = 2 * ((int)(size * view[3] * ratio + 0.5));
-		m_scales[0] = btScalar(m_sizes[0] / 2);
-		m_scales[1] = btScalar(m_sizes[1] / 2);
-		m_offsets[0] = m_scales[0] + 0.5f;
-		m_offsets[1] = m_scales[1] + 0.5f;
-		// prepare matrix
-		// at this time of the rendering, the modelview matrix is the
-		// world to camera transformation and the projection matrix is
-		// camera to clip transformation. combine both so that
-		for (unsigned short i = 0; i < 16; i++) {
-			m_wtc[i] = btScalar(mat[i]);
-		}
-	}
-
-	void initialize()
+	virtual bool needsCollision(btBroadphaseProxy *proxy0) const
 	{
-		size_t newsize = (m_sizes[0] * m_sizes[1]) * sizeof(btScalar);
-		if (m_buffer) {
-			// see if we can reuse
-			if (newsize > m_bufferSize) {
-				free(m_buffer);
-				m_buffer = nullptr;
-				m_bufferSize = 0;
-			}
-		}
-		if (!m_buffer) {
-			m_buffer = (btScalar *)calloc(1, newsize);
-			m_bufferSize = newsize;
-		}
-		else {
-			// buffer exists already, just clears it
-			memset(m_buffer, 0, newsize);
-		}
-		// memory allocate must succeed
-		BLI_assert(m_buffer != nullptr);
-		m_initialized = true;
-		m_occlusion = false;
+		return (btCollisionWorld::ClosestRayResultCallback::needsCollision(proxy0) && ray_cast_batch_filter(m_query, proxy0));
 	}
+};
+
+struct BatchClosestConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback
+{
+	const PHY_RayCastQuery& m_query;
 
-	void SetModelMatrix(float *fl)
+	BatchClosestConvexResultCallback(const PHY_RayCastQuery& query, const btVector3& convexFrom, const btVector3& convexTo)
+		:btCollisionWorld::ClosestConvexResultCallback(convexFrom, convexTo),
+		m_query(query)
 	{
-		CMmat4mul(m_mtc, m_wtc, fl);
-		if (!m_initialized) {
-			initialize();
-		}
+		// don't collision with sensor object
+		m_collisionFilterMask = CcdConstructionInfo::AllFilter ^ CcdConstructionInfo::SensorFilter;
 	}
 
-	// transform a segment in world coordinate to clip coordinate
-	void transformW(const btVector3 &x, btVector4 &t)
+	virtual bool needsCollision(btBroadphaseProxy *proxy0) const
 	{
-		t[0] = x[0] * m_wtc[0] + x[1] * m_wtc[4] + x[2] * m_wtc[8] + m_wtc[12];
-		t[1] = x[0] * m_wtc[1] + x[1] * m_wtc[5] + x[2] * m_wtc[9] + m_wtc[13];
-		t[2] = x[0] * m_wtc[2] + x[1] * m_wtc[6] + x[2] * m_wtc[10] + m_wtc[14];
-		t[3] = x[0] * m_wtc[3] + x[1] * m_wtc[7] + x[2] * m_wtc[11] + m_wtc[15];
+		return (btCollisionWorld::ClosestConvexResultCallback::needsCollision(proxy0) && ray_cast_batch_filter(m_query, proxy0));
 	}
+};
+
+/** Test the broadphase leaves met by a ray against their collision shape.
+ * Unlike btCollisionWorld::rayTest nothing is written in the broadphase, several
+ * rays can be tested at the same time.
+ */
+struct BatchRayLeafCallback : btDbvt::ICollide {
+	const btTransform& m_from;
+	const btTransform& m_to;
+	BatchClosestRayResultCallback& m_callback;
 
-	void transformM(const float *x, btVector4 &t)
+	BatchRayLeafCallback(const btTransform& from, const btTransform& to, BatchClosestRayResultCallback& callback)
+		:m_from(from),
+		m_to(to),
+		m_callback(callback)
 	{
-		t[0] = x[0] * m_mtc[0] + x[1] * m_mtc[4] + x[2] * m_mtc[8] + m_mtc[12];
-		t[1] = x[0] * m_mtc[1] + x[1] * m_mtc[5] + x[2] * m_mtc[9] + m_mtc[13];
-		t[2] = x[0] * m_mtc[2] + x[1] * m_mtc[6] + x[2] * m_mtc[10] + m_mtc[14];
-		t[3] = x[0] * m_mtc[3] + x[1] * m_mtc[7] + x[2] * m_mtc[11] + m_mtc[15];
 	}
-	// convert polygon to device coordinates
-	static bool project(btVector4 *p, int n)
+
+	void Process(const btDbvtNode *leaf)
 	{
-		for (int i = 0; i < n; ++i) {
-			p[i][2] = 1 / p[i][3];
-			p[i][0] *= p[i][2];
-			p[i][1] *= p[i][2];
+		btBroadphaseProxy *proxy = (btBroadphaseProxy *)leaf->data;
+		if (!m_callback.needsCollision(proxy)) {
+			return;
 		}
-		return true;
+		btCollisionObject *object = (btCollisionObject *)proxy->m_clientObject;
+		btSoftRigidDynamicsWorld::rayTestSingle(m_from, m_to, object, object->getCollisionShape(), object->getWorldTransform(), m_callback);
 	}
-	// pi: closed polygon in clip coordinate, NP = number of segments
-	// po: same polygon with clipped segments removed
-	template <const int NP>
-	static int clip(const btVector4 *pi, btVector4 *po)
+};
+
+/// Same as BatchRayLeafCallback for a sphere sweep.
+struct BatchSweepLeafCallback : btDbvt::ICollide {
+	const btConvexShape *m_shape;
+	const btTransform& m_from;
+	const btTransform& m_to;
+	BatchClosestConvexResultCallback& m_callback;
+	btScalar m_allowedPenetration;
+
+	BatchSweepLeafCallback(const btConvexShape *shape, const btTransform& from, const btTransform& to,
+			BatchClosestConvexResultCallback& callback, btScalar allowedPenetration)
+		:m_shape(shape),
+		m_from(from),
+		m_to(to),
+		m_callback(callback),
+		m_allowedPenetration(allowedPenetration)
 	{
-		btScalar s[2 * NP];
-		btVector4 pn[2 * NP];
-		int i, j, m, n, ni;
-		// deal with near clipping
-		for (i = 0, m = 0; i < NP; ++i) {
-			s[i] = pi[i][2] + pi[i][3];
-			if (s[i] < 0) {
-				m += 1 << i;
-			}
-		}
-		if (m == ((1 << NP) - 1)) {
-			return 0;
-		}
-		if (m != 0) {
-			for (i = NP - 1, j = 0, n = 0; j < NP; i = j++) {
-				const btVector4 &a = pi[i];
-				const btVector4 &b = pi[j];
-				const btScalar t = s[i] / (a[3] + a[2] - b[3] - b[2]);
-				if ((t > 0) && (t < 1)) {
-					pn[n][0] = a[0] + (b[0] - a[0]) * t;
-					pn[n][1] = a[1] + (b[1] - a[1]) * t;
-					pn[n][2] = a[2] + (b[2] - a[2]) * t;
-					pn[n][3] = a[3] + (b[3] - a[3]) * t;
-					++n;
-				}
-				if (s[j] > 0) {
-					pn[n++] = b;
-				}
-			}
-			// ready to test far clipping, start from the modified polygon
-			pi = pn;
-			ni = n;
-		}
-		else {
-			// no clipping on the near plane, keep same vector
-			ni = NP;
-		}
-		// now deal with far clipping
-		for (i = 0, m = 0; i < ni; ++i) {
-			s[i] = pi[i][2] - pi[i][3];
-			if (s[i] > 0) {
-				m += 1 << i;
-			}
-		}
-		if (m == ((1 << ni) - 1)) {
-			return 0;
-		}
-		if (m != 0) {
-			for (i = ni - 1, j = 0, n = 0; j < ni; i = j++) {
-				const btVector4 &a = pi[i];
-				const btVector4 &b = pi[j];
-				const btScalar t = s[i] / (a[2] - a[3] - b[2] + b[3]);
-				if ((t > 0) && (t < 1)) {
-					po[n][0] = a[0] + (b[0] - a[0]) * t;
-					po[n][1] = a[1] + (b[1] - a[1]) * t;
-					po[n][2] = a[2] + (b[2] - a[2]) * t;
-					po[n][3] = a[3] + (b[3] - a[3]) * t;
-					++n;
-				}
-				if (s[j] < 0) {
-					po[n++] = b;
-				}
-			}
-			return n;
-		}
-		for (int i = 0; i < ni; ++i) {
-			po[i] = pi[i];
-		}
-		return ni;
 	}
-	// write or check a triangle to buffer. a,b,c in device coordinates (-1,+1)
-	template <typename POLICY>
-	inline bool draw(const btVector4 &a,
-	                 const btVector4 &b,
-	                 const btVector4 &c,
-	                 const float face,
-	                 const btScalar minarea)
+
+	void Process(const btDbvtNode *leaf)
 	{
-		const btScalar a2 = btCross(b - a, c - a)[2];
-		if ((face * a2) < 0.0f || btFabs(a2) < minarea) {
-			return false;
-		}
-		// further down we are normally going to write to the Zbuffer, mark it so
-		POLICY::Occlusion(m_occlusion);
-
-		int x[3], y[3], ib = 1, ic = 2;
-		btScalar z[3];
-		x[0] = (int)(a.x() * m_scales[0] + m_offsets[0]);
-		y[0] = (int)(a.y() * m_scales[1] + m_offsets[1]);
-		z[0] = a.z();
-		if (a2 < 0.f) {
-			// negative aire is possible with double face => must
-			// change the order of b and c otherwise the algorithm doesn't work
-			ib = 2;
-			ic = 1;
-		}
-		x[ib] = (int)(b.x() * m_scales[0] + m_offsets[0]);
-		x[ic] = (int)(c.x() * m_scales[0] + m_offsets[0]);
-		y[ib] = (int)(b.y() * m_scales[1] + m_offsets[1]);
-		y[ic] = (int)(c.y() * m_scales[1] + m_offsets[1]);
-		z[ib] = b.z();
-		z[ic] = c.z();
-		const int mix = btMax(0, btMin(x[0], btMin(x[1], x[2])));
-		const int mxx = btMin(m_sizes[0], 1 + btMax(x[0], btMax(x[1], x[2])));
-		const int miy = btMax(0, btMin(y[0], btMin(y[1], y[2])));
-		const int mxy = btMin(m_sizes[1], 1 + btMax(y[0], btMax(y[1], y[2])));
-		const int width = mxx - mix;
-		const int height = mxy - miy;
-		if ((width * height) <= 1) {
-			// degenerated in at most one single pixel
-			btScalar *scan = &m_buffer[miy * m_sizes[0] + mix];
-			// use for loop to detect the case where width or height == 0
-			for (int iy = miy; iy < mxy; ++iy) {
-				for (int ix = mix; ix < mxx; ++ix) {
-					if (POLICY::Process(*scan, z[0])) {
-						return true;
-					}
-					if (POLICY::Process(*scan, z[1])) {
-						return true;
-					}
-					if (POLICY::Process(*scan, z[2])) {
-						return true;
-					}
-				}
-			}
-		}
-		else if (width == 1) {
-			// Degenerated in at least 2 vertical lines
-			// The algorithm below doesn't work when face has a single pixel width
-			// We cannot use general formulas because the plane is degenerated.
-			// We have to interpolate along the 3 edges that overlaps and process each pixel.
-			// sort the y coord to make formula simpler
-			int ytmp;
-			btScalar ztmp;
-			if (y[0] > y[1]) {
-				ytmp = y[1];
-				y[1] = y[0];
-				y[0] = ytmp;
-				ztmp = z[1];
-				z[1] = z[0];
-				z[0] = ztmp;
-			}
-			if (y[0] > y[2]) {
-				ytmp = y[2];
-				y[2] = y[0];
-				y[0] = ytmp;
-				ztmp = z[2];
-				z[2] = z[0];
-				z[0] = ztmp;
-			}
-			if (y[1] > y[2]) {
-				ytmp = y[2];
-				y[2] = y[1];
-				y[1] = ytmp;
-				ztmp = z[2];
-				z[2] = z[1];
-				z[1] = ztmp;
-			}
-			int dy[] = {y[0] - y[1],
-				        y[1] - y[2],
-				        y[2] - y[0]};
-			btScalar dzy[3];
-			dzy[0] = (dy[0]) ? (z[0] - z[1]) / dy[0] : btScalar(0.0f);
-			dzy[1] = (dy[1]) ? (z[1] - z[2]) / dy[1] : btScalar(0.0f);
-			dzy[2] = (dy[2]) ? (z[2] - z[0]) / dy[2] : btScalar(0.0f);
-			btScalar v[3] = {dzy[0] * (miy - y[0]) + z[0],
-				             dzy[1] * (miy - y[1]) + z[1],
-				             dzy[2] * (miy - y[2]) + z[2]};
-			dy[0] = y[1] - y[0];
-			dy[1] = y[0] - y[1];
-			dy[2] = y[2] - y[0];
-			btScalar *scan = &m_buffer[miy * m_sizes[0] + mix];
-			for (int iy = miy; iy < mxy; ++iy) {
-				if (dy[0] >= 0 && POLICY::Process(*scan, v[0])) {
-					return true;
-				}
-				if (dy[1] >= 0 && POLICY::Process(*scan, v[1])) {
-					return true;
-				}
-				if (dy[2] >= 0 && POLICY::Process(*scan, v[2])) {
-					return true;
-				}
-				scan += m_sizes[0];
-				v[0] += dzy[0];
-				v[1] += dzy[1];
-				v[2] += dzy[2];
-				dy[0]--;
-				dy[1]++;
-				dy[2]--;
-			}
+		btBroadphaseProxy *proxy = (btBroadphaseProxy *)leaf->data;
+		if (!m_callback.needsCollision(proxy)) {
+			return;
 		}
-		else if (height == 1) {
-			// Degenerated in at least 2 horizontal lines
-			// The algorithm below doesn't work when face has a single pixel width
-			// We cannot use general formulas because the plane is degenerated.
-			// We have to interpolate along the 3 edges that overlaps and process each pixel.
-			int xtmp;
-			btScalar ztmp;
-			if (x[0] > x[1]) {
-				xtmp = x[1];
-				x[1] = x[0];
-				x[0] = xtmp;
-				ztmp = z[1];
-				z[1] = z[0];
-				z[0] = ztmp;
-			}
-			if (x[0] > x[2]) {
-				xtmp = x[2];
-				x[2] = x[0];
-				x[0] = xtmp;
-				ztmp = z[2];
-				z[2] = z[0];
-				z[0] = ztmp;
-			}
-			if (x[1] > x[2]) {
-				xtmp = x[2];
-				x[2] = x[1];
-				x[1] = xtmp;
-				ztmp = z[2];
-				z[2] = z[1];
-				z[1] = ztmp;
-			}
-			int dx[] = {x[0] - x[1],
-				        x[1] - x[2],
-				        x[2] - x[0]};
-			btScalar dzx[3];
-			dzx[0] = (dx[0]) ? (z[0] - z[1]) / dx[0] : btScalar(0.0f);
-			dzx[1] = (dx[1]) ? (z[1] - z[2]) / dx[1] : btScalar(0.0f);
-			dzx[2] = (dx[2]) ? (z[2] - z[0]) / dx[2] : btScalar(0.0f);
-			btScalar v[3] = {dzx[0] * (mix - x[0]) + z[0],
-				             dzx[1] * (mix - x[1]) + z[1],
-				             dzx[2] * (mix - x[2]) + z[2]};
-			dx[0] = x[1] - x[0];
-			dx[1] = x[0] - x[1];
-			dx[2] = x[2] - x[0];
-			btScalar *scan = &m_buffer[miy * m_sizes[0] + mix];
-			for (int ix = mix; ix < mxx; ++ix) {
-				if (dx[0] >= 0 && POLICY::Process(*scan, v[0])) {
-					return true;
-				}
-				if (dx[1] >= 0 && POLICY::Process(*scan, v[1])) {
-					return true;
-				}
-				if (dx[2] >= 0 && POLICY::Process(*scan, v[2])) {
-					return true;
-				}
-				scan++;
-				v[0] += dzx[0];
-				v[1] += dzx[1];
-				v[2] += dzx[2];
-				dx[0]--;
-				dx[1]++;
-				dx[2]--;
+		btCollisionObject *object = (btCollisionObject *)proxy->m_clientObject;
+		btCollisionWorld::objectQuerySingle(m_shape, m_from, m_to, object, object->getCollisionShape(), object->getWorldTransform(),
+				m_callback, m_allowedPenetration);
+	}
+};
+
+static void ray_cast_batch_hit(PHY_RayCastHit& hit, const btCollisionObject *object, const btVector3& point, const btVector3& normal,
+		btScalar fraction)
+{
+	hit.m_controller = static_cast<CcdPhysicsController *>(object->getUserPointer());
+	const btVector3 hitNormal = (normal.length2() > (SIMD_EPSILON * SIMD_EPSILON)) ? normal.normalized() : btVector3(1.0f, 0.0f, 0.0f);
+	for (unsigned short i = 0; i < 3; ++i) {
+		hit.m_hitPoint[i] = point[i];
+		hit.m_hitNormal[i] = hitNormal[i];
+	}
+	hit.m_hitFraction = fraction;
+}
+
+struct RayCastBatchTask
+{
+	const btDbvtBroadphase *m_broadphase;
+	const PHY_RayCastQuery *m_queries;
+	PHY_RayCastHit *m_hits;
+	unsigned int m_count;
+	btScalar m_allowedPenetration;
+};
+
+static void ray_cast_batch_range(const RayCastBatchTask& task)
+{
+	const btDbvt *sets = task.m_broadphase->m_sets;
+
+	for (unsigned int i = 0; i < task.m_count; ++i) {
+		const PHY_RayCastQuery& query = task.m_queries[i];
+		PHY_RayCastHit& hit = task.m_hits[i];
+		hit.m_controller = nullptr;
+
+		const btVector3 from(query.m_from[0], query.m_from[1], query.m_from[2]);
+		const btVector3 to(query.m_to[0], query.m_to[1], query.m_to[2]);
+		const btTransform fromTrans(btMatrix3x3::getIdentity(), from);
+		const btTransform toTrans(btMatrix3x3::getIdentity(), to);
+
+		if (query.m_radius > 0.0f) {
+			const btSphereShape sphere(query.m_radius);
+			BatchClosestConvexResultCallback callback(query, from, to);
+			BatchSweepLeafCallback leafCallback(&sphere, fromTrans, toTrans, callback, task.m_allowedPenetration);
+
+			btVector3 aabbMin = from;
+			btVector3 aabbMax = from;
+			aabbMin.setMin(to);
+			aabbMax.setMax(to);
+			const btVector3 radius(query.m_radius, query.m_radius, query.m_radius);
+			const btDbvtVolume volume = btDbvtVolume::FromMM(aabbMin - radius, aabbMax + radius);
+			sets[0].collideTV(sets[0].m_root, volume, leafCallback);
+			sets[1].collideTV(sets[1].m_root, volume, leafCallback);
+
+			if (callback.hasHit()) {
+				ray_cast_batch_hit(hit, callback.m_hitCollisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld,
+						callback.m_closestHitFraction);
 			}
 		}
 		else {
-			// general case
-			const int dx[] = {y[0] - y[1],
-				              y[1] - y[2],
-				              y[2] - y[0]};
-			const int dy[] = {x[1] - x[0] - dx[0] * width,
-				              x[2] - x[1] - dx[1] * width,
-				              x[0] - x[2] - dx[2] * width};
-			const int a = x[2] * y[0] + x[0] * y[1] - x[2] * y[1] - x[0] * y[2] + x[1] * y[2] - x[1] * y[0];
-			const btScalar ia = 1 / (btScalar)a;
-			const btScalar dzx = ia * (y[2] * (z[1] - z[0]) + y[1] * (z[0] - z[2]) + y[0] * (z[2] - z[1]));
-			const btScalar dzy = ia * (x[2] * (z[0] - z[1]) + x[0] * (z[1] - z[2]) + x[1] * (z[2] - z[0])) - (dzx * width);
-			int c[] = {miy *x[1] + mix * y[0] - x[1] * y[0] - mix * y[1] + x[0] * y[1] - miy * x[0],
-				miy *x[2] + mix * y[1] - x[2] * y[1] - mix * y[2] + x[1] * y[2] - miy * x[1],
-				miy *x[0] + mix * y[2] - x[0] * y[2] - mix * y[0] + x[2] * y[0] - miy * x[2]};
-			btScalar v = ia * ((z[2] * c[0]) + (z[0] * c[1]) + (z[1] * c[2]));
-			btScalar *scan = &m_buffer[miy * m_sizes[0]];
-
-			for (int iy = miy; iy < mxy; ++iy) {
-				for (int ix = mix; ix < mxx; ++ix) {
-					if ((c[0] >= 0) && (c[1] >= 0) && (c[2] >= 0)) {
-						if (POLICY::Process(scan[ix], v)) {
-							return true;
-						}
-					}
-					c[0] += dx[0]; c[1] += dx[1]; c[2] += dx[2]; v += dzx;
-				}
-				c[0] += dy[0]; c[1] += dy[1]; c[2] += dy[2]; v += dzy;
-				scan += m_sizes[0];
+			BatchClosestRayResultCallback callback(query, from, to);
+			BatchRayLeafCallback leafCallback(fromTrans, toTrans, callback);
+
+			btDbvt::rayTest(sets[0].m_root, from, to, leafCallback);
+			btDbvt::rayTest(sets[1].m_root, from, to, leafCallback);
+
+			if (callback.hasHit()) {
+				ray_cast_batch_hit(hit, callback.m_collisionObject, callback.m_hitPointWorld, callback.m_hitNormalWorld,
+						callback.m_closestHitFraction);
 			}
 		}
-		return false;
 	}
-	// clip than write or check a polygon
-	template <const int NP, typename POLICY>
-	inline bool clipDraw(const btVector4 *p,
-	                     const float face,
-	                     btScalar minarea)
-	{
-		btVector4 o[NP * 2];
-		int n = clip<NP>(p, o);
-		bool earlyexit = false;
-		if (n) {
-			project(o, n);
-			for (int i = 2; i < n && !earlyexit; ++i) {
-				earlyexit |= draw<POLICY>(o[0], o[i - 1], o[i], face, minarea);
-			}
-		}
-		return earlyexit;
+}
+
+static void ray_cast_batch_task_func(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	ray_cast_batch_range(*(RayCastBatchTask *)taskdata);
+}
+
+/// Number of queries computed by a task of a batch.
+#define RAY_CAST_BATCH_TASK_SIZE 32
+
+void CcdPhysicsEnvironment::RayTestBatch(const std::vector<PHY_RayCastQuery>& queries, std::vector<PHY_RayCastHit>& hits)
+{
+	const unsigned int count = queries.size();
+	hits.resize(count);
+	if (count == 0) {
+		return;
 	}
-	// add a triangle (in model coordinate)
-	// face =  0.f if face is double side,
-	//      =  1.f if face is single sided and scale is positive
-	//      = -1.f if face is single sided and scale is negative
-	void appendOccluderM(const float *a,
-	                     const float *b,
-	                     const float *c,
-	                     const float face)
-	{
-		btVector4 p[3];
-		transformM(a, p[0]);
-		transformM(b, p[1]);
-		transformM(c, p[2]);
-		clipDraw<3, WriteOCL>(p, face, btScalar(0.0f));
+
+	const btDbvtBroadphase *broadphase = static_cast<btDbvtBroadphase *>(m_broadphase);
+	const btScalar allowedPenetration = m_dynamicsWorld->getDispatchInfo().m_allowedCcdPenetration;
+
+	if (count <= RAY_CAST_BATCH_TASK_SIZE) {
+		const RayCastBatchTask task = {broadphase, queries.data(), hits.data(), count, allowedPenetration};
+		ray_cast_batch_range(task);
+		return;
 	}
 
-	// query occluder for a box (c=center, e=extend) in world coordinate
-	inline bool queryOccluderW(const btVector3 &c,
-	                           const btVector3 &e)
-	{
-		if (!m_occlusion) {
-			// no occlusion yet, no need to check
-			return true;
-		}
-		btVector4 x[8];
-		transformW(btVector3(c[0] - e[0], c[1] - e[1], c[2] - e[2]), x[0]);
-		transformW(btVector3(c[0] + e[0], c[1] - e[1], c[2] - e[2]), x[1]);
-		transformW(btVector3(c[0] + e[0], c[1] + e[1], c[2] - e[2]), x[2]);
-		transformW(btVector3(c[0] - e[0], c[1] + e[1], c[2] - e[2]), x[3]);
-		transformW(btVector3(c[0] - e[0], c[1] - e[1], c[2] + e[2]), x[4]);
-		transformW(btVector3(c[0] + e[0], c[1] - e[1], c[2] + e[2]), x[5]);
-		transformW(btVector3(c[0] + e[0], c[1] + e[1], c[2] + e[2]), x[6]);
-		transformW(btVector3(c[0] - e[0], c[1] + e[1], c[2] + e[2]), x[7]);
-
-		for (int i = 0; i < 8; ++i) {
-			// the box is clipped, it's probably a large box, don't waste our time to check
-			if ((x[i][2] + x[i][3]) <= 0) {
-				return true;
-			}
-		}
-		static const int d[] = {1, 0, 3, 2,
-			                    4, 5, 6, 7,
-			                    4, 7, 3, 0,
-			                    6, 5, 1, 2,
-			                    7, 6, 2, 3,
-			                    5, 4, 0, 1};
-		for (unsigned int i = 0; i < (sizeof(d) / sizeof(d[0])); ) {
-			const btVector4 p[] = {x[d[i + 0]],
-				                   x[d[i + 1]],
-				                   x[d[i + 2]],
-				                   x[d[i + 3]]};
-			i += 4;
-			if (clipDraw<4, QueryOCL>(p, 1.0f, 0.0f)) {
-				return true;
-			}
-		}
-		return false;
+	std::vector<RayCastBatchTask> tasks;
+	for (unsigned int begin = 0; begin < count; begin += RAY_CAST_BATCH_TASK_SIZE) {
+		const unsigned int size = std::min(count - begin, (unsigned int)RAY_CAST_BATCH_TASK_SIZE);
+		tasks.push_back({broadphase, &queries[begin], &hits[begin], size, allowedPenetration});
 	}
-};
 
+	TaskPool *pool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), nullptr);
+	for (RayCastBatchTask& task : tasks) {
+		BLI_task_pool_push(pool, ray_cast_batch_task_func, &task, false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
 
 struct  DbvtCullingCallback : btDbvt::ICollide {
 	PHY_CullingCallback m_clientCallback;
 	void *m_userData;
-	OcclusionBuffer *m_ocb;
+	SG_OcclusionBuffer *m_ocb;
 
 	DbvtCullingCallback(PHY_CullingCallback clientCallback, void *userData)
 	{
@@ -1848,7 +1589,11 @@ struct  DbvtCullingCallback : btDbvt::ICollide {
 	}
 	bool Descent(const btDbvtNode *node)
 	{
-		return(m_ocb->queryOccluderW(node->volume.Center(), node->volume.Extents()));
+		const btVector3 center = node->volume.Center();
+		const btVector3 extents = node->volume.Extents();
+		const float c[3] = {center.x(), center.y(), center.z()};
+		const float e[3] = {extents.x(), extents.y(), extents.z()};
+		return m_ocb->QueryBox(c, e);
 	}
 	void Process(const btDbvtNode *node, btScalar depth)
 	{
@@ -1867,7 +1612,7 @@ struct  DbvtCullingCallback : btDbvt::ICollide {
 				const MT_Transform trans = gameobj->NodeGetWorldTransform();
 				float fl[16];
 				trans.getValue(fl);
-				// this will create the occlusion buffer if not already done
+				// this will clear the occlusion buffer if not already done
 				// and compute the transformation from model local space to clip space
 				m_ocb->SetModelMatrix(fl);
 				const float negative = gameobj->IsNegativeScaling();
@@ -1880,10 +1625,10 @@ struct  DbvtCullingCallback : btDbvt::ICollide {
 
 						for (unsigned int j = 0, size = array->GetTriangleIndexCount(); j < size; j += 3) {
 							const unsigned int index = array->GetTriangleIndex(j);
-							m_ocb->appendOccluderM(array->GetVertex(index).GetXYZ(),
-												   array->GetVertex(index + 1).GetXYZ(),
-												   array->GetVertex(index + 2).GetXYZ(),
-												   face);
+							m_ocb->AppendOccluder(array->GetVertex(index).GetXYZ(),
+												  array->GetVertex(index + 1).GetXYZ(),
+												  array->GetVertex(index + 2).GetXYZ(),
+												  face);
 						}
 					}
 				}
@@ -1894,7 +1639,6 @@ struct  DbvtCullingCallback : btDbvt::ICollide {
 	}
 };
 
-static OcclusionBuffer gOcb;
 bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback, void *userData, const std::array<MT_Vector4, 6>& planes,
 										int occlusionRes, const int *viewport, const MT_Matrix4x4& matrix)
 {
@@ -1911,8 +1655,8 @@ bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback, void *user
 	if (occlusionRes) {
 		float mat[16];
 		matrix.getValue(mat);
-		gOcb.setup(occlusionRes, viewport, mat);
-		dispatcher.m_ocb = &gOcb;
+		m_occlusionBuffer.Setup(occlusionRes, viewport, mat);
+		dispatcher.m_ocb = &m_occlusionBuffer;
 		// occlusion culling, the direction of the view is taken from the first plan which MUST be the near plane
 		btDbvt::collideOCL(m_cullingTree->m_sets[1].m_root, planes_n, planes_o, planes_n[0], 6, dispatcher);
 		btDbvt::collideOCL(m_cullingTree->m_sets[0].m_root, planes_n, planes_o, planes_n[0], 6, dispatcher);
@@ -1924,6 +1668,128 @@ bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback, void *user
 	return true;
 }
 
+/// Node of the culling tree to test against the views not yet culled.
+struct MultiCullingNode
+{
+	const btDbvtNode *m_node;
+	/// Views in which the node is not outside.
+	unsigned int m_visible;
+	/// Views in which the node is fully inside, they are not tested for the children.
+	unsigned int m_inside;
+};
+
+static void multi_culling_leaf(const btDbvtNode *leaf, unsigned int viewMask, PHY_MultiCullingCallback callback, void *userData)
+{
+	btBroadphaseProxy *proxy = (btBroadphaseProxy *)leaf->data;
+	// the client object is a graphic controller
+	CcdGraphicController *ctrl = static_cast<CcdGraphicController *>(proxy->m_clientObject);
+	KX_ClientObjectInfo *info = (KX_ClientObjectInfo *)ctrl->GetNewClientInfo();
+	if (info) {
+		(*callback)(info, viewMask, userData);
+	}
+}
+
+static void multi_culling_enum_leaves(const btDbvtNode *node, unsigned int viewMask, PHY_MultiCullingCallback callback, void *userData)
+{
+	if (node->isinternal()) {
+		multi_culling_enum_leaves(node->childs[0], viewMask, callback, userData);
+		multi_culling_enum_leaves(node->childs[1], viewMask, callback, userData);
+	}
+	else {
+		multi_culling_leaf(node, viewMask, callback, userData);
+	}
+}
+
+bool CcdPhysicsEnvironment::MultiCullingTest(PHY_MultiCullingCallback callback, void *userData,
+											 const std::vector<std::array<MT_Vector4, 6> >& planes)
+{
+	if (!m_cullingTree) {
+		return false;
+	}
+
+	const unsigned int numViews = planes.size();
+	BLI_assert(numViews <= PHY_MAX_CULLING_VIEWS);
+	if (numViews == 0) {
+		return true;
+	}
+
+	std::vector<btVector3> planes_n(numViews * 6);
+	std::vector<btScalar> planes_o(numViews * 6);
+	std::vector<int> signs(numViews * 6);
+	for (unsigned int i = 0; i < numViews; ++i) {
+		for (unsigned short j = 0; j < 6; ++j) {
+			const unsigned int index = i * 6 + j;
+			const btVector3 normal = ToBullet(planes[i][j]);
+			planes_n[index] = normal;
+			planes_o[index] = planes[i][j][3];
+			// Same sign encoding as btDbvt::collideKDOP.
+			signs[index] = ((normal.x() >= 0) ? 1 : 0) + ((normal.y() >= 0) ? 2 : 0) + ((normal.z() >= 0) ? 4 : 0);
+		}
+	}
+
+	const unsigned int allViews = (numViews == 32) ? ~0u : ((1u << numViews) - 1);
+
+	std::vector<MultiCullingNode> stack;
+	for (const btDbvtNode *root : {m_cullingTree->m_sets[1].m_root, m_cullingTree->m_sets[0].m_root}) {
+		if (!root) {
+			continue;
+		}
+
+		stack.push_back({root, allViews, 0});
+		while (!stack.empty()) {
+			MultiCullingNode entry = stack.back();
+			stack.pop_back();
+
+			// Test the node volume only against the views where it is intersecting.
+			const unsigned int tested = entry.m_visible & ~entry.m_inside;
+			for (unsigned int i = 0; i < numViews; ++i) {
+				const unsigned int bit = (1u << i);
+				if (!(tested & bit)) {
+					continue;
+				}
+
+				bool inside = true;
+				for (unsigned short j = 0; j < 6; ++j) {
+					const unsigned int index = i * 6 + j;
+					const int side = entry.m_node->volume.Classify(planes_n[index], planes_o[index], signs[index]);
+					if (side == -1) {
+						entry.m_visible &= ~bit;
+						inside = false;
+						break;
+					}
+					else if (side != 1) {
+						inside = false;
+					}
+				}
+
+				if (inside) {
+					entry.m_inside |= bit;
+				}
+			}
+
+			if (entry.m_visible == 0) {
+				continue;
+			}
+
+			if (entry.m_node->isinternal()) {
+				// All the views are fully containing the node, no more tests needed.
+				if (entry.m_inside == entry.m_visible) {
+					multi_culling_enum_leaves(entry.m_node, entry.m_visible, callback, userData);
+				}
+				else {
+					stack.push_back({entry.m_node->childs[0], entry.m_visible, entry.m_inside});
+					stack.push_back({entry.m_node->childs[1], entry.m_visible, entry.m_inside});
+				}
+			}
+			else {
+				multi_culling_leaf(entry.m_node, entry.m_visible, callback, userData);
+			}
+		}
+	}
+
+	return true;
+}
+
 int CcdPhysicsEnvironment::GetNumContactPoints()
 {
 	return 0;
@@ -1951,11 +1817,8 @@ void CcdPhysicsEnvironment::MergeEnvironment(PHY_IPhysicsEnvironment *other_env)
 		return;
 	}
 
-	std::set<CcdPhysicsController *>::iterator it;
-
-	while (other->m_controllers.begin() != other->m_controllers.end()) {
-		it = other->m_controllers.begin();
-		CcdPhysicsController *ctrl = (*it);
+	while (!other->m_controllers.empty()) {
+		CcdPhysicsController *ctrl = other->m_controllers.back();
 
 		other->RemoveCcdPhysicsController(ctrl, true);
 		this->AddCcdPhysicsController(ctrl);
@@ -2668,6 +2531,7 @@ CcdPhysicsEnvironment *CcdPhysicsEnvironment::Create(Scene *blenderscene, bool v
 	ccdPhysEnv->SetDeactivationLinearTreshold(blenderscene->gm.lineardeactthreshold);
 	ccdPhysEnv->SetDeactivationAngularTreshold(blenderscene->gm.angulardeactthreshold);
 	ccdPhysEnv->SetDeactivationTime(blenderscene->gm.deactivationtime);
+	ccdPhysEnv->SetParallelSolving((blenderscene->gm.flag & GAME_PARALLEL_PHYSICS) != 0);
 
 	if (visualizePhysics) {
 		ccdPhysEnv->SetDebugMode(btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawAabb | btIDebugDraw::DBG_DrawContactPoints |
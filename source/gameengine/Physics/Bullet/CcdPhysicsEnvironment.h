@@ -26,10 +26,14 @@
 #include "KX_Globals.h"
 
 #include "CcdPhysicsController.h"
+#include "CcdDynamicsWorld.h"
+
+#include "SG_OcclusionBuffer.h"
 
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
 class CcdGraphicController;
 #include "LinearMath/btVector3.h"
 #include "LinearMath/btTransform.h"
@@ -48,6 +52,7 @@ struct btDbvtBroadphase;
 class btOverlappingPairCache;
 class btIDebugDraw;
 class btDynamicsWorld;
+class btConstraintSolver;
 class PHY_IVehicle;
 class CcdOverlapFilterCallBack;
 class CcdShapeConstructionInfo;
@@ -84,6 +89,8 @@ protected:
 	btOverlappingPairCache *m_cullingCache;
 	/// broadphase for culling
 	struct btDbvtBroadphase *m_cullingTree;
+	/// Occlusion buffer of the scene, used by the occlusion culling of each view.
+	SG_OcclusionBuffer m_occlusionBuffer;
 
 	/// solver iterations
 	int m_numIterations;
@@ -101,6 +108,9 @@ protected:
 
 	void ProcessFhSprings(double curTime, float timeStep);
 
+	/// Create a new constraint solver of the environment solver type.
+	btConstraintSolver *CreateSolver() const;
+
 public:
 	CcdPhysicsEnvironment(PHY_SolverType solverType, bool useDbvtCulling);
 
@@ -125,6 +135,8 @@ public:
 	virtual void SetContactBreakingTreshold(float contactBreakingTreshold);
 	virtual void SetCcdMode(int ccdMode);
 	virtual void SetSolverType(PHY_SolverType solverType);
+	/// Solve the constraints of the simulation islands on the worker threads of the engine.
+	void SetParallelSolving(bool parallel);
 	virtual void SetSolverSorConstant(float sor);
 	virtual void SetSolverTau(float tau);
 	virtual void SetSolverDamping(float damping);
@@ -187,8 +199,11 @@ public:
 	btTypedConstraint *GetConstraintById(int constraintId);
 
 	virtual PHY_IPhysicsController *RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX, float fromY, float fromZ, float toX, float toY, float toZ);
+	virtual void RayTestBatch(const std::vector<PHY_RayCastQuery>& queries, std::vector<PHY_RayCastHit>& hits);
 	virtual bool CullingTest(PHY_CullingCallback callback, void *userData, const std::array<MT_Vector4, 6>& planes,
 							 int occlusionRes, const int *viewport, const MT_Matrix4x4& matrix);
+	virtual bool MultiCullingTest(PHY_MultiCullingCallback callback, void *userData,
+								  const std::vector<std::array<MT_Vector4, 6> >& planes);
 
 
 	//Methods for gamelogic collision/physics callbacks
@@ -269,7 +284,10 @@ public:
 	                                    bRigidBodyJointConstraint *dat);
 
 protected:
-	std::set<CcdPhysicsController *> m_controllers;
+	/// Dense array of the controllers, iterated each step to synchronize the motion states.
+	std::vector<CcdPhysicsController *> m_controllers;
+	/// Index of each controller in m_controllers.
+	std::unordered_map<CcdPhysicsController *, unsigned int> m_controllerIndices;
 
 	PHY_ResponseCallback m_triggerCallbacks[PHY_NUM_RESPONSE];
 	void *m_triggerCallbacksUserPtrs[PHY_NUM_RESPONSE];
@@ -283,9 +301,13 @@ protected:
 	 * Ideally we would like to have access to this function from the btDynamicsWorld interface
 	 */
 	// class btDynamicsWorld *m_dynamicsWorld;
-	class btSoftRigidDynamicsWorld *m_dynamicsWorld;
+	CcdDynamicsWorld *m_dynamicsWorld;
 
 	class btConstraintSolver *m_solver;
+	/// True when the islands are solved in parallel.
+	bool m_parallelSolving;
+	/// Start time of the current sub step in the timeline.
+	double m_subStepStartTime;
 
 	class btOverlappingPairCache *m_ownPairCache;
 
@@ -293,7 +315,7 @@ protected:
 
 	class btGhostPairCallback *m_ghostPairCallback;
 
-	class btDispatcher *m_ownDispatcher;
+	class btCollisionDispatcher *m_ownDispatcher;
 
 	virtual void ExportFile(const std::string& filename);
 };
@@ -63,6 +63,10 @@ typedef bool (*PHY_ResponseCallback)(void *client_data,
                                      void *client_object2,
                                      const PHY_CollData *coll_data);
 typedef void (*PHY_CullingCallback)(KX_ClientObjectInfo *info, void *param);
+/// Culling callback of several views, viewMask contains a bit per view the object is visible in.
+typedef void (*PHY_MultiCullingCallback)(KX_ClientObjectInfo *info, unsigned int viewMask, void *param);
+/// Maximum number of views of PHY_IPhysicsEnvironment::MultiCullingTest, the size of the view mask.
+#define PHY_MAX_CULLING_VIEWS 32
 
 /// PHY_PhysicsType enumerates all possible Physics Entities.
 /// It is mainly used to create/add Physics Objects
@@ -39,6 +39,7 @@
 #include "MT_Vector4.h"
 
 #include <array>
+#include <vector>
 
 class PHY_IConstraint;
 class PHY_IVehicle;
@@ -69,6 +70,27 @@ struct PHY_RayCastResult {
 	MT_Vector2 m_hitUV; // UV coordinates of hit point
 };
 
+/**
+ * A ray or a sphere sweep of a batch query.
+ */
+struct PHY_RayCastQuery {
+	float m_from[3];
+	float m_to[3];
+	float m_radius; // radius of the swept sphere, 0 for a ray
+	unsigned short m_mask; // user collision groups the ray can hit
+	PHY_IPhysicsController *m_ignoreController; // controller never hit, can be nullptr
+};
+
+/**
+ * Closest hit of a batch query, m_controller is nullptr if nothing was hit.
+ */
+struct PHY_RayCastHit {
+	PHY_IPhysicsController *m_controller;
+	float m_hitPoint[3];
+	float m_hitNormal[3];
+	float m_hitFraction; // fraction of the ray or the sweep where the hit occured
+};
+
 /**
  * This class replaces the ignoreController parameter of rayTest function.
  * It allows more sophisticated filtering on the physics controller before computing the ray intersection to save CPU.
@@ -205,12 +227,21 @@ public:
 	virtual PHY_ICharacter *GetCharacterController(class KX_GameObject *ob) = 0;
 
 	virtual PHY_IPhysicsController *RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX, float fromY, float fromZ, float toX, float toY, float toZ) = 0;
+	/** Cast several rays or sphere sweeps and return the closest hit of each one in hits.
+	 * The queries only read the broadphase and are executed in parallel, the physics
+	 * must not be modified during the call. Sensor objects are never hit.
+	 */
+	virtual void RayTestBatch(const std::vector<PHY_RayCastQuery>& queries, std::vector<PHY_RayCastHit>& hits) = 0;
 
 	// culling based on physical broad phase
 	// the plane number must be set as follow: near, far, left, right, top, botton
 	// the near plane must be the first one and must always be present, it is used to get the direction of the view
 	virtual bool CullingTest(PHY_CullingCallback callback, void *userData, const std::array<MT_Vector4, 6>& planes,
 							 int occlusionRes, const int *viewport, const MT_Matrix4x4& matrix) = 0;
+	// culling of several views in a single walk of the broad phase, without occlusion
+	// the number of views is limited to PHY_MAX_CULLING_VIEWS
+	virtual bool MultiCullingTest(PHY_MultiCullingCallback callback, void *userData,
+								  const std::vector<std::array<MT_Vector4, 6> >& planes) = 0;
 
 	// Methods for gamelogic collision/physics callbacks
 	virtual void AddSensor(PHY_IPhysicsController *ctrl) = 0;
@@ -103,3 +103,11 @@ PHY_IPhysicsController *DummyPhysicsEnvironment::RayTest(PHY_IRayCastFilterCallb
 	return nullptr;
 }
 
+void DummyPhysicsEnvironment::RayTestBatch(const std::vector<PHY_RayCastQuery>& queries, std::vector<PHY_RayCastHit>& hits)
+{
+	hits.resize(queries.size());
+	for (PHY_RayCastHit& hit : hits) {
+		hit.m_controller = nullptr;
+	}
+}
+
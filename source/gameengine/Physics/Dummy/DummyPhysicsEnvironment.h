@@ -80,11 +80,17 @@ public:
 	}
 
 	virtual PHY_IPhysicsController *RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX, float fromY, float fromZ, float toX, float toY, float toZ);
+	virtual void RayTestBatch(const std::vector<PHY_RayCastQuery>& queries, std::vector<PHY_RayCastHit>& hits);
 	virtual bool CullingTest(PHY_CullingCallback callback, void *userData, const std::array<MT_Vector4, 6>& planes,
 							 int occlusionRes, const int *viewport, const MT_Matrix4x4& matrix)
 	{
 		return false;
 	}
+	virtual bool MultiCullingTest(PHY_MultiCullingCallback callback, void *userData,
+								  const std::vector<std::array<MT_Vector4, 6> >& planes)
+	{
+		return false;
+	}
 
 	//gamelogic callbacks
 	virtual void AddSensor(PHY_IPhysicsController *ctrl)
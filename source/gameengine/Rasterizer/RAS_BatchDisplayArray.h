@@ -68,12 +68,34 @@ public:
 		return nullptr;
 	}
 
-	/** Merge array in the batched array.
+protected:
+	/** Transform vertices in place, the position by the full matrix and the normal
+	 * and tangent by its 3x3 part. The tangent sign in w is left untouched.
+	 * \param vertexes The first vertex to transform.
+	 * \param count The number of vertices.
+	 * \param mat The transformation in column major order.
+	 */
+	static void TransformVertices(VertexData *vertexes, unsigned int count, const float mat[4][4])
+	{
+		for (VertexData *data = vertexes, *end = vertexes + count; data != end; ++data) {
+			const float pos[3] = {data->position[0], data->position[1], data->position[2]};
+			const float nor[3] = {data->normal[0], data->normal[1], data->normal[2]};
+			const float tan[3] = {data->tangent[0], data->tangent[1], data->tangent[2]};
+
+			for (unsigned short i = 0; i < 3; ++i) {
+				data->position[i] = mat[0][i] * pos[0] + mat[1][i] * pos[1] + mat[2][i] * pos[2] + mat[3][i];
+				data->normal[i] = mat[0][i] * nor[0] + mat[1][i] * nor[1] + mat[2][i] * nor[2];
+				data->tangent[i] = mat[0][i] * tan[0] + mat[1][i] * tan[1] + mat[2][i] * tan[2];
+			}
+		}
+	}
+
+	/** Append a part without updating the vertex cache.
 	 * \param iarray The array to merge, must be of the same vertex format than the
 	 * batched array.
 	 * \param mat The transformation to apply on each vertex in the merging.
 	 */
-	virtual unsigned int Merge(RAS_IDisplayArray *iarray, const MT_Matrix4x4& mat)
+	void MergePart(RAS_IDisplayArray *iarray, const MT_Matrix4x4& mat)
 	{
 		RAS_DisplayArray<VertexData> *array = dynamic_cast<RAS_DisplayArray<VertexData> *>(iarray);
 		const unsigned int vertexcount = iarray->GetVertexCount();
@@ -91,32 +113,33 @@ public:
 		part.m_indexOffset = (void *)(part.m_startIndex * sizeof(unsigned int));
 		m_parts.push_back(part);
 
-		// Pre-allocate vertex list and index list.
-		m_vertexes.resize(startvertex + vertexcount);
-		m_primitiveIndices.resize(startindex + indexcount);
-
 #if 0
 		CM_Debug("Add part : " << (m_parts.size() - 1) << ", start index: " << startindex << ", index count: " << indexcount << ", start vertex: " << startvertex << ", vertex count: " << vertexcount);
 #endif  // DEBUG
 
-		// Normal and tangent matrix.
-		MT_Matrix4x4 nmat = mat;
-		nmat[0][3] = nmat[1][3] = nmat[2][3] = 0.0f;
-
-		// Copy the vertex by not using a reference in the loop.
-		for (unsigned int i = 0; i < vertexcount; ++i) {
-			VertexData data = array->m_vertexes[i];
-			RAS_Vertex vert(&data, m_format);
-			// Transform the vertex position, normal and tangent.
-			vert.Transform(mat, nmat);
-			// Add the vertex in the list.
-			m_vertexes[startvertex + i] = data;
-		}
+		// Copy the vertices in one block and transform the copy in place.
+		m_vertexes.insert(m_vertexes.end(), array->m_vertexes.begin(), array->m_vertexes.end());
+
+		float fmat[4][4];
+		mat.getValue(&fmat[0][0]);
+		TransformVertices(m_vertexes.data() + startvertex, vertexcount, fmat);
 
 		// Copy the indices of the merged array with as gap the first vertex index.
+		m_primitiveIndices.resize(startindex + indexcount);
 		for (unsigned int i = 0; i < indexcount; ++i) {
 			m_primitiveIndices[startindex + i] = (array->m_primitiveIndices[i] + startvertex);
 		}
+	}
+
+public:
+	/** Merge array in the batched array.
+	 * \param iarray The array to merge, must be of the same vertex format than the
+	 * batched array.
+	 * \param mat The transformation to apply on each vertex in the merging.
+	 */
+	virtual unsigned int Merge(RAS_IDisplayArray *iarray, const MT_Matrix4x4& mat)
+	{
+		MergePart(iarray, mat);
 
 		// Update the cache to avoid accessing dangling vertex pointer from GetVertex().
 		RAS_DisplayArray<VertexData>::UpdateCache();
@@ -124,6 +147,36 @@ public:
 		return (m_parts.size() - 1);
 	}
 
+	/** Merge multiple arrays in the batched array. The storage is grown once
+	 * and the vertex cache is updated once for all the parts.
+	 * \param iarrays The arrays to merge, must be of the same vertex format than the
+	 * batched array.
+	 * \param mats The transformation to apply on the vertices of each array.
+	 * \return The index of the first part added.
+	 */
+	virtual unsigned int Merge(const std::vector<RAS_IDisplayArray *>& iarrays, const std::vector<MT_Matrix4x4>& mats)
+	{
+		unsigned int vertexcount = m_vertexes.size();
+		unsigned int indexcount = m_primitiveIndices.size();
+		for (RAS_IDisplayArray *iarray : iarrays) {
+			vertexcount += iarray->GetVertexCount();
+			indexcount += iarray->GetPrimitiveIndexCount();
+		}
+
+		m_vertexes.reserve(vertexcount);
+		m_primitiveIndices.reserve(indexcount);
+		m_parts.reserve(m_parts.size() + iarrays.size());
+
+		const unsigned int firstPart = m_parts.size();
+		for (unsigned int i = 0, size = iarrays.size(); i < size; ++i) {
+			MergePart(iarrays[i], mats[i]);
+		}
+
+		RAS_DisplayArray<VertexData>::UpdateCache();
+
+		return firstPart;
+	}
+
 	virtual void Split(unsigned int partIndex)
 	{
 		const Part &part = m_parts[partIndex];
@@ -92,17 +92,38 @@ bool RAS_BatchGroup::MergeMeshSlot(RAS_BatchGroup::Batch& batch, RAS_MeshSlot *s
 	batch.m_originalDisplayArrayBucketList[slot] = origArrayBucket;
 	batch.m_meshSlots.push_back(slot);
 
-	// Merge display array.
-	const unsigned int index = array->Merge(origArray, mat);
-	slot->m_batchPartIndex = index;
-
-	arrayBucket->DestructStorageInfo();
+	// Defer the display array merge to merge all the mesh slots of the batch at once.
+	batch.m_pendingArrays.push_back(origArray);
+	batch.m_pendingMatrices.push_back(mat);
 
 	slot->SetDisplayArrayBucket(arrayBucket);
 
 	return true;
 }
 
+void RAS_BatchGroup::MergePendingArrays()
+{
+	for (auto& pair : m_batchs) {
+		Batch& batch = pair.second;
+		const unsigned int count = batch.m_pendingArrays.size();
+		if (count == 0) {
+			continue;
+		}
+
+		const unsigned int firstIndex = batch.m_displayArray->Merge(batch.m_pendingArrays, batch.m_pendingMatrices);
+
+		// The pending mesh slots are the last ones of the list, in the order of the parts.
+		for (unsigned int i = 0, start = batch.m_meshSlots.size() - count; i < count; ++i) {
+			batch.m_meshSlots[start + i]->m_batchPartIndex = firstIndex + i;
+		}
+
+		batch.m_displayArrayBucket->DestructStorageInfo();
+
+		batch.m_pendingArrays.clear();
+		batch.m_pendingMatrices.clear();
+	}
+}
+
 bool RAS_BatchGroup::SplitMeshSlot(RAS_MeshSlot *slot)
 {
 	RAS_MaterialBucket *bucket = slot->m_displayArrayBucket->GetBucket();
@@ -143,7 +164,7 @@ bool RAS_BatchGroup::SplitMeshSlot(RAS_MeshSlot *slot)
 	return true;
 }
 
-bool RAS_BatchGroup::MergeMeshUser(RAS_MeshUser *meshUser, const MT_Matrix4x4& mat)
+bool RAS_BatchGroup::MergeMeshUserSlots(RAS_MeshUser *meshUser, const MT_Matrix4x4& mat)
 {
 	for (RAS_MeshSlot *meshSlot : meshUser->GetMeshSlots()) {
 		RAS_DisplayArrayBucket *arrayBucket = meshSlot->m_displayArrayBucket;
@@ -169,6 +190,28 @@ bool RAS_BatchGroup::MergeMeshUser(RAS_MeshUser *meshUser, const MT_Matrix4x4& m
 	return true;
 }
 
+bool RAS_BatchGroup::MergeMeshUser(RAS_MeshUser *meshUser, const MT_Matrix4x4& mat)
+{
+	const bool result = MergeMeshUserSlots(meshUser, mat);
+	MergePendingArrays();
+
+	return result;
+}
+
+unsigned int RAS_BatchGroup::MergeMeshUsers(const std::vector<RAS_MeshUser *>& meshUsers, const std::vector<MT_Matrix4x4>& mats)
+{
+	unsigned int merged = 0;
+	for (unsigned int i = 0, size = meshUsers.size(); i < size; ++i) {
+		if (MergeMeshUserSlots(meshUsers[i], mats[i])) {
+			++merged;
+		}
+	}
+
+	MergePendingArrays();
+
+	return merged;
+}
+
 bool RAS_BatchGroup::SplitMeshUser(RAS_MeshUser *meshUser)
 {
 	for (RAS_MeshSlot *meshSlot : meshUser->GetMeshSlots()) {
@@ -54,18 +54,30 @@ private:
 		std::map<RAS_MeshSlot *, RAS_DisplayArrayBucket *> m_originalDisplayArrayBucketList;
 		/// All the mesh slots sorted by batch index.
 		RAS_MeshSlotList m_meshSlots;
+
+		/// The display arrays and matrices of the mesh slots waiting to be merged, at the end of m_meshSlots.
+		std::vector<RAS_IDisplayArray *> m_pendingArrays;
+		std::vector<MT_Matrix4x4> m_pendingMatrices;
 	};
 
 	/// The batch per material.
 	std::map<RAS_IPolyMaterial *, Batch> m_batchs;
 
-	/** Merge the display array of the passed mesh slot.
+	/** Register the display array of the passed mesh slot to be merged by MergePendingArrays.
 	 * \param slot The mesh slot using the display array to merge.
 	 * \param mat The transform matrix to apply to vertices during merging.
 	 * \return false on failure.
 	 */
 	bool MergeMeshSlot(Batch& batch, RAS_MeshSlot *slot, const MT_Matrix4x4& mat);
 
+	/** Register the mesh slots of a mesh user to be merged by MergePendingArrays.
+	 * \return false on failure.
+	 */
+	bool MergeMeshUserSlots(RAS_MeshUser *meshUser, const MT_Matrix4x4& mat);
+
+	/// Merge the display arrays registered in all the batches, one bulk merge per batch.
+	void MergePendingArrays();
+
 	/** Split the part representing the display array containing in the passed mesh slot.
 	 * \param slot The mesh slot using the display array to split.
 	 * \return false on failure.
@@ -89,6 +101,14 @@ public:
 	 */
 	bool MergeMeshUser(RAS_MeshUser *meshUser, const MT_Matrix4x4& mat);
 
+	/** Merge the display array of the mesh slots contained in a list of mesh users.
+	 * The vertices of all the mesh users are appended once per material.
+	 * \param meshUsers The mesh users to merge mesh slots from.
+	 * \param mats The object matrix of each mesh user.
+	 * \return The number of mesh users merged, the failed ones don't use this batch group.
+	 */
+	unsigned int MergeMeshUsers(const std::vector<RAS_MeshUser *>& meshUsers, const std::vector<MT_Matrix4x4>& mats);
+
 	/** Split the display array of the mesh slots contained in the mesh user.
 	 * \param meshUser THe mesh user to merge mesh slots from.
 	 * \return false on failure.
@@ -75,6 +75,13 @@ public:
 	 */
 	virtual unsigned int Merge(RAS_IDisplayArray *iarray, const MT_Matrix4x4& mat) = 0;
 
+	/** Merge a list of display arrays, each one with its transform matrix.
+	 * \param iarrays The display arrays to merge.
+	 * \param mats The matrices applied on the vertices of each display array.
+	 * \return The index of the first part added, the following parts use the next indices.
+	 */
+	virtual unsigned int Merge(const std::vector<RAS_IDisplayArray *>& iarrays, const std::vector<MT_Matrix4x4>& mats) = 0;
+
 	/** Split a part.
 	 * \param partIndex The index of the part to remove.
 	 */
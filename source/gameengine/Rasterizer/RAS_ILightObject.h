@@ -93,6 +93,8 @@ public:
 	virtual MT_Matrix4x4 GetViewMat() = 0;
 	virtual MT_Matrix4x4 GetWinMat() = 0;
 	virtual int GetShadowLayer() = 0;
+	/// Return the projection multiplied by the view matrix used by the next BindShadowBuffer.
+	virtual MT_Matrix4x4 GetShadowFrustumMatrix() = 0;
 	virtual void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans) = 0;
 	virtual void UnbindShadowBuffer() = 0;
 	virtual Image *GetTextureImage(short texslot) = 0;
@@ -212,6 +212,21 @@ MT_Matrix4x4 RAS_OpenGLLight::GetShadowMatrix()
 	return mat;
 }
 
+MT_Matrix4x4 RAS_OpenGLLight::GetShadowFrustumMatrix()
+{
+	GPULamp *lamp = GetGPULamp();
+	if (!lamp) {
+		return MT_Matrix4x4::Identity();
+	}
+
+	// Compute the matrices as GPU_lamp_shadow_buffer_bind without binding the buffer.
+	GPU_lamp_update_buffer_mats(lamp);
+	const MT_Matrix4x4 modelviewmat(GPU_lamp_get_viewmat(lamp));
+	const MT_Matrix4x4 projectionmat(GPU_lamp_get_winmat(lamp));
+
+	return projectionmat * modelviewmat;
+}
+
 int RAS_OpenGLLight::GetShadowLayer()
 {
 	GPULamp *lamp;
@@ -55,6 +55,7 @@ public:
 	MT_Matrix4x4 GetViewMat();
 	MT_Matrix4x4 GetWinMat();
 	MT_Matrix4x4 GetShadowMatrix();
+	MT_Matrix4x4 GetShadowFrustumMatrix();
 	int GetShadowLayer();
 	void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans);
 	void UnbindShadowBuffer();
@@ -2,6 +2,10 @@
 
 #include "MT_Frustum.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 SG_Frustum::SG_Frustum(const MT_Matrix4x4& matrix)
 	:m_matrix(matrix)
 {
@@ -63,6 +67,60 @@ SG_Frustum::TestType SG_Frustum::SphereInsideFrustum(const MT_Vector3& center, f
 	return INSIDE;
 }
 
+void SG_Frustum::SpheresInsideFrustum(const float *x, const float *y, const float *z, const float *radius,
+		TestType *results, unsigned int count) const
+{
+	unsigned int i = 0;
+
+#ifdef __SSE2__
+	const __m128 signmask = _mm_set1_ps(-0.0f);
+
+	for (; i + 4 <= count; i += 4) {
+		const __m128 cx = _mm_loadu_ps(x + i);
+		const __m128 cy = _mm_loadu_ps(y + i);
+		const __m128 cz = _mm_loadu_ps(z + i);
+		const __m128 rad = _mm_loadu_ps(radius + i);
+		const __m128 negrad = _mm_xor_ps(rad, signmask);
+
+		__m128 outside = _mm_setzero_ps();
+		__m128 intersect = _mm_setzero_ps();
+		// Spheres which already got a result from a previous plane, as the early exit of SphereInsideFrustum.
+		__m128 done = _mm_setzero_ps();
+
+		for (const MT_Vector4& plane : m_planes) {
+			// Same operation order as MT_Vector4::dot to keep identical results.
+			const __m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_set1_ps(plane[0]), cx),
+				_mm_mul_ps(_mm_set1_ps(plane[1]), cy)),
+				_mm_mul_ps(_mm_set1_ps(plane[2]), cz)),
+				_mm_set1_ps(plane[3]));
+
+			const __m128 out = _mm_andnot_ps(done, _mm_cmplt_ps(distance, negrad));
+			done = _mm_or_ps(done, out);
+			const __m128 inter = _mm_andnot_ps(done, _mm_cmple_ps(_mm_andnot_ps(signmask, distance), rad));
+			done = _mm_or_ps(done, inter);
+
+			outside = _mm_or_ps(outside, out);
+			intersect = _mm_or_ps(intersect, inter);
+
+			if (_mm_movemask_ps(done) == 0xF) {
+				break;
+			}
+		}
+
+		const int outsideMask = _mm_movemask_ps(outside);
+		const int intersectMask = _mm_movemask_ps(intersect);
+		for (unsigned short j = 0; j < 4; ++j) {
+			results[i + j] = (outsideMask & (1 << j)) ? OUTSIDE : ((intersectMask & (1 << j)) ? INTERSECT : INSIDE);
+		}
+	}
+#endif
+
+	for (; i < count; ++i) {
+		results[i] = SphereInsideFrustum(MT_Vector3(x[i], y[i], z[i]), radius[i]);
+	}
+}
+
 SG_Frustum::TestType SG_Frustum::BoxInsideFrustum(const std::array<MT_Vector3, 8>& box) const
 {
 	unsigned short insidePlane = 0;
@@ -31,6 +31,12 @@ public:
 
 	TestType PointInsideFrustum(const MT_Vector3& point) const;
 	TestType SphereInsideFrustum(const MT_Vector3& center, float radius) const;
+	/** Same as SphereInsideFrustum for count spheres stored as separate arrays,
+	 * four spheres are tested at once when SSE is available.
+	 * \param results The test result of each sphere.
+	 */
+	void SpheresInsideFrustum(const float *x, const float *y, const float *z, const float *radius,
+			TestType *results, unsigned int count) const;
 	TestType BoxInsideFrustum(const std::array<MT_Vector3, 8>& box) const;
 	TestType AabbInsideFrustum(const MT_Vector3& min, const MT_Vector3& max, const MT_Matrix4x4& mat) const;
 	TestType FrustumInsideFrustum(const SG_Frustum& frustum) const;
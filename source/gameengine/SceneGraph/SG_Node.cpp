@@ -32,29 +32,31 @@
 #include "SG_Node.h"
 #include "SG_Familly.h"
 #include "SG_Controller.h"
+#include "SG_TransformPool.h"
 
 #include "CM_List.h"
 
+#include "BLI_utildefines.h"
+
+#include <algorithm>
+
 static CM_ThreadMutex scheduleMutex;
 static CM_ThreadMutex transformMutex;
 
-SG_Node::SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks)
+SG_Node::SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks, const std::shared_ptr<SG_TransformPool>& pool)
 	:SG_QList(),
 	m_SGclientObject(clientobj),
 	m_SGclientInfo(clientinfo),
 	m_callbacks(callbacks),
 	m_SGparent(nullptr),
-	m_localPosition(0.0f, 0.0f, 0.0f),
-	m_localRotation(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
-	m_localScaling(1.0f, 1.0f, 1.0f),
-	m_worldPosition(0.0f, 0.0f, 0.0f),
-	m_worldRotation(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
-	m_worldScaling(1.0f, 1.0f, 1.0f),
 	m_parent_relation(nullptr),
 	m_familly(new SG_Familly()),
-	m_modified(true),
+	m_transformPool(pool),
 	m_dirty(DIRTY_NONE)
 {
+	BLI_assert(m_transformPool);
+
+	m_transformSlot = m_transformPool->Allocate(this);
 }
 
 SG_Node::SG_Node(const SG_Node & other)
@@ -64,16 +66,15 @@ SG_Node::SG_Node(const SG_Node & other)
 	m_callbacks(other.m_callbacks),
 	m_children(other.m_children),
 	m_SGparent(other.m_SGparent),
-	m_localPosition(other.m_localPosition),
-	m_localRotation(other.m_localRotation),
-	m_localScaling(other.m_localScaling),
-	m_worldPosition(other.m_worldPosition),
-	m_worldRotation(other.m_worldRotation),
-	m_worldScaling(other.m_worldScaling),
 	m_parent_relation(other.m_parent_relation->NewCopy()),
 	m_familly(new SG_Familly()),
+	m_transformPool(other.m_transformPool),
 	m_dirty(DIRTY_NONE)
 {
+	// The replica uses its own slot in the same pool.
+	m_transformSlot = m_transformPool->Allocate(this);
+	m_transformPool->CopySlot(m_transformSlot, *other.m_transformPool, other.m_transformSlot);
+	UpdatePoolRelation();
 }
 
 SG_Node::~SG_Node()
@@ -83,6 +84,8 @@ SG_Node::~SG_Node()
 	for (contit = m_SGcontrollers.begin(); contit != m_SGcontrollers.end(); ++contit) {
 		delete (*contit);
 	}
+
+	m_transformPool->Free(m_transformSlot);
 }
 
 SG_Node *SG_Node::GetSGReplica()
@@ -108,6 +111,7 @@ void SG_Node::ProcessSGReplica(SG_Node **replica)
 
 	// clear the replica node of it's parent.
 	(*replica)->m_SGparent = nullptr;
+	(*replica)->UpdatePoolRelation();
 
 	if (!m_children.empty()) {
 		// if this node has children, the replica has too, so clear and clone children
@@ -141,6 +145,7 @@ void SG_Node::Destruct()
 	// We'll delete m_parent_relation now anyway.
 
 	m_parent_relation.reset(nullptr);
+	UpdatePoolRelation();
 
 	for (SG_Node *childnode : m_children) {
 		// call the SG_Node destruct method on each of our children }-)
@@ -182,6 +187,7 @@ void SG_Node::SetSGParent(SG_Node *parent)
 	if (parent) {
 		SetFamilly(parent->GetFamilly());
 	}
+	UpdatePoolRelation();
 }
 
 void SG_Node::DisconnectFromParent()
@@ -190,6 +196,7 @@ void SG_Node::DisconnectFromParent()
 		m_SGparent->RemoveChild(this);
 		m_SGparent = nullptr;
 		SetFamilly(std::make_shared<SG_Familly>());
+		UpdatePoolRelation();
 	}
 }
 
@@ -314,6 +321,28 @@ SG_Node *SG_Node::GetNextScheduled(SG_QList& head)
 	return result;
 }
 
+void SG_Node::UpdateScheduled(SG_QList& head, double time, TaskPool *pool)
+{
+	std::vector<SG_TransformPool *> transformPools;
+
+	// Updating nodes can schedule other nodes, loop until no nodes are scheduled.
+	while (!head.Empty()) {
+		SG_Node *node;
+		while ((node = GetNextScheduled(head))) {
+			SG_TransformPool *transformPool = node->m_transformPool.get();
+			transformPool->SetFlag(node->m_transformSlot, SG_TransformPool::FLAG_SCHEDULED, true);
+			if (std::find(transformPools.begin(), transformPools.end(), transformPool) == transformPools.end()) {
+				transformPools.push_back(transformPool);
+			}
+		}
+
+		for (SG_TransformPool *transformPool : transformPools) {
+			transformPool->Update(time, pool);
+		}
+		transformPools.clear();
+	}
+}
+
 bool SG_Node::Reschedule(SG_QList& head)
 {
 	scheduleMutex.Lock();
@@ -335,18 +364,21 @@ SG_Node *SG_Node::GetNextRescheduled(SG_QList& head)
 void SG_Node::AddSGController(SG_Controller *cont)
 {
 	m_SGcontrollers.push_back(cont);
+	UpdatePoolRelation();
 }
 
 void SG_Node::RemoveSGController(SG_Controller *cont)
 {
 	m_mutex.Lock();
 	CM_ListRemoveIfFound(m_SGcontrollers, cont);
+	UpdatePoolRelation();
 	m_mutex.Unlock();
 }
 
 void SG_Node::RemoveAllControllers()
 {
 	m_SGcontrollers.clear();
+	UpdatePoolRelation();
 }
 
 SGControllerList& SG_Node::GetSGControllerList()
@@ -387,13 +419,13 @@ void SG_Node::SetControllerTime(double time)
 
 void SG_Node::ClearModified()
 {
-	m_modified = false;
+	m_transformPool->SetFlag(m_transformSlot, SG_TransformPool::FLAG_MODIFIED, false);
 	m_dirty = DIRTY_ALL;
 }
 
 void SG_Node::SetModified()
 {
-	m_modified = true;
+	m_transformPool->SetFlag(m_transformSlot, SG_TransformPool::FLAG_MODIFIED, true);
 	ActivateScheduleUpdateCallback();
 }
 
@@ -405,6 +437,7 @@ void SG_Node::ClearDirty(DirtyFlag flag)
 void SG_Node::SetParentRelation(SG_ParentRelation *relation)
 {
 	m_parent_relation.reset(relation);
+	UpdatePoolRelation();
 	SetModified();
 }
 
@@ -444,29 +477,31 @@ bool SG_Node::UpdateSpatialData(const SG_Node *parent, double time, bool& parent
  */
 void SG_Node::RelativeTranslate(const MT_Vector3& trans, const SG_Node *parent, bool local)
 {
+	MT_Vector3 position = GetLocalPosition();
 	if (local) {
-		m_localPosition += m_localRotation * trans;
+		position += GetLocalOrientation() * trans;
 	}
 	else {
 		if (parent) {
-			m_localPosition += trans * parent->GetWorldOrientation();
+			position += trans * parent->GetWorldOrientation();
 		}
 		else {
-			m_localPosition += trans;
+			position += trans;
 		}
 	}
+	m_transformPool->SetLocalPosition(m_transformSlot, position);
 	SetModified();
 }
 
 void SG_Node::SetLocalPosition(const MT_Vector3& trans)
 {
-	m_localPosition = trans;
+	m_transformPool->SetLocalPosition(m_transformSlot, trans);
 	SetModified();
 }
 
 void SG_Node::SetWorldPosition(const MT_Vector3& trans)
 {
-	m_worldPosition = trans;
+	m_transformPool->SetPosition(m_transformSlot, trans);
 }
 
 /**
@@ -478,97 +513,101 @@ void SG_Node::SetWorldPosition(const MT_Vector3& trans)
  */
 void SG_Node::RelativeRotate(const MT_Matrix3x3& rot, bool local)
 {
-	m_localRotation = m_localRotation * (
-		local ?
-		rot
-		:
-		(GetWorldOrientation().inverse() * rot * GetWorldOrientation()));
+	const MT_Matrix3x3 orientation = GetLocalOrientation();
+	if (local) {
+		m_transformPool->SetLocalOrientation(m_transformSlot, orientation * rot);
+	}
+	else {
+		const MT_Matrix3x3 worldOrientation = GetWorldOrientation();
+		m_transformPool->SetLocalOrientation(m_transformSlot,
+		                                     orientation * (worldOrientation.inverse() * rot * worldOrientation));
+	}
 	SetModified();
 }
 
 void SG_Node::SetLocalOrientation(const MT_Matrix3x3& rot)
 {
-	m_localRotation = rot;
+	m_transformPool->SetLocalOrientation(m_transformSlot, rot);
 	SetModified();
 }
 
 void SG_Node::SetLocalOrientation(const float *rot)
 {
-	m_localRotation.setValue(rot);
+	MT_Matrix3x3 orientation;
+	orientation.setValue(rot);
+	m_transformPool->SetLocalOrientation(m_transformSlot, orientation);
 	SetModified();
 }
 
 void SG_Node::SetWorldOrientation(const MT_Matrix3x3& rot)
 {
-	m_worldRotation = rot;
+	m_transformPool->SetOrientation(m_transformSlot, rot);
 }
 
 void SG_Node::RelativeScale(const MT_Vector3& scale)
 {
-	m_localScaling = m_localScaling * scale;
+	m_transformPool->SetLocalScaling(m_transformSlot, GetLocalScale() * scale);
 	SetModified();
 }
 
 void SG_Node::SetLocalScale(const MT_Vector3& scale)
 {
-	m_localScaling = scale;
+	m_transformPool->SetLocalScaling(m_transformSlot, scale);
 	SetModified();
 }
 
 void SG_Node::SetWorldScale(const MT_Vector3& scale)
 {
-	m_worldScaling = scale;
+	m_transformPool->SetScaling(m_transformSlot, scale);
 }
 
-const MT_Vector3& SG_Node::GetLocalPosition() const
+MT_Vector3 SG_Node::GetLocalPosition() const
 {
-	return m_localPosition;
+	return m_transformPool->GetLocalPosition(m_transformSlot);
 }
 
-const MT_Matrix3x3& SG_Node::GetLocalOrientation() const
+MT_Matrix3x3 SG_Node::GetLocalOrientation() const
 {
-	return m_localRotation;
+	return m_transformPool->GetLocalOrientation(m_transformSlot);
 }
 
-const MT_Vector3& SG_Node::GetLocalScale() const
+MT_Vector3 SG_Node::GetLocalScale() const
 {
-	return m_localScaling;
+	return m_transformPool->GetLocalScaling(m_transformSlot);
 }
 
-const MT_Vector3& SG_Node::GetWorldPosition() const
+MT_Vector3 SG_Node::GetWorldPosition() const
 {
-	return m_worldPosition;
+	return m_transformPool->GetPosition(m_transformSlot);
 }
 
-const MT_Matrix3x3& SG_Node::GetWorldOrientation() const
+MT_Matrix3x3 SG_Node::GetWorldOrientation() const
 {
-	return m_worldRotation;
+	return m_transformPool->GetOrientation(m_transformSlot);
 }
 
-const MT_Vector3& SG_Node::GetWorldScaling() const
+MT_Vector3 SG_Node::GetWorldScaling() const
 {
-	return m_worldScaling;
+	return m_transformPool->GetScaling(m_transformSlot);
 }
 
 void SG_Node::SetWorldFromLocalTransform()
 {
-	m_worldPosition = m_localPosition;
-	m_worldScaling = m_localScaling;
-	m_worldRotation = m_localRotation;
+	m_transformPool->SetPosition(m_transformSlot, GetLocalPosition());
+	m_transformPool->SetScaling(m_transformSlot, GetLocalScale());
+	m_transformPool->SetOrientation(m_transformSlot, GetLocalOrientation());
 }
 
 MT_Transform SG_Node::GetWorldTransform() const
 {
-	return MT_Transform(m_worldPosition,
-	                    m_worldRotation.scaled(
-							m_worldScaling[0], m_worldScaling[1], m_worldScaling[2]));
+	const MT_Vector3 scaling = GetWorldScaling();
+	return MT_Transform(GetWorldPosition(), GetWorldOrientation().scaled(scaling[0], scaling[1], scaling[2]));
 }
 
 MT_Transform SG_Node::GetLocalTransform() const
 {
-	return MT_Transform(m_localPosition,
-	                    m_localRotation.scaled(
-							m_localScaling[0], m_localScaling[1], m_localScaling[2]));
+	const MT_Vector3 scaling = GetLocalScale();
+	return MT_Transform(GetLocalPosition(), GetLocalOrientation().scaled(scaling[0], scaling[1], scaling[2]));
 }
 
 bool SG_Node::ComputeWorldTransforms(const SG_Node *parent, bool& parentUpdated)
@@ -593,9 +632,40 @@ void SG_Node::SetFamilly(const std::shared_ptr<SG_Familly>& familly)
 	}
 }
 
+void SG_Node::SetTransformPool(const std::shared_ptr<SG_TransformPool>& pool)
+{
+	BLI_assert(pool);
+
+	if (pool == m_transformPool) {
+		return;
+	}
+
+	const unsigned int slot = pool->Allocate(this);
+	pool->CopySlot(slot, *m_transformPool, m_transformSlot);
+	m_transformPool->Free(m_transformSlot);
+
+	m_transformPool = pool;
+	m_transformSlot = slot;
+
+	UpdatePoolRelation();
+	for (SG_Node *child : m_children) {
+		child->UpdatePoolRelation();
+	}
+}
+
+const std::shared_ptr<SG_TransformPool>& SG_Node::GetTransformPool() const
+{
+	return m_transformPool;
+}
+
+unsigned int SG_Node::GetTransformSlot() const
+{
+	return m_transformSlot;
+}
+
 bool SG_Node::IsModified()
 {
-	return m_modified;
+	return m_transformPool->GetFlag(m_transformSlot, SG_TransformPool::FLAG_MODIFIED);
 }
 
 bool SG_Node::IsDirty(DirtyFlag flag)
@@ -603,6 +673,29 @@ bool SG_Node::IsDirty(DirtyFlag flag)
 	return (m_dirty & flag);
 }
 
+void SG_Node::UpdatePoolRelation()
+{
+	const bool parentInPool = (m_SGparent && m_SGparent->m_transformPool == m_transformPool);
+	m_transformPool->SetParent(m_transformSlot, parentInPool ? m_SGparent->m_transformSlot : SG_TransformPool::INVALID_SLOT);
+
+	// The pool computes the normal relations by itself, as long as no controller overrides them.
+	const bool composed = (m_parent_relation && m_parent_relation->IsNormalRelation() &&
+	                       m_SGcontrollers.empty() && (!m_SGparent || parentInPool));
+	m_transformPool->SetFlag(m_transformSlot, SG_TransformPool::FLAG_COMPOSED, composed);
+}
+
+void SG_Node::EndTransformUpdate(bool updated)
+{
+	if (updated) {
+		ActivateUpdateTransformCallback();
+	}
+
+	scheduleMutex.Lock();
+	// The node is updated, remove it from the update list
+	Delink();
+	scheduleMutex.Unlock();
+}
+
 bool SG_Node::ActivateReplicationCallback(SG_Node *replica)
 {
 	if (m_callbacks.m_replicafunc) {
@@ -42,8 +42,11 @@
 #include <vector>
 #include <memory>
 
+struct TaskPool;
+
 class SG_Controller;
 class SG_Familly;
+class SG_TransformPool;
 class SG_Node;
 
 typedef std::vector<SG_Controller *> SGControllerList;
@@ -115,7 +118,11 @@ public:
 		DIRTY_CULLING = (1 << 1)
 	};
 
-	SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks);
+	/**
+	 * \param pool The storage of the transform of the node, the parent and children
+	 * of the node are expected to use the same pool.
+	 */
+	SG_Node(void *clientobj, void *clientinfo, SG_Callbacks& callbacks, const std::shared_ptr<SG_TransformPool>& pool);
 	SG_Node(const SG_Node & other);
 	virtual ~SG_Node();
 
@@ -206,6 +213,16 @@ public:
 	 */
 	static SG_Node *GetNextScheduled(SG_QList& head);
 
+	/**
+	 * Update the world data of all the nodes scheduled in head until the list is empty.
+	 * The scheduled nodes are marked in their transform pool which updates them with
+	 * their descendants level by level, see SG_TransformPool::Update. Nodes of different
+	 * famillies don't share any transform data so the result is identical to a serial update.
+	 * \param pool The task pool used to update famillies, if nullptr or if there's not
+	 * enough work the update is done serially in the calling thread.
+	 */
+	static void UpdateScheduled(SG_QList& head, double time, TaskPool *pool);
+
 	/**
 	 * Make this node ready for schedule on next update. This is needed for nodes
 	 * that must always be updated (slow parent, bone parent)
@@ -328,12 +345,13 @@ public:
 	void SetLocalScale(const MT_Vector3& scale);
 	void SetWorldScale(const MT_Vector3& scale);
 
-	const MT_Vector3& GetLocalPosition() const;
-	const MT_Matrix3x3& GetLocalOrientation() const;
-	const MT_Vector3& GetLocalScale() const;
-	const MT_Vector3& GetWorldPosition() const;
-	const MT_Matrix3x3& GetWorldOrientation() const;
-	const MT_Vector3& GetWorldScaling() const;
+	/// The transforms are stored in the transform pool and returned by value.
+	MT_Vector3 GetLocalPosition() const;
+	MT_Matrix3x3 GetLocalOrientation() const;
+	MT_Vector3 GetLocalScale() const;
+	MT_Vector3 GetWorldPosition() const;
+	MT_Matrix3x3 GetWorldOrientation() const;
+	MT_Vector3 GetWorldScaling() const;
 
 	void SetWorldFromLocalTransform();
 	MT_Transform GetWorldTransform() const;
@@ -344,11 +362,21 @@ public:
 	const std::shared_ptr<SG_Familly>& GetFamilly() const;
 	void SetFamilly(const std::shared_ptr<SG_Familly>& familly);
 
+	/**
+	 * Move the transform of this node into a slot of pool,
+	 * the slot of the previous pool is released.
+	 */
+	void SetTransformPool(const std::shared_ptr<SG_TransformPool>& pool);
+	const std::shared_ptr<SG_TransformPool>& GetTransformPool() const;
+	/// Return the slot of this node in the transform pool.
+	unsigned int GetTransformSlot() const;
+
 	bool IsModified();
 	bool IsDirty(DirtyFlag flag);
 
 protected:
 	friend class SG_Controller;
+	friend class SG_TransformPool;
 	friend class KX_BoneParentRelation;
 	friend class KX_VertexParentRelation;
 	friend class KX_SlowParentRelation;
@@ -371,6 +399,11 @@ private:
 
 	void ProcessSGReplica(SG_Node **replica);
 
+	/// Update the parent slot and the composed flag of this node in the transform pool.
+	void UpdatePoolRelation();
+	/// Called by the transform pool after the world transform update of this node.
+	void EndTransformUpdate(bool updated);
+
 	void *m_SGclientObject;
 	void *m_SGclientInfo;
 	SG_Callbacks m_callbacks;
@@ -386,20 +419,15 @@ private:
 	 */
 	SG_Node *m_SGparent;
 
-	MT_Vector3 m_localPosition;
-	MT_Matrix3x3 m_localRotation;
-	MT_Vector3 m_localScaling;
-
-	MT_Vector3 m_worldPosition;
-	MT_Matrix3x3 m_worldRotation;
-	MT_Vector3 m_worldScaling;
-
 	std::unique_ptr<SG_ParentRelation> m_parent_relation;
 
 	std::shared_ptr<SG_Familly> m_familly;
 	CM_ThreadMutex m_mutex;
 
-	bool m_modified;
+	/// Storage of the local and world transforms.
+	std::shared_ptr<SG_TransformPool> m_transformPool;
+	unsigned int m_transformSlot;
+
 	unsigned short m_dirty;
 };
 
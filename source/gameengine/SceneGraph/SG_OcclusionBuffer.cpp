@@ -0,0 +1,377 @@
+#include "SG_OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+/// Multiplication of column major matrices: m = m1 * m2.
+static void mul_m4_m4_cm(float m[16], const float m1[16], const float m2[16])
+{
+	for (unsigned short i = 0; i < 4; ++i) {
+		for (unsigned short j = 0; j < 4; ++j) {
+			m[i * 4 + j] = m1[j] * m2[i * 4] + m1[4 + j] * m2[i * 4 + 1] + m1[8 + j] * m2[i * 4 + 2] + m1[12 + j] * m2[i * 4 + 3];
+		}
+	}
+}
+
+static void transform_point(const float m[16], const float p[3], float r[4])
+{
+	for (unsigned short i = 0; i < 4; ++i) {
+		r[i] = p[0] * m[i] + p[1] * m[4 + i] + p[2] * m[8 + i] + m[12 + i];
+	}
+}
+
+/** Clip a polygon in clip coordinates against a plane.
+ * \param sign 1 for the near plane (z >= -w) and -1 for the far plane (z <= w).
+ * \return The number of vertices of the clipped polygon.
+ */
+static int clip_polygon(const float (*pi)[4], int ni, float (*po)[4], float sign)
+{
+	int no = 0;
+	for (int i = ni - 1, j = 0; j < ni; i = j++) {
+		const float *a = pi[i];
+		const float *b = pi[j];
+		const float da = a[3] + sign * a[2];
+		const float db = b[3] + sign * b[2];
+		if ((da >= 0.0f) != (db >= 0.0f)) {
+			const float t = da / (da - db);
+			for (unsigned short k = 0; k < 4; ++k) {
+				po[no][k] = a[k] + (b[k] - a[k]) * t;
+			}
+			++no;
+		}
+		if (db >= 0.0f) {
+			for (unsigned short k = 0; k < 4; ++k) {
+				po[no][k] = b[k];
+			}
+			++no;
+		}
+	}
+	return no;
+}
+
+SG_OcclusionBuffer::SG_OcclusionBuffer()
+	:m_initialized(false),
+	m_occlusion(false)
+{
+	m_dirty[0] = m_dirty[1] = INT_MAX;
+	m_dirty[2] = m_dirty[3] = -1;
+}
+
+void SG_OcclusionBuffer::Setup(int size, const int *viewport, const float matrix[16])
+{
+	m_initialized = false;
+	m_occlusion = false;
+
+	// Compute the size of the buffer, it depends on the aspect ratio.
+	const int maxsize = std::max(std::max(viewport[2], viewport[3]), 1);
+	const double ratio = 1.0 / (2 * maxsize);
+	// Ensure even number.
+	const int width = std::max(2 * ((int)(size * viewport[2] * ratio + 0.5)), 2);
+	const int height = std::max(2 * ((int)(size * viewport[3] * ratio + 0.5)), 2);
+
+	if (m_levels.empty() || m_levels[0].m_width != width || m_levels[0].m_height != height) {
+		m_levels.clear();
+		int levelWidth = width;
+		int levelHeight = height;
+		while (true) {
+			Level level;
+			level.m_width = levelWidth;
+			level.m_height = levelHeight;
+			level.m_stride = (levelWidth + 3) & ~3;
+			level.m_depth.resize(level.m_stride * levelHeight);
+			m_levels.push_back(level);
+
+			if (levelWidth == 1 && levelHeight == 1) {
+				break;
+			}
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+		}
+	}
+
+	std::copy(matrix, matrix + 16, m_wtc);
+}
+
+void SG_OcclusionBuffer::Initialize()
+{
+	for (Level& level : m_levels) {
+		std::fill(level.m_depth.begin(), level.m_depth.end(), FLT_MAX);
+	}
+	m_dirty[0] = m_dirty[1] = INT_MAX;
+	m_dirty[2] = m_dirty[3] = -1;
+	m_initialized = true;
+}
+
+void SG_OcclusionBuffer::SetModelMatrix(const float matrix[16])
+{
+	mul_m4_m4_cm(m_mtc, m_wtc, matrix);
+	if (!m_initialized) {
+		Initialize();
+	}
+}
+
+void SG_OcclusionBuffer::AppendOccluder(const float a[3], const float b[3], const float c[3], float face)
+{
+	float clip[3][4];
+	transform_point(m_mtc, a, clip[0]);
+	transform_point(m_mtc, b, clip[1]);
+	transform_point(m_mtc, c, clip[2]);
+
+	// A triangle clipped by two planes has at most five vertices.
+	float nearClip[4][4];
+	float farClip[5][4];
+	const int numNear = clip_polygon(clip, 3, nearClip, 1.0f);
+	if (numNear < 3) {
+		return;
+	}
+	const int num = clip_polygon(nearClip, numNear, farClip, -1.0f);
+	if (num < 3) {
+		return;
+	}
+
+	const Level& level = m_levels[0];
+	float screen[5][3];
+	for (int i = 0; i < num; ++i) {
+		const float iw = 1.0f / farClip[i][3];
+		screen[i][0] = (farClip[i][0] * iw + 1.0f) * 0.5f * level.m_width;
+		screen[i][1] = (farClip[i][1] * iw + 1.0f) * 0.5f * level.m_height;
+		screen[i][2] = farClip[i][2] * iw;
+	}
+
+	for (int i = 2; i < num; ++i) {
+		RasterizeTriangle(screen[0], screen[i - 1], screen[i], face);
+	}
+}
+
+void SG_OcclusionBuffer::RasterizeTriangle(const float a[3], const float b[3], const float c[3], float face)
+{
+	float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+	if ((face * area) < 0.0f || area == 0.0f) {
+		return;
+	}
+	// Further down we are normally going to write to the buffer.
+	m_occlusion = true;
+
+	// Use a counter clockwise order so that the edge functions are positive inside.
+	if (area < 0.0f) {
+		std::swap(b, c);
+		area = -area;
+	}
+
+	Level& level = m_levels[0];
+	// Pixels whose center is in the triangle bounds.
+	const int minx = std::max(0, (int)ceilf(std::min(a[0], std::min(b[0], c[0])) - 0.5f));
+	const int maxx = std::min(level.m_width - 1, (int)floorf(std::max(a[0], std::max(b[0], c[0])) - 0.5f));
+	const int miny = std::max(0, (int)ceilf(std::min(a[1], std::min(b[1], c[1])) - 0.5f));
+	const int maxy = std::min(level.m_height - 1, (int)floorf(std::max(a[1], std::max(b[1], c[1])) - 0.5f));
+	if (minx > maxx || miny > maxy) {
+		return;
+	}
+
+	// Edge functions e = ex * x + ey * y + eo, one per edge opposed to a vertex.
+	const float *verts[3] = {a, b, c};
+	float ex[3];
+	float ey[3];
+	float eo[3];
+	for (unsigned short i = 0; i < 3; ++i) {
+		const float *v0 = verts[(i + 1) % 3];
+		const float *v1 = verts[(i + 2) % 3];
+		ex[i] = v0[1] - v1[1];
+		ey[i] = v1[0] - v0[0];
+		eo[i] = -(ex[i] * v0[0] + ey[i] * v0[1]);
+	}
+
+	// The normalized device depth is linear in screen space.
+	const float iarea = 1.0f / area;
+	const float zx = (ex[0] * a[2] + ex[1] * b[2] + ex[2] * c[2]) * iarea;
+	const float zy = (ey[0] * a[2] + ey[1] * b[2] + ey[2] * c[2]) * iarea;
+	const float zo = (eo[0] * a[2] + eo[1] * b[2] + eo[2] * c[2]) * iarea;
+
+	// Start on a multiple of four pixels, the pixels before minx are outside of the triangle.
+	const int startx = minx & ~3;
+
+#ifdef __SSE2__
+	const __m128 offsets = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 e0step = _mm_set1_ps(4.0f * ex[0]);
+	const __m128 e1step = _mm_set1_ps(4.0f * ex[1]);
+	const __m128 e2step = _mm_set1_ps(4.0f * ex[2]);
+	const __m128 zstep = _mm_set1_ps(4.0f * zx);
+	const __m128 e0dx = _mm_mul_ps(offsets, _mm_set1_ps(ex[0]));
+	const __m128 e1dx = _mm_mul_ps(offsets, _mm_set1_ps(ex[1]));
+	const __m128 e2dx = _mm_mul_ps(offsets, _mm_set1_ps(ex[2]));
+	const __m128 zdx = _mm_mul_ps(offsets, _mm_set1_ps(zx));
+#endif
+
+	for (int y = miny; y <= maxy; ++y) {
+		const float py = (float)y + 0.5f;
+		const float px = (float)startx + 0.5f;
+		float *row = &level.m_depth[y * level.m_stride];
+
+#ifdef __SSE2__
+		__m128 e0 = _mm_add_ps(_mm_set1_ps(ex[0] * px + ey[0] * py + eo[0]), e0dx);
+		__m128 e1 = _mm_add_ps(_mm_set1_ps(ex[1] * px + ey[1] * py + eo[1]), e1dx);
+		__m128 e2 = _mm_add_ps(_mm_set1_ps(ex[2] * px + ey[2] * py + eo[2]), e2dx);
+		__m128 z = _mm_add_ps(_mm_set1_ps(zx * px + zy * py + zo), zdx);
+
+		for (int x = startx; x <= maxx; x += 4) {
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if (_mm_movemask_ps(inside)) {
+				const __m128 depth = _mm_loadu_ps(row + x);
+				const __m128 nearest = _mm_min_ps(depth, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+			}
+			e0 = _mm_add_ps(e0, e0step);
+			e1 = _mm_add_ps(e1, e1step);
+			e2 = _mm_add_ps(e2, e2step);
+			z = _mm_add_ps(z, zstep);
+		}
+#else
+		for (int x = startx; x <= maxx; ++x) {
+			const float px = (float)x + 0.5f;
+			if ((ex[0] * px + ey[0] * py + eo[0]) >= 0.0f &&
+				(ex[1] * px + ey[1] * py + eo[1]) >= 0.0f &&
+				(ex[2] * px + ey[2] * py + eo[2]) >= 0.0f)
+			{
+				row[x] = std::min(row[x], zx * px + zy * py + zo);
+			}
+		}
+#endif
+	}
+
+	m_dirty[0] = std::min(m_dirty[0], minx);
+	m_dirty[1] = std::min(m_dirty[1], miny);
+	m_dirty[2] = std::max(m_dirty[2], maxx);
+	m_dirty[3] = std::max(m_dirty[3], maxy);
+}
+
+void SG_OcclusionBuffer::UpdatePyramid()
+{
+	if (m_dirty[0] > m_dirty[2]) {
+		return;
+	}
+
+	int minx = m_dirty[0];
+	int miny = m_dirty[1];
+	int maxx = m_dirty[2];
+	int maxy = m_dirty[3];
+	for (unsigned int i = 1, size = m_levels.size(); i < size; ++i) {
+		const Level& src = m_levels[i - 1];
+		Level& dst = m_levels[i];
+		minx >>= 1;
+		miny >>= 1;
+		maxx >>= 1;
+		maxy >>= 1;
+
+		// Each texel stores the farthest depth of its four texels in the previous level.
+		for (int y = miny; y <= maxy; ++y) {
+			const float *row0 = &src.m_depth[(2 * y) * src.m_stride];
+			const float *row1 = &src.m_depth[std::min(2 * y + 1, src.m_height - 1) * src.m_stride];
+			float *dstrow = &dst.m_depth[y * dst.m_stride];
+			for (int x = minx; x <= maxx; ++x) {
+				const int x0 = 2 * x;
+				const int x1 = std::min(x0 + 1, src.m_width - 1);
+				dstrow[x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+			}
+		}
+	}
+
+	m_dirty[0] = m_dirty[1] = INT_MAX;
+	m_dirty[2] = m_dirty[3] = -1;
+}
+
+bool SG_OcclusionBuffer::QueryBox(const float center[3], const float extents[3])
+{
+	if (!m_occlusion) {
+		// No occlusion yet, no need to check.
+		return true;
+	}
+
+	const Level& base = m_levels[0];
+	float minx = FLT_MAX;
+	float miny = FLT_MAX;
+	float maxx = -FLT_MAX;
+	float maxy = -FLT_MAX;
+	float minz = FLT_MAX;
+	for (unsigned short i = 0; i < 8; ++i) {
+		const float corner[3] = {
+			center[0] + ((i & 1) ? extents[0] : -extents[0]),
+			center[1] + ((i & 2) ? extents[1] : -extents[1]),
+			center[2] + ((i & 4) ? extents[2] : -extents[2])
+		};
+		float clip[4];
+		transform_point(m_wtc, corner, clip);
+		// The box is clipped, it's probably a large box, don't waste our time to check.
+		if ((clip[2] + clip[3]) <= 0.0f) {
+			return true;
+		}
+
+		const float iw = 1.0f / clip[3];
+		const float x = (clip[0] * iw + 1.0f) * 0.5f * base.m_width;
+		const float y = (clip[1] * iw + 1.0f) * 0.5f * base.m_height;
+		minx = std::min(minx, x);
+		maxx = std::max(maxx, x);
+		miny = std::min(miny, y);
+		maxy = std::max(maxy, y);
+		minz = std::min(minz, clip[2] * iw);
+	}
+
+	int x0 = std::max(0, (int)floorf(minx));
+	int x1 = std::min(base.m_width - 1, (int)floorf(maxx));
+	int y0 = std::max(0, (int)floorf(miny));
+	int y1 = std::min(base.m_height - 1, (int)floorf(maxy));
+	if (x0 > x1 || y0 > y1) {
+		// Outside of the buffer, let the frustum culling decide.
+		return true;
+	}
+
+	UpdatePyramid();
+
+	// Use the first level where the box covers at most four texels per axis.
+	unsigned int levelIndex = 0;
+	while ((x1 - x0) > 3 || (y1 - y0) > 3) {
+		if ((levelIndex + 1) == m_levels.size()) {
+			break;
+		}
+		x0 >>= 1;
+		x1 >>= 1;
+		y0 >>= 1;
+		y1 >>= 1;
+		++levelIndex;
+	}
+
+	const Level& level = m_levels[levelIndex];
+	for (int y = y0; y <= y1; ++y) {
+		const float *row = &level.m_depth[y * level.m_stride];
+		for (int x = x0; x <= x1; ++x) {
+			// The nearest point of the box is in front of the farthest occluder.
+			if (minz < row[x]) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+int SG_OcclusionBuffer::GetWidth() const
+{
+	return m_levels.empty() ? 0 : m_levels[0].m_width;
+}
+
+int SG_OcclusionBuffer::GetHeight() const
+{
+	return m_levels.empty() ? 0 : m_levels[0].m_height;
+}
+
+float SG_OcclusionBuffer::GetDepth(int x, int y) const
+{
+	const Level& level = m_levels[0];
+	return level.m_depth[y * level.m_stride + x];
+}
@@ -0,0 +1,75 @@
+#ifndef __SG_OCCLUSION_BUFFER_H__
+#define __SG_OCCLUSION_BUFFER_H__
+
+#include <vector>
+
+/** \brief Software occlusion buffer with a hierarchical depth pyramid.
+ * Occluder triangles are rasterized into a low resolution depth buffer storing
+ * the normalized device depth of the nearest occluder per pixel. Each level of
+ * the pyramid stores the farthest depth of four texels of the previous level so
+ * that a box query only reads a few texels whatever its size on screen.
+ * Only this maximum is kept: a box is hidden when its nearest point is behind the
+ * farthest occluder depth of the texels it covers, no query needs the minimum.
+ * The pyramid is updated lazily over the region modified since the last query.
+ */
+class SG_OcclusionBuffer
+{
+private:
+	struct Level
+	{
+		int m_width;
+		int m_height;
+		/// Row stride of the texels, a multiple of four for SIMD rasterization.
+		int m_stride;
+		/// Nearest occluder depth in level 0, farthest depth of the four texels below in the other levels.
+		std::vector<float> m_depth;
+	};
+
+	/// Depth levels, level 0 is the rasterized buffer.
+	std::vector<Level> m_levels;
+	/// World to clip transform, column major.
+	float m_wtc[16];
+	/// Model to clip transform, column major.
+	float m_mtc[16];
+	/// True when the buffer was cleared for the current view.
+	bool m_initialized;
+	/// True when at least an occluder triangle was rasterized.
+	bool m_occlusion;
+	/// Region of level 0 modified since the last pyramid update: min x, min y, max x, max y.
+	int m_dirty[4];
+
+	void Initialize();
+	void RasterizeTriangle(const float a[3], const float b[3], const float c[3], float face);
+	void UpdatePyramid();
+
+public:
+	SG_OcclusionBuffer();
+	~SG_OcclusionBuffer() = default;
+
+	/** Prepare the buffer for a new view, the buffer is cleared on the first occluder.
+	 * \param size The resolution of the largest dimension of the viewport.
+	 * \param viewport The viewport x, y, width and height.
+	 * \param matrix The world to clip transform, column major.
+	 */
+	void Setup(int size, const int *viewport, const float matrix[16]);
+	/// Set the model to world transform, column major, of the next occluder triangles.
+	void SetModelMatrix(const float matrix[16]);
+	/** Rasterize an occluder triangle in model coordinates.
+	 * \param face 0 if the triangle is double sided, 1 if it is single sided and -1
+	 * if it is single sided with a negative scale.
+	 */
+	void AppendOccluder(const float a[3], const float b[3], const float c[3], float face);
+	/** Test if a box in world coordinates is hidden by the occluders.
+	 * \param center The center of the box.
+	 * \param extents The half size of the box.
+	 * \return True if the box is potentially visible.
+	 */
+	bool QueryBox(const float center[3], const float extents[3]);
+
+	int GetWidth() const;
+	int GetHeight() const;
+	/// Return the depth of the nearest occluder at a pixel of the buffer, FLT_MAX if none.
+	float GetDepth(int x, int y) const;
+};
+
+#endif  // __SG_OCCLUSION_BUFFER_H__
@@ -96,6 +96,16 @@ public:
 		return false;
 	}
 
+	/**
+	 * Normal relations only compose the parent world transform with the local
+	 * transform of the child, the transform pool computes them without calling
+	 * UpdateChildCoordinates.
+	 */
+	virtual bool IsNormalRelation()
+	{
+		return false;
+	}
+
 protected:
 	/**
 	 * Protected constructors
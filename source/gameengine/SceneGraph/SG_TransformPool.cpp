@@ -0,0 +1,446 @@
+#include "SG_TransformPool.h"
+#include "SG_Node.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <unordered_map>
+
+/// Minimum number of relation nodes in a level to update the famillies in parallel.
+static const unsigned int parallelUpdateMinNodes = 64;
+
+/// The relation nodes of a level in a familly, updated in a single task.
+struct SG_TransformPool::FamillyUpdateData
+{
+	std::vector<SG_Node *> m_nodes;
+	double m_time;
+};
+
+SG_TransformPool::SG_TransformPool()
+	:m_orderValid(false)
+{
+}
+
+MT_Vector3 SG_TransformPool::GetVector(const std::vector<float> *array, unsigned int slot)
+{
+	return MT_Vector3(array[0][slot], array[1][slot], array[2][slot]);
+}
+
+void SG_TransformPool::SetVector(std::vector<float> *array, unsigned int slot, const MT_Vector3& vec)
+{
+	for (unsigned short i = 0; i < 3; ++i) {
+		array[i][slot] = vec[i];
+	}
+}
+
+MT_Matrix3x3 SG_TransformPool::GetMatrix(const std::vector<float> *array, unsigned int slot)
+{
+	return MT_Matrix3x3(array[0][slot], array[1][slot], array[2][slot],
+	                    array[3][slot], array[4][slot], array[5][slot],
+	                    array[6][slot], array[7][slot], array[8][slot]);
+}
+
+void SG_TransformPool::SetMatrix(std::vector<float> *array, unsigned int slot, const MT_Matrix3x3& mat)
+{
+	for (unsigned short i = 0; i < 3; ++i) {
+		for (unsigned short j = 0; j < 3; ++j) {
+			array[i * 3 + j][slot] = mat[i][j];
+		}
+	}
+}
+
+unsigned int SG_TransformPool::Allocate(SG_Node *node)
+{
+	unsigned int slot;
+	if (!m_freeSlots.empty()) {
+		slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slot = GetSize();
+		for (unsigned short i = 0; i < 3; ++i) {
+			m_localPosition[i].push_back(0.0f);
+			m_position[i].push_back(0.0f);
+			m_localScaling[i].push_back(0.0f);
+			m_scaling[i].push_back(0.0f);
+		}
+		for (unsigned short i = 0; i < 9; ++i) {
+			m_localOrientation[i].push_back(0.0f);
+			m_orientation[i].push_back(0.0f);
+		}
+		m_parents.push_back(INVALID_SLOT);
+		m_flags.push_back(0);
+		m_nodes.push_back(nullptr);
+	}
+
+	const MT_Vector3 zero(0.0f, 0.0f, 0.0f);
+	const MT_Vector3 one(1.0f, 1.0f, 1.0f);
+	const MT_Matrix3x3 identity(1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	SetVector(m_localPosition, slot, zero);
+	SetVector(m_position, slot, zero);
+	SetMatrix(m_localOrientation, slot, identity);
+	SetMatrix(m_orientation, slot, identity);
+	SetVector(m_localScaling, slot, one);
+	SetVector(m_scaling, slot, one);
+	m_parents[slot] = INVALID_SLOT;
+	m_flags[slot] = FLAG_MODIFIED;
+	m_nodes[slot] = node;
+
+	m_orderValid = false;
+
+	return slot;
+}
+
+void SG_TransformPool::Free(unsigned int slot)
+{
+	m_nodes[slot] = nullptr;
+	m_parents[slot] = INVALID_SLOT;
+	m_flags[slot] = 0;
+	m_freeSlots.push_back(slot);
+
+	m_orderValid = false;
+}
+
+unsigned int SG_TransformPool::GetSize() const
+{
+	return m_nodes.size();
+}
+
+void SG_TransformPool::CopySlot(unsigned int slot, const SG_TransformPool& other, unsigned int otherSlot)
+{
+	SetVector(m_localPosition, slot, GetVector(other.m_localPosition, otherSlot));
+	SetVector(m_position, slot, GetVector(other.m_position, otherSlot));
+	SetMatrix(m_localOrientation, slot, GetMatrix(other.m_localOrientation, otherSlot));
+	SetMatrix(m_orientation, slot, GetMatrix(other.m_orientation, otherSlot));
+	SetVector(m_localScaling, slot, GetVector(other.m_localScaling, otherSlot));
+	SetVector(m_scaling, slot, GetVector(other.m_scaling, otherSlot));
+	SetFlag(slot, FLAG_MODIFIED, other.GetFlag(otherSlot, FLAG_MODIFIED));
+}
+
+void SG_TransformPool::SetParent(unsigned int slot, unsigned int parent)
+{
+	if (m_parents[slot] != parent) {
+		m_parents[slot] = parent;
+		m_orderValid = false;
+	}
+}
+
+void SG_TransformPool::SetFlag(unsigned int slot, Flag flag, bool value)
+{
+	if (value) {
+		m_flags[slot] |= flag;
+	}
+	else {
+		m_flags[slot] &= ~flag;
+	}
+}
+
+bool SG_TransformPool::GetFlag(unsigned int slot, Flag flag) const
+{
+	return (m_flags[slot] & flag);
+}
+
+MT_Vector3 SG_TransformPool::GetLocalPosition(unsigned int slot) const
+{
+	return GetVector(m_localPosition, slot);
+}
+
+MT_Matrix3x3 SG_TransformPool::GetLocalOrientation(unsigned int slot) const
+{
+	return GetMatrix(m_localOrientation, slot);
+}
+
+MT_Vector3 SG_TransformPool::GetLocalScaling(unsigned int slot) const
+{
+	return GetVector(m_localScaling, slot);
+}
+
+MT_Vector3 SG_TransformPool::GetPosition(unsigned int slot) const
+{
+	return GetVector(m_position, slot);
+}
+
+MT_Matrix3x3 SG_TransformPool::GetOrientation(unsigned int slot) const
+{
+	return GetMatrix(m_orientation, slot);
+}
+
+MT_Vector3 SG_TransformPool::GetScaling(unsigned int slot) const
+{
+	return GetVector(m_scaling, slot);
+}
+
+void SG_TransformPool::SetLocalPosition(unsigned int slot, const MT_Vector3& pos)
+{
+	SetVector(m_localPosition, slot, pos);
+}
+
+void SG_TransformPool::SetLocalOrientation(unsigned int slot, const MT_Matrix3x3& rot)
+{
+	SetMatrix(m_localOrientation, slot, rot);
+}
+
+void SG_TransformPool::SetLocalScaling(unsigned int slot, const MT_Vector3& scale)
+{
+	SetVector(m_localScaling, slot, scale);
+}
+
+void SG_TransformPool::SetPosition(unsigned int slot, const MT_Vector3& pos)
+{
+	SetVector(m_position, slot, pos);
+}
+
+void SG_TransformPool::SetOrientation(unsigned int slot, const MT_Matrix3x3& rot)
+{
+	SetMatrix(m_orientation, slot, rot);
+}
+
+void SG_TransformPool::SetScaling(unsigned int slot, const MT_Vector3& scale)
+{
+	SetVector(m_scaling, slot, scale);
+}
+
+void SG_TransformPool::UpdateOrder()
+{
+	if (m_orderValid) {
+		return;
+	}
+
+	const unsigned int size = GetSize();
+	const unsigned int unknown = INVALID_SLOT;
+	m_depths.assign(size, unknown);
+
+	// Compute the depth of each slot from the parent slots, walking up to the first known depth.
+	unsigned int numLevels = 0;
+	for (unsigned int slot = 0; slot < size; ++slot) {
+		if (!m_nodes[slot] || m_depths[slot] != unknown) {
+			continue;
+		}
+
+		m_visited.clear();
+		unsigned int depth = 0;
+		for (unsigned int cur = slot; ; cur = m_parents[cur]) {
+			m_visited.push_back(cur);
+			const unsigned int parent = m_parents[cur];
+			if (parent == INVALID_SLOT || !m_nodes[parent]) {
+				break;
+			}
+			if (m_depths[parent] != unknown) {
+				depth = m_depths[parent] + 1;
+				break;
+			}
+		}
+
+		for (std::vector<unsigned int>::reverse_iterator it = m_visited.rbegin(); it != m_visited.rend(); ++it) {
+			m_depths[*it] = depth++;
+		}
+		numLevels = std::max(numLevels, depth);
+	}
+
+	// Counting sort of the slots by depth.
+	m_levels.assign(numLevels + 1, 0);
+	for (unsigned int slot = 0; slot < size; ++slot) {
+		if (m_nodes[slot]) {
+			++m_levels[m_depths[slot] + 1];
+		}
+	}
+	for (unsigned int i = 1; i <= numLevels; ++i) {
+		m_levels[i] += m_levels[i - 1];
+	}
+	m_order.resize(m_levels[numLevels]);
+	m_visited.assign(m_levels.begin(), m_levels.end() - 1);
+	for (unsigned int slot = 0; slot < size; ++slot) {
+		if (m_nodes[slot]) {
+			m_order[m_visited[m_depths[slot]]++] = slot;
+		}
+	}
+
+	m_orderValid = true;
+}
+
+void SG_TransformPool::ComposeWorldTransform(unsigned int slot, unsigned int parent)
+{
+	if (parent == INVALID_SLOT) {
+		for (unsigned short i = 0; i < 3; ++i) {
+			m_position[i][slot] = m_localPosition[i][slot];
+			m_scaling[i][slot] = m_localScaling[i][slot];
+		}
+		for (unsigned short i = 0; i < 9; ++i) {
+			m_orientation[i][slot] = m_localOrientation[i][slot];
+		}
+		return;
+	}
+
+	// Same operations as the normal parent relation on the MT types.
+	float rot[9];
+	float pos[3];
+	for (unsigned short i = 0; i < 3; ++i) {
+		for (unsigned short j = 0; j < 3; ++j) {
+			rot[i * 3 + j] = m_localOrientation[j][slot] * m_orientation[i * 3][parent] +
+			                 m_localOrientation[3 + j][slot] * m_orientation[i * 3 + 1][parent] +
+			                 m_localOrientation[6 + j][slot] * m_orientation[i * 3 + 2][parent];
+		}
+		pos[i] = m_orientation[i * 3][parent] * m_localPosition[0][slot] +
+		         m_orientation[i * 3 + 1][parent] * m_localPosition[1][slot] +
+		         m_orientation[i * 3 + 2][parent] * m_localPosition[2][slot];
+	}
+
+	for (unsigned short i = 0; i < 3; ++i) {
+		const float scale = m_scaling[i][parent];
+		m_position[i][slot] = m_position[i][parent] + scale * pos[i];
+		m_scaling[i][slot] = scale * m_localScaling[i][slot];
+	}
+	for (unsigned short i = 0; i < 9; ++i) {
+		m_orientation[i][slot] = rot[i];
+	}
+}
+
+void SG_TransformPool::UpdateFamillyTask(TaskPool *__restrict UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	FamillyUpdateData *data = (FamillyUpdateData *)taskdata;
+	for (SG_Node *node : data->m_nodes) {
+		UpdateRelationNode(node, data->m_time);
+	}
+}
+
+void SG_TransformPool::UpdateRelationNode(SG_Node *node, double time)
+{
+	SG_TransformPool *pool = node->m_transformPool.get();
+	const unsigned int slot = node->m_transformSlot;
+	const unsigned int parent = pool->m_parents[slot];
+
+	bool parentUpdated = (parent != INVALID_SLOT && (pool->m_flags[parent] & FLAG_PARENT_UPDATED));
+	const bool updated = node->UpdateSpatialData(node->GetSGParent(), time, parentUpdated);
+
+	// The controllers and relations update the flags of this slot only.
+	unsigned char& flags = pool->m_flags[slot];
+	if (updated) {
+		flags |= FLAG_UPDATED;
+	}
+	if (parentUpdated) {
+		flags |= FLAG_PARENT_UPDATED;
+	}
+}
+
+void SG_TransformPool::UpdateRelationNodes(double time, TaskPool *taskPool)
+{
+	if (!taskPool || m_relationNodes.size() < parallelUpdateMinNodes) {
+		for (SG_Node *node : m_relationNodes) {
+			UpdateRelationNode(node, time);
+		}
+		return;
+	}
+
+	// The map is filled before any task is pushed, the data is never moved.
+	std::unordered_map<SG_Familly *, FamillyUpdateData> famillies;
+	for (SG_Node *node : m_relationNodes) {
+		FamillyUpdateData& data = famillies[node->GetFamilly().get()];
+		data.m_nodes.push_back(node);
+		data.m_time = time;
+	}
+
+	for (auto& pair : famillies) {
+		BLI_task_pool_push(taskPool, UpdateFamillyTask, &pair.second, false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(taskPool);
+}
+
+void SG_TransformPool::Update(double time, TaskPool *taskPool)
+{
+	UpdateOrder();
+
+	m_visited.clear();
+
+	for (unsigned int level = 0, numLevels = m_levels.size() - 1; level < numLevels; ++level) {
+		m_relationNodes.clear();
+
+		for (unsigned int i = m_levels[level], end = m_levels[level + 1]; i < end; ++i) {
+			const unsigned int slot = m_order[i];
+			const unsigned int parent = m_parents[slot];
+			const unsigned char parentFlags = (parent == INVALID_SLOT) ? 0 : m_flags[parent];
+			unsigned char flags = m_flags[slot];
+
+			// Only the scheduled nodes and the descendants of the visited nodes are updated.
+			if (!(flags & FLAG_SCHEDULED) && !(parentFlags & FLAG_VISITED)) {
+				continue;
+			}
+
+			flags = (flags & ~FLAG_SCHEDULED) | FLAG_VISITED;
+			m_visited.push_back(slot);
+
+			if (flags & FLAG_COMPOSED) {
+				if ((parentFlags & FLAG_PARENT_UPDATED) || (flags & FLAG_MODIFIED)) {
+					ComposeWorldTransform(slot, parent);
+					flags = (flags & ~FLAG_MODIFIED) | FLAG_UPDATED | FLAG_PARENT_UPDATED;
+				}
+			}
+			else {
+				m_relationNodes.push_back(m_nodes[slot]);
+			}
+
+			m_flags[slot] = flags;
+		}
+
+		UpdateRelationNodes(time, taskPool);
+	}
+
+	// Notify the updated nodes in the hierarchy order.
+	for (unsigned int slot : m_visited) {
+		const unsigned char flags = m_flags[slot];
+		m_flags[slot] &= ~(FLAG_VISITED | FLAG_UPDATED | FLAG_PARENT_UPDATED);
+
+		SG_Node *node = m_nodes[slot];
+		if ((flags & (FLAG_COMPOSED | FLAG_UPDATED)) == (FLAG_COMPOSED | FLAG_UPDATED)) {
+			node->ClearModified();
+		}
+		node->EndTransformUpdate(flags & FLAG_UPDATED);
+	}
+}
+
+void SG_TransformPool::ComputeMinDistances2(const std::vector<MT_Vector3>& points, std::vector<float>& distances) const
+{
+	const unsigned int size = GetSize();
+	distances.assign(size, FLT_MAX);
+
+	const float *__restrict x = m_position[0].data();
+	const float *__restrict y = m_position[1].data();
+	const float *__restrict z = m_position[2].data();
+	float *__restrict dist = distances.data();
+
+	// One pass per point over the contiguous positions, this loop is vectorized.
+	for (const MT_Vector3& point : points) {
+		const float px = point[0];
+		const float py = point[1];
+		const float pz = point[2];
+		for (unsigned int i = 0; i < size; ++i) {
+			const float dx = x[i] - px;
+			const float dy = y[i] - py;
+			const float dz = z[i] - pz;
+			const float d = dx * dx + dy * dy + dz * dz;
+			dist[i] = (d < dist[i]) ? d : dist[i];
+		}
+	}
+}
+
+void SG_TransformPool::ComputeMatrices(const std::vector<unsigned int>& slots, const std::vector<float *>& matrices) const
+{
+	for (unsigned int i = 0, size = slots.size(); i < size; ++i) {
+		const unsigned int slot = slots[i];
+		float *mat = matrices[i];
+
+		// Same layout as MT_Transform::getValue of the node world transform.
+		for (unsigned short col = 0; col < 3; ++col) {
+			const float scale = m_scaling[col][slot];
+			for (unsigned short row = 0; row < 3; ++row) {
+				mat[col * 4 + row] = m_orientation[row * 3 + col][slot] * scale;
+			}
+			mat[col * 4 + 3] = 0.0f;
+		}
+		for (unsigned short row = 0; row < 3; ++row) {
+			mat[12 + row] = m_position[row][slot];
+		}
+		mat[15] = 1.0f;
+	}
+}
@@ -0,0 +1,142 @@
+#ifndef __SG_TRANSFORM_POOL_H__
+#define __SG_TRANSFORM_POOL_H__
+
+#include "MT_Vector3.h"
+#include "MT_Matrix3x3.h"
+
+#include <vector>
+
+struct TaskPool;
+class SG_Node;
+
+/** \brief Contiguous storage of node transforms.
+ * Each component is stored in its own array (structure of arrays) so that batch
+ * operations over many nodes read linear memory and can be vectorized by the compiler.
+ * The pool is the only storage of the local and world transforms of its nodes, it also
+ * stores the hierarchy as parent slots so that the world transforms of the nodes using
+ * a normal parent relation are computed without going through the nodes.
+ */
+class SG_TransformPool
+{
+public:
+	enum {
+		INVALID_SLOT = (unsigned int)-1
+	};
+
+	enum Flag {
+		/// The local transform changed since the last world transform update.
+		FLAG_MODIFIED = (1 << 0),
+		/// The world transform is the composition of the parent world and local transforms.
+		FLAG_COMPOSED = (1 << 1),
+		/// The node is scheduled for the next update.
+		FLAG_SCHEDULED = (1 << 2),
+		/// The node is visited by the current update.
+		FLAG_VISITED = (1 << 3),
+		/// The world transform was updated, the update callback must be called.
+		FLAG_UPDATED = (1 << 4),
+		/// The children must update their world transform.
+		FLAG_PARENT_UPDATED = (1 << 5)
+	};
+
+private:
+	/// Local and world position per axis.
+	std::vector<float> m_localPosition[3];
+	std::vector<float> m_position[3];
+	/// Local and world orientation per matrix element, row major.
+	std::vector<float> m_localOrientation[9];
+	std::vector<float> m_orientation[9];
+	/// Local and world scaling per axis.
+	std::vector<float> m_localScaling[3];
+	std::vector<float> m_scaling[3];
+	/// Slot of the parent node or INVALID_SLOT.
+	std::vector<unsigned int> m_parents;
+	/// Combination of Flag.
+	std::vector<unsigned char> m_flags;
+	/// The node owning the slot, nullptr for unused slots.
+	std::vector<SG_Node *> m_nodes;
+	/// Unused slots to recycle.
+	std::vector<unsigned int> m_freeSlots;
+
+	/// Used slots sorted by depth in the hierarchy, parents are before their children.
+	std::vector<unsigned int> m_order;
+	/// Offset in m_order of each depth, followed by the size of m_order.
+	std::vector<unsigned int> m_levels;
+	/// False when the hierarchy changed since m_order was computed.
+	bool m_orderValid;
+	/// Scratch lists of the update.
+	std::vector<unsigned int> m_depths;
+	std::vector<unsigned int> m_visited;
+	std::vector<SG_Node *> m_relationNodes;
+
+	static MT_Vector3 GetVector(const std::vector<float> *array, unsigned int slot);
+	static void SetVector(std::vector<float> *array, unsigned int slot, const MT_Vector3& vec);
+	static MT_Matrix3x3 GetMatrix(const std::vector<float> *array, unsigned int slot);
+	static void SetMatrix(std::vector<float> *array, unsigned int slot, const MT_Matrix3x3& mat);
+
+	/// Sort the slots by depth if the hierarchy changed.
+	void UpdateOrder();
+	/// Compose the parent world transform with the local one, parent can be INVALID_SLOT.
+	void ComposeWorldTransform(unsigned int slot, unsigned int parent);
+
+	struct FamillyUpdateData;
+	static void UpdateFamillyTask(TaskPool *__restrict pool, void *taskdata, int threadid);
+	/// Update a node using its parent relation or controllers.
+	static void UpdateRelationNode(SG_Node *node, double time);
+	/// Update the relation nodes of a level, the famillies are updated in parallel.
+	void UpdateRelationNodes(double time, TaskPool *taskPool);
+
+public:
+	SG_TransformPool();
+	~SG_TransformPool() = default;
+
+	/// Return a free slot owned by node, with an identity transform and modified.
+	unsigned int Allocate(SG_Node *node);
+	/// Release a slot returned by Allocate.
+	void Free(unsigned int slot);
+	/// Return the number of slots, used or not.
+	unsigned int GetSize() const;
+
+	/// Copy the transforms and the modified state of a slot of an other pool.
+	void CopySlot(unsigned int slot, const SG_TransformPool& other, unsigned int otherSlot);
+
+	void SetParent(unsigned int slot, unsigned int parent);
+	void SetFlag(unsigned int slot, Flag flag, bool value);
+	bool GetFlag(unsigned int slot, Flag flag) const;
+
+	MT_Vector3 GetLocalPosition(unsigned int slot) const;
+	MT_Matrix3x3 GetLocalOrientation(unsigned int slot) const;
+	MT_Vector3 GetLocalScaling(unsigned int slot) const;
+	MT_Vector3 GetPosition(unsigned int slot) const;
+	MT_Matrix3x3 GetOrientation(unsigned int slot) const;
+	MT_Vector3 GetScaling(unsigned int slot) const;
+
+	void SetLocalPosition(unsigned int slot, const MT_Vector3& pos);
+	void SetLocalOrientation(unsigned int slot, const MT_Matrix3x3& rot);
+	void SetLocalScaling(unsigned int slot, const MT_Vector3& scale);
+	void SetPosition(unsigned int slot, const MT_Vector3& pos);
+	void SetOrientation(unsigned int slot, const MT_Matrix3x3& rot);
+	void SetScaling(unsigned int slot, const MT_Vector3& scale);
+
+	/** Update the world transforms of the scheduled slots and of their descendants.
+	 * The hierarchy is traversed level by level in the slot arrays, the composed slots
+	 * are computed in place and only the other nodes are updated through their parent
+	 * relation and controllers. The update callback of the updated nodes is called
+	 * at the end, parents first.
+	 * \param taskPool The task pool used to update the relation nodes of different
+	 * famillies, nullptr to update them in the calling thread.
+	 */
+	void Update(double time, TaskPool *taskPool);
+
+	/** Compute for every slot the minimum squared distance between the world position and points.
+	 * \param distances The result indexed by slot, resized to the number of slots.
+	 */
+	void ComputeMinDistances2(const std::vector<MT_Vector3>& points, std::vector<float>& distances) const;
+
+	/** Compose the OpenGL world matrices (column major, scaled) of a list of slots.
+	 * \param slots The slots to compute the matrix of.
+	 * \param matrices The 16 floats destination of each slot matrix.
+	 */
+	void ComputeMatrices(const std::vector<unsigned int>& slots, const std::vector<float *>& matrices) const;
+};
+
+#endif  // __SG_TRANSFORM_POOL_H__
@@ -31,6 +31,8 @@
 
 #include "FilterBase.h"
 
+#include <algorithm>
+
 #include "EXP_PyObjectPlus.h"
 #include <structmember.h>
 
@@ -84,6 +86,24 @@ FilterBase * FilterBase::findFirst (void)
 }
 
 
+// get row filter chain
+bool FilterBase::getRowChain (std::vector<FilterBase *> & chain)
+{
+	chain.clear();
+	for (FilterBase * filt = this; filt != nullptr;
+	     filt = filt->m_previous != nullptr ? filt->m_previous->m_filter : nullptr)
+	{
+		// a single per pixel filter prevents row evaluation of the whole chain
+		if (filt->getRowMode() == FILTER_ROW_NONE)
+			return false;
+		chain.push_back(filt);
+	}
+	// first filter is evaluated first
+	std::reverse(chain.begin(), chain.end());
+	return true;
+}
+
+
 
 // list offilter types
 PyTypeList pyFilterTypes;
@@ -37,6 +37,8 @@
 
 #include "PyTypeList.h"
 
+#include <vector>
+
 #define VT_C(v,idx)	((unsigned char*)&v)[idx]
 #define VT_R(v)	((unsigned char*)&v)[0]
 #define VT_G(v)	((unsigned char*)&v)[1]
@@ -55,6 +57,18 @@
 class FilterBase;
 
 
+/// evaluation of a filter on whole pixel rows
+enum FilterRowMode
+{
+	/// filter can only be evaluated per pixel
+	FILTER_ROW_NONE,
+	/// filter result depends only on the converted pixel
+	FILTER_ROW_POINT,
+	/// filter result depends on the converted pixel and its left and upper neighbours
+	FILTER_ROW_NEIGHBOUR
+};
+
+
 // python structure for filter
 struct PyFilter
 {
@@ -94,6 +108,19 @@ public:
 	/// get first filter's source pixel size
 	unsigned int firstPixelSize (void) { return findFirst()->getPixelSize(); }
 
+	/// get row evaluation mode
+	virtual FilterRowMode getRowMode (void) { return FILTER_ROW_NONE; }
+	/// filter a row of pixels converted by the previous filters in place
+	/// \param row pixels of the row, replaced by the filtered pixels
+	/// \param prevRow converted pixels of the previous source row, used by neighbour filters,
+	/// nullptr on the first row
+	/// \param count number of pixels in the row
+	virtual void filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count) {}
+
+	/// get filter chain ending with this filter, first filter first
+	/// \return false if a filter of the chain can't be evaluated on rows
+	bool getRowChain (std::vector<FilterBase *> & chain);
+
 protected:
 	/// previous pixel filter
 	PyFilter * m_previous;
@@ -36,6 +36,13 @@
 #include "FilterBase.h"
 #include "PyTypeList.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+#include <climits>
+#include <algorithm>
+
 // implementation FilterBlueScreen
 
 // constructor
@@ -67,6 +74,51 @@ void FilterBlueScreen::setLimits (unsigned short minLimit, unsigned short maxLim
 	m_limitDist = m_squareLimits[1] - m_squareLimits[0];
 }
 
+// filter a row of pixels
+void FilterBlueScreen::filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count)
+{
+	unsigned int x = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	// color of two pixels, alpha differences are masked out
+	const __m128i color = _mm_set_epi16(0, m_color[2], m_color[1], m_color[0], 0, m_color[2], m_color[1], m_color[0]);
+	const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+	// distances never exceed 3 * 255^2, larger limits behave as the maximum int
+	const __m128i minLimit = _mm_set1_epi32((int)std::min(m_squareLimits[0], (unsigned int)INT_MAX));
+	const __m128i maxLimit = _mm_set1_epi32((int)std::min(m_squareLimits[1], (unsigned int)INT_MAX));
+	const __m128i alphaMask = _mm_set1_epi32(0x00FFFFFF);
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pix = _mm_loadu_si128((__m128i *)(row + x));
+		__m128i difLo = _mm_and_si128(_mm_sub_epi16(_mm_unpacklo_epi8(pix, zero), color), colorMask);
+		__m128i difHi = _mm_and_si128(_mm_sub_epi16(_mm_unpackhi_epi8(pix, zero), color), colorMask);
+		// squared distances of component pairs, then of whole pixels
+		__m128i distLo = _mm_madd_epi16(difLo, difLo);
+		__m128i distHi = _mm_madd_epi16(difHi, difHi);
+		distLo = _mm_add_epi32(distLo, _mm_shuffle_epi32(distLo, _MM_SHUFFLE(2, 3, 0, 1)));
+		distHi = _mm_add_epi32(distHi, _mm_shuffle_epi32(distHi, _MM_SHUFFLE(2, 3, 0, 1)));
+		__m128i dist = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(distLo), _mm_castsi128_ps(distHi),
+		                                               _MM_SHUFFLE(2, 0, 2, 0)));
+		// pixels above the transparent limit and below the opaque limit
+		__m128i aboveMin = _mm_cmpgt_epi32(dist, minLimit);
+		__m128i belowMax = _mm_cmpgt_epi32(maxLimit, dist);
+		// pixels between both limits need a division, use the scalar path
+		if (_mm_movemask_epi8(_mm_and_si128(aboveMin, belowMax)) != 0)
+		{
+			for (unsigned int i = x; i < x + 4; ++i)
+				row[i] = tFilter(row, i, 0, nullptr, 1, row[i]);
+			continue;
+		}
+		// alpha is zero when not above the minimum limit, full otherwise
+		__m128i alpha = _mm_slli_epi32(_mm_srli_epi32(aboveMin, 24), 24);
+		_mm_storeu_si128((__m128i *)(row + x), _mm_or_si128(_mm_and_si128(pix, alphaMask), alpha));
+	}
+#endif
+	// remaining pixels
+	for (; x < count; ++x)
+		row[x] = tFilter(row, x, 0, nullptr, 1, row[x]);
+}
+
 
 
 // cast Filter pointer to FilterBlueScreen
@@ -55,6 +55,11 @@ public:
 	/// set limits for color variation
 	void setLimits (unsigned short minLimit, unsigned short maxLimit);
 
+	/// get row evaluation mode
+	virtual FilterRowMode getRowMode (void) { return FILTER_ROW_POINT; }
+	/// filter a row of pixels
+	virtual void filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count);
+
 protected:
 	///  blue screen color (red component first)
 	unsigned char m_color[3];
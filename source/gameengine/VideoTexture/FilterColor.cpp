@@ -36,8 +36,58 @@
 #include "FilterBase.h"
 #include "PyTypeList.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+
+/// component coefficients of two pixels, red first
+static inline __m128i colorCoefs (short red, short green, short blue, short alpha)
+{
+	return _mm_set_epi16(alpha, blue, green, red, alpha, blue, green, red);
+}
+
+/// weighted sums of the components of four pixels, one 32 bit sum per pixel
+/// \param lo first two pixels unpacked to 16 bits
+/// \param hi last two pixels unpacked to 16 bits
+static inline __m128i colorSums (__m128i lo, __m128i hi, __m128i coefs)
+{
+	// sums of component pairs
+	__m128i sumLo = _mm_madd_epi16(lo, coefs);
+	__m128i sumHi = _mm_madd_epi16(hi, coefs);
+	// add both pairs of each pixel
+	sumLo = _mm_add_epi32(sumLo, _mm_shuffle_epi32(sumLo, _MM_SHUFFLE(2, 3, 0, 1)));
+	sumHi = _mm_add_epi32(sumHi, _mm_shuffle_epi32(sumHi, _MM_SHUFFLE(2, 3, 0, 1)));
+	// gather one sum per pixel
+	return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(sumLo), _mm_castsi128_ps(sumHi),
+	                                       _MM_SHUFFLE(2, 0, 2, 0)));
+}
+#endif
+
 // implementation FilterGray
 
+// filter a row of pixels
+void FilterGray::filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count)
+{
+	unsigned int x = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i coefs = colorCoefs(77, 151, 28, 0);
+	const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+	// four pixels at once
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pix = _mm_loadu_si128((__m128i *)(row + x));
+		__m128i gray = _mm_srli_epi32(colorSums(_mm_unpacklo_epi8(pix, zero),
+		                                        _mm_unpackhi_epi8(pix, zero), coefs), 8);
+		// gray value for red, green and blue, alpha is kept
+		gray = _mm_or_si128(gray, _mm_or_si128(_mm_slli_epi32(gray, 8), _mm_slli_epi32(gray, 16)));
+		_mm_storeu_si128((__m128i *)(row + x), _mm_or_si128(gray, _mm_and_si128(pix, alphaMask)));
+	}
+#endif
+	// remaining pixels
+	for (; x < count; ++x)
+		row[x] = tFilter(row, x, 0, nullptr, 1, row[x]);
+}
+
 // attributes structure
 static PyGetSetDef filterGrayGetSets[] =
 { // attributes from FilterBase class
@@ -109,6 +159,42 @@ void FilterColor::setMatrix (ColorMatrix & mat)
 			m_matrix[r][c] = mat[r][c]; 
 }
 
+// filter a row of pixels
+void FilterColor::filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count)
+{
+	unsigned int x = 0;
+#ifdef __SSE2__
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	__m128i coefs[4];
+	__m128i offsets[4];
+	for (int r = 0; r < 4; ++r)
+	{
+		coefs[r] = colorCoefs(m_matrix[r][0], m_matrix[r][1], m_matrix[r][2], m_matrix[r][3]);
+		offsets[r] = _mm_set1_epi32(m_matrix[r][4]);
+	}
+	// four pixels at once
+	for (; x + 4 <= count; x += 4)
+	{
+		__m128i pix = _mm_loadu_si128((__m128i *)(row + x));
+		__m128i lo = _mm_unpacklo_epi8(pix, zero);
+		__m128i hi = _mm_unpackhi_epi8(pix, zero);
+		// calculate color components the same way as calcColor
+		__m128i red = _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(colorSums(lo, hi, coefs[0]), offsets[0]), 8), mask);
+		__m128i green = _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(colorSums(lo, hi, coefs[1]), offsets[1]), 8), mask);
+		__m128i blue = _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(colorSums(lo, hi, coefs[2]), offsets[2]), 8), mask);
+		__m128i alpha = _mm_and_si128(_mm_srai_epi32(_mm_add_epi32(colorSums(lo, hi, coefs[3]), offsets[3]), 8), mask);
+		// pack components
+		pix = _mm_or_si128(_mm_or_si128(red, _mm_slli_epi32(green, 8)),
+		                   _mm_or_si128(_mm_slli_epi32(blue, 16), _mm_slli_epi32(alpha, 24)));
+		_mm_storeu_si128((__m128i *)(row + x), pix);
+	}
+#endif
+	// remaining pixels
+	for (; x < count; ++x)
+		row[x] = tFilter(row, x, 0, nullptr, 1, row[x]);
+}
+
 
 
 // cast Filter pointer to FilterColor
@@ -231,6 +317,7 @@ FilterLevel::FilterLevel (void)
 		levels[r][1] = 0xFF;
 		levels[r][2] = 0xFF;
 	}
+	updateLevelTable();
 }
 
 // set color levels
@@ -243,6 +330,32 @@ void FilterLevel::setLevels (ColorLevel & lev)
 			levels[r][c] = lev[r][c];
 		levels[r][2] = lev[r][0] < lev[r][1] ? lev[r][1] - lev[r][0] : 1;
 	}
+	updateLevelTable();
+}
+
+// calculate color components of all levels
+void FilterLevel::updateLevelTable (void)
+{
+	for (short idx = 0; idx < 4; ++idx)
+	{
+		for (unsigned int col = 0; col < 256; ++col)
+		{
+			unsigned int val = 0;
+			VT_C(val, idx) = col;
+			m_levelTable[idx][col] = calcColor(val, idx);
+		}
+	}
+}
+
+// filter a row of pixels
+void FilterLevel::filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count)
+{
+	for (unsigned int x = 0; x < count; ++x)
+	{
+		unsigned int val = row[x];
+		VT_RGBA(row[x], m_levelTable[0][VT_R(val)], m_levelTable[1][VT_G(val)],
+		        m_levelTable[2][VT_B(val)], m_levelTable[3][VT_A(val)]);
+	}
 }
 
 
@@ -45,6 +45,11 @@ public:
 	/// destructor
 	virtual ~FilterGray (void) {}
 
+	/// get row evaluation mode
+	virtual FilterRowMode getRowMode (void) { return FILTER_ROW_POINT; }
+	/// filter a row of pixels
+	virtual void filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count);
+
 protected:
 	/// filter pixel template, source int buffer
 	template <class SRC> unsigned int tFilter (SRC src, short x, short y,
@@ -88,6 +93,11 @@ public:
 	/// set color matrix
 	void setMatrix (ColorMatrix & mat);
 
+	/// get row evaluation mode
+	virtual FilterRowMode getRowMode (void) { return FILTER_ROW_POINT; }
+	/// filter a row of pixels
+	virtual void filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count);
+
 protected:
 	///  color calculation matrix
 	ColorMatrix m_matrix;
@@ -138,9 +148,19 @@ public:
 	/// set color matrix
 	void setLevels (ColorLevel & lev);
 
+	/// get row evaluation mode
+	virtual FilterRowMode getRowMode (void) { return FILTER_ROW_POINT; }
+	/// filter a row of pixels
+	virtual void filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count);
+
 protected:
 	///  color calculation matrix
 	ColorLevel levels;
+	/// calculated color components for each level, used for row evaluation
+	unsigned char m_levelTable[4][256];
+
+	/// calculate color components of all levels
+	void updateLevelTable (void);
 
 	/// calculate one color component
 	unsigned int calcColor (unsigned int val, short idx)
@@ -61,6 +61,20 @@ void FilterNormal::setDepth (float depth)
 	m_depthScale = depth / depthScaleKoef;
 }
 
+// filter a row of pixels
+void FilterNormal::filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count)
+{
+	// left pixel of the first column is the pixel itself
+	int leftPix = count > 0 ? int(VT_C(row[0], m_colIdx)) : 0;
+	for (unsigned int x = 0; x < count; ++x)
+	{
+		int actPix = int(VT_C(row[x], m_colIdx));
+		int upPix = prevRow != nullptr ? int(VT_C(prevRow[x], m_colIdx)) : actPix;
+		row[x] = calcNormal(actPix, leftPix, upPix);
+		leftPix = actPix;
+	}
+}
+
 
 // cast Filter pointer to FilterNormal
 inline FilterNormal * getFilter (PyFilter *self)
@@ -60,6 +60,11 @@ public:
 	/// set depth
 	void setDepth (float depth);
 
+	/// get row evaluation mode
+	virtual FilterRowMode getRowMode (void) { return FILTER_ROW_NEIGHBOUR; }
+	/// filter a row of pixels
+	virtual void filterRow (unsigned int *row, const unsigned int *prevRow, unsigned int count);
+
 protected:
 	/// depth of normal relief
 	float m_depth;
@@ -88,6 +93,12 @@ protected:
 			val = convertPrevious(src - pixSize, x - 1, y, size, pixSize);
 			leftPix = VT_C(val,m_colIdx);
 		}
+		return calcNormal(actPix, leftPix, upPix);
+	}
+
+	/// calculate normal color from the heights of a pixel and its neighbours
+	unsigned int calcNormal (int actPix, int leftPix, int upPix)
+	{
 		// height differences (from blue color)
 		float dx = (actPix - leftPix) * m_depthScale;
 		float dy = (actPix - upPix) * m_depthScale;
@@ -97,6 +108,7 @@ protected:
 		dy = dy * dz + normScaleKoef;
 		dz += normScaleKoef;
 		// return normal vector converted to color
+		unsigned int val;
 		VT_RGBA(val, dx, dy, dz, 0xFF);
 		return val;
 	}
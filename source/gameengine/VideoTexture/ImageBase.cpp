@@ -47,6 +47,20 @@ extern "C" {
 
 #include "Exception.h"
 
+#include "KX_Globals.h"
+#include "KX_KetsjiEngine.h"
+
+extern "C" {
+#  include "BLI_utildefines.h"
+#  include "BLI_task.h"
+#  include "BLI_threads.h"
+}
+
+#include <algorithm>
+
+/// number of source rows converted by each task of the row evaluation
+#define VT_FILTER_ROWS_TASK 32
+
 #if (defined(WIN32) || defined(WIN64))
 #define strcasecmp	_stricmp
 #endif
@@ -212,6 +226,146 @@ void ImageBase::setFilter (PyFilter * filt)
 	m_pyfilter = filt;
 }
 
+struct FilterRowsData
+{
+	/// filter converting source pixels and its row function
+	FilterBase *source;
+	FilterSourceRowFunc sourceRow;
+	const void *srcBuff;
+	short *srcSize;
+	unsigned int pixSize;
+	/// pixel filters, first evaluated first
+	std::vector<FilterBase *> chain;
+	/// number of neighbour filters, rows converted before each range to obtain their previous rows
+	int halo;
+	/// source column of each image column
+	std::vector<int> columns;
+	/// image row of each source row, -1 for skipped rows
+	std::vector<int> rows;
+	unsigned int *image;
+};
+
+// convert and filter a range of source rows
+static void filter_rows(const FilterRowsData *data, int begin, int end)
+{
+	// rows are filtered at the image width unless neighbour filters need all source pixels
+	const unsigned int width = data->halo > 0 ? data->srcSize[0] : data->columns.size();
+	const int *columns = data->halo > 0 ? nullptr : data->columns.data();
+	std::vector<unsigned int> row(width);
+	// input of the neighbour filters for the current and previous row
+	const unsigned int numFilters = data->chain.size();
+	std::vector<std::vector<unsigned int> > inputs(numFilters);
+	std::vector<std::vector<unsigned int> > prevInputs(numFilters);
+
+	// the first rows only initialize the previous rows of the neighbour filters
+	const int first = std::max(begin - data->halo, 0);
+	for (int y = first; y < end; ++y)
+	{
+		const int imgRow = data->rows[y];
+		if (data->halo == 0 && imgRow < 0)
+			continue;
+
+		data->sourceRow(data->source, data->srcBuff, data->srcSize, data->pixSize, y, columns, width, row.data());
+		for (unsigned int i = 0; i < numFilters; ++i)
+		{
+			FilterBase *filt = data->chain[i];
+			if (filt->getRowMode() == FILTER_ROW_NEIGHBOUR)
+			{
+				inputs[i].assign(row.begin(), row.end());
+				filt->filterRow(row.data(), (y > first) ? prevInputs[i].data() : nullptr, width);
+				inputs[i].swap(prevInputs[i]);
+			}
+			else
+				filt->filterRow(row.data(), nullptr, width);
+		}
+
+		if (y < begin || imgRow < 0)
+			continue;
+
+		unsigned int *dstBuff = data->image + long(imgRow) * data->columns.size();
+		if (columns != nullptr)
+			memcpy(dstBuff, row.data(), width * sizeof(unsigned int));
+		else
+			for (unsigned int x = 0, size = data->columns.size(); x < size; ++x)
+				dstBuff[x] = row[data->columns[x]];
+	}
+}
+
+static void filter_rows_task_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	const FilterRowsData *data = (FilterRowsData *)BLI_task_pool_userdata(pool);
+	const int begin = GET_INT_FROM_POINTER(taskdata);
+	const int end = std::min(begin + VT_FILTER_ROWS_TASK, (int)data->srcSize[1]);
+
+	filter_rows(data, begin, end);
+}
+
+// convert image with filters evaluated on rows
+bool ImageBase::filterRows (FilterBase & srcFilter, FilterSourceRowFunc sourceRow,
+	const void *srcBuff, short *srcSize)
+{
+	FilterRowsData data;
+	// pixel filters must all support row evaluation
+	if (m_pyfilter != nullptr && !m_pyfilter->m_filter->getRowChain(data.chain))
+		return false;
+
+	data.source = &srcFilter;
+	data.sourceRow = sourceRow;
+	data.srcBuff = srcBuff;
+	data.srcSize = srcSize;
+	data.pixSize = srcFilter.firstPixelSize();
+	data.halo = 0;
+	for (FilterBase *filt : data.chain)
+		if (filt->getRowMode() == FILTER_ROW_NEIGHBOUR)
+			++data.halo;
+	data.image = m_image;
+
+	// columns and rows drawn by the nearest neighbor scaling of convImage
+	int accWidth = srcSize[0] >> 1;
+	for (int x = 0; x < srcSize[0]; ++x)
+	{
+		accWidth += m_size[0];
+		if (accWidth >= srcSize[0])
+		{
+			accWidth -= srcSize[0];
+			data.columns.push_back(x);
+		}
+	}
+	data.rows.resize(srcSize[1]);
+	int accHeight = srcSize[1] >> 1;
+	for (int y = 0, imgRow = 0; y < srcSize[1]; ++y)
+	{
+		// flipped images begin with the last source row
+		const int srcRow = m_flip ? srcSize[1] - y - 1 : y;
+		accHeight += m_size[1];
+		if (accHeight >= srcSize[1])
+		{
+			accHeight -= srcSize[1];
+			data.rows[srcRow] = imgRow++;
+		}
+		else
+			data.rows[srcRow] = -1;
+	}
+
+	if (srcSize[1] <= VT_FILTER_ROWS_TASK)
+	{
+		filter_rows(&data, 0, srcSize[1]);
+		return true;
+	}
+
+	// images converted outside of a running engine use the global scheduler
+	KX_KetsjiEngine *engine = KX_GetActiveEngine();
+	TaskScheduler *scheduler = engine ? engine->GetTaskScheduler() : BLI_task_scheduler_get();
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+	for (int begin = 0; begin < srcSize[1]; begin += VT_FILTER_ROWS_TASK)
+		BLI_task_pool_push(pool, filter_rows_task_func, SET_INT_IN_POINTER(begin), false, TASK_PRIORITY_HIGH);
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+
+	return true;
+}
+
 void ImageBase::swapImageBR()
 {
 	unsigned int size, v, *s;
@@ -48,6 +48,11 @@ class ImageSource;
 /// type for list of image sources
 typedef std::vector<ImageSource*> ImageSourceList;
 
+/// function converting a row of source pixels with a source filter
+typedef void (*FilterSourceRowFunc)(FilterBase *filter, const void *srcBuff, short *srcSize,
+                                    unsigned int pixSize, short y, const int *columns,
+                                    unsigned int count, unsigned int *row);
+
 
 /// base class for image filters
 class ImageBase
@@ -250,9 +255,36 @@ protected:
 		}
 	}
 
+	/// template converting a row of source pixels with a source filter
+	/// \param columns source column of each pixel, nullptr to convert the whole row
+	template <class SRC> static void convSourceRow (FilterBase *filter, const void *srcBuff,
+		short *srcSize, unsigned int pixSize, short y, const int *columns, unsigned int count,
+		unsigned int *row)
+	{
+		// begin of source row
+		SRC src = static_cast<SRC>(const_cast<void *>(srcBuff)) + long(y) * srcSize[0] * pixSize;
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			short x = columns != nullptr ? columns[i] : i;
+			row[i] = filter->convert(src + x * pixSize, x, y, srcSize, pixSize);
+		}
+	}
+
+	/// convert image with the source filter and the pixel filters evaluated on rows in parallel
+	/// \return false if a pixel filter can only be evaluated per pixel
+	bool filterRows (FilterBase & srcFilter, FilterSourceRowFunc sourceRow,
+		const void *srcBuff, short *srcSize);
+
 	// template for specific filter preprocessing
 	template <class F, class SRC> void filterImage (F & filt, SRC srcBuff, short *srcSize)
 	{
+		// evaluate filters on whole rows if all of them support it
+		if (filterRows(filt, convSourceRow<SRC>, srcBuff, srcSize))
+		{
+			// source was processed
+			m_avail = true;
+			return;
+		}
 		// find first filter in chain
 		FilterBase * firstFilter = nullptr;
 		if (m_pyfilter != nullptr) firstFilter = m_pyfilter->m_filter->findFirst();
@@ -63,10 +63,10 @@ const double defFrameRate = 25.0;
 VideoFFmpeg::VideoFFmpeg (HRESULT * hRslt) : VideoBase(), 
 m_codec(nullptr), m_formatCtx(nullptr), m_codecCtx(nullptr), 
 m_frame(nullptr), m_frameDeinterlaced(nullptr), m_frameRGB(nullptr), m_imgConvertCtx(nullptr),
-m_deinterlace(false), m_preseek(0),	m_videoStream(-1), m_baseFrameRate(25.0),
+m_directYUV(false), m_deinterlace(false), m_preseek(0),	m_videoStream(-1), m_baseFrameRate(25.0),
 m_lastFrame(-1),  m_eof(false), m_externTime(false), m_curPosition(-1), m_startTime(0), 
 m_captWidth(0), m_captHeight(0), m_captRate(0.f), m_isImage(false),
-m_isThreaded(false), m_isStreaming(false), m_stopThread(false), m_cacheStarted(false)
+m_isThreaded(false), m_isStreaming(false), m_cache(nullptr)
 {
 	// set video format
 	m_format = RGB24;
@@ -74,12 +74,7 @@ m_isThreaded(false), m_isStreaming(false), m_stopThread(false), m_cacheStarted(f
 	setFlip(true);
 	// construction is OK
 	*hRslt = S_OK;
-	BLI_listbase_clear(&m_thread);
-	pthread_mutex_init(&m_cacheMutex, nullptr);
-	BLI_listbase_clear(&m_frameCacheFree);
-	BLI_listbase_clear(&m_frameCacheBase);
-	BLI_listbase_clear(&m_packetCacheFree);
-	BLI_listbase_clear(&m_packetCacheBase);
+	resetStatistics();
 }
 
 // destructor
@@ -87,6 +82,11 @@ VideoFFmpeg::~VideoFFmpeg ()
 {
 }
 
+void VideoFFmpeg::resetStatistics(void)
+{
+	m_statistics = Statistics();
+}
+
 void VideoFFmpeg::refresh(void)
 {
     // a fixed image will not refresh because it is loaded only once at creation
@@ -117,14 +117,12 @@ bool VideoFFmpeg::release()
 	}
 	if (m_frameDeinterlaced)
 	{
-		MEM_freeN(m_frameDeinterlaced->data[0]);
-		av_free(m_frameDeinterlaced);
+		VideoFFmpegCache::FreeFrame(m_frameDeinterlaced);
 		m_frameDeinterlaced = nullptr;
 	}
 	if (m_frameRGB)
 	{
-		MEM_freeN(m_frameRGB->data[0]);
-		av_free(m_frameRGB);
+		VideoFFmpegCache::FreeFrame(m_frameRGB);
 		m_frameRGB = nullptr;
 	}
 	if (m_imgConvertCtx)
@@ -140,35 +138,25 @@ bool VideoFFmpeg::release()
 
 AVFrame	*VideoFFmpeg::allocFrameRGB()
 {
-	AVFrame *frame;
-	frame = av_frame_alloc();
-	if (m_format == RGBA32)
-	{
-		avpicture_fill((AVPicture*)frame, 
-			(uint8_t*)MEM_callocN(avpicture_get_size(
-				AV_PIX_FMT_RGBA,
-				m_codecCtx->width, m_codecCtx->height),
-				"ffmpeg rgba"),
-			AV_PIX_FMT_RGBA, m_codecCtx->width, m_codecCtx->height);
-	} else 
+	switch (m_format)
 	{
-		avpicture_fill((AVPicture*)frame, 
-			(uint8_t*)MEM_callocN(avpicture_get_size(
-				AV_PIX_FMT_RGB24,
-				m_codecCtx->width, m_codecCtx->height),
-				"ffmpeg rgb"),
-			AV_PIX_FMT_RGB24, m_codecCtx->width, m_codecCtx->height);
+	case RGBA32:
+		return VideoFFmpegCache::AllocFrame(AV_PIX_FMT_RGBA, m_codecCtx->width, m_codecCtx->height, false);
+	case YV12:
+		return VideoFFmpegCache::AllocFrame(AV_PIX_FMT_YUV420P, m_codecCtx->width, m_codecCtx->height, true);
+	default:
+		return VideoFFmpegCache::AllocFrame(AV_PIX_FMT_RGB24, m_codecCtx->width, m_codecCtx->height, false);
 	}
-	return frame;
 }
 
 // set initial parameters
-void VideoFFmpeg::initParams (short width, short height, float rate, bool image)
+void VideoFFmpeg::initParams (short width, short height, float rate, bool image, bool directYUV)
 {
 	m_captWidth = width;
 	m_captHeight = height;
 	m_captRate = rate;
 	m_isImage = image;
+	m_directYUV = directYUV;
 }
 
 
@@ -238,18 +226,17 @@ int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AV
 	m_formatCtx = formatCtx;
 	m_videoStream = videoStream;
 	m_frame = av_frame_alloc();
-	m_frameDeinterlaced = av_frame_alloc();
-
 	// allocate buffer if deinterlacing is required
-	avpicture_fill((AVPicture*)m_frameDeinterlaced, 
-		(uint8_t*)MEM_callocN(avpicture_get_size(
-		m_codecCtx->pix_fmt,
-		m_codecCtx->width, m_codecCtx->height), 
-		"ffmpeg deinterlace"), 
-		m_codecCtx->pix_fmt, m_codecCtx->width, m_codecCtx->height);
+	m_frameDeinterlaced = VideoFFmpegCache::AllocFrame(m_codecCtx->pix_fmt, m_codecCtx->width, m_codecCtx->height, false);
 
+	// deliver YUV frames directly, they are converted by the image filter
+	if (m_directYUV && !m_isImage && VideoFFmpegCache::SupportDirectYUV(m_codecCtx))
+	{
+		m_format = YV12;
+		m_imgConvertCtx = nullptr;
+	}
 	// check if the pixel format supports Alpha
-	if (m_codecCtx->pix_fmt == AV_PIX_FMT_RGB32 ||
+	else if (m_codecCtx->pix_fmt == AV_PIX_FMT_RGB32 ||
 		m_codecCtx->pix_fmt == AV_PIX_FMT_BGR32 ||
 		m_codecCtx->pix_fmt == AV_PIX_FMT_RGB32_1 ||
 		m_codecCtx->pix_fmt == AV_PIX_FMT_BGR32_1) 
@@ -283,232 +270,50 @@ int VideoFFmpeg::openStream(const char *filename, AVInputFormat *inputFormat, AV
 	}
 	m_frameRGB = allocFrameRGB();
 
-	if (!m_imgConvertCtx) {
+	if (!m_imgConvertCtx && m_format != YV12) {
 		avcodec_close(m_codecCtx);
 		m_codecCtx = nullptr;
 		avformat_close_input(&m_formatCtx);
 		m_formatCtx = nullptr;
 		av_free(m_frame);
 		m_frame = nullptr;
-		MEM_freeN(m_frameDeinterlaced->data[0]);
-		av_free(m_frameDeinterlaced);
+		VideoFFmpegCache::FreeFrame(m_frameDeinterlaced);
 		m_frameDeinterlaced = nullptr;
-		MEM_freeN(m_frameRGB->data[0]);
-		av_free(m_frameRGB);
+		VideoFFmpegCache::FreeFrame(m_frameRGB);
 		m_frameRGB = nullptr;
 		return -1;
 	}
 	return 0;
 }
 
-/*
- * This thread is used to load video frame asynchronously.
- * It provides a frame caching service. 
- * The main thread is responsible for positioning the frame pointer in the
- * file correctly before calling startCache() which starts this thread.
- * The cache is organized in two layers: 1) a cache of 20-30 undecoded packets to keep
- * memory and CPU low 2) a cache of 5 decoded frames. 
- * If the main thread does not find the frame in the cache (because the video has restarted
- * or because the GE is lagging), it stops the cache with StopCache() (this is a synchronous
- * function: it sends a signal to stop the cache thread and wait for confirmation), then
- * change the position in the stream and restarts the cache thread.
- */
-void *VideoFFmpeg::cacheThread(void *data)
-{
-	VideoFFmpeg* video = (VideoFFmpeg*)data;
-	// holds the frame that is being decoded
-	CacheFrame *currentFrame = nullptr;
-	CachePacket *cachePacket;
-	bool endOfFile = false;
-	int frameFinished = 0;
-	double timeBase = av_q2d(video->m_formatCtx->streams[video->m_videoStream]->time_base);
-	int64_t startTs = video->m_formatCtx->streams[video->m_videoStream]->start_time;
-
-	if (startTs == AV_NOPTS_VALUE)
-		startTs = 0;
-
-	while (!video->m_stopThread)
-	{
-		// packet cache is used solely by this thread, no need to lock
-		// In case the stream/file contains other stream than the one we are looking for,
-		// allow a bit of cycling to get rid quickly of those frames
-		frameFinished = 0;
-		while (	   !endOfFile 
-				&& (cachePacket = (CachePacket *)video->m_packetCacheFree.first) != nullptr 
-				&& frameFinished < 25)
-		{
-			// free packet => packet cache is not full yet, just read more
-			if (av_read_frame(video->m_formatCtx, &cachePacket->packet)>=0) 
-			{
-				if (cachePacket->packet.stream_index == video->m_videoStream)
-				{
-					// make sure fresh memory is allocated for the packet and move it to queue
-					av_dup_packet(&cachePacket->packet);
-					BLI_remlink(&video->m_packetCacheFree, cachePacket);
-					BLI_addtail(&video->m_packetCacheBase, cachePacket);
-					break;
-				} else {
-					// this is not a good packet for us, just leave it on free queue
-					// Note: here we could handle sound packet
-					av_free_packet(&cachePacket->packet);
-					frameFinished++;
-				}
-				
-			} else {
-				if (video->m_isFile)
-					// this mark the end of the file
-					endOfFile = true;
-				// if we cannot read a packet, no need to continue
-				break;
-			}
-		}
-		// frame cache is also used by main thread, lock
-		if (currentFrame == nullptr) 
-		{
-			// no current frame being decoded, take free one
-			pthread_mutex_lock(&video->m_cacheMutex);
-			if ((currentFrame = (CacheFrame *)video->m_frameCacheFree.first) != nullptr)
-				BLI_remlink(&video->m_frameCacheFree, currentFrame);
-			pthread_mutex_unlock(&video->m_cacheMutex);
-		}
-		if (currentFrame != nullptr)
-		{
-			// this frame is out of free and busy queue, we can manipulate it without locking
-			frameFinished = 0;
-			while (!frameFinished && (cachePacket = (CachePacket *)video->m_packetCacheBase.first) != nullptr)
-			{
-				BLI_remlink(&video->m_packetCacheBase, cachePacket);
-				// use m_frame because when caching, it is not used in main thread
-				// we can't use currentFrame directly because we need to convert to RGB first
-				avcodec_decode_video2(video->m_codecCtx, 
-					video->m_frame, &frameFinished, 
-					&cachePacket->packet);
-				if (frameFinished) 
-				{
-					AVFrame * input = video->m_frame;
-
-					/* This means the data wasnt read properly, this check stops crashing */
-					if (   input->data[0]!=0 || input->data[1]!=0 
-						|| input->data[2]!=0 || input->data[3]!=0)
-					{
-						if (video->m_deinterlace) 
-						{
-							if (avpicture_deinterlace(
-								(AVPicture*) video->m_frameDeinterlaced,
-								(const AVPicture*) video->m_frame,
-								video->m_codecCtx->pix_fmt,
-								video->m_codecCtx->width,
-								video->m_codecCtx->height) >= 0)
-							{
-								input = video->m_frameDeinterlaced;
-							}
-						}
-						// convert to RGB24
-						sws_scale(video->m_imgConvertCtx,
-							input->data,
-							input->linesize,
-							0,
-							video->m_codecCtx->height,
-							currentFrame->frame->data,
-							currentFrame->frame->linesize);
-						// move frame to queue, this frame is necessarily the next one
-						video->m_curPosition = (long)((cachePacket->packet.dts-startTs) * (video->m_baseFrameRate*timeBase) + 0.5);
-						currentFrame->framePosition = video->m_curPosition;
-						pthread_mutex_lock(&video->m_cacheMutex);
-						BLI_addtail(&video->m_frameCacheBase, currentFrame);
-						pthread_mutex_unlock(&video->m_cacheMutex);
-						currentFrame = nullptr;
-					}
-				}
-				av_free_packet(&cachePacket->packet);
-				BLI_addtail(&video->m_packetCacheFree, cachePacket);
-			} 
-			if (currentFrame && endOfFile) 
-			{
-				// no more packet and end of file => put a special frame that indicates that
-				currentFrame->framePosition = -1;
-				pthread_mutex_lock(&video->m_cacheMutex);
-				BLI_addtail(&video->m_frameCacheBase, currentFrame);
-				pthread_mutex_unlock(&video->m_cacheMutex);
-				currentFrame = nullptr;
-				// no need to stay any longer in this thread
-				break;
-			}
-		}
-		// small sleep to avoid unnecessary looping
-		PIL_sleep_ms(10);
-	}
-	// before quitting, put back the current frame to queue to allow freeing
-	if (currentFrame)
-	{
-		pthread_mutex_lock(&video->m_cacheMutex);
-		BLI_addtail(&video->m_frameCacheFree, currentFrame);
-		pthread_mutex_unlock(&video->m_cacheMutex);
-	}
-	return 0;
-}
-
 // start thread to cache video frame from file/capture/stream
 // this function should be called only when the position in the stream is set for the
 // first frame to cache
+// If the main thread does not find the frame in the cache (because the video has restarted
+// or because the GE is lagging), it stops the cache with stopCache() (this is a synchronous
+// function: it sends a signal to stop the cache threads and wait for them), then
+// change the position in the stream and restarts the cache.
 bool VideoFFmpeg::startCache()
 {
-	if (!m_cacheStarted && m_isThreaded)
+	if (!m_cache && m_isThreaded)
 	{
-		m_stopThread = false;
-		for (int i=0; i<CACHE_FRAME_SIZE; i++)
-		{
-			CacheFrame *frame = new CacheFrame();
-			frame->frame = allocFrameRGB();
-			BLI_addtail(&m_frameCacheFree, frame);
-		}
-		for (int i=0; i<CACHE_PACKET_SIZE; i++) 
-		{
-			CachePacket *packet = new CachePacket();
-			BLI_addtail(&m_packetCacheFree, packet);
-		}
-		BLI_init_threads(&m_thread, cacheThread, 1);
-		BLI_insert_thread(&m_thread, this);
-		m_cacheStarted = true;
+		AVPixelFormat format = (m_format == RGBA32) ? AV_PIX_FMT_RGBA : AV_PIX_FMT_RGB24;
+		m_cache = new VideoFFmpegCache(m_formatCtx, m_codecCtx, m_videoStream, m_baseFrameRate, m_isFile,
+		                               m_deinterlace, m_imgConvertCtx, format, m_curPosition);
+		m_cache->Start();
 	}
-	return m_cacheStarted;
+	return (m_cache != nullptr);
 }
 
 void VideoFFmpeg::stopCache()
 {
-	if (m_cacheStarted)
+	if (m_cache)
 	{
-		m_stopThread = true;
-		BLI_end_threads(&m_thread);
-		// now delete the cache
-		CacheFrame *frame;
-		CachePacket *packet;
-		while ((frame = (CacheFrame *)m_frameCacheBase.first) != nullptr)
-		{
-			BLI_remlink(&m_frameCacheBase, frame);
-			MEM_freeN(frame->frame->data[0]);
-			av_free(frame->frame);
-			delete frame;
-		}
-		while ((frame = (CacheFrame *)m_frameCacheFree.first) != nullptr)
-		{
-			BLI_remlink(&m_frameCacheFree, frame);
-			MEM_freeN(frame->frame->data[0]);
-			av_free(frame->frame);
-			delete frame;
-		}
-		while ((packet = (CachePacket *)m_packetCacheBase.first) != nullptr)
-		{
-			BLI_remlink(&m_packetCacheBase, packet);
-			av_free_packet(&packet->packet);
-			delete packet;
-		}
-		while ((packet = (CachePacket *)m_packetCacheFree.first) != nullptr)
-		{
-			BLI_remlink(&m_packetCacheFree, packet);
-			delete packet;
-		}
-		m_cacheStarted = false;
+		m_cache->Stop();
+		// the cache threads read the stream further than the frames used
+		m_curPosition = m_cache->GetPosition();
+		delete m_cache;
+		m_cache = nullptr;
 	}
 }
 
@@ -520,12 +325,8 @@ void VideoFFmpeg::releaseFrame(AVFrame *frame)
 		return;
 	}
 	// this frame MUST be the first one of the queue
-	pthread_mutex_lock(&m_cacheMutex);
-	CacheFrame *cacheFrame = (CacheFrame *)m_frameCacheBase.first;
-	assert (cacheFrame != nullptr && cacheFrame->frame == frame);
-	BLI_remlink(&m_frameCacheBase, cacheFrame);
-	BLI_addtail(&m_frameCacheFree, cacheFrame);
-	pthread_mutex_unlock(&m_cacheMutex);
+	assert(m_cache != nullptr && m_cache->GetFrame() != nullptr && m_cache->GetFrame()->m_frame == frame);
+	m_cache->ReleaseFrame();
 }
 
 // open video file
@@ -818,7 +619,7 @@ void VideoFFmpeg::calcImage (unsigned int texId, double ts, bool mipmap, unsigne
 			// get image
 			if ((frame = grabFrame(actFrame)) != nullptr)
 			{
-				if (!m_isFile && !m_cacheStarted) 
+				if (!m_isFile && !m_cache) 
 				{
 					// streaming without cache: detect synchronization problem
 					double execTime = PIL_check_seconds_timer() - startTime;
@@ -834,7 +635,10 @@ void VideoFFmpeg::calcImage (unsigned int texId, double ts, bool mipmap, unsigne
 				// init image, if needed
 				init(short(m_codecCtx->width), short(m_codecCtx->height));
 				// process image
+				double processTime = PIL_check_seconds_timer();
 				process((BYTE*)(frame->data[0]));
+				m_statistics.m_processTime += PIL_check_seconds_timer() - processTime;
+				++m_statistics.m_frames;
 				// finished with the frame, release it so that cache can reuse it
 				releaseFrame(frame);
 				// in case it is an image, automatically stop reading it
@@ -880,17 +684,16 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 	int posFound = 1;
 	bool frameLoaded = false;
 	int64_t targetTs = 0;
-	CacheFrame *frame;
+	VideoFFmpegCache::Frame *frame;
 	int64_t dts = 0;
+	double decodeTime = 0.0;
 
-	if (m_cacheStarted)
+	if (m_cache)
 	{
 		// when cache is active, we must not read the file directly
 		do {
-			pthread_mutex_lock(&m_cacheMutex);
-			frame = (CacheFrame *)m_frameCacheBase.first;
-			pthread_mutex_unlock(&m_cacheMutex);
-			// no need to remove the frame from the queue: the cache thread does not touch the head, only the tail
+			frame = m_cache->GetFrame();
+			// no need to remove the frame from the queue: the cache threads do not touch the head, only the tail
 			if (frame == nullptr)
 			{
 				// no frame in cache, in case of file it is an abnormal situation
@@ -902,7 +705,7 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 				}
 				return nullptr;
 			}
-			if (frame->framePosition == -1) 
+			if (frame->m_position == -1) 
 			{
 				// this frame mark the end of the file (only used for file)
 				// leave in cache to make sure we don't miss it
@@ -911,23 +714,24 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 			}
 			// for streaming, always return the next frame, 
 			// that's what grabFrame does in non cache mode anyway.
-			if (m_isStreaming || frame->framePosition == position)
+			if (m_isStreaming || frame->m_position == position)
 			{
-				return frame->frame;
+				m_statistics.m_decodeTime += frame->m_decodeTime;
+				m_statistics.m_convertTime += frame->m_convertTime;
+				m_statistics.m_queueTime += PIL_check_seconds_timer() - frame->m_readyTime;
+				return frame->m_frame;
 			}
 			// for cam, skip old frames to keep image realtime.
 			// There should be no risk of clock drift since it all happens on the same CPU
-			if (frame->framePosition > position) 
+			if (frame->m_position > position) 
 			{
 				// this can happen after rewind if the seek didn't find the first frame
 				// the frame in the buffer is ahead of time, just leave it there
 				return nullptr;
 			}
 			// this frame is not useful, release it
-			pthread_mutex_lock(&m_cacheMutex);
-			BLI_remlink(&m_frameCacheBase, frame);
-			BLI_addtail(&m_frameCacheFree, frame);
-			pthread_mutex_unlock(&m_cacheMutex);
+			m_cache->ReleaseFrame();
+			++m_statistics.m_skippedFrames;
 		} while (true);
 	}
 	double timeBase = av_q2d(m_formatCtx->streams[m_videoStream]->time_base);
@@ -1028,10 +832,12 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 			short counter = 0;
 
 			/* If m_isImage, while the data is not read properly (png, tiffs, etc formats may need several pass), else don't need while loop*/
+			double startTime = PIL_check_seconds_timer();
 			do {
 				avcodec_decode_video2(m_codecCtx, m_frame, &frameFinished, &packet);
 				counter++;
 			} while ((input->data[0] == 0 && input->data[1] == 0 && input->data[2] == 0 && input->data[3] == 0) && counter < 10 && m_isImage);
+			decodeTime += PIL_check_seconds_timer() - startTime;
 
 			// remember dts to compute exact frame number
 			dts = packet.dts;
@@ -1068,14 +874,11 @@ AVFrame *VideoFFmpeg::grabFrame(long position)
 						input = m_frameDeinterlaced;
 					}
 				}
-				// convert to RGB24
-				sws_scale(m_imgConvertCtx,
-					input->data,
-					input->linesize,
-					0,
-					m_codecCtx->height,
-					m_frameRGB->data,
-					m_frameRGB->linesize);
+				// convert to RGB24, or copy the YUV planes
+				double convertTime = PIL_check_seconds_timer();
+				VideoFFmpegCache::ConvertFrame(m_imgConvertCtx, m_codecCtx, input, m_frameRGB);
+				m_statistics.m_convertTime += PIL_check_seconds_timer() - convertTime;
+				m_statistics.m_decodeTime += decodeTime;
 				av_free_packet(&packet);
 				frameLoaded = true;
 				break;
@@ -1125,12 +928,14 @@ static int VideoFFmpeg_init(PyObject *pySelf, PyObject *args, PyObject *kwds)
 	short height = 0;
 	// capture rate, only if capt is >= 0
 	float rate = 25.f;
+	// deliver YUV frames without conversion
+	int yuv = 0;
 
-	static const char *kwlist[] = {"file", "capture", "rate", "width", "height", nullptr};
+	static const char *kwlist[] = {"file", "capture", "rate", "width", "height", "yuv", nullptr};
 
 	// get parameters
-	if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|hfhh",
-		const_cast<char**>(kwlist), &file, &capt, &rate, &width, &height))
+	if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|hfhhp",
+		const_cast<char**>(kwlist), &file, &capt, &rate, &width, &height, &yuv))
 		return -1; 
 
 	try
@@ -1139,7 +944,7 @@ static int VideoFFmpeg_init(PyObject *pySelf, PyObject *args, PyObject *kwds)
 		Video_init<VideoFFmpeg>(self);
 
 		// set thread usage
-		getVideoFFmpeg(self)->initParams(width, height, rate);
+		getVideoFFmpeg(self)->initParams(width, height, rate, false, yuv != 0);
 
 		// open video source
 		Video_open(getVideo(self), file, capt);
@@ -1197,6 +1002,15 @@ static int VideoFFmpeg_setDeinterlace(PyImage *self, PyObject *value, void *clos
 	return 0;
 }
 
+// get direct YUV delivery
+static PyObject *VideoFFmpeg_getYUV(PyImage *self, void *closure)
+{
+	if (getFFmpeg(self)->getDirectYUV())
+		Py_RETURN_TRUE;
+	else
+		Py_RETURN_FALSE;
+}
+
 // methods structure
 static PyMethodDef videoMethods[] =
 { // methods from VideoBase class
@@ -1222,6 +1036,7 @@ static PyGetSetDef videoGetSets[] =
 	{(char*)"filter", (getter)Image_getFilter, (setter)Image_setFilter, (char*)"pixel filter", nullptr},
 	{(char*)"preseek", (getter)VideoFFmpeg_getPreseek, (setter)VideoFFmpeg_setPreseek, (char*)"nb of frames of preseek", nullptr},
 	{(char*)"deinterlace", (getter)VideoFFmpeg_getDeinterlace, (setter)VideoFFmpeg_setDeinterlace, (char*)"deinterlace image", nullptr},
+	{(char*)"yuv", (getter)VideoFFmpeg_getYUV, nullptr, (char*)"frames are delivered as YUV without conversion", nullptr},
 	{nullptr}
 };
 
@@ -37,9 +37,7 @@
 #  include <inttypes.h>
 #endif
 extern "C" {
-#include <pthread.h>
 #include "ffmpeg_compat.h"
-#include "DNA_listBase.h"
 #include "BLI_threads.h"
 #include "BLI_blenlib.h"
 }
@@ -63,9 +61,7 @@ static inline AVCodecContext *get_codec_from_stream(AVStream* stream)
 #endif
 
 #include "VideoBase.h"
-
-#define CACHE_FRAME_SIZE	10
-#define CACHE_PACKET_SIZE	30
+#include "VideoFFmpegCache.h"
 
 // type VideoFFmpeg declaration
 class VideoFFmpeg : public VideoBase
@@ -77,7 +73,7 @@ public:
 	virtual ~VideoFFmpeg ();
 
 	/// set initial parameters
-	void initParams (short width, short height, float rate, bool image=false);
+	void initParams (short width, short height, float rate, bool image=false, bool directYUV=false);
 	/// open video/image file
 	virtual void openFile(char *file);
 	/// open video capture device
@@ -103,6 +99,25 @@ public:
 	bool getDeinterlace(void) { return m_deinterlace; }
 	void setDeinterlace(bool deinterlace) { m_deinterlace = deinterlace; }
 	char *getImageName(void) { return (m_isImage) ? (char *)m_imageName.c_str() : nullptr; }
+	/// are frames delivered as YV12 without conversion
+	bool getDirectYUV(void) { return m_format == YV12; }
+
+	/// time spent in the stages of the frames delivered to the image, in seconds
+	struct Statistics
+	{
+		/// frames delivered to the image, and frames read ahead but never displayed
+		unsigned int m_frames;
+		unsigned int m_skippedFrames;
+		/// decoding and conversion, in the cache threads or in grabFrame
+		double m_decodeTime;
+		double m_convertTime;
+		/// wait of the frames in the cache before being used
+		double m_queueTime;
+		/// conversion of the frames to the image by the filters
+		double m_processTime;
+	};
+	const Statistics& getStatistics(void) { return m_statistics; }
+	void resetStatistics(void);
 
 protected:
 	// format and codec information
@@ -115,8 +130,10 @@ protected:
 	AVFrame	*m_frameDeinterlaced;
 	// decoded RGB24 frame if codec requires it
 	AVFrame	*m_frameRGB;
-	// conversion from raw to RGB is done with sws_scale
+	// conversion from raw to RGB is done with sws_scale, nullptr for direct YUV delivery
 	struct SwsContext *m_imgConvertCtx;
+	// deliver YUV frames without conversion if the codec supports it
+	bool m_directYUV;
 	// should the codec be deinterlaced?
 	bool m_deinterlace;
 	// number of frame of preseek
@@ -163,6 +180,9 @@ protected:
 	/// keep last image name
 	std::string m_imageName;
 
+	/// time spent in the stages of the frames
+	Statistics m_statistics;
+
 	/// image calculation
 	virtual void calcImage (unsigned int texId, double ts, bool mipmap, unsigned int format);
 
@@ -186,27 +206,10 @@ protected:
 	void stopCache();
 
 private:
-	typedef struct {
-		Link link;
-		long framePosition;
-		AVFrame *frame;
-	} CacheFrame;
-	typedef struct {
-		Link link;
-		AVPacket packet;
-	} CachePacket;
-
-	bool m_stopThread;
-	bool m_cacheStarted;
-	ListBase m_thread;
-	ListBase m_frameCacheBase;	// list of frames that are ready
-	ListBase m_frameCacheFree;	// list of frames that are unused
-	ListBase m_packetCacheBase;	// list of packets that are ready for decoding
-	ListBase m_packetCacheFree;	// list of packets that are unused
-	pthread_mutex_t m_cacheMutex;
+	/// frame read ahead, nullptr when the cache is not started
+	VideoFFmpegCache *m_cache;
 
 	AVFrame	*allocFrameRGB();
-	static void *cacheThread(void *);
 };
 
 inline VideoFFmpeg *getFFmpeg(PyImage *self)
@@ -0,0 +1,399 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/VideoTexture/VideoFFmpegCache.cpp
+ *  \ingroup bgevideotex
+ */
+
+
+#ifdef WITH_FFMPEG
+
+// INT64_C fix for some linux machines (C99ism)
+#ifndef __STDC_CONSTANT_MACROS
+#define __STDC_CONSTANT_MACROS
+#endif
+
+#include <stdint.h>
+
+#include "MEM_guardedalloc.h"
+#include "PIL_time.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "BLI_listbase.h"
+}
+
+#include "VideoFFmpegCache.h"
+
+#include <algorithm>
+
+/// sleep time of the threads when they can't progress, in milliseconds
+#define CACHE_DECODE_SLEEP	10
+#define CACHE_CONVERT_SLEEP	1
+
+VideoFFmpegCache::VideoFFmpegCache(AVFormatContext *formatCtx, AVCodecContext *codecCtx, int videoStream,
+	double baseFrameRate, bool isFile, bool deinterlace, SwsContext *convertCtx, AVPixelFormat format,
+	long position)
+	:m_formatCtx(formatCtx),
+	m_codecCtx(codecCtx),
+	m_videoStream(videoStream),
+	m_convertCtx(convertCtx),
+	m_isFile(isFile),
+	m_deinterlace(deinterlace),
+	m_frames(CACHE_FRAME_SIZE),
+	m_decodedFrames((convertCtx) ? CACHE_DECODED_SIZE : 0),
+	m_frameReady(CACHE_FRAME_SIZE),
+	m_frameFree(CACHE_FRAME_SIZE),
+	m_decodedReady(CACHE_DECODED_SIZE),
+	m_decodedFree(CACHE_DECODED_SIZE),
+	m_decodeFrame(nullptr),
+	m_convertFrame(nullptr),
+	m_stopThread(false),
+	m_position(position),
+	m_started(false)
+{
+	AVStream *stream = m_formatCtx->streams[m_videoStream];
+	m_positionScale = baseFrameRate * av_q2d(stream->time_base);
+	m_startTs = stream->start_time;
+	if (m_startTs == AV_NOPTS_VALUE) {
+		m_startTs = 0;
+	}
+
+	m_decodedFrame = av_frame_alloc();
+
+	const int width = m_codecCtx->width;
+	const int height = m_codecCtx->height;
+	// the output frames are filled by the decoding thread when there's no conversion
+	for (Frame& frame : m_frames) {
+		frame.m_frame = (m_convertCtx) ? AllocFrame(format, width, height, false) :
+		                AllocFrame(AV_PIX_FMT_YUV420P, width, height, true);
+		m_frameFree.Push(&frame);
+	}
+	for (Frame& frame : m_decodedFrames) {
+		frame.m_frame = AllocFrame(m_codecCtx->pix_fmt, width, height, false);
+		m_decodedFree.Push(&frame);
+	}
+
+	BLI_listbase_clear(&m_decodeThread);
+	BLI_listbase_clear(&m_convertThread);
+}
+
+VideoFFmpegCache::~VideoFFmpegCache()
+{
+	Stop();
+
+	for (Frame& frame : m_frames) {
+		FreeFrame(frame.m_frame);
+	}
+	for (Frame& frame : m_decodedFrames) {
+		FreeFrame(frame.m_frame);
+	}
+	av_free(m_decodedFrame);
+}
+
+void VideoFFmpegCache::Start()
+{
+	if (m_started) {
+		return;
+	}
+
+	m_stopThread = false;
+	BLI_init_threads(&m_decodeThread, DecodeThread, 1);
+	BLI_insert_thread(&m_decodeThread, this);
+	if (m_convertCtx) {
+		BLI_init_threads(&m_convertThread, ConvertThread, 1);
+		BLI_insert_thread(&m_convertThread, this);
+	}
+	m_started = true;
+}
+
+void VideoFFmpegCache::Stop()
+{
+	if (!m_started) {
+		return;
+	}
+
+	m_stopThread = true;
+	BLI_end_threads(&m_decodeThread);
+	if (m_convertCtx) {
+		BLI_end_threads(&m_convertThread);
+	}
+
+	/* Each ring has a single producer while the threads run, the frames held by the
+	 * threads are put back to their ring only once both threads are stopped. */
+	if (m_decodeFrame) {
+		((m_convertCtx) ? m_decodedFree : m_frameFree).Push(m_decodeFrame);
+		m_decodeFrame = nullptr;
+	}
+	if (m_convertFrame) {
+		m_frameFree.Push(m_convertFrame);
+		m_convertFrame = nullptr;
+	}
+	m_started = false;
+}
+
+VideoFFmpegCache::Frame *VideoFFmpegCache::GetFrame()
+{
+	Frame *frame;
+	if (m_frameReady.Front(frame)) {
+		return frame;
+	}
+	return nullptr;
+}
+
+void VideoFFmpegCache::ReleaseFrame()
+{
+	Frame *frame;
+	if (m_frameReady.Pop(frame)) {
+		m_frameFree.Push(frame);
+	}
+}
+
+long VideoFFmpegCache::GetPosition() const
+{
+	return m_position;
+}
+
+AVFrame *VideoFFmpegCache::AllocFrame(AVPixelFormat format, int width, int height, bool yv12)
+{
+	AVFrame *frame = av_frame_alloc();
+	avpicture_fill((AVPicture *)frame,
+		(uint8_t *)MEM_callocN(avpicture_get_size(format, width, height), "ffmpeg frame"),
+		format, width, height);
+	if (yv12) {
+		// YV12 stores the V plane before the U plane, as expected by FilterYV12
+		std::swap(frame->data[1], frame->data[2]);
+	}
+	return frame;
+}
+
+void VideoFFmpegCache::FreeFrame(AVFrame *frame)
+{
+	// the swapped planes of YV12 frames still begin with the Y plane
+	MEM_freeN(frame->data[0]);
+	av_free(frame);
+}
+
+bool VideoFFmpegCache::SupportDirectYUV(AVCodecContext *codecCtx)
+{
+	// the chroma planes of YV12 frames are half the size of the image
+	return (codecCtx->pix_fmt == AV_PIX_FMT_YUV420P || codecCtx->pix_fmt == AV_PIX_FMT_YUVJ420P) &&
+	       (codecCtx->width % 2) == 0 && (codecCtx->height % 2) == 0;
+}
+
+void VideoFFmpegCache::ConvertFrame(SwsContext *convertCtx, AVCodecContext *codecCtx, AVFrame *input, AVFrame *output)
+{
+	if (convertCtx) {
+		sws_scale(convertCtx, input->data, input->linesize, 0, codecCtx->height,
+		          output->data, output->linesize);
+	}
+	else {
+		// direct YUV delivery, only remove the padding of the planes
+		av_picture_copy((AVPicture *)output, (const AVPicture *)input, codecCtx->pix_fmt,
+		                codecCtx->width, codecCtx->height);
+	}
+}
+
+/*
+ * This thread reads and decodes the packets of the video stream.
+ * The cache is organized in two layers: 1) a cache of 20-30 undecoded packets to keep
+ * memory and CPU low 2) the decoded frames, copied to a free decoded frame for the
+ * conversion thread or directly to a free output frame with the direct YUV delivery.
+ * The thread only sleeps when it can't read a packet or get a frame to fill.
+ */
+void *VideoFFmpegCache::DecodeThread(void *data)
+{
+	VideoFFmpegCache *cache = (VideoFFmpegCache *)data;
+	// packet cache is used solely by this thread
+	ListBase packetCacheBase = {nullptr, nullptr};
+	ListBase packetCacheFree = {nullptr, nullptr};
+	AVPacket packets[CACHE_PACKET_SIZE];
+	for (AVPacket& packet : packets) {
+		av_init_packet(&packet);
+	}
+	LinkData packetLinks[CACHE_PACKET_SIZE];
+	for (unsigned short i = 0; i < CACHE_PACKET_SIZE; ++i) {
+		packetLinks[i].data = &packets[i];
+		BLI_addtail(&packetCacheFree, &packetLinks[i]);
+	}
+
+	// ring of the frames filled by this thread
+	CM_RingBuffer<Frame *>& freeRing = (cache->m_convertCtx) ? cache->m_decodedFree : cache->m_frameFree;
+	CM_RingBuffer<Frame *>& readyRing = (cache->m_convertCtx) ? cache->m_decodedReady : cache->m_frameReady;
+
+	// holds the frame that is being filled
+	Frame *currentFrame = nullptr;
+	LinkData *cachePacket;
+	bool endOfFile = false;
+	double decodeTime = 0.0;
+
+	while (!cache->m_stopThread) {
+		bool progress = false;
+
+		// In case the stream/file contains other stream than the one we are looking for,
+		// allow a bit of cycling to get rid quickly of those frames
+		int skipped = 0;
+		while (!endOfFile && (cachePacket = (LinkData *)packetCacheFree.first) != nullptr && skipped < 25) {
+			AVPacket *packet = (AVPacket *)cachePacket->data;
+			// free packet => packet cache is not full yet, just read more
+			if (av_read_frame(cache->m_formatCtx, packet) >= 0) {
+				if (packet->stream_index == cache->m_videoStream) {
+					// make sure fresh memory is allocated for the packet and move it to queue
+					av_dup_packet(packet);
+					BLI_remlink(&packetCacheFree, cachePacket);
+					BLI_addtail(&packetCacheBase, cachePacket);
+					progress = true;
+					break;
+				}
+				else {
+					// this is not a good packet for us, just leave it on free queue
+					// Note: here we could handle sound packet
+					av_free_packet(packet);
+					++skipped;
+				}
+			}
+			else {
+				if (cache->m_isFile) {
+					// this mark the end of the file
+					endOfFile = true;
+				}
+				// if we cannot read a packet, no need to continue
+				break;
+			}
+		}
+
+		if (currentFrame == nullptr) {
+			freeRing.Pop(currentFrame);
+		}
+
+		if (currentFrame != nullptr) {
+			int frameFinished = 0;
+			while (!frameFinished && (cachePacket = (LinkData *)packetCacheBase.first) != nullptr) {
+				AVPacket *packet = (AVPacket *)cachePacket->data;
+				BLI_remlink(&packetCacheBase, cachePacket);
+
+				const double startTime = PIL_check_seconds_timer();
+				avcodec_decode_video2(cache->m_codecCtx, cache->m_decodedFrame, &frameFinished, packet);
+				if (frameFinished) {
+					AVFrame *input = cache->m_decodedFrame;
+
+					/* This means the data wasnt read properly, this check stops crashing */
+					if (input->data[0] != 0 || input->data[1] != 0 || input->data[2] != 0 || input->data[3] != 0) {
+						// the decoded frame is overwritten by the next decoding, copy it
+						if (!cache->m_deinterlace ||
+							avpicture_deinterlace((AVPicture *)currentFrame->m_frame, (const AVPicture *)input,
+							                      cache->m_codecCtx->pix_fmt, cache->m_codecCtx->width,
+							                      cache->m_codecCtx->height) < 0)
+						{
+							av_picture_copy((AVPicture *)currentFrame->m_frame, (const AVPicture *)input,
+							                cache->m_codecCtx->pix_fmt, cache->m_codecCtx->width,
+							                cache->m_codecCtx->height);
+						}
+
+						// move frame to queue, this frame is necessarily the next one
+						const long position = (long)((packet->dts - cache->m_startTs) * cache->m_positionScale + 0.5);
+						cache->m_position = position;
+						currentFrame->m_position = position;
+						currentFrame->m_decodeTime = decodeTime + PIL_check_seconds_timer() - startTime;
+						currentFrame->m_convertTime = 0.0;
+						currentFrame->m_readyTime = PIL_check_seconds_timer();
+						readyRing.Push(currentFrame);
+						currentFrame = nullptr;
+						decodeTime = 0.0;
+						progress = true;
+					}
+				}
+				else {
+					decodeTime += PIL_check_seconds_timer() - startTime;
+				}
+				av_free_packet(packet);
+				BLI_addtail(&packetCacheFree, cachePacket);
+			}
+			if (currentFrame && endOfFile && !packetCacheBase.first) {
+				// no more packet and end of file => put a special frame that indicates that
+				currentFrame->m_position = -1;
+				currentFrame->m_readyTime = PIL_check_seconds_timer();
+				readyRing.Push(currentFrame);
+				currentFrame = nullptr;
+				// no need to stay any longer in this thread
+				break;
+			}
+		}
+
+		// small sleep to avoid unnecessary looping
+		if (!progress) {
+			PIL_sleep_ms(CACHE_DECODE_SLEEP);
+		}
+	}
+
+	// before quitting, keep the current frame to put it back to queue in Stop
+	cache->m_decodeFrame = currentFrame;
+	while ((cachePacket = (LinkData *)packetCacheBase.first) != nullptr) {
+		BLI_remlink(&packetCacheBase, cachePacket);
+		av_free_packet((AVPacket *)cachePacket->data);
+	}
+	return 0;
+}
+
+/*
+ * This thread converts the decoded frames to the output format.
+ */
+void *VideoFFmpegCache::ConvertThread(void *data)
+{
+	VideoFFmpegCache *cache = (VideoFFmpegCache *)data;
+	// holds the output frame that is being filled
+	Frame *currentFrame = nullptr;
+
+	while (!cache->m_stopThread) {
+		Frame *decodedFrame;
+		if (currentFrame == nullptr) {
+			cache->m_frameFree.Pop(currentFrame);
+		}
+		if (currentFrame == nullptr || !cache->m_decodedReady.Pop(decodedFrame)) {
+			PIL_sleep_ms(CACHE_CONVERT_SLEEP);
+			continue;
+		}
+
+		const double startTime = PIL_check_seconds_timer();
+		if (decodedFrame->m_position != -1) {
+			ConvertFrame(cache->m_convertCtx, cache->m_codecCtx, decodedFrame->m_frame, currentFrame->m_frame);
+		}
+		currentFrame->m_position = decodedFrame->m_position;
+		currentFrame->m_decodeTime = decodedFrame->m_decodeTime;
+		currentFrame->m_convertTime = PIL_check_seconds_timer() - startTime;
+		currentFrame->m_readyTime = PIL_check_seconds_timer();
+		cache->m_decodedFree.Push(decodedFrame);
+		cache->m_frameReady.Push(currentFrame);
+
+		// the end of file frame is the last one
+		if (currentFrame->m_position == -1) {
+			currentFrame = nullptr;
+			break;
+		}
+		currentFrame = nullptr;
+	}
+
+	cache->m_convertFrame = currentFrame;
+	return 0;
+}
+
+#endif  /* WITH_FFMPEG */
@@ -0,0 +1,143 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file VideoFFmpegCache.h
+ *  \ingroup bgevideotex
+ */
+
+#ifndef __VIDEOFFMPEGCACHE_H__
+#define __VIDEOFFMPEGCACHE_H__
+
+#ifdef WITH_FFMPEG
+#if defined(__FreeBSD__)
+#  include <inttypes.h>
+#endif
+extern "C" {
+#include "ffmpeg_compat.h"
+#include "DNA_listBase.h"
+}
+
+#include "CM_RingBuffer.h"
+
+#include <vector>
+#include <atomic>
+
+/// number of converted frames read ahead
+#define CACHE_FRAME_SIZE	10
+/// number of decoded frames waiting for conversion
+#define CACHE_DECODED_SIZE	4
+/// number of undecoded packets read ahead
+#define CACHE_PACKET_SIZE	30
+
+/** \brief Read ahead of the frames of a video stream.
+ * A thread reads and decodes the packets, a second thread converts the decoded frames to the
+ * output format. Frames are preallocated and exchanged between the threads and the main
+ * thread through lock-free ring buffers. With the direct YUV delivery the decoded planes are
+ * copied to a packed YV12 frame and the conversion thread is not used.
+ * The stream must be positioned on the first frame to cache before calling Start.
+ */
+class VideoFFmpegCache
+{
+public:
+	struct Frame
+	{
+		/// position of the frame in the stream, -1 marks the end of the file
+		long m_position;
+		AVFrame *m_frame;
+		/// time spent to decode and convert the frame, in seconds
+		double m_decodeTime;
+		double m_convertTime;
+		/// time the frame was made available to the main thread
+		double m_readyTime;
+	};
+
+	/** Constructor.
+	 * \param convertCtx The conversion to the output format, nullptr for direct YUV delivery.
+	 * \param format The output format, ignored for direct YUV delivery.
+	 * \param position The position of the last frame read in the stream.
+	 */
+	VideoFFmpegCache(AVFormatContext *formatCtx, AVCodecContext *codecCtx, int videoStream,
+	                 double baseFrameRate, bool isFile, bool deinterlace, SwsContext *convertCtx,
+	                 AVPixelFormat format, long position);
+	~VideoFFmpegCache();
+
+	/// start the cache threads
+	void Start();
+	/// stop and wait for the cache threads
+	void Stop();
+
+	/// get the next frame available, nullptr if the frame is not read yet
+	Frame *GetFrame();
+	/// release the frame returned by GetFrame, the following frame becomes available
+	void ReleaseFrame();
+
+	/// get the position of the last frame decoded
+	long GetPosition() const;
+
+	/// allocate a frame with its own buffer, YV12 frames store their V plane before the U plane
+	static AVFrame *AllocFrame(AVPixelFormat format, int width, int height, bool yv12);
+	static void FreeFrame(AVFrame *frame);
+	/// check if the decoded frames of a codec can be delivered as YV12 frames
+	static bool SupportDirectYUV(AVCodecContext *codecCtx);
+	/// copy or convert a decoded frame to the output format
+	static void ConvertFrame(SwsContext *convertCtx, AVCodecContext *codecCtx, AVFrame *input, AVFrame *output);
+
+private:
+	AVFormatContext *m_formatCtx;
+	AVCodecContext *m_codecCtx;
+	int m_videoStream;
+	SwsContext *m_convertCtx;
+	bool m_isFile;
+	bool m_deinterlace;
+	/// conversion of packet time stamps to frame positions
+	double m_positionScale;
+	int64_t m_startTs;
+
+	/// decoded frame, only used by the decoding thread
+	AVFrame *m_decodedFrame;
+	/// all frames, owned by the cache
+	std::vector<Frame> m_frames;
+	std::vector<Frame> m_decodedFrames;
+	/// frames converted and available for the main thread, and frames to fill
+	CM_RingBuffer<Frame *> m_frameReady;
+	CM_RingBuffer<Frame *> m_frameFree;
+	/// frames decoded to be converted, and decoded frames to fill
+	CM_RingBuffer<Frame *> m_decodedReady;
+	CM_RingBuffer<Frame *> m_decodedFree;
+
+	/// frames held by the threads when they stop, given back once both threads are joined
+	Frame *m_decodeFrame;
+	Frame *m_convertFrame;
+
+	std::atomic<bool> m_stopThread;
+	std::atomic<long> m_position;
+	bool m_started;
+	ListBase m_decodeThread;
+	ListBase m_convertThread;
+
+	static void *DecodeThread(void *data);
+	static void *ConvertThread(void *data);
+};
+
+#endif  /* WITH_FFMPEG */
+
+#endif  /* __VIDEOFFMPEGCACHE_H__ */
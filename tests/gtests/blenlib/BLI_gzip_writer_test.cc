@@ -0,0 +1,186 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_gzip_writer.h"
+#include "BLI_fileops.h"
+#include "BLI_threads.h"
+#include "MEM_guardedalloc.h"
+}
+
+#include <fcntl.h>
+#include <string.h>
+#include <random>
+#include <vector>
+
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#define TEST_FILE "BLI_gzip_writer_test.tmp"
+/* Not a multiple of the size of the compressed parts. */
+#define TEST_SIZE (5 * 1024 * 1024 + 12345)
+
+/* Compressible data, as the content of a blend file. */
+static std::vector<char> data_create(size_t size)
+{
+	std::mt19937 generator(size);
+	std::uniform_int_distribution<int> random(0, 63);
+
+	std::vector<char> data(size);
+	for (size_t i = 0; i < size; i++) {
+		data[i] = (i % 7 == 0) ? (char)random(generator) : (char)(i / 1024);
+	}
+	return data;
+}
+
+/* Write the data in chunks of random sizes, some larger than the parts. */
+static void data_write(const char *path, const std::vector<char>& data)
+{
+	std::mt19937 generator(data.size());
+	std::uniform_int_distribution<size_t> random(1, 300000);
+
+	GzipWriter *gw = BLI_gzip_writer_open(path, 1);
+	ASSERT_TRUE(gw != NULL);
+	for (size_t offset = 0; offset < data.size();) {
+		const size_t len = MIN2(random(generator), data.size() - offset);
+		EXPECT_TRUE(BLI_gzip_writer_write(gw, &data[offset], len));
+		offset += len;
+	}
+	EXPECT_TRUE(BLI_gzip_writer_close(gw));
+}
+
+static void data_check_stream(const char *path, const std::vector<char>& data)
+{
+	/* Read as a single stream with gzread, as blend files are loaded. */
+	int size;
+	char *read_data = BLI_file_ungzip_to_mem(path, &size);
+	ASSERT_TRUE(read_data != NULL);
+	EXPECT_EQ(size, (int)data.size());
+	EXPECT_TRUE(memcmp(read_data, data.data(), MIN2((size_t)size, data.size())) == 0);
+	MEM_freeN(read_data);
+}
+
+class GzipWriterTest : public testing::Test
+{
+protected:
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+
+	virtual void TearDown()
+	{
+		BLI_delete(TEST_FILE, false, false);
+	}
+};
+
+TEST_F(GzipWriterTest, WriteRead)
+{
+	const std::vector<char> data = data_create(TEST_SIZE);
+	data_write(TEST_FILE, data);
+	data_check_stream(TEST_FILE, data);
+}
+
+TEST_F(GzipWriterTest, Empty)
+{
+	GzipWriter *gw = BLI_gzip_writer_open(TEST_FILE, 1);
+	ASSERT_TRUE(gw != NULL);
+	EXPECT_TRUE(BLI_gzip_writer_close(gw));
+
+	const int file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+	GzipMember *members;
+	unsigned int members_len;
+	EXPECT_TRUE(BLI_gzip_index_read(file, &members, &members_len));
+	EXPECT_EQ(members_len, 0);
+	MEM_freeN(members);
+	close(file);
+}
+
+TEST_F(GzipWriterTest, Index)
+{
+	const std::vector<char> data = data_create(TEST_SIZE);
+	data_write(TEST_FILE, data);
+
+	const int file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+
+	GzipMember *members;
+	unsigned int members_len;
+	ASSERT_TRUE(BLI_gzip_index_read(file, &members, &members_len));
+	EXPECT_GT(members_len, 1);
+
+	/* The members cover all the data in order. */
+	size_t data_offset = 0;
+	for (unsigned int i = 0; i < members_len; i++) {
+		EXPECT_EQ(members[i].data_offset, data_offset);
+		data_offset += members[i].data_size;
+	}
+	EXPECT_EQ(data_offset, data.size());
+
+	/* Random access, the members are read in reverse order. */
+	for (int i = members_len - 1; i >= 0; i--) {
+		const GzipMember *member = &members[i];
+		std::vector<char> member_data(member->data_size);
+		ASSERT_TRUE(BLI_gzip_member_read(file, member, member_data.data()));
+		EXPECT_TRUE(memcmp(member_data.data(), &data[member->data_offset], member->data_size) == 0);
+	}
+
+	MEM_freeN(members);
+	close(file);
+}
+
+TEST_F(GzipWriterTest, NoIndex)
+{
+	const std::vector<char> data = data_create(TEST_SIZE);
+	data_write(TEST_FILE, data);
+
+	/* Remove the index member, the data members are still a valid gzip stream. */
+	int file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+	GzipMember *members;
+	unsigned int members_len;
+	ASSERT_TRUE(BLI_gzip_index_read(file, &members, &members_len));
+	const GzipMember *last = &members[members_len - 1];
+	std::vector<char> file_data(last->offset + last->size);
+	MEM_freeN(members);
+	ASSERT_NE(lseek(file, 0, SEEK_SET), -1);
+	ASSERT_EQ(read(file, file_data.data(), file_data.size()), (int)file_data.size());
+	close(file);
+
+	FILE *f = BLI_fopen(TEST_FILE, "wb");
+	ASSERT_TRUE(f != NULL);
+	EXPECT_EQ(fwrite(file_data.data(), 1, file_data.size(), f), file_data.size());
+	fclose(f);
+
+	data_check_stream(TEST_FILE, data);
+
+	file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+	EXPECT_FALSE(BLI_gzip_index_read(file, &members, &members_len));
+	close(file);
+}
+
+TEST_F(GzipWriterTest, CorruptedIndex)
+{
+	const std::vector<char> data = data_create(TEST_SIZE);
+	data_write(TEST_FILE, data);
+
+	/* Change the size of the index member stored at the end of the file. */
+	const int file = BLI_open(TEST_FILE, O_BINARY | O_RDWR, 0);
+	ASSERT_NE(file, -1);
+	const size_t file_size = BLI_file_descriptor_size(file);
+	const unsigned char size[4] = {0xFF, 0xFF, 0x00, 0x00};
+	ASSERT_NE(lseek(file, file_size - 14, SEEK_SET), -1);
+	ASSERT_EQ(write(file, size, sizeof(size)), sizeof(size));
+
+	GzipMember *members;
+	unsigned int members_len;
+	EXPECT_FALSE(BLI_gzip_index_read(file, &members, &members_len));
+	close(file);
+}
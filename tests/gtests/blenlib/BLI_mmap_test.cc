@@ -0,0 +1,99 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+extern "C" {
+#include "BLI_mmap.h"
+#include "BLI_fileops.h"
+}
+
+#include <fcntl.h>
+#include <string.h>
+#include <vector>
+
+#ifdef WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+#define TEST_FILE "BLI_mmap_test.tmp"
+
+static void file_write(const char *path, const char *data, size_t size)
+{
+	FILE *f = fopen(path, "wb");
+	ASSERT_TRUE(f != NULL);
+	EXPECT_EQ(fwrite(data, 1, size, f), size);
+	fclose(f);
+}
+
+TEST(mmap, ReadCopyOnWrite)
+{
+	const char data[] = "BLENDER-v279REND";
+	file_write(TEST_FILE, data, sizeof(data));
+
+	int file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+
+	BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+	/* The mapping stays valid once the descriptor is closed. */
+	close(file);
+	ASSERT_TRUE(mmap_file != NULL);
+
+	char *memory = (char *)BLI_mmap_get_pointer(mmap_file);
+	EXPECT_EQ(BLI_mmap_get_length(mmap_file), sizeof(data));
+	EXPECT_EQ(memcmp(memory, data, sizeof(data)), 0);
+
+	/* Pages written are private to the mapping. */
+	memory[0] = 'X';
+	EXPECT_EQ(memory[0], 'X');
+	BLI_mmap_free(mmap_file);
+
+	char buffer[sizeof(data)];
+	FILE *f = fopen(TEST_FILE, "rb");
+	ASSERT_TRUE(f != NULL);
+	EXPECT_EQ(fread(buffer, 1, sizeof(buffer), f), sizeof(buffer));
+	fclose(f);
+	EXPECT_EQ(memcmp(buffer, data, sizeof(data)), 0);
+
+	BLI_delete(TEST_FILE, false, false);
+}
+
+TEST(mmap, EmptyFile)
+{
+	file_write(TEST_FILE, NULL, 0);
+
+	int file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+	EXPECT_TRUE(BLI_mmap_open(file) == NULL);
+	close(file);
+
+	BLI_delete(TEST_FILE, false, false);
+}
+
+#ifndef WIN32
+/* Reading past the end of a file truncated after it was mapped reads zeros instead of crashing. */
+TEST(mmap, TruncatedFile)
+{
+	const size_t size = (size_t)sysconf(_SC_PAGESIZE) * 4;
+	std::vector<char> data(size, 'B');
+	file_write(TEST_FILE, data.data(), size);
+
+	int file = BLI_open(TEST_FILE, O_BINARY | O_RDONLY, 0);
+	ASSERT_NE(file, -1);
+	BLI_mmap_file *mmap_file = BLI_mmap_open(file);
+	close(file);
+	ASSERT_TRUE(mmap_file != NULL);
+
+	const volatile char *memory = (const char *)BLI_mmap_get_pointer(mmap_file);
+	EXPECT_EQ(memory[0], 'B');
+	EXPECT_FALSE(BLI_mmap_any_io_error(mmap_file));
+
+	ASSERT_EQ(truncate(TEST_FILE, 0), 0);
+	EXPECT_EQ(memory[size - 1], 0);
+	EXPECT_TRUE(BLI_mmap_any_io_error(mmap_file));
+
+	BLI_mmap_free(mmap_file);
+	BLI_delete(TEST_FILE, false, false);
+}
+#endif
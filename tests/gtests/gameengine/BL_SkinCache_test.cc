@@ -0,0 +1,85 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BL_SkinCache.h"
+
+#include "DNA_mesh_types.h"
+
+#include <cstring>
+
+static std::vector<BL_SkinInfluences::Matrix> skin_matrices(float offset)
+{
+	std::vector<BL_SkinInfluences::Matrix> matrices(2);
+	for (BL_SkinInfluences::Matrix& matrix : matrices) {
+		memset(matrix.m_data, 0, sizeof(matrix.m_data));
+		for (unsigned short i = 0; i < 4; ++i) {
+			matrix.m_data[i][i] = 1.0f;
+		}
+		matrix.m_data[3][0] = offset;
+	}
+	return matrices;
+}
+
+static std::shared_ptr<BL_SkinCache::Entry> skin_entry(double time)
+{
+	std::shared_ptr<BL_SkinCache::Entry> entry(new BL_SkinCache::Entry());
+	entry->m_hasAabb = false;
+	entry->m_lastUse = time;
+	return entry;
+}
+
+TEST(BL_SkinCache, Key)
+{
+	Mesh mesh;
+	memset(&mesh, 0, sizeof(Mesh));
+	const BL_SkinInfluences influences(&mesh, {true, false});
+
+	BL_SkinCache::Key key1;
+	BL_SkinCache::Key key2;
+	BL_SkinCache::ComputeKey(influences, skin_matrices(1.0f), key1);
+	// The matrices of the unused deform groups are ignored.
+	EXPECT_EQ(key1.size(), 12);
+
+	// Poses closer than the precision are shared.
+	BL_SkinCache::ComputeKey(influences, skin_matrices(1.0f + 1.0e-6f), key2);
+	EXPECT_EQ(key1, key2);
+
+	BL_SkinCache::ComputeKey(influences, skin_matrices(1.1f), key2);
+	EXPECT_NE(key1, key2);
+}
+
+TEST(BL_SkinCache, FindInsert)
+{
+	Mesh mesh;
+	memset(&mesh, 0, sizeof(Mesh));
+	const BL_SkinInfluences influences(&mesh, {true, true});
+
+	BL_SkinCache::Key key1;
+	BL_SkinCache::Key key2;
+	BL_SkinCache::ComputeKey(influences, skin_matrices(1.0f), key1);
+	BL_SkinCache::ComputeKey(influences, skin_matrices(2.0f), key2);
+
+	BL_SkinCache::ResetStatistics();
+	BL_SkinCache cache;
+
+	EXPECT_EQ(cache.Find(key1, 1.0), nullptr);
+	cache.Insert(key1, skin_entry(1.0));
+	EXPECT_NE(cache.Find(key1, 1.0), nullptr);
+
+	// The entries of the previous frame are kept.
+	cache.Insert(key2, skin_entry(2.0));
+	EXPECT_NE(cache.Find(key2, 2.0), nullptr);
+	EXPECT_NE(cache.Find(key1, 2.0), nullptr);
+
+	// The entry of key2 is used at the frame 2 but not at the frame 3, it's removed at the frame 4.
+	cache.Insert(key1, skin_entry(3.0));
+	cache.Insert(key1, skin_entry(4.0));
+	EXPECT_EQ(cache.Find(key2, 4.0), nullptr);
+
+	unsigned int hits;
+	unsigned int misses;
+	BL_SkinCache::GetStatistics(hits, misses);
+	EXPECT_EQ(hits, 3);
+	EXPECT_EQ(misses, 2);
+}
@@ -0,0 +1,128 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BL_SkinInfluences.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+extern "C" {
+#include "BLI_math.h"
+#include "BLI_task.h"
+}
+
+#include <random>
+#include <vector>
+
+#define NUM_VERTICES 10000
+#define NUM_GROUPS 8
+
+struct SkinMesh
+{
+	Mesh mesh;
+	std::vector<MDeformVert> dverts;
+	std::vector<MDeformWeight> weights;
+};
+
+static void skin_mesh_create(SkinMesh& skinMesh)
+{
+	std::mt19937 gen(0);
+	std::uniform_int_distribution<unsigned int> numWeights(0, 4);
+	std::uniform_int_distribution<int> group(0, NUM_GROUPS - 1);
+	std::uniform_real_distribution<float> weight(0.0f, 1.0f);
+
+	std::vector<unsigned int> counts(NUM_VERTICES);
+	for (unsigned int i = 0; i < NUM_VERTICES; ++i) {
+		counts[i] = numWeights(gen);
+		for (unsigned int j = 0; j < counts[i]; ++j) {
+			skinMesh.weights.push_back({group(gen), weight(gen)});
+		}
+	}
+
+	MDeformWeight *dw = skinMesh.weights.data();
+	for (unsigned int i = 0; i < NUM_VERTICES; ++i) {
+		MDeformVert dv = {dw, (int)counts[i], 0};
+		skinMesh.dverts.push_back(dv);
+		dw += counts[i];
+	}
+
+	memset(&skinMesh.mesh, 0, sizeof(Mesh));
+	skinMesh.mesh.dvert = skinMesh.dverts.data();
+	skinMesh.mesh.totvert = NUM_VERTICES;
+}
+
+/// Reference skinning, blend the transformed positions and use the matrix of the most influential group for the normal.
+static void skin_reference(const SkinMesh& skinMesh, const std::vector<bool>& deformGroups,
+		const std::vector<BL_SkinInfluences::Matrix>& matrices, std::vector<std::array<float, 3> >& positions,
+		std::vector<std::array<float, 3> >& normals)
+{
+	for (unsigned int i = 0; i < NUM_VERTICES; ++i) {
+		const MDeformVert& dv = skinMesh.dverts[i];
+		float co[3] = {0.0f, 0.0f, 0.0f};
+		float no[3] = {0.0f, 0.0f, 0.0f};
+		float contrib = 0.0f;
+
+		for (unsigned int j = 0; j < dv.totweight; ++j) {
+			const MDeformWeight& dw = dv.dw[j];
+			if (!deformGroups[dw.def_nr] || dw.weight == 0.0f) {
+				continue;
+			}
+
+			float mat[4][4];
+			memcpy(mat, matrices[dw.def_nr].m_data, sizeof(mat));
+			float vco[3];
+			float vno[3];
+			mul_v3_m4v3(vco, mat, positions[i].data());
+			mul_v3_mat3_m4v3(vno, mat, normals[i].data());
+			madd_v3_v3fl(co, vco, dw.weight);
+			madd_v3_v3fl(no, vno, dw.weight);
+			contrib += dw.weight;
+		}
+
+		if (contrib != 0.0f) {
+			mul_v3_v3fl(positions[i].data(), co, 1.0f / contrib);
+			normalize_v3_v3(normals[i].data(), no);
+		}
+	}
+}
+
+TEST(BL_SkinInfluences, Deform)
+{
+	SkinMesh skinMesh;
+	skin_mesh_create(skinMesh);
+
+	std::vector<bool> deformGroups(NUM_GROUPS, true);
+	deformGroups[3] = false;
+
+	std::vector<BL_SkinInfluences::Matrix> matrices(NUM_GROUPS);
+	for (unsigned int i = 0; i < NUM_GROUPS; ++i) {
+		float eul[3] = {0.1f * i, -0.3f * i, 0.7f};
+		float loc[3] = {(float)i, 2.0f, -1.0f};
+		float size[3] = {1.0f, 1.0f + 0.1f * i, 1.0f};
+		loc_eul_size_to_mat4(matrices[i].m_data, loc, eul, size);
+	}
+
+	std::vector<std::array<float, 3> > refPositions(NUM_VERTICES);
+	std::vector<std::array<float, 3> > refNormals(NUM_VERTICES);
+	for (unsigned int i = 0; i < NUM_VERTICES; ++i) {
+		refPositions[i] = {{(float)(i % 100), (float)(i / 100), 1.0f}};
+		refNormals[i] = {{0.0f, 0.6f, 0.8f}};
+	}
+	std::vector<std::array<float, 3> > positions = refPositions;
+	std::vector<std::array<float, 3> > normals = refNormals;
+
+	skin_reference(skinMesh, deformGroups, matrices, refPositions, refNormals);
+
+	const BL_SkinInfluences influences(&skinMesh.mesh, deformGroups);
+	TaskScheduler *scheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	influences.Deform(matrices, positions.data(), normals.data(), scheduler);
+	BLI_task_scheduler_free(scheduler);
+
+	for (unsigned int i = 0; i < NUM_VERTICES; ++i) {
+		for (unsigned short j = 0; j < 3; ++j) {
+			EXPECT_NEAR(positions[i][j], refPositions[i][j], 1e-3f);
+			EXPECT_NEAR(normals[i][j], refNormals[i][j], 1e-4f);
+		}
+	}
+}
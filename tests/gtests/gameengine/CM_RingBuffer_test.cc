@@ -0,0 +1,72 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "CM_RingBuffer.h"
+
+#include <thread>
+
+TEST(CM_RingBuffer, PushPop)
+{
+	CM_RingBuffer<int> ring(3);
+	EXPECT_EQ(ring.GetCapacity(), 3);
+	EXPECT_TRUE(ring.Empty());
+
+	int item;
+	EXPECT_FALSE(ring.Front(item));
+	EXPECT_FALSE(ring.Pop(item));
+
+	EXPECT_TRUE(ring.Push(1));
+	EXPECT_TRUE(ring.Push(2));
+	EXPECT_TRUE(ring.Push(3));
+	// The queue is full.
+	EXPECT_FALSE(ring.Push(4));
+
+	EXPECT_TRUE(ring.Front(item));
+	EXPECT_EQ(item, 1);
+	EXPECT_TRUE(ring.Pop(item));
+	EXPECT_EQ(item, 1);
+
+	// Wrap around the end of the storage.
+	EXPECT_TRUE(ring.Push(4));
+	for (int i = 2; i <= 4; ++i) {
+		EXPECT_TRUE(ring.Pop(item));
+		EXPECT_EQ(item, i);
+	}
+	EXPECT_TRUE(ring.Empty());
+}
+
+TEST(CM_RingBuffer, ProducerConsumer)
+{
+	const int numItems = 100000;
+	CM_RingBuffer<int> ring(8);
+
+	std::thread producer([&ring]() {
+		for (int i = 0; i < numItems;) {
+			if (ring.Push(i)) {
+				++i;
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	// Items are received once and in order.
+	int expected = 0;
+	bool ordered = true;
+	while (expected < numItems) {
+		int item;
+		if (ring.Pop(item)) {
+			ordered = ordered && (item == expected);
+			++expected;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(ring.Empty());
+}
@@ -0,0 +1,115 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "CM_Trace.h"
+
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#define TEST_FILE "CM_Trace_test.tmp"
+
+TEST(CM_Trace, NotRecording)
+{
+	CM_Trace::Stop();
+	CM_Trace::Clear();
+	{
+		CM_TRACE_SCOPE("Ignored", "test");
+	}
+	EXPECT_EQ(CM_Trace::GetNumSpans(), 0);
+}
+
+TEST(CM_Trace, MultipleThreads)
+{
+	CM_Trace::Start();
+
+	std::vector<std::thread> threads;
+	for (unsigned short i = 0; i < 4; ++i) {
+		threads.emplace_back([]() {
+			for (unsigned short j = 0; j < 100; ++j) {
+				CM_TRACE_SCOPE("Span", "test", "detail");
+			}
+		});
+	}
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	CM_Trace::Stop();
+	EXPECT_EQ(CM_Trace::GetNumSpans(), 400);
+
+	CM_Trace::Clear();
+	EXPECT_EQ(CM_Trace::GetNumSpans(), 0);
+}
+
+TEST(CM_Trace, RingCapacity)
+{
+	CM_Trace::Start();
+	for (unsigned int i = 0; i < CM_TRACE_CAPACITY * 2 + 10; ++i) {
+		CM_Trace::Record("Span", "test", nullptr, i, i + 1);
+	}
+	CM_Trace::Stop();
+
+	EXPECT_EQ(CM_Trace::GetNumSpans(), CM_TRACE_CAPACITY);
+	CM_Trace::Clear();
+}
+
+TEST(CM_Trace, Write)
+{
+	CM_Trace::Start();
+	CM_Trace::Record("Span \"quoted\"", "test", "Scene", 1.0, 2.0);
+	CM_Trace::Stop();
+
+	EXPECT_TRUE(CM_Trace::Write(TEST_FILE));
+
+	std::ifstream file(TEST_FILE);
+	std::stringstream stream;
+	stream << file.rdbuf();
+	const std::string content = stream.str();
+	file.close();
+	std::remove(TEST_FILE);
+
+	EXPECT_NE(content.find("\"traceEvents\""), std::string::npos);
+	EXPECT_NE(content.find("\"name\":\"Span \\\"quoted\\\"\""), std::string::npos);
+	EXPECT_NE(content.find("\"args\":{\"detail\":\"Scene\"}"), std::string::npos);
+
+	CM_Trace::Clear();
+}
+
+/* Python can clear and write the spans while worker threads record. */
+TEST(CM_Trace, ClearWriteWhileRecording)
+{
+	CM_Trace::Start();
+
+	std::atomic<bool> stop(false);
+	std::vector<std::thread> threads;
+	for (unsigned short i = 0; i < 4; ++i) {
+		threads.emplace_back([&stop]() {
+			while (!stop) {
+				CM_TRACE_SCOPE("Span", "test", "detail");
+				std::this_thread::sleep_for(std::chrono::microseconds(10));
+			}
+		});
+	}
+
+	for (unsigned short i = 0; i < 5; ++i) {
+		EXPECT_TRUE(CM_Trace::Write(TEST_FILE));
+		CM_Trace::Clear();
+		CM_Trace::Start();
+	}
+	std::remove(TEST_FILE);
+
+	stop = true;
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	CM_Trace::Stop();
+	EXPECT_GT(CM_Trace::GetNumSpans(), 0);
+	CM_Trace::Clear();
+}
@@ -0,0 +1,128 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "EXP_Value.h"
+#include "EXP_IntValue.h"
+#include "EXP_FloatValue.h"
+#include "EXP_BoolValue.h"
+
+#include <map>
+#include <vector>
+
+extern "C" {
+#include "PIL_time_utildefines.h"
+}
+
+#define NUM_OBJECTS 1000
+#define NUM_PROPERTIES 12
+/* Property sensors per object, each one checks a different property every frame. */
+#define NUM_SENSORS 8
+#define NUM_FRAMES 1000
+
+static const char *propertyNames[NUM_PROPERTIES] = {
+	"health", "ammo", "speed", "target", "state", "timer",
+	"visible", "team", "score", "armor", "level", "alert"
+};
+
+static EXP_Value *property_create(unsigned int index)
+{
+	switch (index % 3) {
+		case 0:
+		{
+			return new EXP_IntValue(index);
+		}
+		case 1:
+		{
+			return new EXP_FloatValue(index * 0.5f);
+		}
+		default:
+		{
+			return new EXP_BoolValue(true);
+		}
+	}
+}
+
+TEST(EXP_Value, PropertySensorPerformance)
+{
+	std::vector<EXP_Value *> objects;
+	/* The storage used before the interned keys, for comparison. */
+	std::vector<std::map<std::string, EXP_Value *> > mapObjects(NUM_OBJECTS);
+
+	for (unsigned int i = 0; i < NUM_OBJECTS; ++i) {
+		EXP_Value *object = new EXP_PropValue();
+		for (unsigned int j = 0; j < NUM_PROPERTIES; ++j) {
+			EXP_Value *prop = property_create(j);
+			object->SetProperty(propertyNames[j], prop);
+			mapObjects[i][propertyNames[j]] = prop;
+			prop->Release();
+		}
+		objects.push_back(object);
+	}
+
+	/* The property names referenced by the sensors, as stored in the bricks. */
+	std::vector<std::string> sensorNames;
+	std::vector<EXP_PropertyKey> sensorKeys;
+	std::vector<unsigned int> sensorSlots(NUM_OBJECTS * NUM_SENSORS, 0);
+	for (unsigned int i = 0; i < NUM_SENSORS; ++i) {
+		sensorNames.push_back(propertyNames[(i * 5) % NUM_PROPERTIES]);
+		sensorKeys.emplace_back(sensorNames.back());
+	}
+
+	double mapSum = 0.0;
+	TIMEIT_START(map_lookup);
+	for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame) {
+		for (unsigned int i = 0; i < NUM_OBJECTS; ++i) {
+			for (unsigned int j = 0; j < NUM_SENSORS; ++j) {
+				std::map<std::string, EXP_Value *>::iterator it = mapObjects[i].find(sensorNames[j]);
+				if (it != mapObjects[i].end()) {
+					mapSum += it->second->GetNumber();
+				}
+			}
+		}
+	}
+	TIMEIT_END(map_lookup);
+
+	double nameSum = 0.0;
+	TIMEIT_START(name_lookup);
+	for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame) {
+		for (unsigned int i = 0; i < NUM_OBJECTS; ++i) {
+			for (unsigned int j = 0; j < NUM_SENSORS; ++j) {
+				EXP_Value *prop = objects[i]->GetProperty(sensorNames[j]);
+				if (prop) {
+					nameSum += prop->GetNumber();
+				}
+			}
+		}
+	}
+	TIMEIT_END(name_lookup);
+
+	double keySum = 0.0;
+	TIMEIT_START(key_slot_lookup);
+	for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame) {
+		for (unsigned int i = 0; i < NUM_OBJECTS; ++i) {
+			for (unsigned int j = 0; j < NUM_SENSORS; ++j) {
+				EXP_Value *prop = objects[i]->GetProperty(sensorKeys[j], sensorSlots[i * NUM_SENSORS + j]);
+				if (prop) {
+					keySum += prop->GetNumber();
+				}
+			}
+		}
+	}
+	TIMEIT_END(key_slot_lookup);
+
+	EXPECT_EQ(mapSum, nameSum);
+	EXPECT_EQ(mapSum, keySum);
+
+	/* The properties are listed by name as with the map storage. */
+	const std::vector<std::string> names = objects[0]->GetPropertyNames();
+	ASSERT_EQ(names.size(), mapObjects[0].size());
+	unsigned int index = 0;
+	for (const auto& pair : mapObjects[0]) {
+		EXPECT_EQ(names[index++], pair.first);
+	}
+
+	for (EXP_Value *object : objects) {
+		object->Release();
+	}
+}
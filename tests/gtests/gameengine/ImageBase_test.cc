@@ -0,0 +1,239 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "ImageBase.h"
+#include "FilterSource.h"
+#include "FilterColor.h"
+#include "FilterBlueScreen.h"
+#include "FilterNormal.h"
+
+extern "C" {
+#include "BLI_threads.h"
+}
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+/* Not a multiple of the 4 pixels of the SIMD kernels, the height covers
+ * several strips of rows converted in parallel. */
+#define TEST_WIDTH 37
+#define TEST_HEIGHT 101
+
+/* Image converting a byte source with the filters of the tests. */
+class ImageTest : public ImageBase
+{
+public:
+	ImageTest(bool flip)
+	{
+		m_flip = flip;
+	}
+
+	virtual ~ImageTest()
+	{
+		m_pyfilter = nullptr;
+	}
+
+	const unsigned int *Convert(PyFilter *filter, unsigned char *src, short *srcSize, short width, short height)
+	{
+		m_pyfilter = filter;
+		init(width, height);
+		FilterRGBA32 srcFilter;
+		filterImage(srcFilter, src, srcSize);
+		m_pyfilter = nullptr;
+		return m_image;
+	}
+};
+
+/* Chain of pixel filters, without Python objects. */
+class FilterChain
+{
+private:
+	std::vector<FilterBase *> m_filters;
+	std::vector<PyFilter> m_pyFilters;
+
+public:
+	FilterChain(const std::vector<FilterBase *>& filters)
+		:m_filters(filters),
+		m_pyFilters(filters.size())
+	{
+		for (unsigned int i = 0; i < m_filters.size(); ++i) {
+			m_pyFilters[i].m_filter = m_filters[i];
+			if (i > 0) {
+				m_filters[i]->setPrevious(&m_pyFilters[i - 1], false);
+			}
+		}
+	}
+
+	~FilterChain()
+	{
+		for (FilterBase *filter : m_filters) {
+			filter->setPrevious(nullptr, false);
+			delete filter;
+		}
+	}
+
+	PyFilter *GetLast()
+	{
+		return &m_pyFilters.back();
+	}
+};
+
+/* Random source pixels, half of them close to the blue screen color to
+ * obtain all the cases of the blue screen filter. */
+static std::vector<unsigned char> source_create(short *size)
+{
+	std::mt19937 generator(size[0] * size[1]);
+	std::uniform_int_distribution<int> random(0, 255);
+	std::uniform_int_distribution<int> offset(-60, 60);
+
+	std::vector<unsigned char> source(size[0] * size[1] * 4);
+	for (unsigned int i = 0, len = size[0] * size[1]; i < len; ++i) {
+		unsigned char *pixel = &source[i * 4];
+		if (random(generator) < 128) {
+			pixel[0] = std::max(0, std::min(255, 30 + offset(generator)));
+			pixel[1] = std::max(0, std::min(255, 200 + offset(generator)));
+			pixel[2] = std::max(0, std::min(255, 60 + offset(generator)));
+		}
+		else {
+			pixel[0] = random(generator);
+			pixel[1] = random(generator);
+			pixel[2] = random(generator);
+		}
+		pixel[3] = random(generator);
+	}
+
+	return source;
+}
+
+/* Convert a source with the filters evaluated on rows and per pixel, the
+ * images must be identical. */
+static void filters_compare(const std::vector<FilterBase *>& filters, short width, short height, bool flip)
+{
+	short srcSize[2] = {TEST_WIDTH, TEST_HEIGHT};
+	std::vector<unsigned char> source = source_create(srcSize);
+
+	FilterChain chain(filters);
+	ImageTest rowImage(flip);
+	const unsigned int *rowData = rowImage.Convert(chain.GetLast(), source.data(), srcSize, width, height);
+
+	// A plain filter returns the converted pixel but can only be evaluated per pixel.
+	FilterBase pixelFilter;
+	PyFilter pyPixelFilter;
+	pyPixelFilter.m_filter = &pixelFilter;
+	pixelFilter.setPrevious(chain.GetLast(), false);
+
+	ImageTest pixelImage(flip);
+	const unsigned int *pixelData = pixelImage.Convert(&pyPixelFilter, source.data(), srcSize, width, height);
+	pixelFilter.setPrevious(nullptr, false);
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			const unsigned int index = y * width + x;
+			ASSERT_EQ(rowData[index], pixelData[index]) << "pixel " << x << ", " << y;
+		}
+	}
+}
+
+static void filters_compare_sizes(std::vector<FilterBase *> (*create)())
+{
+	// Same size as the source.
+	filters_compare(create(), TEST_WIDTH, TEST_HEIGHT, false);
+	filters_compare(create(), TEST_WIDTH, TEST_HEIGHT, true);
+	// Scaled down, a part of the source rows and columns are skipped.
+	filters_compare(create(), 23, 67, false);
+	filters_compare(create(), 23, 67, true);
+}
+
+static FilterBase *filter_gray()
+{
+	return new FilterGray();
+}
+
+static FilterBase *filter_color()
+{
+	FilterColor *filter = new FilterColor();
+	ColorMatrix matrix = {
+		{200, 40, -20, 0, 10},
+		{-30, 300, 10, 0, -500},
+		{50, 50, 150, 0, 1000},
+		{0, 0, 0, 256, 0}
+	};
+	filter->setMatrix(matrix);
+	return filter;
+}
+
+static FilterBase *filter_blue_screen()
+{
+	FilterBlueScreen *filter = new FilterBlueScreen();
+	filter->setColor(30, 200, 60);
+	filter->setLimits(40, 90);
+	return filter;
+}
+
+static FilterBase *filter_level()
+{
+	FilterLevel *filter = new FilterLevel();
+	ColorLevel levels = {
+		{20, 230, 0},
+		{0, 128, 0},
+		{100, 100, 0},
+		{0, 255, 0}
+	};
+	filter->setLevels(levels);
+	return filter;
+}
+
+static FilterBase *filter_normal(unsigned short colIdx)
+{
+	FilterNormal *filter = new FilterNormal();
+	filter->setColor(colIdx);
+	filter->setDepth(7.5f);
+	return filter;
+}
+
+class ImageBaseTest : public testing::Test
+{
+protected:
+	static void TearDownTestCase()
+	{
+		BLI_threadapi_exit();
+	}
+};
+
+TEST_F(ImageBaseTest, Gray)
+{
+	filters_compare_sizes([]() { return std::vector<FilterBase *>{filter_gray()}; });
+}
+
+TEST_F(ImageBaseTest, Color)
+{
+	filters_compare_sizes([]() { return std::vector<FilterBase *>{filter_color()}; });
+}
+
+TEST_F(ImageBaseTest, BlueScreen)
+{
+	filters_compare_sizes([]() { return std::vector<FilterBase *>{filter_blue_screen()}; });
+}
+
+TEST_F(ImageBaseTest, Level)
+{
+	filters_compare_sizes([]() { return std::vector<FilterBase *>{filter_level()}; });
+}
+
+TEST_F(ImageBaseTest, Normal)
+{
+	filters_compare_sizes([]() { return std::vector<FilterBase *>{filter_normal(1)}; });
+}
+
+TEST_F(ImageBaseTest, Chain)
+{
+	// The second normal filter needs two warm-up rows before each strip.
+	filters_compare_sizes([]() {
+		return std::vector<FilterBase *>{filter_color(), filter_normal(2), filter_normal(0), filter_level()};
+	});
+	filters_compare_sizes([]() {
+		return std::vector<FilterBase *>{filter_gray(), filter_blue_screen()};
+	});
+}
@@ -0,0 +1,114 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "KX_NetworkMessageManager.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "PIL_time_utildefines.h"
+}
+
+#define NUM_MESSAGES 10000
+#define NUM_RECEIVERS 500
+#define NUM_SUBJECTS 20
+#define NUM_TICKS 100
+
+/// Message storage of the previous implementation, nested maps of copied strings.
+class LegacyMessageManager
+{
+public:
+	struct Message
+	{
+		std::string to;
+		void *from;
+		std::string subject;
+		std::string body;
+	};
+
+private:
+	std::map<std::string, std::map<std::string, std::vector<Message> > > m_messages[2];
+	unsigned short m_currentList;
+
+public:
+	LegacyMessageManager()
+		:m_currentList(0)
+	{
+	}
+
+	void AddMessage(Message message)
+	{
+		m_messages[m_currentList][message.to][message.subject].push_back(message);
+	}
+
+	const std::vector<Message> GetMessages(std::string to, std::string subject)
+	{
+		std::vector<Message> messages;
+		std::map<std::string, std::vector<Message> >& messagesNoReceiver = m_messages[1 - m_currentList][""];
+		std::map<std::string, std::vector<Message> >& messagesReceiver = m_messages[1 - m_currentList][to];
+		std::vector<Message>& messagesNoReceiverSubject = messagesNoReceiver[subject];
+		messages.insert(messages.end(), messagesNoReceiverSubject.begin(), messagesNoReceiverSubject.end());
+		std::vector<Message>& messagesReceiverSubject = messagesReceiver[subject];
+		messages.insert(messages.end(), messagesReceiverSubject.begin(), messagesReceiverSubject.end());
+		return messages;
+	}
+
+	void ClearMessages()
+	{
+		m_messages[1 - m_currentList].clear();
+		m_currentList = 1 - m_currentList;
+	}
+};
+
+TEST(KX_NetworkMessageManager, TickPerformance)
+{
+	std::vector<std::string> receivers;
+	for (unsigned int i = 0; i < NUM_RECEIVERS; ++i) {
+		receivers.push_back("Object." + std::to_string(i));
+	}
+	std::vector<std::string> subjects;
+	for (unsigned int i = 0; i < NUM_SUBJECTS; ++i) {
+		subjects.push_back("subject_" + std::to_string(i));
+	}
+	const std::string body = "a message body of a usual size";
+
+	/* A tick sends the messages, switches the frame and then every receiver
+	 * queries each subject as a message sensor would do. */
+	unsigned int legacyCount = 0;
+	LegacyMessageManager legacy;
+	TIMEIT_START(legacy);
+	for (unsigned int tick = 0; tick < NUM_TICKS; ++tick) {
+		for (unsigned int i = 0; i < NUM_MESSAGES; ++i) {
+			legacy.AddMessage({receivers[i % NUM_RECEIVERS], nullptr, subjects[i % NUM_SUBJECTS], body});
+		}
+		legacy.ClearMessages();
+		for (const std::string& receiver : receivers) {
+			for (const std::string& subject : subjects) {
+				legacyCount += legacy.GetMessages(receiver, subject).size();
+			}
+		}
+	}
+	TIMEIT_END(legacy);
+
+	unsigned int count = 0;
+	KX_NetworkMessageManager manager;
+	TIMEIT_START(interned);
+	for (unsigned int tick = 0; tick < NUM_TICKS; ++tick) {
+		for (unsigned int i = 0; i < NUM_MESSAGES; ++i) {
+			manager.AddMessage(receivers[i % NUM_RECEIVERS], nullptr, subjects[i % NUM_SUBJECTS], body);
+		}
+		manager.ClearMessages();
+		for (const std::string& receiver : receivers) {
+			for (const std::string& subject : subjects) {
+				count += manager.GetMessages(receiver, subject).size();
+			}
+		}
+	}
+	TIMEIT_END(interned);
+
+	EXPECT_EQ(legacyCount, count);
+	EXPECT_EQ(count, NUM_MESSAGES * NUM_TICKS);
+}
@@ -0,0 +1,58 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "KX_NetworkMessageManager.h"
+
+#include <string>
+#include <vector>
+
+static std::vector<std::string> messages_bodies(const KX_NetworkMessageManager::MessageSpans& spans)
+{
+	std::vector<std::string> bodies;
+	for (const KX_NetworkMessageManager::MessageSpan& span : {spans.noReceiver, spans.receiver}) {
+		for (const KX_NetworkMessageManager::Message& message : span) {
+			bodies.emplace_back(message.body, message.bodyLength);
+		}
+	}
+	return bodies;
+}
+
+TEST(KX_NetworkMessageManager, NextFrame)
+{
+	KX_NetworkMessageManager manager;
+	manager.AddMessage("Cube", nullptr, "hit", "1");
+
+	// Messages are only received the frame after.
+	EXPECT_TRUE(manager.GetMessages("Cube", "hit").empty());
+
+	manager.ClearMessages();
+	EXPECT_EQ(messages_bodies(manager.GetMessages("Cube", "hit")), std::vector<std::string>({"1"}));
+
+	manager.ClearMessages();
+	EXPECT_TRUE(manager.GetMessages("Cube", "hit").empty());
+}
+
+TEST(KX_NetworkMessageManager, Filter)
+{
+	KX_NetworkMessageManager manager;
+	manager.AddMessage("Cube", nullptr, "hit", "1");
+	manager.AddMessage("", nullptr, "hit", "2");
+	manager.AddMessage("Sphere", nullptr, "hit", "3");
+	manager.AddMessage("Cube", nullptr, "move", "4");
+	manager.AddMessage("Cube", nullptr, "hit", "5");
+	manager.AddMessage("", nullptr, "", "6");
+	manager.ClearMessages();
+
+	// Messages without receiver first then in send order.
+	EXPECT_EQ(messages_bodies(manager.GetMessages("Cube", "hit")), std::vector<std::string>({"2", "1", "5"}));
+	EXPECT_EQ(messages_bodies(manager.GetMessages("Sphere", "hit")), std::vector<std::string>({"2", "3"}));
+	EXPECT_EQ(messages_bodies(manager.GetMessages("Cone", "hit")), std::vector<std::string>({"2"}));
+	EXPECT_TRUE(manager.GetMessages("Cube", "jump").empty());
+	EXPECT_EQ(manager.GetMessages("Cube", "").size(), 6 - 1);
+	EXPECT_EQ(manager.GetMessages("Cone", "").size(), 2);
+
+	const KX_NetworkMessageManager::MessageSpans spans = manager.GetMessages("Cube", "move");
+	ASSERT_EQ(spans.size(), 1);
+	EXPECT_EQ(manager.GetName(spans.receiver.begin()->subject), "move");
+}
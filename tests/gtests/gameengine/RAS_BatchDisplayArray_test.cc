@@ -0,0 +1,104 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "RAS_BatchDisplayArray.h"
+
+#include "MT_Transform.h"
+
+#include <memory>
+
+using VertexData = RAS_VertexData<1, 1>;
+
+static const RAS_VertexFormat format = {1, 1};
+
+/* A triangle whose vertices depend on the seed. */
+static RAS_DisplayArray<VertexData> *array_create(float seed)
+{
+	RAS_DisplayArray<VertexData> *array = new RAS_DisplayArray<VertexData>(RAS_IDisplayArray::TRIANGLES, format);
+
+	for (unsigned int i = 0; i < 3; ++i) {
+		const float xyz[3] = {seed + i, seed - 2.0f * i, 0.5f * i};
+		const float uvs[1][2] = {{0.0f, 1.0f}};
+		const float tangent[4] = {1.0f, 0.0f, 0.0f, -1.0f};
+		const unsigned int rgba[1] = {0xFFFFFFFF};
+		const float normal[3] = {0.0f, 0.0f, 1.0f};
+
+		RAS_Vertex vert = array->CreateVertex(xyz, uvs, tangent, rgba, normal);
+		array->AddVertex(vert);
+		array->AddPrimitiveIndex(i);
+	}
+
+	array->UpdateCache();
+	return array;
+}
+
+static MT_Matrix4x4 matrix_create(float angle, const MT_Vector3& pos, float scale)
+{
+	MT_Transform trans(pos, MT_Matrix3x3(MT_Vector3(0.3f, angle, -angle)));
+	trans.scale(scale, scale, scale);
+	return trans.toMatrix();
+}
+
+TEST(RAS_BatchDisplayArray, Merge)
+{
+	std::unique_ptr<RAS_DisplayArray<VertexData> > array1(array_create(1.0f));
+	std::unique_ptr<RAS_DisplayArray<VertexData> > array2(array_create(-3.0f));
+	const std::vector<RAS_IDisplayArray *> arrays = {array1.get(), array2.get(), array1.get()};
+	const std::vector<MT_Matrix4x4> mats = {
+		matrix_create(0.5f, MT_Vector3(1.0f, 2.0f, 3.0f), 2.0f),
+		matrix_create(-1.2f, MT_Vector3(-4.0f, 0.0f, 1.0f), 1.0f),
+		matrix_create(2.0f, MT_Vector3(0.0f, 0.0f, 0.0f), 0.5f)
+	};
+
+	RAS_BatchDisplayArray<VertexData> single(RAS_IDisplayArray::TRIANGLES, format);
+	for (unsigned int i = 0; i < arrays.size(); ++i) {
+		EXPECT_EQ(single.Merge(arrays[i], mats[i]), i);
+	}
+
+	RAS_BatchDisplayArray<VertexData> bulk(RAS_IDisplayArray::TRIANGLES, format);
+	EXPECT_EQ(bulk.Merge(arrays, mats), 0);
+	EXPECT_EQ(bulk.Merge(arrays, mats), 3);
+
+	ASSERT_EQ(bulk.GetVertexCount(), 18);
+	ASSERT_EQ(bulk.GetPrimitiveIndexCount(), 18);
+
+	for (unsigned int part = 0; part < 6; ++part) {
+		EXPECT_EQ(bulk.GetPartIndexCount(part), 3);
+		EXPECT_EQ(bulk.GetPartIndexOffset(part), (void *)(part * 3 * sizeof(unsigned int)));
+
+		const unsigned int merged = part % 3;
+		const MT_Matrix4x4& mat = mats[merged];
+		MT_Matrix4x4 nmat = mat;
+		nmat[0][3] = nmat[1][3] = nmat[2][3] = 0.0f;
+
+		for (unsigned int i = 0; i < 3; ++i) {
+			const unsigned int index = part * 3 + i;
+			EXPECT_EQ(bulk.GetPrimitiveIndex(index), index);
+
+			// The reference transform of the vertices.
+			VertexData data = *static_cast<VertexData *>(arrays[merged]->GetVertex(i).GetData());
+			RAS_Vertex vert(&data, format);
+			vert.Transform(mat, nmat);
+
+			const RAS_Vertex result = bulk.GetVertex(index);
+			const RAS_Vertex resultSingle = single.GetVertex(index % 9);
+			for (unsigned short j = 0; j < 3; ++j) {
+				EXPECT_NEAR(result.GetXYZ()[j], vert.GetXYZ()[j], 1e-5f);
+				EXPECT_NEAR(result.GetNormal()[j], vert.GetNormal()[j], 1e-5f);
+				EXPECT_NEAR(result.GetTangent()[j], vert.GetTangent()[j], 1e-5f);
+				EXPECT_EQ(result.GetXYZ()[j], resultSingle.GetXYZ()[j]);
+			}
+			// The tangent sign is kept.
+			EXPECT_EQ(result.GetTangent()[3], -1.0f);
+		}
+	}
+
+	// Splitting a part shifts the indices of the following parts.
+	bulk.Split(1);
+	ASSERT_EQ(bulk.GetVertexCount(), 15);
+	for (unsigned int i = 0; i < 15; ++i) {
+		EXPECT_EQ(bulk.GetPrimitiveIndex(i), i);
+	}
+	EXPECT_EQ(bulk.GetPartIndexOffset(1), (void *)(3 * sizeof(unsigned int)));
+}
@@ -0,0 +1,191 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SCA_PythonBytecodeCache.h"
+
+#include <cstdio>
+#include <string>
+
+#define TEST_FILE "SCA_PythonBytecodeCache_test.bgepyc"
+
+static const std::string scriptText = "value = 6 * 7\n";
+static const std::string scriptName = "script.py";
+
+static void cache_write_file(const std::string& data)
+{
+	FILE *fp = fopen(TEST_FILE, "wb");
+	ASSERT_TRUE(fp != nullptr);
+	if (!data.empty()) {
+		ASSERT_EQ(fwrite(data.data(), data.size(), 1, fp), 1);
+	}
+	fclose(fp);
+}
+
+/* Run a code object and return the value of its global "value". */
+static long code_eval_value(PyObject *code)
+{
+	PyObject *globals = PyDict_New();
+	PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+	PyObject *result = PyEval_EvalCode(code, globals, globals);
+	long value = -1;
+	if (result) {
+		PyObject *item = PyDict_GetItemString(globals, "value");
+		if (item) {
+			value = PyLong_AsLong(item);
+		}
+		Py_DECREF(result);
+	}
+	PyErr_Clear();
+	Py_DECREF(globals);
+	return value;
+}
+
+class SCA_PythonBytecodeCacheTest : public testing::Test
+{
+protected:
+	static void SetUpTestCase()
+	{
+		Py_Initialize();
+	}
+
+	static void TearDownTestCase()
+	{
+		Py_Finalize();
+	}
+
+	virtual void TearDown()
+	{
+		SCA_PythonBytecodeCache::Clear();
+		remove(TEST_FILE);
+	}
+
+	/// Return the content of a cache holding the test script.
+	std::string GetCacheData()
+	{
+		PyObject *code = SCA_PythonBytecodeCache::Compile(scriptText, scriptName);
+		EXPECT_TRUE(code != nullptr);
+		Py_XDECREF(code);
+
+		std::string data;
+		SCA_PythonBytecodeCache::GetData(data);
+		SCA_PythonBytecodeCache::Clear();
+		return data;
+	}
+};
+
+TEST_F(SCA_PythonBytecodeCacheTest, SaveLoad)
+{
+	PyObject *code = SCA_PythonBytecodeCache::Compile(scriptText, scriptName);
+	ASSERT_TRUE(code != nullptr);
+	EXPECT_EQ(code_eval_value(code), 42);
+
+	// The same script shares the code object.
+	PyObject *code2 = SCA_PythonBytecodeCache::Compile(scriptText, scriptName);
+	EXPECT_EQ(code, code2);
+	Py_DECREF(code);
+	Py_DECREF(code2);
+
+	EXPECT_TRUE(SCA_PythonBytecodeCache::IsModified());
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Save(TEST_FILE));
+	EXPECT_FALSE(SCA_PythonBytecodeCache::IsModified());
+	SCA_PythonBytecodeCache::Clear();
+
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, scriptName) == nullptr);
+
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Load(TEST_FILE));
+	EXPECT_FALSE(SCA_PythonBytecodeCache::IsModified());
+	code = SCA_PythonBytecodeCache::Find(scriptText, scriptName);
+	ASSERT_TRUE(code != nullptr);
+	EXPECT_EQ(code_eval_value(code), 42);
+	Py_DECREF(code);
+
+	// The name is part of the key.
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, "other.py") == nullptr);
+}
+
+TEST_F(SCA_PythonBytecodeCacheTest, LoadData)
+{
+	const std::string data = GetCacheData();
+
+	EXPECT_TRUE(SCA_PythonBytecodeCache::LoadData(data.data(), data.size()));
+	PyObject *code = SCA_PythonBytecodeCache::Find(scriptText, scriptName);
+	ASSERT_TRUE(code != nullptr);
+	EXPECT_EQ(code_eval_value(code), 42);
+	Py_DECREF(code);
+
+	// The serialized entries are the same after a load.
+	std::string data2;
+	SCA_PythonBytecodeCache::GetData(data2);
+	EXPECT_EQ(data, data2);
+}
+
+TEST_F(SCA_PythonBytecodeCacheTest, Missing)
+{
+	EXPECT_FALSE(SCA_PythonBytecodeCache::Load(TEST_FILE));
+}
+
+TEST_F(SCA_PythonBytecodeCacheTest, Truncated)
+{
+	const std::string data = GetCacheData();
+
+	// Every truncation is rejected without adding any entry.
+	for (size_t size = 0; size < data.size(); ++size) {
+		cache_write_file(data.substr(0, size));
+		EXPECT_FALSE(SCA_PythonBytecodeCache::Load(TEST_FILE)) << "size " << size;
+		EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, scriptName) == nullptr) << "size " << size;
+	}
+
+	// Trailing data is as invalid as missing data.
+	cache_write_file(data + "garbage");
+	EXPECT_FALSE(SCA_PythonBytecodeCache::Load(TEST_FILE));
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, scriptName) == nullptr);
+}
+
+TEST_F(SCA_PythonBytecodeCacheTest, Corrupted)
+{
+	const std::string data = GetCacheData();
+	const size_t countOffset = 8 + sizeof(long);
+	const size_t checksumOffset = countOffset + sizeof(unsigned int) + 16 + sizeof(unsigned short);
+	const size_t sizeOffset = checksumOffset + 16;
+
+	// A huge number of entries.
+	std::string corrupted = data;
+	const unsigned int count = 0xFFFFFFFF;
+	corrupted.replace(countOffset, sizeof(count), (const char *)&count, sizeof(count));
+	cache_write_file(corrupted);
+	EXPECT_FALSE(SCA_PythonBytecodeCache::Load(TEST_FILE));
+
+	// A huge entry, never allocated.
+	corrupted = data;
+	const unsigned int size = 0xFFFFFFF0;
+	corrupted.replace(sizeOffset, sizeof(size), (const char *)&size, sizeof(size));
+	cache_write_file(corrupted);
+	EXPECT_FALSE(SCA_PythonBytecodeCache::Load(TEST_FILE));
+
+	// A wrong identifier.
+	corrupted = data;
+	corrupted[0] = 'X';
+	EXPECT_FALSE(SCA_PythonBytecodeCache::LoadData(corrupted.data(), corrupted.size()));
+
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, scriptName) == nullptr);
+
+	// Marshalled data not matching the checksum is dropped, the script is compiled again.
+	corrupted = data;
+	corrupted.replace(sizeOffset + sizeof(unsigned int), std::string::npos, data.size() - sizeOffset - sizeof(unsigned int), '\xff');
+	EXPECT_TRUE(SCA_PythonBytecodeCache::LoadData(corrupted.data(), corrupted.size()));
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, scriptName) == nullptr);
+	EXPECT_TRUE(SCA_PythonBytecodeCache::IsModified());
+	SCA_PythonBytecodeCache::Clear();
+
+	// A wrong checksum.
+	corrupted = data;
+	corrupted[checksumOffset] ^= 0xFF;
+	EXPECT_TRUE(SCA_PythonBytecodeCache::LoadData(corrupted.data(), corrupted.size()));
+	EXPECT_TRUE(SCA_PythonBytecodeCache::Find(scriptText, scriptName) == nullptr);
+
+	PyObject *code = SCA_PythonBytecodeCache::Compile(scriptText, scriptName);
+	ASSERT_TRUE(code != nullptr);
+	EXPECT_EQ(code_eval_value(code), 42);
+	Py_DECREF(code);
+}
@@ -0,0 +1,126 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_Frustum.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "PIL_time_utildefines.h"
+}
+
+#define NUM_SPHERES 1000000
+#define NUM_PASSES 10
+/* Same value as the culling task size of KX_CullingHandler. */
+#define TASK_SIZE 256
+
+struct SphereSet
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> radius;
+};
+
+struct SphereTaskData
+{
+	const SG_Frustum *frustum;
+	const SphereSet *spheres;
+	SG_Frustum::TestType *results;
+	unsigned int begin;
+	unsigned int end;
+};
+
+static SG_Frustum frustum_create()
+{
+	/* Perspective projection of 90 degrees, near 0.1 and far 100, looking at -Z. */
+	const float near = 0.1f;
+	const float far = 100.0f;
+	MT_Matrix4x4 mat;
+	mat.setIdentity();
+	mat[2][2] = (far + near) / (near - far);
+	mat[2][3] = 2.0f * far * near / (near - far);
+	mat[3][2] = -1.0f;
+	mat[3][3] = 0.0f;
+
+	return SG_Frustum(mat);
+}
+
+static void spheres_create(SphereSet& spheres)
+{
+	std::mt19937 gen(0);
+	std::uniform_real_distribution<float> pos(-150.0f, 150.0f);
+	std::uniform_real_distribution<float> size(0.0f, 10.0f);
+
+	for (unsigned int i = 0; i < NUM_SPHERES; ++i) {
+		spheres.x.push_back(pos(gen));
+		spheres.y.push_back(pos(gen));
+		spheres.z.push_back(pos(gen));
+		spheres.radius.push_back(size(gen));
+	}
+}
+
+static void sphere_task_func(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	SphereTaskData *data = (SphereTaskData *)taskdata;
+	const SphereSet& spheres = *data->spheres;
+	const unsigned int begin = data->begin;
+
+	data->frustum->SpheresInsideFrustum(&spheres.x[begin], &spheres.y[begin], &spheres.z[begin], &spheres.radius[begin],
+			&data->results[begin], data->end - begin);
+}
+
+TEST(SG_Frustum, SpheresInsideFrustumPerformance)
+{
+	const SG_Frustum frustum = frustum_create();
+	SphereSet spheres;
+	spheres_create(spheres);
+
+	std::vector<SG_Frustum::TestType> scalarResults(NUM_SPHERES);
+	std::vector<SG_Frustum::TestType> batchResults(NUM_SPHERES);
+	std::vector<SG_Frustum::TestType> taskResults(NUM_SPHERES);
+
+	/* One sphere at a time, as KX_CullingHandler::Process(KX_GameObject *). */
+	TIMEIT_START(scalar);
+	for (unsigned int pass = 0; pass < NUM_PASSES; ++pass) {
+		for (unsigned int i = 0; i < NUM_SPHERES; ++i) {
+			scalarResults[i] = frustum.SphereInsideFrustum(MT_Vector3(spheres.x[i], spheres.y[i], spheres.z[i]), spheres.radius[i]);
+		}
+	}
+	TIMEIT_END(scalar);
+
+	TIMEIT_START(batch);
+	for (unsigned int pass = 0; pass < NUM_PASSES; ++pass) {
+		frustum.SpheresInsideFrustum(spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(),
+				batchResults.data(), NUM_SPHERES);
+	}
+	TIMEIT_END(batch);
+
+	TaskScheduler *scheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	TaskPool *pool = BLI_task_pool_create(scheduler, nullptr);
+
+	std::vector<SphereTaskData> tasks;
+	for (unsigned int begin = 0; begin < NUM_SPHERES; begin += TASK_SIZE) {
+		tasks.push_back({&frustum, &spheres, taskResults.data(), begin, std::min(begin + TASK_SIZE, (unsigned int)NUM_SPHERES)});
+	}
+
+	TIMEIT_START(batch_tasks);
+	for (unsigned int pass = 0; pass < NUM_PASSES; ++pass) {
+		for (SphereTaskData& task : tasks) {
+			BLI_task_pool_push(pool, sphere_task_func, &task, false, TASK_PRIORITY_HIGH);
+		}
+		BLI_task_pool_work_and_wait(pool);
+	}
+	TIMEIT_END(batch_tasks);
+
+	BLI_task_pool_free(pool);
+	BLI_task_scheduler_free(scheduler);
+
+	EXPECT_EQ(scalarResults, batchResults);
+	EXPECT_EQ(scalarResults, taskResults);
+}
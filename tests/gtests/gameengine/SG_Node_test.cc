@@ -0,0 +1,207 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_Node.h"
+#include "SG_ParentRelation.h"
+#include "SG_TransformPool.h"
+
+#include <memory>
+#include <vector>
+
+extern "C" {
+#include "BLI_task.h"
+}
+
+/* Number of root nodes, each root owns a complete binary tree of this depth. */
+#define NUM_ROOTS 32
+#define TREE_DEPTH 4
+#define NUM_FRAMES 8
+
+/* Same transform propagation as the game engine normal parent relation. */
+class TestParentRelation : public SG_ParentRelation
+{
+public:
+	virtual bool UpdateChildCoordinates(SG_Node *child, const SG_Node *parent, bool& parentUpdated)
+	{
+		if (!parentUpdated && !child->IsModified()) {
+			return false;
+		}
+
+		parentUpdated = true;
+
+		if (!parent) {
+			child->SetWorldFromLocalTransform();
+		}
+		else {
+			const MT_Vector3& scale = parent->GetWorldScaling();
+			const MT_Matrix3x3& rot = parent->GetWorldOrientation();
+			child->SetWorldScale(scale * child->GetLocalScale());
+			child->SetWorldOrientation(rot * child->GetLocalOrientation());
+			child->SetWorldPosition(parent->GetWorldPosition() + scale * (rot * child->GetLocalPosition()));
+		}
+		child->ClearModified();
+
+		return true;
+	}
+
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestParentRelation();
+	}
+};
+
+/* Same relation computed by the transform pool. */
+class TestNormalParentRelation : public TestParentRelation
+{
+public:
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestNormalParentRelation();
+	}
+
+	virtual bool IsNormalRelation()
+	{
+		return true;
+	}
+};
+
+static bool test_schedule_func(SG_Node *sgnode, void *UNUSED(clientobj), void *clientinfo)
+{
+	return sgnode->Schedule(*(SG_QList *)clientinfo);
+}
+
+static void test_update_transform_func(SG_Node *UNUSED(sgnode), void *clientobj, void *UNUSED(clientinfo))
+{
+	++(*(unsigned int *)clientobj);
+}
+
+class TestSceneGraph
+{
+public:
+	SG_QList m_head;
+	std::shared_ptr<SG_TransformPool> m_pool;
+	std::vector<std::unique_ptr<SG_Node> > m_nodes;
+	unsigned int m_numTransformUpdates;
+
+	TestSceneGraph(bool normalRelation)
+		:m_pool(std::make_shared<SG_TransformPool>()),
+		m_numTransformUpdates(0),
+		m_normalRelation(normalRelation),
+		m_callbacks(nullptr, nullptr, test_update_transform_func, test_schedule_func, nullptr)
+	{
+		for (unsigned int i = 0; i < NUM_ROOTS; ++i) {
+			AddNode(nullptr, TREE_DEPTH);
+		}
+	}
+
+	/* Deterministic local transform changes, touching roots and children. */
+	void Modify(unsigned int frame)
+	{
+		for (unsigned int i = frame % 3; i < m_nodes.size(); i += 3 + frame % 5) {
+			SG_Node *node = m_nodes[i].get();
+			const float angle = (float)(i + frame) * 0.1f;
+			node->SetLocalPosition(node->GetLocalPosition() + MT_Vector3(0.1f * angle, -0.2f, 0.05f * frame));
+			node->SetLocalOrientation(node->GetLocalOrientation() * MT_Matrix3x3(MT_Vector3(angle, 0.0f, 0.5f * angle)));
+		}
+	}
+
+private:
+	bool m_normalRelation;
+	SG_Callbacks m_callbacks;
+
+	void AddNode(SG_Node *parent, unsigned int depth)
+	{
+		const float index = (float)m_nodes.size();
+		SG_Node *node = new SG_Node(&m_numTransformUpdates, &m_head, m_callbacks, m_pool);
+		m_nodes.emplace_back(node);
+
+		node->SetParentRelation(m_normalRelation ? new TestNormalParentRelation() : new TestParentRelation());
+		if (parent) {
+			parent->AddChild(node);
+		}
+		node->SetLocalPosition(MT_Vector3(index, 1.0f / (index + 1.0f), -0.5f * index));
+		node->SetLocalOrientation(MT_Matrix3x3(MT_Vector3(0.3f * index, 0.1f, -0.2f * index)));
+		node->SetLocalScale(MT_Vector3(1.0f + 0.01f * index, 1.0f, 0.9f));
+
+		if (depth > 0) {
+			AddNode(node, depth - 1);
+			AddNode(node, depth - 1);
+		}
+	}
+};
+
+static void expect_same_world_transforms(const TestSceneGraph& a, const TestSceneGraph& b)
+{
+	for (unsigned int i = 0, size = a.m_nodes.size(); i < size; ++i) {
+		const SG_Node *na = a.m_nodes[i].get();
+		const SG_Node *nb = b.m_nodes[i].get();
+		for (unsigned short j = 0; j < 3; ++j) {
+			EXPECT_EQ(na->GetWorldPosition()[j], nb->GetWorldPosition()[j]);
+			EXPECT_EQ(na->GetWorldScaling()[j], nb->GetWorldScaling()[j]);
+			for (unsigned short k = 0; k < 3; ++k) {
+				EXPECT_EQ(na->GetWorldOrientation()[j][k], nb->GetWorldOrientation()[j][k]);
+			}
+		}
+	}
+}
+
+TEST(SG_Node, UpdateScheduledParallelDeterminism)
+{
+	TaskScheduler *scheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	TaskPool *pool = BLI_task_pool_create(scheduler, nullptr);
+
+	TestSceneGraph serial(false);
+	TestSceneGraph parallel(false);
+
+	for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame) {
+		if (frame > 0) {
+			serial.Modify(frame);
+			parallel.Modify(frame);
+		}
+
+		SG_Node::UpdateScheduled(serial.m_head, frame, nullptr);
+		SG_Node::UpdateScheduled(parallel.m_head, frame, pool);
+
+		EXPECT_TRUE(serial.m_head.Empty());
+		EXPECT_TRUE(parallel.m_head.Empty());
+		EXPECT_EQ(serial.m_numTransformUpdates, parallel.m_numTransformUpdates);
+		expect_same_world_transforms(serial, parallel);
+	}
+
+	BLI_task_pool_free(pool);
+	BLI_task_scheduler_free(scheduler);
+}
+
+TEST(SG_Node, UpdateScheduledComposed)
+{
+	TestSceneGraph relation(false);
+	TestSceneGraph composed(true);
+
+	for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame) {
+		if (frame > 0) {
+			relation.Modify(frame);
+			composed.Modify(frame);
+		}
+
+		SG_Node::UpdateScheduled(relation.m_head, frame, nullptr);
+		SG_Node::UpdateScheduled(composed.m_head, frame, nullptr);
+
+		EXPECT_TRUE(composed.m_head.Empty());
+		EXPECT_EQ(relation.m_numTransformUpdates, composed.m_numTransformUpdates);
+
+		// The pool doesn't compute in the same order as the MT types.
+		for (unsigned int i = 0, size = relation.m_nodes.size(); i < size; ++i) {
+			const SG_Node *nr = relation.m_nodes[i].get();
+			SG_Node *nc = composed.m_nodes[i].get();
+			EXPECT_FALSE(nc->IsModified());
+			for (unsigned short j = 0; j < 3; ++j) {
+				EXPECT_NEAR(nr->GetWorldPosition()[j], nc->GetWorldPosition()[j], 1e-3f);
+				EXPECT_NEAR(nr->GetWorldScaling()[j], nc->GetWorldScaling()[j], 1e-5f);
+				for (unsigned short k = 0; k < 3; ++k) {
+					EXPECT_NEAR(nr->GetWorldOrientation()[j][k], nc->GetWorldOrientation()[j][k], 1e-5f);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,135 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_OcclusionBuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+/* Perspective camera at the origin looking along -Z with a 90 degrees field of view. */
+static void test_setup(SG_OcclusionBuffer& buffer)
+{
+	const float n = 0.1f;
+	const float f = 100.0f;
+	const float projection[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, (f + n) / (n - f), -1.0f,
+		0.0f, 0.0f, 2.0f * f * n / (n - f), 0.0f
+	};
+	const int viewport[4] = {0, 0, 1024, 512};
+	buffer.Setup(256, viewport, projection);
+}
+
+/* Square wall of half size 1 at z = -5. */
+static void test_append_wall(SG_OcclusionBuffer& buffer, float face)
+{
+	const float identity[16] = {
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	const float v[4][3] = {{-1.0f, -1.0f, -5.0f}, {1.0f, -1.0f, -5.0f}, {1.0f, 1.0f, -5.0f}, {-1.0f, 1.0f, -5.0f}};
+
+	buffer.SetModelMatrix(identity);
+	buffer.AppendOccluder(v[0], v[1], v[2], face);
+	buffer.AppendOccluder(v[0], v[2], v[3], face);
+}
+
+static bool test_query(SG_OcclusionBuffer& buffer, float x, float y, float z, float extent)
+{
+	const float center[3] = {x, y, z};
+	const float extents[3] = {extent, extent, extent};
+	return buffer.QueryBox(center, extents);
+}
+
+TEST(SG_OcclusionBuffer, QueryBox)
+{
+	SG_OcclusionBuffer buffer;
+	test_setup(buffer);
+
+	// Nothing is hidden without occluder.
+	EXPECT_TRUE(test_query(buffer, 0.0f, 0.0f, -10.0f, 0.5f));
+
+	test_append_wall(buffer, 0.0f);
+	EXPECT_EQ(buffer.GetWidth(), 256);
+	EXPECT_EQ(buffer.GetHeight(), 128);
+
+	// Behind the wall.
+	EXPECT_FALSE(test_query(buffer, 0.0f, 0.0f, -10.0f, 0.5f));
+	EXPECT_FALSE(test_query(buffer, 0.3f, -0.4f, -50.0f, 2.0f));
+	// In front of the wall.
+	EXPECT_TRUE(test_query(buffer, 0.0f, 0.0f, -3.0f, 0.5f));
+	// Beside the wall.
+	EXPECT_TRUE(test_query(buffer, 8.0f, 0.0f, -10.0f, 0.5f));
+	// Larger than the wall.
+	EXPECT_TRUE(test_query(buffer, 0.0f, 0.0f, -10.0f, 3.0f));
+	// Crossing the near plane.
+	EXPECT_TRUE(test_query(buffer, 0.0f, 0.0f, 0.0f, 0.5f));
+}
+
+TEST(SG_OcclusionBuffer, BackFace)
+{
+	SG_OcclusionBuffer buffer;
+
+	// The wall faces the camera.
+	test_setup(buffer);
+	test_append_wall(buffer, 1.0f);
+	EXPECT_FALSE(test_query(buffer, 0.0f, 0.0f, -10.0f, 0.5f));
+
+	// With a negative scale the wall is back facing and ignored.
+	test_setup(buffer);
+	test_append_wall(buffer, -1.0f);
+	EXPECT_TRUE(test_query(buffer, 0.0f, 0.0f, -10.0f, 0.5f));
+}
+
+/* The pyramid query must never hide a box visible in the full resolution buffer. */
+TEST(SG_OcclusionBuffer, PyramidConservative)
+{
+	SG_OcclusionBuffer buffer;
+	test_setup(buffer);
+	test_append_wall(buffer, 0.0f);
+
+	const float n = 0.1f;
+	const float f = 100.0f;
+	const int width = buffer.GetWidth();
+	const int height = buffer.GetHeight();
+
+	srand(0);
+	for (unsigned int i = 0; i < 2000; ++i) {
+		const float x = ((float)rand() / RAND_MAX - 0.5f) * 6.0f;
+		const float y = ((float)rand() / RAND_MAX - 0.5f) * 6.0f;
+		const float z = -4.0f - ((float)rand() / RAND_MAX) * 20.0f;
+		const float extent = 0.05f + ((float)rand() / RAND_MAX) * 1.5f;
+
+		if (test_query(buffer, x, y, z, extent)) {
+			continue;
+		}
+
+		// Compute the screen bounds of the box and its nearest depth.
+		float minx = width, maxx = 0.0f, miny = height, maxy = 0.0f, minz = 1.0f;
+		for (unsigned short j = 0; j < 8; ++j) {
+			const float cx = x + ((j & 1) ? extent : -extent);
+			const float cy = y + ((j & 2) ? extent : -extent);
+			const float cz = z + ((j & 4) ? extent : -extent);
+			const float w = -cz;
+			const float sx = (cx / w + 1.0f) * 0.5f * width;
+			const float sy = (cy / w + 1.0f) * 0.5f * height;
+			const float sz = ((f + n) / (n - f) * cz + 2.0f * f * n / (n - f)) / w;
+			minx = std::min(minx, sx);
+			maxx = std::max(maxx, sx);
+			miny = std::min(miny, sy);
+			maxy = std::max(maxy, sy);
+			minz = std::min(minz, sz);
+		}
+
+		for (int py = std::max(0, (int)floorf(miny)); py <= std::min(height - 1, (int)floorf(maxy)); ++py) {
+			for (int px = std::max(0, (int)floorf(minx)); px <= std::min(width - 1, (int)floorf(maxx)); ++px) {
+				EXPECT_GE(minz + 1e-5f, buffer.GetDepth(px, py));
+			}
+		}
+	}
+}
@@ -0,0 +1,140 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_Node.h"
+#include "SG_TransformPool.h"
+
+#include <memory>
+
+/* Relation computed by the transform pool, never called. */
+class TestNormalParentRelation : public SG_ParentRelation
+{
+public:
+	virtual bool UpdateChildCoordinates(SG_Node *UNUSED(child), const SG_Node *UNUSED(parent), bool& UNUSED(parentUpdated))
+	{
+		ADD_FAILURE();
+		return false;
+	}
+
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestNormalParentRelation();
+	}
+
+	virtual bool IsNormalRelation()
+	{
+		return true;
+	}
+};
+
+static bool test_schedule_func(SG_Node *sgnode, void *UNUSED(clientobj), void *clientinfo)
+{
+	return sgnode->Schedule(*(SG_QList *)clientinfo);
+}
+
+static void expect_near_vector(const MT_Vector3& a, const MT_Vector3& b)
+{
+	for (unsigned short i = 0; i < 3; ++i) {
+		EXPECT_NEAR(a[i], b[i], 1e-5f);
+	}
+}
+
+TEST(SG_TransformPool, ComputeMatrices)
+{
+	std::shared_ptr<SG_TransformPool> pool = std::make_shared<SG_TransformPool>();
+	SG_Callbacks callbacks;
+	SG_Node node(nullptr, nullptr, callbacks, pool);
+
+	node.SetWorldPosition(MT_Vector3(1.0f, -2.0f, 3.5f));
+	node.SetWorldOrientation(MT_Matrix3x3(MT_Vector3(0.3f, -1.2f, 2.0f)));
+	node.SetWorldScale(MT_Vector3(0.5f, 2.0f, -1.0f));
+
+	float expected[16];
+	float result[16];
+	node.GetWorldTransform().getValue(expected);
+	pool->ComputeMatrices({node.GetTransformSlot()}, {result});
+
+	for (unsigned short i = 0; i < 16; ++i) {
+		EXPECT_EQ(expected[i], result[i]);
+	}
+}
+
+TEST(SG_TransformPool, ComputeMinDistances2)
+{
+	std::shared_ptr<SG_TransformPool> pool = std::make_shared<SG_TransformPool>();
+	SG_Callbacks callbacks;
+	std::unique_ptr<SG_Node> nodes[2] = {
+		std::unique_ptr<SG_Node>(new SG_Node(nullptr, nullptr, callbacks, pool)),
+		std::unique_ptr<SG_Node>(new SG_Node(nullptr, nullptr, callbacks, pool))
+	};
+
+	nodes[0]->SetWorldPosition(MT_Vector3(1.0f, 0.0f, 0.0f));
+	nodes[1]->SetWorldPosition(MT_Vector3(0.0f, 10.0f, 0.0f));
+
+	std::vector<float> distances;
+	pool->ComputeMinDistances2({MT_Vector3(0.0f, 0.0f, 0.0f), MT_Vector3(0.0f, 8.0f, 0.0f)}, distances);
+
+	EXPECT_EQ(distances.size(), 2);
+	EXPECT_EQ(distances[nodes[0]->GetTransformSlot()], 1.0f);
+	EXPECT_EQ(distances[nodes[1]->GetTransformSlot()], 4.0f);
+
+	// A released slot is reused.
+	const unsigned int slot = nodes[1]->GetTransformSlot();
+	nodes[1].reset();
+	nodes[1].reset(new SG_Node(nullptr, nullptr, callbacks, pool));
+	EXPECT_EQ(nodes[1]->GetTransformSlot(), slot);
+	EXPECT_EQ(pool->GetSize(), 2);
+}
+
+TEST(SG_TransformPool, Update)
+{
+	std::shared_ptr<SG_TransformPool> pool = std::make_shared<SG_TransformPool>();
+	SG_QList head;
+	SG_Callbacks callbacks(nullptr, nullptr, nullptr, test_schedule_func, nullptr);
+
+	// The children use the first slots, the update must still go from the root.
+	SG_Node grandChild(nullptr, &head, callbacks, pool);
+	SG_Node child(nullptr, &head, callbacks, pool);
+	SG_Node root(nullptr, &head, callbacks, pool);
+	SG_Node *nodes[3] = {&root, &child, &grandChild};
+	for (unsigned short i = 0; i < 3; ++i) {
+		nodes[i]->SetParentRelation(new TestNormalParentRelation());
+		if (i > 0) {
+			nodes[i - 1]->AddChild(nodes[i]);
+		}
+		nodes[i]->SetLocalPosition(MT_Vector3(1.0f, 0.0f, 0.0f));
+		nodes[i]->SetLocalOrientation(MT_Matrix3x3(MT_Vector3(0.0f, 0.0f, M_PI_2)));
+		nodes[i]->SetLocalScale(MT_Vector3(2.0f, 2.0f, 2.0f));
+	}
+
+	SG_Node::UpdateScheduled(head, 0.0, nullptr);
+	EXPECT_TRUE(head.Empty());
+
+	expect_near_vector(root.GetWorldPosition(), MT_Vector3(1.0f, 0.0f, 0.0f));
+	expect_near_vector(child.GetWorldPosition(), MT_Vector3(1.0f, 2.0f, 0.0f));
+	expect_near_vector(grandChild.GetWorldPosition(), MT_Vector3(-3.0f, 2.0f, 0.0f));
+	expect_near_vector(grandChild.GetWorldScaling(), MT_Vector3(8.0f, 8.0f, 8.0f));
+	for (SG_Node *node : nodes) {
+		EXPECT_FALSE(node->IsModified());
+	}
+
+	// Only the modified root is scheduled, its descendants are updated with it.
+	root.SetLocalPosition(MT_Vector3(0.0f, 0.0f, 5.0f));
+	SG_Node::UpdateScheduled(head, 0.0, nullptr);
+	expect_near_vector(grandChild.GetWorldPosition(), MT_Vector3(-4.0f, 2.0f, 5.0f));
+
+	// The transforms and the hierarchy follow the nodes in an other pool.
+	std::shared_ptr<SG_TransformPool> otherPool = std::make_shared<SG_TransformPool>();
+	for (SG_Node *node : nodes) {
+		node->SetTransformPool(otherPool);
+	}
+	EXPECT_EQ(otherPool->GetSize(), 3);
+	expect_near_vector(child.GetLocalPosition(), MT_Vector3(1.0f, 0.0f, 0.0f));
+	expect_near_vector(grandChild.GetWorldPosition(), MT_Vector3(-4.0f, 2.0f, 5.0f));
+
+	child.SetLocalScale(MT_Vector3(1.0f, 1.0f, 1.0f));
+	SG_Node::UpdateScheduled(head, 0.0, nullptr);
+	expect_near_vector(grandChild.GetWorldPosition(), MT_Vector3(-2.0f, 2.0f, 5.0f));
+	expect_near_vector(grandChild.GetWorldScaling(), MT_Vector3(4.0f, 4.0f, 4.0f));
+}
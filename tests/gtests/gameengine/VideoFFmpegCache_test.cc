@@ -0,0 +1,318 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "VideoFFmpegCache.h"
+
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#define TEST_FILE "VideoFFmpegCache_test.avi"
+#define TEST_WIDTH 64
+#define TEST_HEIGHT 48
+#define TEST_FRAMES 40
+#define TEST_FRAME_RATE 25
+
+struct VideoStream
+{
+	AVFormatContext *formatCtx;
+	AVCodecContext *codecCtx;
+	int videoStream;
+};
+
+/* The luminance of the generated clip, a smooth gradient changing with each frame. */
+static unsigned char clip_luma(int x, int y, int frame)
+{
+	return (unsigned char)(16 + x + y + frame * 2);
+}
+
+static bool clip_write_packet(AVFormatContext *formatCtx, AVStream *stream, AVPacket *packet)
+{
+	AVCodecContext *codecCtx = stream->codec;
+	if (packet->pts != AV_NOPTS_VALUE) {
+		packet->pts = av_rescale_q(packet->pts, codecCtx->time_base, stream->time_base);
+	}
+	if (packet->dts != AV_NOPTS_VALUE) {
+		packet->dts = av_rescale_q(packet->dts, codecCtx->time_base, stream->time_base);
+	}
+	packet->stream_index = stream->index;
+	return (av_interleaved_write_frame(formatCtx, packet) == 0);
+}
+
+/* Encode a short MPEG-4 clip with a known luminance in each frame. */
+static bool clip_generate(const char *path)
+{
+	AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG4);
+	if (!codec) {
+		return false;
+	}
+
+	AVFormatContext *formatCtx = avformat_alloc_context();
+	formatCtx->oformat = av_guess_format("avi", nullptr, nullptr);
+	snprintf(formatCtx->filename, sizeof(formatCtx->filename), "%s", path);
+
+	AVStream *stream = avformat_new_stream(formatCtx, codec);
+	AVCodecContext *codecCtx = stream->codec;
+	codecCtx->codec_id = AV_CODEC_ID_MPEG4;
+	codecCtx->codec_type = AVMEDIA_TYPE_VIDEO;
+	codecCtx->width = TEST_WIDTH;
+	codecCtx->height = TEST_HEIGHT;
+	codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
+	codecCtx->time_base.num = 1;
+	codecCtx->time_base.den = TEST_FRAME_RATE;
+	stream->time_base = codecCtx->time_base;
+	codecCtx->gop_size = 5;
+	codecCtx->max_b_frames = 0;
+	// almost lossless, the decoded luminance is compared to the generated one
+	codecCtx->flags |= CODEC_FLAG_QSCALE;
+	codecCtx->global_quality = FF_QP2LAMBDA * 2;
+	if (formatCtx->oformat->flags & AVFMT_GLOBALHEADER) {
+		codecCtx->flags |= CODEC_FLAG_GLOBAL_HEADER;
+	}
+
+	bool success = (avcodec_open2(codecCtx, codec, nullptr) >= 0 &&
+	                avio_open(&formatCtx->pb, path, AVIO_FLAG_WRITE) >= 0);
+	if (success) {
+		success = (avformat_write_header(formatCtx, nullptr) >= 0);
+
+		AVFrame *frame = VideoFFmpegCache::AllocFrame(AV_PIX_FMT_YUV420P, TEST_WIDTH, TEST_HEIGHT, false);
+		frame->width = TEST_WIDTH;
+		frame->height = TEST_HEIGHT;
+		frame->format = AV_PIX_FMT_YUV420P;
+
+		// encode all the frames and then flush the delayed ones
+		for (int i = 0; success && i <= TEST_FRAMES; ++i) {
+			AVFrame *input = nullptr;
+			if (i < TEST_FRAMES) {
+				for (int y = 0; y < TEST_HEIGHT; ++y) {
+					for (int x = 0; x < TEST_WIDTH; ++x) {
+						frame->data[0][y * frame->linesize[0] + x] = clip_luma(x, y, i);
+					}
+				}
+				for (int y = 0; y < TEST_HEIGHT / 2; ++y) {
+					memset(frame->data[1] + y * frame->linesize[1], 128, TEST_WIDTH / 2);
+					memset(frame->data[2] + y * frame->linesize[2], 128, TEST_WIDTH / 2);
+				}
+				frame->pts = i;
+				input = frame;
+			}
+
+			int gotOutput;
+			do {
+				AVPacket packet;
+				av_init_packet(&packet);
+				packet.data = nullptr;
+				packet.size = 0;
+				if (avcodec_encode_video2(codecCtx, &packet, input, &gotOutput) < 0) {
+					success = false;
+					break;
+				}
+				if (gotOutput) {
+					success = clip_write_packet(formatCtx, stream, &packet);
+					av_free_packet(&packet);
+				}
+			} while (success && !input && gotOutput);
+		}
+
+		VideoFFmpegCache::FreeFrame(frame);
+
+		if (av_write_trailer(formatCtx) != 0) {
+			success = false;
+		}
+		avio_close(formatCtx->pb);
+	}
+
+	avcodec_close(codecCtx);
+	avformat_free_context(formatCtx);
+
+	return success;
+}
+
+static bool clip_open(const char *path, VideoStream& video)
+{
+	video.formatCtx = nullptr;
+	if (avformat_open_input(&video.formatCtx, path, nullptr, nullptr) != 0) {
+		return false;
+	}
+	if (avformat_find_stream_info(video.formatCtx, nullptr) < 0 || video.formatCtx->nb_streams != 1) {
+		avformat_close_input(&video.formatCtx);
+		return false;
+	}
+
+	video.videoStream = 0;
+	video.codecCtx = video.formatCtx->streams[0]->codec;
+	AVCodec *codec = avcodec_find_decoder(video.codecCtx->codec_id);
+	if (!codec || avcodec_open2(video.codecCtx, codec, nullptr) < 0) {
+		avformat_close_input(&video.formatCtx);
+		return false;
+	}
+	return true;
+}
+
+static void clip_close(VideoStream& video)
+{
+	avcodec_close(video.codecCtx);
+	avformat_close_input(&video.formatCtx);
+}
+
+/* Wait for the next frame of the cache, nullptr after a few seconds. */
+static VideoFFmpegCache::Frame *cache_wait_frame(VideoFFmpegCache& cache)
+{
+	for (unsigned int i = 0; i < 5000; ++i) {
+		VideoFFmpegCache::Frame *frame = cache.GetFrame();
+		if (frame) {
+			return frame;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return nullptr;
+}
+
+class VideoFFmpegCacheTest : public testing::Test
+{
+protected:
+	VideoStream m_video;
+
+	static void SetUpTestCase()
+	{
+		av_register_all();
+		ASSERT_TRUE(clip_generate(TEST_FILE));
+	}
+
+	static void TearDownTestCase()
+	{
+		remove(TEST_FILE);
+	}
+
+	virtual void SetUp()
+	{
+		ASSERT_TRUE(clip_open(TEST_FILE, m_video));
+		ASSERT_EQ(m_video.codecCtx->width, TEST_WIDTH);
+		ASSERT_EQ(m_video.codecCtx->height, TEST_HEIGHT);
+	}
+
+	virtual void TearDown()
+	{
+		clip_close(m_video);
+	}
+
+	/* Read all the frames through the cache and check their order and content. */
+	void Play(bool directYUV)
+	{
+		SwsContext *convertCtx = nullptr;
+		if (!directYUV) {
+			convertCtx = sws_getContext(TEST_WIDTH, TEST_HEIGHT, m_video.codecCtx->pix_fmt,
+			                            TEST_WIDTH, TEST_HEIGHT, AV_PIX_FMT_RGB24,
+			                            SWS_POINT, nullptr, nullptr, nullptr);
+			ASSERT_TRUE(convertCtx != nullptr);
+		}
+		else {
+			ASSERT_TRUE(VideoFFmpegCache::SupportDirectYUV(m_video.codecCtx));
+		}
+
+		{
+			VideoFFmpegCache cache(m_video.formatCtx, m_video.codecCtx, m_video.videoStream, TEST_FRAME_RATE,
+			                       true, false, convertCtx, AV_PIX_FMT_RGB24, -1);
+			cache.Start();
+
+			int numFrames = 0;
+			long lastPosition = -1;
+			while (true) {
+				VideoFFmpegCache::Frame *frame = cache_wait_frame(cache);
+				ASSERT_TRUE(frame != nullptr) << "no frame after " << numFrames << " frames";
+				if (frame->m_position == -1) {
+					break;
+				}
+
+				EXPECT_GT(frame->m_position, lastPosition);
+				lastPosition = frame->m_position;
+
+				/* The gray pixels of the clip keep their luminance in YUV and in RGB,
+				 * only the rounding of the codec and the conversion differ. */
+				const AVFrame *data = frame->m_frame;
+				for (int y = 0; y < TEST_HEIGHT; y += 7) {
+					for (int x = 0; x < TEST_WIDTH; x += 5) {
+						const int expected = clip_luma(x, y, numFrames);
+						const int value = (directYUV) ? data->data[0][y * data->linesize[0] + x] :
+						                  data->data[0][y * data->linesize[0] + x * 3] * 219 / 255 + 16;
+						EXPECT_NEAR(value, expected, 12) << "frame " << numFrames << " pixel " << x << ", " << y;
+					}
+				}
+
+				++numFrames;
+				cache.ReleaseFrame();
+			}
+			EXPECT_EQ(numFrames, TEST_FRAMES);
+			EXPECT_EQ(cache.GetPosition(), lastPosition);
+
+			cache.Stop();
+		}
+
+		if (convertCtx) {
+			sws_freeContext(convertCtx);
+		}
+	}
+
+	/* Stop the cache while its threads hold frames, then restart it to the end. */
+	void StopRestart(bool directYUV)
+	{
+		SwsContext *convertCtx = nullptr;
+		if (!directYUV) {
+			convertCtx = sws_getContext(TEST_WIDTH, TEST_HEIGHT, m_video.codecCtx->pix_fmt,
+			                            TEST_WIDTH, TEST_HEIGHT, AV_PIX_FMT_RGB24,
+			                            SWS_POINT, nullptr, nullptr, nullptr);
+		}
+
+		VideoFFmpegCache cache(m_video.formatCtx, m_video.codecCtx, m_video.videoStream, TEST_FRAME_RATE,
+		                       true, false, convertCtx, AV_PIX_FMT_RGB24, -1);
+
+		// the ready rings are full when the main thread doesn't release the frames
+		cache.Start();
+		ASSERT_TRUE(cache_wait_frame(cache) != nullptr);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		cache.Stop();
+
+		// all the frames are usable after the restart, the end of the file is reached
+		cache.Start();
+		int numFrames = 0;
+		while (true) {
+			VideoFFmpegCache::Frame *frame = cache_wait_frame(cache);
+			ASSERT_TRUE(frame != nullptr) << "no frame after " << numFrames << " frames";
+			if (frame->m_position == -1) {
+				break;
+			}
+			++numFrames;
+			cache.ReleaseFrame();
+		}
+		EXPECT_GT(numFrames, 0);
+		EXPECT_LE(numFrames, TEST_FRAMES);
+
+		cache.Stop();
+
+		if (convertCtx) {
+			sws_freeContext(convertCtx);
+		}
+	}
+};
+
+TEST_F(VideoFFmpegCacheTest, PlayConversion)
+{
+	Play(false);
+}
+
+TEST_F(VideoFFmpegCacheTest, PlayDirectYUV)
+{
+	Play(true);
+}
+
+TEST_F(VideoFFmpegCacheTest, StopRestartConversion)
+{
+	StopRestart(false);
+}
+
+TEST_F(VideoFFmpegCacheTest, StopRestartDirectYUV)
+{
+	StopRestart(true);
+}
@@ -0,0 +1,140 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "VideoFFmpeg.h"
+
+extern "C" {
+#include "BLI_threads.h"
+#include "PIL_time.h"
+}
+
+#include <cstdio>
+#include <cstdlib>
+
+/* The video played by the benchmark, the benchmark is skipped if not set. */
+#define VIDEO_FILE_VARIABLE "BGE_VIDEO_PERFORMANCE_FILE"
+/* Number of times the first frame of the video is loaded as an image. */
+#define IMAGE_LOAD_COUNT 20
+
+static VideoFFmpeg *video_open(const char *path, bool image, bool directYUV)
+{
+	HRESULT hRslt = S_OK;
+	VideoFFmpeg *video = new VideoFFmpeg(&hRslt);
+	video->initParams(0, 0, 0.0f, image, directYUV);
+	video->openFile((char *)path);
+	if (video->getStatus() == SourceEmpty) {
+		ADD_FAILURE() << "Can't open the video " << path;
+		delete video;
+		return nullptr;
+	}
+	return video;
+}
+
+static void video_close(VideoFFmpeg *video)
+{
+	if (video->release()) {
+		delete video;
+	}
+}
+
+static void print_statistics(const VideoFFmpeg::Statistics& stats, unsigned int calls, double callTime)
+{
+	if (stats.m_frames == 0) {
+		return;
+	}
+	printf("  per frame: decode %.3f ms, conversion %.3f ms, waiting in queue %.3f ms, filters %.3f ms\n",
+	       stats.m_decodeTime * 1000.0 / stats.m_frames, stats.m_convertTime * 1000.0 / stats.m_frames,
+	       stats.m_queueTime * 1000.0 / stats.m_frames, stats.m_processTime * 1000.0 / stats.m_frames);
+	printf("  per image request: %.3f ms in the main thread over %u requests\n", callTime * 1000.0 / calls, calls);
+}
+
+/* Play the video as VideoTexture.VideoFFmpeg in the game engine: the image is refreshed
+ * and requested in a loop, the video time follows the clock at speed times the frame rate.
+ * The sustained frame rate is the one at which no frame is skipped. */
+static void video_play(const char *path, bool directYUV, float speed)
+{
+	VideoFFmpeg *video = video_open(path, false, directYUV);
+	if (!video) {
+		return;
+	}
+	if (directYUV && !video->getDirectYUV()) {
+		printf("Direct YUV: not supported by the video format\n");
+		video_close(video);
+		return;
+	}
+
+	video->setFrameRate(speed);
+	video->play();
+
+	unsigned int calls = 0;
+	double callTime = 0.0;
+	const double startTime = PIL_check_seconds_timer();
+	while (video->getStatus() == SourcePlaying) {
+		const double time = PIL_check_seconds_timer();
+		video->refresh();
+		video->getImage(0, -1.0, false);
+		callTime += PIL_check_seconds_timer() - time;
+		++calls;
+	}
+	const double totalTime = PIL_check_seconds_timer() - startTime;
+
+	const VideoFFmpeg::Statistics& stats = video->getStatistics();
+	const short *size = video->getSize();
+	printf("%s at %.0fx: %dx%d, %u frames in %.3f s, %.1f fps, %u frames skipped\n",
+	       directYUV ? "Direct YUV" : "RGB conversion", speed, size[0], size[1], stats.m_frames, totalTime,
+	       stats.m_frames / totalTime, stats.m_skippedFrames);
+	print_statistics(stats, calls, callTime);
+	EXPECT_GT(stats.m_frames, 0);
+
+	video_close(video);
+}
+
+/* Load the first frame of the video as VideoTexture.ImageFFmpeg. */
+static void image_load(const char *path)
+{
+	unsigned int loads = 0;
+	double callTime = 0.0;
+	VideoFFmpeg::Statistics stats = VideoFFmpeg::Statistics();
+	const double startTime = PIL_check_seconds_timer();
+	for (unsigned int i = 0; i < IMAGE_LOAD_COUNT; ++i) {
+		VideoFFmpeg *image = video_open(path, true, false);
+		if (!image) {
+			return;
+		}
+		const double time = PIL_check_seconds_timer();
+		EXPECT_TRUE(image->getImage(0, -1.0, false) != nullptr);
+		callTime += PIL_check_seconds_timer() - time;
+		++loads;
+
+		const VideoFFmpeg::Statistics& imageStats = image->getStatistics();
+		stats.m_frames += imageStats.m_frames;
+		stats.m_decodeTime += imageStats.m_decodeTime;
+		stats.m_convertTime += imageStats.m_convertTime;
+		stats.m_processTime += imageStats.m_processTime;
+		video_close(image);
+	}
+	const double totalTime = PIL_check_seconds_timer() - startTime;
+
+	printf("Image: %u loads in %.3f s, %.1f loads per second\n", loads, totalTime, loads / totalTime);
+	print_statistics(stats, loads, callTime);
+}
+
+TEST(VideoFFmpeg, Play)
+{
+	const char *path = getenv(VIDEO_FILE_VARIABLE);
+	if (!path) {
+		printf("Set %s to the path of a video to run the benchmark.\n", VIDEO_FILE_VARIABLE);
+		return;
+	}
+
+	av_register_all();
+
+	image_load(path);
+	for (float speed = 1.0f; speed <= 8.0f; speed *= 2.0f) {
+		video_play(path, false, speed);
+		video_play(path, true, speed);
+	}
+
+	BLI_threadapi_exit();
+}
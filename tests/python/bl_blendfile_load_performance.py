@@ -0,0 +1,119 @@
+# ##### BEGIN GPL LICENSE BLOCK #####
+#
+#  This program is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU General Public License
+#  as published by the Free Software Foundation; either version 2
+#  of the License, or (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software Foundation,
+#  Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+# ##### END GPL LICENSE BLOCK #####
+
+# <pep8 compliant>
+
+"""
+Measure the loading time of a large scene file, and check the loaded meshes.
+
+Example Usage:
+
+./blender.bin --background --factory-startup \
+    --python tests/python/bl_blendfile_load_performance.py -- \
+    --objects=2000 --subdivisions=32 --repeat=5 --filepath=/tmp/load_performance.blend
+
+An existing file is loaded as is when --filepath points to it and --generate is not given.
+"""
+
+import bpy
+
+import os
+import sys
+import time
+
+
+def mesh_checksum():
+    # Only the local meshes are compared, the order of bpy.data.meshes is sorted by name.
+    totvert = 0
+    totloop = 0
+    total = 0.0
+    for me in bpy.data.meshes:
+        totvert += len(me.vertices)
+        totloop += len(me.loops)
+        for v in me.vertices[::97]:
+            total += v.co.x + v.co.y * 2.0 + v.co.z * 3.0
+        for uv in me.uv_layers:
+            total += sum(d.uv.x for d in uv.data[::97])
+    return len(bpy.data.meshes), totvert, totloop, round(total, 3)
+
+
+def scene_generate(filepath, objects, subdivisions):
+    import bmesh
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+
+    for i in range(objects):
+        me = bpy.data.meshes.new("Mesh.%05d" % i)
+        bm = bmesh.new()
+        bmesh.ops.create_grid(bm, x_segments=subdivisions, y_segments=subdivisions, size=1.0 + (i % 7))
+        for v in bm.verts:
+            v.co.z = (v.co.x * v.co.y + i) * 0.01
+        bm.to_mesh(me)
+        bm.free()
+        me.uv_textures.new()
+        me.vertex_colors.new()
+
+        ob = bpy.data.objects.new("Object.%05d" % i, me)
+        ob.location = ((i % 50) * 3.0, (i // 50) * 3.0, 0.0)
+        scene.objects.link(ob)
+
+    checksum = mesh_checksum()
+    bpy.ops.wm.save_as_mainfile(filepath=filepath, compress=False)
+    return checksum
+
+
+def main():
+    import argparse
+
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--filepath", default=os.path.join(bpy.app.tempdir, "load_performance.blend"))
+    parser.add_argument("--generate", action="store_true", help="Always generate the scene file")
+    parser.add_argument("--objects", type=int, default=1000)
+    parser.add_argument("--subdivisions", type=int, default=32)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args(argv)
+
+    if args.generate or not os.path.exists(args.filepath):
+        checksum = scene_generate(args.filepath, args.objects, args.subdivisions)
+    else:
+        bpy.ops.wm.open_mainfile(filepath=args.filepath)
+        checksum = mesh_checksum()
+
+    print("File: %s (%.1f MB)" % (args.filepath, os.path.getsize(args.filepath) / (1024.0 * 1024.0)))
+    print("Meshes: %d, vertices: %d, loops: %d" % checksum[:3])
+
+    timings = []
+    for i in range(args.repeat):
+        start = time.time()
+        bpy.ops.wm.open_mainfile(filepath=args.filepath)
+        timings.append(time.time() - start)
+
+        if mesh_checksum() != checksum:
+            print("Error: the meshes loaded differ from the saved ones")
+            sys.exit(1)
+
+    timings.sort()
+    print("Load time: min %.4f s, median %.4f s, max %.4f s" %
+          (timings[0], timings[len(timings) // 2], timings[-1]))
+
+
+if __name__ == "__main__":
+    main()